@@ -0,0 +1,206 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBADT_BENCH_H
+#define LIBADT_BENCH_H
+
+/*
+ * A small, self-contained timing harness for the benchmarks.
+ *
+ * Each benchmark is a function taking a context pointer and an
+ * iteration count, performing the measured operation that many
+ * times. The harness calibrates the iteration count so that a
+ * single repetition takes roughly LIBADT_BENCH_MIN_TIME_MS
+ * milliseconds, runs a few warmup repetitions, then records
+ * LIBADT_BENCH_REPETITIONS repetitions and reports the median and
+ * 99th percentile as one JSON object per line on stdout.
+ *
+ * Both knobs can be overridden from the environment, which is
+ * handy for quick smoke runs:
+ *
+ * 	LIBADT_BENCH_MIN_TIME_MS=1 LIBADT_BENCH_REPETITIONS=3 ./bench_libadt_vector
+ *
+ * A benchmark filter can be given as the first argument; only
+ * benchmarks whose name contains it are run.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_DEFAULT_MIN_TIME_MS 20
+#define BENCH_DEFAULT_REPETITIONS 15
+#define BENCH_WARMUP_REPETITIONS 2
+#define BENCH_MAX_REPETITIONS 1000
+
+typedef void bench_fn(void *context, size_t iterations);
+
+/*
+ * Describes a single measurement. ops_per_iteration and
+ * bytes_per_iteration describe the work done by one iteration
+ * of fn, and are used to compute ns/op and bytes/s. params is
+ * a preformatted, comma-separated list of JSON members
+ * (e.g. "\"width\":3,\"length\":1024"), or NULL.
+ */
+struct bench_case {
+	const char *name;
+	const char *params;
+	bench_fn *fn;
+	void *context;
+	double ops_per_iteration;
+	double bytes_per_iteration;
+};
+
+static const char *bench_filter = NULL;
+
+/*
+ * Prevents the compiler from optimizing away a computed value.
+ */
+#if defined(__GNUC__)
+#define bench_do_not_optimize(value) \
+	__asm__ volatile("" : : "g"(value) : "memory")
+#define bench_clobber() __asm__ volatile("" : : : "memory")
+#else
+static volatile uintptr_t bench_sink;
+#define bench_do_not_optimize(value) \
+	(bench_sink = (uintptr_t)(value))
+#define bench_clobber() ((void)0)
+#endif
+
+static inline double bench_now_ns(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double)now.tv_sec * 1e9 + (double)now.tv_nsec;
+}
+
+static inline long bench_env(const char *name, long fallback)
+{
+	const char *value = getenv(name);
+	if (!value || !*value)
+		return fallback;
+	const long result = strtol(value, NULL, 10);
+	return result > 0 ? result : fallback;
+}
+
+static inline void bench_init(int argc, char **argv)
+{
+	if (argc > 1)
+		bench_filter = argv[1];
+}
+
+static inline int bench_compare_double(const void *a, const void *b)
+{
+	const double
+		first = *(const double *)a,
+		second = *(const double *)b;
+	return (first > second) - (first < second);
+}
+
+static inline double bench_time(const struct bench_case *bench, size_t iterations)
+{
+	const double start = bench_now_ns();
+	bench->fn(bench->context, iterations);
+	return bench_now_ns() - start;
+}
+
+/*
+ * Doubles the iteration count until a repetition takes at
+ * least min_time_ns, then scales it to land close to it.
+ */
+static inline size_t bench_calibrate(const struct bench_case *bench, double min_time_ns)
+{
+	size_t iterations = 1;
+	for (;;) {
+		const double elapsed = bench_time(bench, iterations);
+		if (elapsed >= min_time_ns)
+			return iterations;
+		if (elapsed < min_time_ns / 100 && iterations < SIZE_MAX / 100) {
+			iterations *= 10;
+			continue;
+		}
+		const double scale = min_time_ns / (elapsed > 1 ? elapsed : 1);
+		const size_t next = (size_t)((double)iterations * scale * 1.1) + 1;
+		if (next <= iterations)
+			return iterations;
+		iterations = next;
+	}
+}
+
+static inline void bench_run(const struct bench_case *bench)
+{
+	if (bench_filter && !strstr(bench->name, bench_filter))
+		return;
+
+	const double min_time_ns =
+		(double)bench_env("LIBADT_BENCH_MIN_TIME_MS", BENCH_DEFAULT_MIN_TIME_MS) * 1e6;
+	long repetitions = bench_env("LIBADT_BENCH_REPETITIONS", BENCH_DEFAULT_REPETITIONS);
+	if (repetitions > BENCH_MAX_REPETITIONS)
+		repetitions = BENCH_MAX_REPETITIONS;
+
+	const size_t iterations = bench_calibrate(bench, min_time_ns);
+
+	for (int i = 0; i < BENCH_WARMUP_REPETITIONS; i++)
+		bench_time(bench, iterations);
+
+	double samples[BENCH_MAX_REPETITIONS];
+	const double ops = bench->ops_per_iteration * (double)iterations;
+	for (long i = 0; i < repetitions; i++)
+		samples[i] = bench_time(bench, iterations) / ops;
+
+	qsort(samples, (size_t)repetitions, sizeof(samples[0]), bench_compare_double);
+
+	const double
+		median = samples[repetitions / 2],
+		p99 = samples[(size_t)((double)(repetitions - 1) * 0.99 + 0.5)],
+		min = samples[0],
+		bytes_per_op = bench->bytes_per_iteration / bench->ops_per_iteration,
+		bytes_per_second = bytes_per_op > 0 ? bytes_per_op / median * 1e9 : 0;
+
+	printf(
+		"{\"benchmark\":\"%s\",\"params\":{%s},"
+		"\"iterations\":%zu,\"repetitions\":%ld,"
+		"\"ns_per_op\":%.4f,\"p99_ns_per_op\":%.4f,\"min_ns_per_op\":%.4f,"
+		"\"bytes_per_second\":%.0f}\n",
+		bench->name,
+		bench->params ? bench->params : "",
+		iterations,
+		repetitions,
+		median,
+		p99,
+		min,
+		bytes_per_second
+	);
+	fflush(stdout);
+}
+
+/*
+ * A cheap deterministic generator for benchmark inputs, so
+ * runs are comparable with each other.
+ */
+static inline uint64_t bench_random(uint64_t *state)
+{
+	uint64_t x = (*state += 0x9e3779b97f4a7c15ull);
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+	return x ^ (x >> 31);
+}
+
+#endif // LIBADT_BENCH_H
@@ -0,0 +1,92 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+#include <libadt/arena.h>
+
+static const size_t sizes[] = { 16, 64, 256, 4096 };
+
+// Allocations per simulated request
+#define BATCH 1024
+
+struct context {
+	size_t size;
+	struct libadt_arena arena;
+	struct libadt_lptr lptrs[BATCH];
+};
+
+static void bench_lptr_calloc(void *ctx, size_t iterations)
+{
+	struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		for (size_t j = 0; j < BATCH; j++)
+			context->lptrs[j] = libadt_lptr_calloc(1, context->size);
+		bench_clobber();
+		for (size_t j = 0; j < BATCH; j++)
+			libadt_lptr_free(context->lptrs[j]);
+	}
+}
+
+static void bench_arena_calloc(void *ctx, size_t iterations)
+{
+	struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		for (size_t j = 0; j < BATCH; j++)
+			context->lptrs[j] = libadt_arena_calloc(&context->arena, 1, context->size);
+		bench_clobber();
+		libadt_arena_reset(&context->arena);
+	}
+}
+
+static void bench_arena_alloc(void *ctx, size_t iterations)
+{
+	struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		for (size_t j = 0; j < BATCH; j++)
+			context->lptrs[j] = libadt_arena_alloc(&context->arena, 1, context->size);
+		bench_clobber();
+		libadt_arena_reset(&context->arena);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	static struct context context;
+	for (size_t s = 0; s < libadt_util_arrlength(sizes); s++) {
+		context.size = sizes[s];
+		context.arena = libadt_arena_init(1 << 20);
+		if (!libadt_arena_valid(context.arena))
+			return 1;
+
+		char params[32];
+		snprintf(params, sizeof(params), "\"size\":%zu", context.size);
+		const double bytes = (double)(BATCH * context.size);
+
+		const struct bench_case cases[] = {
+			{ "arena_lptr_calloc_free", params, bench_lptr_calloc, &context, BATCH, bytes },
+			{ "arena_calloc_reset", params, bench_arena_calloc, &context, BATCH, bytes },
+			{ "arena_alloc_reset", params, bench_arena_alloc, &context, BATCH, bytes },
+		};
+		for (size_t i = 0; i < libadt_util_arrlength(cases); i++)
+			bench_run(&cases[i]);
+
+		context.arena = libadt_arena_free(context.arena);
+	}
+}
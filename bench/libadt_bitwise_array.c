@@ -0,0 +1,217 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+#include <libadt/bitwise_array.h>
+#include <libadt/util.h>
+
+static const ssize_t lengths[] = { 1024, 1 << 20 };
+
+struct context {
+	struct libadt_bitwise_array array;
+	ssize_t *indices;
+	unsigned *values;
+};
+
+static unsigned mask(int width)
+{
+	return width >= 32 ? ~0u : ~(~0u << width);
+}
+
+static void bench_get_sequential(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	const struct libadt_bitwise_array array = context->array;
+	for (size_t i = 0; i < iterations; i++) {
+		unsigned sum = 0;
+		for (ssize_t j = 0; j < array.length; j++)
+			sum += libadt_bitwise_array_get(array, j);
+		bench_do_not_optimize(sum);
+	}
+}
+
+static void bench_set_sequential(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	const struct libadt_bitwise_array array = context->array;
+	const unsigned value_mask = mask(array.width);
+	for (size_t i = 0; i < iterations; i++) {
+		for (ssize_t j = 0; j < array.length; j++)
+			libadt_bitwise_array_set(array, j, (unsigned)(j + (ssize_t)i) & value_mask);
+		bench_clobber();
+	}
+}
+
+static void bench_set_random(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	const struct libadt_bitwise_array array = context->array;
+	const unsigned value_mask = mask(array.width);
+	for (size_t i = 0; i < iterations; i++) {
+		for (ssize_t j = 0; j < array.length; j++)
+			libadt_bitwise_array_set(array, context->indices[j], (unsigned)(j + (ssize_t)i) & value_mask);
+		bench_clobber();
+	}
+}
+
+static void bench_get_random(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	const struct libadt_bitwise_array array = context->array;
+	for (size_t i = 0; i < iterations; i++) {
+		unsigned sum = 0;
+		for (ssize_t j = 0; j < array.length; j++)
+			sum += libadt_bitwise_array_get(array, context->indices[j]);
+		bench_do_not_optimize(sum);
+	}
+}
+
+static void bench_get64_random(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	const struct libadt_bitwise_array array = context->array;
+	for (size_t i = 0; i < iterations; i++) {
+		uint64_t sum = 0;
+		for (ssize_t j = 0; j < array.length; j++)
+			sum += libadt_bitwise_array_get64(array, context->indices[j]);
+		bench_do_not_optimize(sum);
+	}
+}
+
+static void bench_set64_sequential(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	const struct libadt_bitwise_array array = context->array;
+	const uint64_t value_mask = ~0ull >> (64 - array.width);
+	for (size_t i = 0; i < iterations; i++) {
+		for (ssize_t j = 0; j < array.length; j++)
+			libadt_bitwise_array_set64(array, j, (uint64_t)(j + (ssize_t)i) * 0x9e3779b97f4a7c15u & value_mask);
+		bench_clobber();
+	}
+}
+
+static void bench_unpack(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		libadt_bitwise_array_unpack(context->array, 0, context->array.length, context->values);
+		bench_clobber();
+	}
+}
+
+static void bench_pack(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		libadt_bitwise_array_pack(context->array, 0, context->array.length, context->values);
+		bench_clobber();
+	}
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	for (size_t l = 0; l < libadt_util_arrlength(lengths); l++) {
+		for (int width = 1; width <= 32; width++) {
+			const ssize_t length = lengths[l];
+			uint64_t seed = 1;
+
+			struct context context = {
+				.array = libadt_bitwise_array_alloc(length, width),
+				.indices = malloc(sizeof(ssize_t) * (size_t)length),
+				.values = malloc(sizeof(unsigned) * (size_t)length),
+			};
+			if (
+				!libadt_bitwise_array_valid(context.array)
+				|| !context.indices
+				|| !context.values
+			)
+				return 1;
+
+			for (ssize_t i = 0; i < length; i++) {
+				libadt_bitwise_array_set(
+					context.array,
+					i,
+					(unsigned)bench_random(&seed) & mask(width)
+				);
+				context.indices[i] = (ssize_t)(bench_random(&seed) % (uint64_t)length);
+			}
+			libadt_bitwise_array_unpack(context.array, 0, length, context.values);
+
+			char params[64];
+			snprintf(params, sizeof(params), "\"width\":%d,\"length\":%zd", width, length);
+			const double
+				ops = (double)length,
+				bytes = (double)length * width / 8;
+
+			const struct bench_case cases[] = {
+				{ "bitwise_array_get_sequential", params, bench_get_sequential, &context, ops, bytes },
+				{ "bitwise_array_set_sequential", params, bench_set_sequential, &context, ops, bytes },
+				{ "bitwise_array_get_random", params, bench_get_random, &context, ops, bytes },
+				{ "bitwise_array_set_random", params, bench_set_random, &context, ops, bytes },
+				{ "bitwise_array_unpack", params, bench_unpack, &context, ops, bytes },
+				{ "bitwise_array_pack", params, bench_pack, &context, ops, bytes },
+			};
+			for (size_t i = 0; i < libadt_util_arrlength(cases); i++)
+				bench_run(&cases[i]);
+
+			free(context.indices);
+			free(context.values);
+			libadt_bitwise_array_free(context.array);
+		}
+
+		// Elements wider than an unsigned int, such as 40-bit offsets
+		for (int width = 33; width <= 64; width++) {
+			const ssize_t length = lengths[l];
+			uint64_t seed = 1;
+
+			struct context context = {
+				.array = libadt_bitwise_array_alloc(length, width),
+				.indices = malloc(sizeof(ssize_t) * (size_t)length),
+			};
+			if (!libadt_bitwise_array_valid(context.array) || !context.indices)
+				return 1;
+
+			for (ssize_t i = 0; i < length; i++) {
+				libadt_bitwise_array_set64(
+					context.array,
+					i,
+					bench_random(&seed) >> (64 - width)
+				);
+				context.indices[i] = (ssize_t)(bench_random(&seed) % (uint64_t)length);
+			}
+
+			char params[64];
+			snprintf(params, sizeof(params), "\"width\":%d,\"length\":%zd", width, length);
+			const double
+				ops = (double)length,
+				bytes = (double)length * width / 8;
+
+			const struct bench_case cases[] = {
+				{ "bitwise_array_get64_random", params, bench_get64_random, &context, ops, bytes },
+				{ "bitwise_array_set64_sequential", params, bench_set64_sequential, &context, ops, bytes },
+			};
+			for (size_t i = 0; i < libadt_util_arrlength(cases); i++)
+				bench_run(&cases[i]);
+
+			free(context.indices);
+			libadt_bitwise_array_free(context.array);
+		}
+	}
+}
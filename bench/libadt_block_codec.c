@@ -0,0 +1,183 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+#include <libadt/block_codec.h>
+#include <libadt/util.h>
+
+#define LENGTH (1 << 20)
+#define QUERIES 4096
+
+static const enum libadt_block_codec_mode modes[] = {
+	LIBADT_BLOCK_CODEC_FOR,
+	LIBADT_BLOCK_CODEC_DELTA,
+	LIBADT_BLOCK_CODEC_ZIGZAG_DELTA,
+};
+
+static const char *const mode_names[] = { "for", "delta", "zigzag_delta" };
+
+static const size_t block_lengths[] = { 128, 256 };
+
+struct context {
+	uint64_t *values;
+	uint64_t *out;
+	size_t blocks[QUERIES];
+	struct libadt_block_codec codec;
+	struct libadt_bitwise_array fixed;
+	enum libadt_block_codec_mode mode;
+	size_t block_length;
+};
+
+static void bench_encode(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		struct libadt_block_codec codec = libadt_block_codec_encode(
+			context->values,
+			LENGTH,
+			context->block_length,
+			context->mode
+		);
+		bench_do_not_optimize(codec.size);
+		libadt_block_codec_free(codec);
+	}
+}
+
+static void bench_decode(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		libadt_block_codec_decode(&context->codec, context->out);
+		bench_clobber();
+	}
+}
+
+static void bench_decode_block_random(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		for (size_t j = 0; j < QUERIES; j++)
+			libadt_block_codec_decode_block(&context->codec, context->blocks[j], context->out);
+		bench_clobber();
+	}
+}
+
+// The values at the single width wide enough for all of them
+static void bench_fixed_width_get64(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		for (ssize_t j = 0; j < LENGTH; j++)
+			context->out[j] = libadt_bitwise_array_get64(context->fixed, j);
+		bench_clobber();
+	}
+}
+
+static int width_of(uint64_t value)
+{
+	int width = 0;
+	for (; value; value >>= 1)
+		width++;
+	return width;
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	struct context context = {
+		.values = malloc(sizeof(uint64_t) * LENGTH),
+		.out = malloc(sizeof(uint64_t) * LENGTH),
+	};
+	if (!context.values || !context.out)
+		return 1;
+
+	// Timestamps in microseconds, with gaps of up to a millisecond
+	uint64_t seed = 1, value = (uint64_t)1700000000 * 1000000;
+	for (size_t i = 0; i < LENGTH; i++) {
+		value += bench_random(&seed) % 1000;
+		context.values[i] = value;
+	}
+
+	const int width = width_of(value);
+	context.fixed = libadt_bitwise_array_alloc(LENGTH, width);
+	if (!libadt_bitwise_array_valid(context.fixed))
+		return 1;
+	for (ssize_t i = 0; i < LENGTH; i++)
+		libadt_bitwise_array_set64(context.fixed, i, context.values[i]);
+
+	char params[128];
+	snprintf(params, sizeof(params), "\"length\":%d,\"width\":%d", LENGTH, width);
+	const struct bench_case fixed = {
+		"bitwise_array_get64_sequential",
+		params,
+		bench_fixed_width_get64,
+		&context,
+		LENGTH,
+		(double)libadt_bitwise_array_size(context.fixed),
+	};
+	bench_run(&fixed);
+
+	for (size_t m = 0; m < libadt_util_arrlength(modes); m++) {
+		for (size_t b = 0; b < libadt_util_arrlength(block_lengths); b++) {
+			context.mode = modes[m];
+			context.block_length = block_lengths[b];
+			context.codec = libadt_block_codec_encode(
+				context.values,
+				LENGTH,
+				context.block_length,
+				context.mode
+			);
+			if (!libadt_block_codec_valid(context.codec))
+				return 1;
+			for (size_t i = 0; i < QUERIES; i++)
+				context.blocks[i] = bench_random(&seed) % libadt_block_codec_blocks(context.codec);
+
+			const size_t size = libadt_block_codec_size(context.codec);
+			snprintf(
+				params,
+				sizeof(params),
+				"\"mode\":\"%s\",\"block\":%zu,\"length\":%d,\"bits_per_value\":%.2f",
+				mode_names[m],
+				context.block_length,
+				LENGTH,
+				(double)size * 8 / LENGTH
+			);
+			const struct bench_case cases[] = {
+				{ "block_codec_encode", params, bench_encode, &context, LENGTH, (double)LENGTH * 8 },
+				{ "block_codec_decode", params, bench_decode, &context, LENGTH, (double)size },
+				{
+					"block_codec_decode_block_random",
+					params,
+					bench_decode_block_random,
+					&context,
+					(double)QUERIES * context.block_length,
+					0,
+				},
+			};
+			for (size_t i = 0; i < libadt_util_arrlength(cases); i++)
+				bench_run(&cases[i]);
+
+			context.codec = libadt_block_codec_free(context.codec);
+		}
+	}
+
+	libadt_bitwise_array_free(context.fixed);
+	free(context.values);
+	free(context.out);
+}
@@ -0,0 +1,149 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+#include <libadt/elias_fano.h>
+#include <libadt/util.h>
+
+#define LENGTH (1 << 20)
+#define QUERIES 4096
+
+// The average gap between postings
+static const uint64_t gaps[] = { 8, 1000 };
+
+struct context {
+	uint64_t *values;
+	struct libadt_elias_fano sequence;
+	size_t indices[QUERIES];
+	uint64_t targets[QUERIES];
+};
+
+static void bench_get(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		uint64_t sum = 0;
+		for (size_t j = 0; j < QUERIES; j++)
+			sum += libadt_elias_fano_get(&context->sequence, context->indices[j]);
+		bench_do_not_optimize(sum);
+	}
+}
+
+static void bench_next_geq(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		uint64_t sum = 0, value;
+		for (size_t j = 0; j < QUERIES; j++)
+			sum += libadt_elias_fano_next_geq(&context->sequence, context->targets[j], &value);
+		bench_do_not_optimize(sum);
+	}
+}
+
+static void bench_iterate(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		struct libadt_elias_fano_iterator iterator = libadt_elias_fano_iterator_at(
+			&context->sequence,
+			0
+		);
+		uint64_t sum = 0, value;
+		while (libadt_elias_fano_iterator_next(&iterator, &value))
+			sum += value;
+		bench_do_not_optimize(sum);
+	}
+}
+
+// A binary search of the uncompressed values
+static void bench_lower_bound(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		size_t sum = 0;
+		for (size_t j = 0; j < QUERIES; j++) {
+			size_t low = 0, high = LENGTH;
+			while (low < high) {
+				const size_t middle = low + (high - low) / 2;
+				if (context->values[middle] < context->targets[j])
+					low = middle + 1;
+				else
+					high = middle;
+			}
+			sum += low;
+		}
+		bench_do_not_optimize(sum);
+	}
+}
+
+static void bench_sum(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		uint64_t sum = 0;
+		for (size_t j = 0; j < LENGTH; j++)
+			sum += context->values[j];
+		bench_do_not_optimize(sum);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	struct context context = { .values = malloc(sizeof(uint64_t) * LENGTH) };
+	if (!context.values)
+		return 1;
+
+	uint64_t seed = 1;
+	for (size_t g = 0; g < libadt_util_arrlength(gaps); g++) {
+		uint64_t value = 0;
+		for (size_t i = 0; i < LENGTH; i++)
+			context.values[i] = value += 1 + bench_random(&seed) % (2 * gaps[g] - 1);
+		for (size_t i = 0; i < QUERIES; i++) {
+			context.indices[i] = bench_random(&seed) % LENGTH;
+			context.targets[i] = bench_random(&seed) % value;
+		}
+
+		context.sequence = libadt_elias_fano_init(context.values, LENGTH);
+		if (!libadt_elias_fano_valid(context.sequence))
+			return 1;
+
+		char params[96];
+		snprintf(
+			params,
+			sizeof(params),
+			"\"length\":%d,\"gap\":%llu,\"bits_per_value\":%.2f",
+			LENGTH,
+			(unsigned long long)gaps[g],
+			(double)libadt_elias_fano_size(context.sequence) * 8 / LENGTH
+		);
+		const struct bench_case cases[] = {
+			{ "elias_fano_get_random", params, bench_get, &context, QUERIES, 0 },
+			{ "elias_fano_next_geq_random", params, bench_next_geq, &context, QUERIES, 0 },
+			{ "elias_fano_iterate", params, bench_iterate, &context, LENGTH, 0 },
+			{ "array_lower_bound_random", params, bench_lower_bound, &context, QUERIES, 0 },
+			{ "array_sum", params, bench_sum, &context, LENGTH, (double)LENGTH * 8 },
+		};
+		for (size_t i = 0; i < libadt_util_arrlength(cases); i++)
+			bench_run(&cases[i]);
+
+		context.sequence = libadt_elias_fano_free(context.sequence);
+	}
+	free(context.values);
+}
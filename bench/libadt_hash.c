@@ -0,0 +1,168 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+#include <libadt/hash.h>
+#include <libadt/util.h>
+
+static const size_t sizes[] = { 8, 16, 32, 64, 256, 4096, 1 << 20 };
+
+// Buffers hashed per iteration, for the small sizes
+#define BATCH 1024
+
+// Scattered buffers for the batch benchmarks, far enough apart that
+// they miss in cache
+#define SCATTER_STRIDE 4096
+#define SCATTER_COUNT (1 << 14)
+
+struct context {
+	size_t size;
+	size_t count;
+	unsigned char *data;
+	struct libadt_const_lptr lptrs[BATCH];
+	uint64_t hashes[BATCH];
+};
+
+// The byte-at-a-time hash the library used to lack a replacement for
+static uint64_t fnv1a(const unsigned char *data, size_t size)
+{
+	uint64_t hash = 0xcbf29ce484222325u;
+	for (size_t i = 0; i < size; i++)
+		hash = (hash ^ data[i]) * 0x100000001b3u;
+	return hash;
+}
+
+static void bench_hash(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++)
+		for (size_t j = 0; j < context->count; j++)
+			bench_do_not_optimize(libadt_lptr_hash(context->lptrs[j]));
+}
+
+static void bench_fnv1a(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++)
+		for (size_t j = 0; j < context->count; j++)
+			bench_do_not_optimize(fnv1a(context->lptrs[j].buffer, context->size));
+}
+
+static void bench_streaming(void *ctx, size_t iterations)
+{
+	// Hashes the buffer in 4KiB chunks, as if read from a file
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		struct libadt_lptr_hasher hasher = libadt_lptr_hasher_init(0);
+		for (size_t offset = 0; offset < context->size; offset += 4096) {
+			const size_t chunk = context->size - offset < 4096 ? context->size - offset : 4096;
+			libadt_lptr_hasher_update(
+				&hasher,
+				(struct libadt_const_lptr) { context->data + offset, 1, (ssize_t)chunk }
+			);
+		}
+		bench_do_not_optimize(libadt_lptr_hasher_final(&hasher));
+	}
+}
+
+static void bench_scattered(void *ctx, size_t iterations)
+{
+	struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		for (size_t j = 0; j < BATCH; j++)
+			context->hashes[j] = libadt_lptr_hash(context->lptrs[j]);
+		bench_clobber();
+	}
+}
+
+static void bench_scattered_batch(void *ctx, size_t iterations)
+{
+	struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		libadt_lptr_hash_batch(context->lptrs, context->hashes, BATCH, 0);
+		bench_clobber();
+	}
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	static struct context context;
+	context.data = malloc((size_t)1 << 20 > (size_t)BATCH * 64 ? (size_t)1 << 20 : (size_t)BATCH * 64);
+	unsigned char *const scattered = malloc((size_t)SCATTER_STRIDE * SCATTER_COUNT);
+	if (!context.data || !scattered)
+		return 1;
+	uint64_t state = 1;
+	for (size_t i = 0; i < (size_t)1 << 20; i++)
+		context.data[i] = (unsigned char)bench_random(&state);
+	for (size_t i = 0; i < (size_t)SCATTER_STRIDE * SCATTER_COUNT; i++)
+		scattered[i] = (unsigned char)i;
+
+	for (size_t i = 0; i < libadt_util_arrlength(sizes); i++) {
+		const size_t size = sizes[i];
+		context.size = size;
+		context.count = size <= 64 ? BATCH : 1;
+		for (size_t j = 0; j < context.count; j++)
+			context.lptrs[j] = (struct libadt_const_lptr) {
+				context.data + j * size, 1, (ssize_t)size,
+			};
+
+		const double
+			ops = (double)context.count,
+			bytes = (double)(context.count * size);
+		char params[64];
+		snprintf(params, sizeof(params), "\"size\":%zu", size);
+		const struct bench_case cases[] = {
+			{ "lptr_hash", params, bench_hash, &context, ops, bytes },
+			{ "fnv1a", params, bench_fnv1a, &context, ops, bytes },
+		};
+		for (size_t j = 0; j < libadt_util_arrlength(cases); j++)
+			bench_run(&cases[j]);
+
+		if (size >= 4096) {
+			const struct bench_case streaming = {
+				"lptr_hasher", params, bench_streaming, &context, 1, (double)size,
+			};
+			bench_run(&streaming);
+		}
+	}
+
+	// Small keys scattered through memory, as in hash table lookups
+	for (size_t i = 0; i < libadt_util_arrlength(sizes) && sizes[i] <= 64; i++) {
+		const size_t size = sizes[i];
+		for (size_t j = 0; j < BATCH; j++)
+			context.lptrs[j] = (struct libadt_const_lptr) {
+				scattered + (bench_random(&state) % SCATTER_COUNT) * SCATTER_STRIDE,
+				1,
+				(ssize_t)size,
+			};
+
+		char params[64];
+		snprintf(params, sizeof(params), "\"size\":%zu", size);
+		const struct bench_case cases[] = {
+			{ "lptr_hash_scattered", params, bench_scattered, &context, BATCH, (double)(BATCH * size) },
+			{ "lptr_hash_batch_scattered", params, bench_scattered_batch, &context, BATCH, (double)(BATCH * size) },
+		};
+		for (size_t j = 0; j < libadt_util_arrlength(cases); j++)
+			bench_run(&cases[j]);
+	}
+
+	free(context.data);
+	free(scattered);
+}
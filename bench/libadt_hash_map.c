@@ -0,0 +1,200 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+#include <libadt/hash_map.h>
+#include <libadt/util.h>
+
+static const size_t lengths[] = { 1 << 10, 1 << 16, 1 << 20, 1 << 23 };
+
+static uint64_t mix64(uint64_t x)
+{
+	x ^= x >> 33;
+	x *= 0xff51afd7ed558ccdu;
+	x ^= x >> 33;
+	x *= 0xc4ceb9fe1a85ec53u;
+	x ^= x >> 33;
+	return x;
+}
+
+#define u64_equal(a, b) ((a) == (b))
+LIBADT_HASH_MAP_DEFINE(u64_map, uint64_t, uint64_t, mix64, u64_equal)
+
+// A chained table with one allocation per entry, as a baseline
+struct node {
+	uint64_t key;
+	uint64_t value;
+	struct node *next;
+};
+
+struct chained {
+	struct node **buckets;
+	size_t mask;
+};
+
+static void chained_insert(struct chained *table, uint64_t key, uint64_t value)
+{
+	struct node **const bucket = &table->buckets[mix64(key) & table->mask];
+	struct node *const node = malloc(sizeof(*node));
+	*node = (struct node) { key, value, *bucket };
+	*bucket = node;
+}
+
+static uint64_t *chained_find(const struct chained *table, uint64_t key)
+{
+	for (struct node *node = table->buckets[mix64(key) & table->mask]; node; node = node->next)
+		if (node->key == key)
+			return &node->value;
+	return NULL;
+}
+
+static void chained_free(struct chained *table)
+{
+	for (size_t i = 0; i <= table->mask; i++)
+		for (struct node *node = table->buckets[i], *next; node; node = next) {
+			next = node->next;
+			free(node);
+		}
+	free(table->buckets);
+}
+
+struct context {
+	size_t length;
+	uint64_t *keys;
+	uint64_t *misses;
+	struct libadt_hash_map map;
+	struct chained chained;
+};
+
+static void bench_find(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++)
+		for (size_t j = 0; j < context->length; j++)
+			bench_do_not_optimize(u64_map_find(&context->map, context->keys[j]));
+}
+
+static void bench_find_miss(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++)
+		for (size_t j = 0; j < context->length; j++)
+			bench_do_not_optimize(u64_map_find(&context->map, context->misses[j]));
+}
+
+static void bench_find_generic(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++)
+		for (size_t j = 0; j < context->length; j++)
+			bench_do_not_optimize(libadt_hash_map_find(&context->map, &context->keys[j]));
+}
+
+static void bench_insert(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		struct libadt_hash_map map = u64_map_init();
+		for (size_t j = 0; j < context->length; j++)
+			u64_map_insert(&map, context->keys[j], j);
+		bench_do_not_optimize(map.length);
+		libadt_hash_map_free(map);
+	}
+}
+
+static void bench_chained_find(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++)
+		for (size_t j = 0; j < context->length; j++)
+			bench_do_not_optimize(chained_find(&context->chained, context->keys[j]));
+}
+
+static void bench_chained_insert(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		struct chained table = {
+			calloc(context->length, sizeof(*table.buckets)),
+			context->length - 1,
+		};
+		for (size_t j = 0; j < context->length; j++)
+			chained_insert(&table, context->keys[j], j);
+		bench_clobber();
+		chained_free(&table);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	uint64_t state = 1;
+	for (size_t i = 0; i < libadt_util_arrlength(lengths); i++) {
+		const size_t length = lengths[i];
+		struct context context = {
+			.length = length,
+			.keys = malloc(length * sizeof(uint64_t)),
+			.misses = malloc(length * sizeof(uint64_t)),
+			.map = u64_map_init(),
+			.chained = {
+				calloc(length, sizeof(*context.chained.buckets)),
+				length - 1,
+			},
+		};
+		if (!context.keys || !context.misses || !context.chained.buckets)
+			return 1;
+
+		// Odd keys are in the tables, even ones are not
+		for (size_t j = 0; j < length; j++) {
+			const uint64_t random = bench_random(&state);
+			context.keys[j] = random | 1;
+			context.misses[j] = random & ~(uint64_t)1;
+		}
+		for (size_t j = 0; j < length; j++) {
+			u64_map_insert(&context.map, context.keys[j], j);
+			chained_insert(&context.chained, context.keys[j], j);
+		}
+
+		// Look up in a different order to the inserts
+		for (size_t j = length - 1; j > 0; j--) {
+			const size_t k = bench_random(&state) % (j + 1);
+			const uint64_t swap = context.keys[j];
+			context.keys[j] = context.keys[k];
+			context.keys[k] = swap;
+		}
+
+		char params[64];
+		snprintf(params, sizeof(params), "\"length\":%zu", length);
+		const struct bench_case cases[] = {
+			{ "hash_map_find", params, bench_find, &context, (double)length, 0 },
+			{ "hash_map_find_miss", params, bench_find_miss, &context, (double)length, 0 },
+			{ "hash_map_find_generic", params, bench_find_generic, &context, (double)length, 0 },
+			{ "hash_map_insert", params, bench_insert, &context, (double)length, 0 },
+			{ "chained_find", params, bench_chained_find, &context, (double)length, 0 },
+			{ "chained_insert", params, bench_chained_insert, &context, (double)length, 0 },
+		};
+		for (size_t j = 0; j < libadt_util_arrlength(cases); j++)
+			bench_run(&cases[j]);
+
+		free(context.keys);
+		free(context.misses);
+		libadt_hash_map_free(context.map);
+		chained_free(&context.chained);
+	}
+}
@@ -0,0 +1,114 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+#include <libadt/lptr.h>
+
+static const ssize_t sizes[] = { 1, 4, 8 };
+static const ssize_t bytes[] = { 64, 4096, 1 << 20 };
+
+struct context {
+	struct libadt_lptr source;
+	struct libadt_lptr dest;
+};
+
+static void bench_memcpy(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		libadt_lptr_memcpy(context->dest, libadt_const_lptr(context->source));
+		bench_clobber();
+	}
+}
+
+static void bench_memmove(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	// Overlapping: shift the buffer down by one element
+	const struct libadt_lptr
+		dest = context->dest,
+		source = libadt_lptr_index(dest, 1);
+	for (size_t i = 0; i < iterations; i++) {
+		libadt_lptr_memmove(dest, libadt_const_lptr(source));
+		bench_clobber();
+	}
+}
+
+static void bench_index(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		unsigned sum = 0;
+		for (
+			struct libadt_lptr it = context->source;
+			libadt_lptr_in_bounds(it);
+			it = libadt_lptr_index(it, 1)
+		)
+			sum += *(unsigned char *)libadt_lptr_raw(it);
+		bench_do_not_optimize(sum);
+	}
+}
+
+static void bench_calloc_free(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		struct libadt_lptr lptr = libadt_lptr_calloc(
+			(size_t)context->source.length,
+			(size_t)context->source.size
+		);
+		bench_do_not_optimize(lptr.buffer);
+		libadt_lptr_free(lptr);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	for (size_t b = 0; b < libadt_util_arrlength(bytes); b++) {
+		for (size_t s = 0; s < libadt_util_arrlength(sizes); s++) {
+			const ssize_t length = bytes[b] / sizes[s];
+			struct context context = {
+				.source = libadt_lptr_calloc((size_t)length, (size_t)sizes[s]),
+				.dest = libadt_lptr_calloc((size_t)length, (size_t)sizes[s]),
+			};
+			if (!libadt_lptr_valid(context.source) || !libadt_lptr_valid(context.dest))
+				return 1;
+			memset(context.source.buffer, 0x5a, (size_t)bytes[b]);
+
+			char params[64];
+			snprintf(params, sizeof(params), "\"size\":%zd,\"length\":%zd", sizes[s], length);
+			const double
+				elements = (double)length,
+				total = (double)bytes[b];
+
+			const struct bench_case cases[] = {
+				{ "lptr_memcpy", params, bench_memcpy, &context, 1, total },
+				{ "lptr_memmove", params, bench_memmove, &context, 1, total },
+				{ "lptr_index", params, bench_index, &context, elements, total },
+				{ "lptr_calloc_free", params, bench_calloc_free, &context, 1, total },
+			};
+			for (size_t i = 0; i < libadt_util_arrlength(cases); i++)
+				bench_run(&cases[i]);
+
+			libadt_lptr_free(context.source);
+			libadt_lptr_free(context.dest);
+		}
+	}
+}
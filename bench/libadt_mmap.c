@@ -0,0 +1,113 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+#include <libadt/hash.h>
+#include <libadt/mmap.h>
+#include <libadt/util.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// Files are read from the page cache, which the first read fills
+static const size_t sizes[] = { 64 << 10, 4 << 20, 64 << 20 };
+
+struct context {
+	char path[64];
+	size_t size;
+	int flags;
+	unsigned char *buffer;
+};
+
+// Reads the whole file into a buffer and hashes it, as before
+static void bench_read(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		const int fd = open(context->path, O_RDONLY);
+		size_t done = 0;
+		ssize_t got;
+		while (done < context->size && (got = read(fd, context->buffer + done, context->size - done)) > 0)
+			done += (size_t)got;
+		close(fd);
+		bench_do_not_optimize(libadt_lptr_hash(
+			(struct libadt_const_lptr) { context->buffer, 1, (ssize_t)done }
+		));
+	}
+}
+
+// Maps the file and hashes it in place
+static void bench_mmap(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		const struct libadt_const_lptr file = libadt_lptr_mmap_file(context->path, context->flags);
+		bench_do_not_optimize(libadt_lptr_hash(file));
+		libadt_const_lptr_munmap(file);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	static struct context context;
+	strcpy(context.path, "/tmp/libadt_bench_mmap_XXXXXX");
+	const int fd = mkstemp(context.path);
+	context.buffer = malloc(sizes[libadt_util_arrlength(sizes) - 1]);
+	if (fd < 0 || !context.buffer)
+		return 1;
+
+	uint64_t state = 1;
+	for (size_t i = 0; i < sizes[libadt_util_arrlength(sizes) - 1]; i++)
+		context.buffer[i] = (unsigned char)bench_random(&state);
+
+	for (size_t i = 0; i < libadt_util_arrlength(sizes); i++) {
+		context.size = sizes[i];
+		if (ftruncate(fd, 0) || pwrite(fd, context.buffer, context.size, 0) != (ssize_t)context.size)
+			return 1;
+
+		char params[64];
+		snprintf(params, sizeof(params), "\"size\":%zu", context.size);
+		const struct {
+			const char *name;
+			int flags;
+		} mappings[] = {
+			{ "mmap_file", 0 },
+			{ "mmap_file_sequential", LIBADT_MMAP_SEQUENTIAL },
+			{ "mmap_file_populate", LIBADT_MMAP_POPULATE },
+			{ "mmap_file_hugepage", LIBADT_MMAP_HUGEPAGE | LIBADT_MMAP_POPULATE },
+		};
+
+		const struct bench_case read_case = {
+			"read_file", params, bench_read, &context, 1, (double)context.size,
+		};
+		bench_run(&read_case);
+		for (size_t j = 0; j < libadt_util_arrlength(mappings); j++) {
+			context.flags = mappings[j].flags;
+			const struct bench_case mmap_case = {
+				mappings[j].name, params, bench_mmap, &context, 1, (double)context.size,
+			};
+			bench_run(&mmap_case);
+		}
+	}
+
+	close(fd);
+	unlink(context.path);
+	free(context.buffer);
+}
@@ -0,0 +1,145 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+#include <libadt/packed_vector.h>
+#include <libadt/util.h>
+#include <libadt/vector.h>
+
+#define LENGTH (1 << 20)
+
+// IDs below 2^bits, as a list of ints that could be packed
+static const int bits[] = { 8, 20 };
+
+struct context {
+	unsigned int *values;
+	size_t *indices;
+	struct libadt_packed_vector packed;
+	struct libadt_vector vector;
+};
+
+static void bench_packed_append(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		struct libadt_packed_vector vector = libadt_packed_vector_init(1, 0);
+		for (size_t j = 0; j < LENGTH; j++)
+			vector = libadt_packed_vector_append(vector, context->values[j]);
+		bench_do_not_optimize(vector.length);
+		libadt_packed_vector_free(vector);
+	}
+}
+
+static void bench_packed_append_n(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		struct libadt_packed_vector vector = libadt_packed_vector_init(1, 0);
+		vector = libadt_packed_vector_append_n(vector, context->values, LENGTH);
+		bench_do_not_optimize(vector.length);
+		libadt_packed_vector_free(vector);
+	}
+}
+
+static void bench_packed_get_random(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		unsigned int sum = 0;
+		for (size_t j = 0; j < LENGTH; j++)
+			sum += libadt_packed_vector_get(context->packed, context->indices[j]);
+		bench_do_not_optimize(sum);
+	}
+}
+
+// The same as the packed vector, but storing whole unsigned ints
+static void bench_vector_append(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		struct libadt_vector vector = libadt_vector_init(sizeof(unsigned int), 0);
+		for (size_t j = 0; j < LENGTH; j++)
+			vector = libadt_vector_append(vector, &context->values[j]);
+		bench_do_not_optimize(vector.length);
+		libadt_vector_free(vector);
+	}
+}
+
+static void bench_vector_get_random(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	const unsigned int *const values = context->vector.buffer;
+	for (size_t i = 0; i < iterations; i++) {
+		unsigned int sum = 0;
+		for (size_t j = 0; j < LENGTH; j++)
+			sum += values[context->indices[j]];
+		bench_do_not_optimize(sum);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	struct context context = {
+		.values = malloc(sizeof(unsigned int) * LENGTH),
+		.indices = malloc(sizeof(size_t) * LENGTH),
+	};
+	if (!context.values || !context.indices)
+		return 1;
+
+	for (size_t b = 0; b < libadt_util_arrlength(bits); b++) {
+		uint64_t seed = 1;
+		for (size_t i = 0; i < LENGTH; i++) {
+			context.values[i] = (unsigned int)(bench_random(&seed) >> (64 - bits[b]));
+			context.indices[i] = bench_random(&seed) % LENGTH;
+		}
+		context.packed = libadt_packed_vector_append_n(
+			libadt_packed_vector_init(1, 0),
+			context.values,
+			LENGTH
+		);
+		context.vector = libadt_vector_append_n(
+			libadt_vector_init(sizeof(unsigned int), 0),
+			context.values,
+			LENGTH
+		);
+		if (context.packed.length != LENGTH || context.vector.length != LENGTH)
+			return 1;
+
+		char params[64];
+		snprintf(params, sizeof(params), "\"bits\":%d,\"length\":%d", bits[b], LENGTH);
+		const double
+			packed_bytes = (double)LENGTH * context.packed.width / 8,
+			vector_bytes = (double)LENGTH * sizeof(unsigned int);
+		const struct bench_case cases[] = {
+			{ "packed_vector_append", params, bench_packed_append, &context, LENGTH, packed_bytes },
+			{ "packed_vector_append_n", params, bench_packed_append_n, &context, LENGTH, packed_bytes },
+			{ "packed_vector_get_random", params, bench_packed_get_random, &context, LENGTH, packed_bytes },
+			{ "vector_append", params, bench_vector_append, &context, LENGTH, vector_bytes },
+			{ "vector_get_random", params, bench_vector_get_random, &context, LENGTH, vector_bytes },
+		};
+		for (size_t i = 0; i < libadt_util_arrlength(cases); i++)
+			bench_run(&cases[i]);
+
+		libadt_packed_vector_free(context.packed);
+		libadt_vector_free(context.vector);
+	}
+	free(context.values);
+	free(context.indices);
+}
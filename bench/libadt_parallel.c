@@ -0,0 +1,149 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+#include <libadt/parallel.h>
+#include <libadt/util.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static const size_t length = 1 << 22;
+
+struct context {
+	struct libadt_parallel parallel;
+	uint64_t *source;
+	struct libadt_lptr data;
+	struct libadt_lptr scratch;
+};
+
+static void scale(struct libadt_lptr chunk, size_t offset, void *context)
+{
+	(void)offset;
+	(void)context;
+	uint64_t *const data = chunk.buffer;
+	for (ssize_t i = 0; i < chunk.length; i++)
+		data[i] = data[i] * 3 + 1;
+}
+
+static void bench_for(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		libadt_parallel_for(context->data, scale, NULL, &context->parallel);
+		bench_clobber();
+	}
+}
+
+static void sum(void *accumulator, struct libadt_lptr chunk, void *context)
+{
+	(void)context;
+	const uint64_t *const data = chunk.buffer;
+	uint64_t result = 0;
+	for (ssize_t i = 0; i < chunk.length; i++)
+		result += data[i];
+	*(uint64_t *)accumulator += result;
+}
+
+static void add(void *accumulator, const void *other, void *context)
+{
+	(void)context;
+	*(uint64_t *)accumulator += *(const uint64_t *)other;
+}
+
+static void bench_reduce(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		uint64_t result = 0;
+		libadt_parallel_reduce(
+			context->data,
+			(struct libadt_lptr) { .buffer = &result, .size = sizeof(result), .length = 1 },
+			sum,
+			add,
+			NULL,
+			&context->parallel
+		);
+		bench_do_not_optimize(result);
+	}
+}
+
+static int compare_u64(const void *first, const void *second)
+{
+	const uint64_t a = *(const uint64_t *)first, b = *(const uint64_t *)second;
+	return (a > b) - (a < b);
+}
+
+static void bench_sort(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		memcpy(context->data.buffer, context->source, length * sizeof(uint64_t));
+		libadt_parallel_sort(context->data, context->scratch, compare_u64, &context->parallel);
+		bench_clobber();
+	}
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	struct context context = { 0 };
+	context.source = malloc(length * sizeof(uint64_t));
+	context.data = libadt_lptr_calloc(length, sizeof(uint64_t));
+	context.scratch = libadt_lptr_calloc(length, sizeof(uint64_t));
+	if (!context.source || !context.data.buffer || !context.scratch.buffer)
+		return 1;
+
+	uint64_t state = 1;
+	for (size_t i = 0; i < length; i++)
+		context.source[i] = bench_random(&state);
+	memcpy(context.data.buffer, context.source, length * sizeof(uint64_t));
+
+	const long online = sysconf(_SC_NPROCESSORS_ONLN);
+	const unsigned int max_threads = online > 0 ? (unsigned int)online : 1;
+
+	// 1, 2, 4, ... threads, then every online processor
+	for (unsigned int threads = 1; threads <= max_threads; threads *= 2) {
+		if (threads * 2 > max_threads)
+			threads = max_threads;
+		context.parallel.threads = threads;
+
+		char params[64];
+		snprintf(params, sizeof(params), "\"threads\":%u,\"length\":%zu", threads, length);
+		const double
+			ops = (double)length,
+			bytes = (double)(length * sizeof(uint64_t));
+
+		const struct bench_case cases[] = {
+			{ "parallel_for", params, bench_for, &context, ops, bytes },
+			{ "parallel_reduce", params, bench_reduce, &context, ops, bytes },
+			{ "parallel_sort", params, bench_sort, &context, ops, bytes },
+		};
+		for (size_t i = 0; i < libadt_util_arrlength(cases); i++)
+			bench_run(&cases[i]);
+
+		if (threads == max_threads)
+			break;
+	}
+
+	free(context.source);
+	libadt_lptr_free(context.data);
+	libadt_lptr_free(context.scratch);
+}
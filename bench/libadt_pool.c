@@ -0,0 +1,106 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+#include <libadt/pool.h>
+
+static const size_t sizes[] = { 16, 64, 256 };
+
+// Live objects per simulated request
+#define BATCH 1024
+
+struct context {
+	size_t size;
+	struct libadt_pool pool;
+	struct libadt_lptr lptrs[BATCH];
+	size_t order[BATCH];
+};
+
+static void bench_lptr_calloc(void *ctx, size_t iterations)
+{
+	struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		for (size_t j = 0; j < BATCH; j++)
+			context->lptrs[j] = libadt_lptr_calloc(1, context->size);
+		bench_clobber();
+		for (size_t j = 0; j < BATCH; j++)
+			libadt_lptr_free(context->lptrs[context->order[j]]);
+	}
+}
+
+static void bench_pool_calloc(void *ctx, size_t iterations)
+{
+	struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		for (size_t j = 0; j < BATCH; j++)
+			context->lptrs[j] = libadt_pool_calloc(&context->pool);
+		bench_clobber();
+		for (size_t j = 0; j < BATCH; j++)
+			libadt_pool_free(&context->pool, context->lptrs[context->order[j]]);
+	}
+}
+
+static void bench_pool_alloc(void *ctx, size_t iterations)
+{
+	struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		for (size_t j = 0; j < BATCH; j++)
+			context->lptrs[j] = libadt_pool_alloc(&context->pool);
+		bench_clobber();
+		for (size_t j = 0; j < BATCH; j++)
+			libadt_pool_free(&context->pool, context->lptrs[context->order[j]]);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	static struct context context;
+
+	// Free in a shuffled order, so free lists don't stay sorted
+	uint64_t state = 1;
+	for (size_t i = 0; i < BATCH; i++)
+		context.order[i] = i;
+	for (size_t i = BATCH - 1; i > 0; i--) {
+		const size_t j = bench_random(&state) % (i + 1), tmp = context.order[i];
+		context.order[i] = context.order[j];
+		context.order[j] = tmp;
+	}
+
+	for (size_t s = 0; s < libadt_util_arrlength(sizes); s++) {
+		context.size = sizes[s];
+		context.pool = libadt_pool_init(context.size);
+		if (!libadt_pool_valid(context.pool))
+			return 1;
+
+		char params[32];
+		snprintf(params, sizeof(params), "\"size\":%zu", context.size);
+		const double bytes = (double)(BATCH * context.size);
+
+		const struct bench_case cases[] = {
+			{ "pool_lptr_calloc_free", params, bench_lptr_calloc, &context, BATCH, bytes },
+			{ "pool_calloc_free", params, bench_pool_calloc, &context, BATCH, bytes },
+			{ "pool_alloc_free", params, bench_pool_alloc, &context, BATCH, bytes },
+		};
+		for (size_t i = 0; i < libadt_util_arrlength(cases); i++)
+			bench_run(&cases[i]);
+
+		context.pool = libadt_pool_destroy(context.pool);
+	}
+}
@@ -0,0 +1,171 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+#include <libadt/rank_select.h>
+#include <libadt/util.h>
+
+#define QUERIES 4096
+
+// Scanning from the start is linear, so it gets fewer queries
+#define SCAN_QUERIES 16
+
+static const ssize_t lengths[] = { 1 << 20, 1 << 28 };
+
+// Ones out of 256 bits
+static const unsigned int densities[] = { 128, 3 };
+
+struct context {
+	struct libadt_bitwise_array array;
+	struct libadt_rank_select index;
+	size_t positions[QUERIES];
+	size_t ones[QUERIES];
+	size_t zeros[QUERIES];
+};
+
+static void bench_rank(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		size_t sum = 0;
+		for (size_t j = 0; j < QUERIES; j++)
+			sum += libadt_rank_select_rank(&context->index, (ssize_t)context->positions[j]);
+		bench_do_not_optimize(sum);
+	}
+}
+
+static void bench_select(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		ssize_t sum = 0;
+		for (size_t j = 0; j < QUERIES; j++)
+			sum += libadt_rank_select_select(&context->index, context->ones[j]);
+		bench_do_not_optimize(sum);
+	}
+}
+
+static void bench_select0(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		ssize_t sum = 0;
+		for (size_t j = 0; j < QUERIES; j++)
+			sum += libadt_rank_select_select0(&context->index, context->zeros[j]);
+		bench_do_not_optimize(sum);
+	}
+}
+
+static void bench_init_index(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		struct libadt_rank_select index = libadt_rank_select_init(context->array);
+		bench_do_not_optimize(index.ones);
+		libadt_rank_select_free(index);
+	}
+}
+
+// Rank without an index, a word at a time from the start
+static void bench_rank_scan(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		size_t sum = 0;
+		for (size_t j = 0; j < SCAN_QUERIES; j++) {
+			const size_t position = context->positions[j];
+			for (size_t word = 0; word < position / 64; word++)
+				sum += libadt_rank_select_popcount(
+					libadt_bitwise_array_load_word(&context->array.bits[word * 8])
+				);
+			for (size_t bit = position / 64 * 64; bit < position; bit++)
+				sum += libadt_bitwise_array_get(context->array, (ssize_t)bit);
+		}
+		bench_do_not_optimize(sum);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	struct context *const context = malloc(sizeof(*context));
+	if (!context)
+		return 1;
+
+	for (size_t l = 0; l < libadt_util_arrlength(lengths); l++) {
+		for (size_t d = 0; d < libadt_util_arrlength(densities); d++) {
+			const ssize_t length = lengths[l];
+			uint64_t seed = 1;
+
+			context->array = libadt_bitwise_array_alloc(length, 1);
+			if (!libadt_bitwise_array_valid(context->array))
+				return 1;
+			const size_t size = libadt_bitwise_array_size(context->array);
+			for (size_t i = 0; i < size; i++) {
+				libadt_bitwise_array_bit byte = 0;
+				for (int bit = 0; bit < CHAR_BIT; bit++)
+					byte = (libadt_bitwise_array_bit)(
+						byte << 1 | (bench_random(&seed) % 256 < densities[d])
+					);
+				context->array.bits[i] = byte;
+			}
+
+			context->index = libadt_rank_select_init(context->array);
+			if (!libadt_rank_select_valid(context->index))
+				return 1;
+			const size_t
+				ones = context->index.ones,
+				zeros = (size_t)length - ones;
+			for (size_t i = 0; i < QUERIES; i++) {
+				context->positions[i] = bench_random(&seed) % (uint64_t)length;
+				context->ones[i] = bench_random(&seed) % ones;
+				context->zeros[i] = bench_random(&seed) % zeros;
+			}
+
+			char params[64];
+			snprintf(
+				params,
+				sizeof(params),
+				"\"length\":%zd,\"density\":%.3f",
+				length,
+				densities[d] / 256.0
+			);
+			const double bytes = (double)size;
+			const struct bench_case cases[] = {
+				{ "rank_select_rank", params, bench_rank, context, QUERIES, 0 },
+				{ "rank_select_select", params, bench_select, context, QUERIES, 0 },
+				{ "rank_select_select0", params, bench_select0, context, QUERIES, 0 },
+				{ "rank_select_init", params, bench_init_index, context, 1, bytes },
+			};
+			for (size_t i = 0; i < libadt_util_arrlength(cases); i++)
+				bench_run(&cases[i]);
+
+			if (l == 0) {
+				const struct bench_case baseline = {
+					"rank_scan", params, bench_rank_scan, context, SCAN_QUERIES, 0,
+				};
+				bench_run(&baseline);
+			}
+
+			context->index = libadt_rank_select_free(context->index);
+			libadt_bitwise_array_free(context->array);
+		}
+	}
+	free(context);
+}
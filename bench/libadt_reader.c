@@ -0,0 +1,117 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+#include <libadt/reader.h>
+#include <libadt/util.h>
+
+#include <unistd.h>
+
+// Lines of 1 to 80 bytes, read from the page cache
+#define SIZE (16 << 20)
+
+static const size_t capacities[] = { 4 << 10, LIBADT_READER_DEFAULT_CAPACITY };
+
+struct context {
+	int fd;
+	size_t capacity;
+};
+
+static void bench_next_line(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		lseek(context->fd, 0, SEEK_SET);
+		struct libadt_reader reader = libadt_reader_init(context->fd, context->capacity);
+		size_t lines = 0;
+		for (
+			struct libadt_const_lptr line = libadt_reader_next_line(&reader);
+			libadt_const_lptr_allocated(line);
+			line = libadt_reader_next_line(&reader)
+		) {
+			bench_do_not_optimize(line.length);
+			lines++;
+		}
+		bench_do_not_optimize(lines);
+		libadt_reader_free(reader);
+	}
+}
+
+// Copies each line out of the stdio buffer
+static void bench_getline(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	char *line = NULL;
+	size_t capacity = 0;
+	for (size_t i = 0; i < iterations; i++) {
+		lseek(context->fd, 0, SEEK_SET);
+		FILE *const file = fdopen(dup(context->fd), "r");
+		size_t lines = 0;
+		ssize_t length;
+		while ((length = getline(&line, &capacity, file)) >= 0) {
+			bench_do_not_optimize(length);
+			lines++;
+		}
+		bench_do_not_optimize(lines);
+		fclose(file);
+	}
+	free(line);
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	char path[] = "/tmp/libadt_bench_reader_XXXXXX";
+	struct context context = { .fd = mkstemp(path) };
+	char *const text = malloc(SIZE);
+	if (context.fd < 0 || !text)
+		return 1;
+	unlink(path);
+
+	uint64_t state = 1;
+	for (size_t i = 0; i < SIZE;) {
+		const size_t length = 1 + bench_random(&state) % 80;
+		for (size_t j = 0; j < length && i < SIZE; j++)
+			text[i++] = (char)('a' + bench_random(&state) % 26);
+		if (i < SIZE)
+			text[i++] = '\n';
+	}
+	if (write(context.fd, text, SIZE) != SIZE)
+		return 1;
+	free(text);
+
+	for (size_t i = 0; i < libadt_util_arrlength(capacities); i++) {
+		context.capacity = capacities[i];
+		char params[64];
+		snprintf(params, sizeof(params), "\"size\":%d,\"capacity\":%zu", SIZE, context.capacity);
+		const struct bench_case next_line = {
+			"reader_next_line", params, bench_next_line, &context, 1, SIZE,
+		};
+		bench_run(&next_line);
+	}
+
+	char params[32];
+	snprintf(params, sizeof(params), "\"size\":%d", SIZE);
+	const struct bench_case baseline = {
+		"getline", params, bench_getline, &context, 1, SIZE,
+	};
+	bench_run(&baseline);
+
+	close(context.fd);
+}
@@ -0,0 +1,139 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+#include <libadt/segmented_vector.h>
+#include <libadt/vector.h>
+#include <libadt/util.h>
+
+static const size_t sizes[] = { 4, 16, 64 };
+static const size_t lengths[] = { 1024, 1 << 20 };
+
+struct context {
+	size_t size;
+	size_t length;
+	unsigned char source[64];
+	struct libadt_segmented_vector filled;
+};
+
+static void bench_vector_append(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		struct libadt_vector vector = libadt_vector_init(context->size, 0);
+		for (size_t j = 0; j < context->length; j++)
+			vector = libadt_vector_append(vector, (void *)context->source);
+		bench_do_not_optimize(vector.buffer);
+		libadt_vector_free(vector);
+	}
+}
+
+static void bench_append(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		struct libadt_segmented_vector vector = libadt_segmented_vector_init(context->size, 0);
+		for (size_t j = 0; j < context->length; j++)
+			vector = libadt_segmented_vector_append(vector, context->source);
+		bench_do_not_optimize(vector.blocks);
+		libadt_segmented_vector_free(vector);
+	}
+}
+
+static void bench_index(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	const struct libadt_segmented_vector vector = context->filled;
+	for (size_t i = 0; i < iterations; i++) {
+		unsigned sum = 0;
+		for (size_t j = 0; j < vector.length; j++)
+			sum += *(unsigned char *)libadt_segmented_vector_index(vector, j);
+		bench_do_not_optimize(sum);
+	}
+}
+
+static void bench_segment(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	const struct libadt_segmented_vector vector = context->filled;
+	for (size_t i = 0; i < iterations; i++) {
+		unsigned sum = 0;
+		for (size_t j = 0; j < vector.length;) {
+			const struct libadt_lptr run = libadt_segmented_vector_segment(vector, j);
+			for (ssize_t k = 0; k < run.length; k++)
+				sum += *(unsigned char *)libadt_lptr_index(run, k).buffer;
+			j += (size_t)run.length;
+		}
+		bench_do_not_optimize(sum);
+	}
+}
+
+static void bench_index_random(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	const struct libadt_segmented_vector vector = context->filled;
+	for (size_t i = 0; i < iterations; i++) {
+		uint64_t state = 1;
+		unsigned sum = 0;
+		for (size_t j = 0; j < vector.length; j++)
+			sum += *(unsigned char *)libadt_segmented_vector_index(
+				vector,
+				bench_random(&state) % vector.length
+			);
+		bench_do_not_optimize(sum);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	static struct context context;
+	for (size_t i = 0; i < sizeof(context.source); i++)
+		context.source[i] = (unsigned char)i;
+
+	for (size_t l = 0; l < libadt_util_arrlength(lengths); l++) {
+		for (size_t s = 0; s < libadt_util_arrlength(sizes); s++) {
+			context.size = sizes[s];
+			context.length = lengths[l];
+			context.filled = libadt_segmented_vector_init(context.size, 0);
+			for (size_t i = 0; i < context.length; i++)
+				context.filled = libadt_segmented_vector_append(context.filled, context.source);
+			if (context.filled.length != context.length)
+				return 1;
+
+			char params[64];
+			snprintf(params, sizeof(params), "\"size\":%zu,\"length\":%zu", context.size, context.length);
+			const double
+				ops = (double)context.length,
+				bytes = (double)(context.length * context.size);
+
+			const struct bench_case cases[] = {
+				{ "segmented_vector_vector_append", params, bench_vector_append, &context, ops, bytes },
+				{ "segmented_vector_append", params, bench_append, &context, ops, bytes },
+				{ "segmented_vector_index", params, bench_index, &context, ops, bytes },
+				{ "segmented_vector_segment", params, bench_segment, &context, ops, bytes },
+				{ "segmented_vector_index_random", params, bench_index_random, &context, ops, bytes },
+			};
+			for (size_t i = 0; i < libadt_util_arrlength(cases); i++)
+				bench_run(&cases[i]);
+
+			context.filled = libadt_segmented_vector_free(context.filled);
+		}
+	}
+}
@@ -0,0 +1,147 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+#include <libadt/sort.h>
+#include <libadt/util.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+static const size_t lengths[] = { 1 << 10, 1 << 16, 10000000 };
+
+#define u64_less(a, b) ((a) < (b))
+LIBADT_SORT_DEFINE(sort_u64, uint64_t, u64_less)
+
+struct context {
+	size_t length;
+	uint64_t *source;
+	struct libadt_lptr data;
+	struct libadt_lptr scratch;
+};
+
+static int compare_u64(const void *first, const void *second)
+{
+	const uint64_t a = *(const uint64_t *)first, b = *(const uint64_t *)second;
+	return (a > b) - (a < b);
+}
+
+// Every case sorts a fresh copy of the same random keys, so each
+// iteration includes a memcpy of the input
+static void reset(const struct context *context)
+{
+	memcpy(context->data.buffer, context->source, context->length * sizeof(uint64_t));
+}
+
+static void bench_memcpy(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		reset(context);
+		bench_clobber();
+	}
+}
+
+static void bench_qsort(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		reset(context);
+		qsort(context->data.buffer, context->length, sizeof(uint64_t), compare_u64);
+		bench_clobber();
+	}
+}
+
+static void bench_sort(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		reset(context);
+		libadt_sort(context->data, compare_u64);
+		bench_clobber();
+	}
+}
+
+static void bench_sort_typed(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		reset(context);
+		sort_u64(context->data);
+		bench_clobber();
+	}
+}
+
+static void bench_stable_typed(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		reset(context);
+		sort_u64_stable(context->data, context->scratch);
+		bench_clobber();
+	}
+}
+
+static void bench_radix(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		reset(context);
+		libadt_sort_radix_u64(context->data, context->scratch);
+		bench_clobber();
+	}
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	for (size_t l = 0; l < libadt_util_arrlength(lengths); l++) {
+		struct context context = { .length = lengths[l] };
+		context.source = malloc(context.length * sizeof(uint64_t));
+		context.data = libadt_lptr_calloc(context.length, sizeof(uint64_t));
+		context.scratch = libadt_lptr_calloc(context.length, sizeof(uint64_t));
+		if (!context.source || !context.data.buffer || !context.scratch.buffer)
+			return 1;
+
+		uint64_t state = 1;
+		for (size_t i = 0; i < context.length; i++)
+			context.source[i] = bench_random(&state);
+
+		char params[64];
+		snprintf(params, sizeof(params), "\"length\":%zu", context.length);
+		const double
+			ops = (double)context.length,
+			bytes = (double)(context.length * sizeof(uint64_t));
+
+		const struct bench_case cases[] = {
+			{ "sort_memcpy", params, bench_memcpy, &context, ops, bytes },
+			{ "sort_qsort", params, bench_qsort, &context, ops, bytes },
+			{ "sort_introsort", params, bench_sort, &context, ops, bytes },
+			{ "sort_introsort_typed", params, bench_sort_typed, &context, ops, bytes },
+			{ "sort_stable_typed", params, bench_stable_typed, &context, ops, bytes },
+			{ "sort_radix_u64", params, bench_radix, &context, ops, bytes },
+		};
+		for (size_t i = 0; i < libadt_util_arrlength(cases); i++)
+			bench_run(&cases[i]);
+
+		free(context.source);
+		libadt_lptr_free(context.data);
+		libadt_lptr_free(context.scratch);
+	}
+}
@@ -0,0 +1,319 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+#include <libadt/str.h>
+
+static const size_t lengths[] = { 16, 1024, 1 << 16 };
+
+struct context {
+	char *str;
+	wchar_t *wstr;
+	struct libadt_const_lptr haystack;
+	struct libadt_const_lptr needle;
+	struct libadt_const_lptr set;
+};
+
+static void bench_str(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		bench_clobber();
+		bench_do_not_optimize(libadt_str(context->str).length);
+	}
+}
+
+static void bench_wstr(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		bench_clobber();
+		bench_do_not_optimize(libadt_wstr(context->wstr).length);
+	}
+}
+
+static void bench_find(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		bench_clobber();
+		bench_do_not_optimize(libadt_str_find(context->haystack, context->needle).buffer);
+	}
+}
+
+static void bench_rfind(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		bench_clobber();
+		bench_do_not_optimize(libadt_str_rfind(context->haystack, context->needle).buffer);
+	}
+}
+
+static void bench_find_byte(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		bench_clobber();
+		bench_do_not_optimize(libadt_str_find_byte(context->haystack, '\n').buffer);
+	}
+}
+
+static void bench_find_any(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		bench_clobber();
+		bench_do_not_optimize(libadt_str_find_any(context->haystack, context->set).buffer);
+	}
+}
+
+// The hand-rolled loops the search functions replace
+static void bench_loop_find(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	const char *const h = context->haystack.buffer, *const n = context->needle.buffer;
+	const ssize_t length = context->haystack.length, needle_length = context->needle.length;
+	for (size_t i = 0; i < iterations; i++) {
+		bench_clobber();
+		ssize_t j = 0;
+		while (j + needle_length <= length && memcmp(h + j, n, (size_t)needle_length))
+			j++;
+		bench_do_not_optimize(j);
+	}
+}
+
+static void bench_loop_find_any(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	const char *const h = context->haystack.buffer, *const set = context->set.buffer;
+	for (size_t i = 0; i < iterations; i++) {
+		bench_clobber();
+		ssize_t j = 0;
+		while (j < context->haystack.length && !memchr(set, h[j], (size_t)context->set.length))
+			j++;
+		bench_do_not_optimize(j);
+	}
+}
+
+// Comma-separated fields in lines of 8 fields
+#define SPLIT_LENGTH (1 << 20)
+
+// Short fields, as in CSV, and long ones, as in log lines
+static const size_t field_lengths[] = { 12, 1024 };
+
+struct split_context {
+	struct libadt_const_lptr text;
+	char *copy;
+};
+
+static void bench_split_byte(void *ctx, size_t iterations)
+{
+	const struct split_context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		size_t fields = 0;
+		for (
+			struct libadt_str_split split = libadt_str_split_next(libadt_str_split_byte(context->text, ','));
+			libadt_str_split_valid(split);
+			split = libadt_str_split_next(split)
+		) {
+			bench_do_not_optimize(split.token.length);
+			fields++;
+		}
+		bench_do_not_optimize(fields);
+	}
+}
+
+static void bench_split_any(void *ctx, size_t iterations)
+{
+	const struct split_context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		size_t fields = 0;
+		for (
+			struct libadt_str_split split = libadt_str_split_next(
+				libadt_str_split_any(context->text, libadt_str_literal(",\n"))
+			);
+			libadt_str_split_valid(split);
+			split = libadt_str_split_next(split)
+		) {
+			bench_do_not_optimize(split.token.length);
+			fields++;
+		}
+		bench_do_not_optimize(fields);
+	}
+}
+
+static void bench_split_substring(void *ctx, size_t iterations)
+{
+	const struct split_context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		size_t fields = 0;
+		for (
+			struct libadt_str_split split = libadt_str_split_next(
+				libadt_str_split(context->text, libadt_str_literal(","))
+			);
+			libadt_str_split_valid(split);
+			split = libadt_str_split_next(split)
+		) {
+			bench_do_not_optimize(split.token.length);
+			fields++;
+		}
+		bench_do_not_optimize(fields);
+	}
+}
+
+// A search per field, rather than a bitmask per 64 bytes
+static void bench_find_byte_loop(void *ctx, size_t iterations)
+{
+	const struct split_context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		size_t fields = 0;
+		struct libadt_const_lptr rest = context->text;
+		for (;;) {
+			const struct libadt_const_lptr comma = libadt_str_find_byte(rest, ',');
+			fields++;
+			if (!libadt_const_lptr_allocated(comma))
+				break;
+			bench_do_not_optimize((const char *)comma.buffer - (const char *)rest.buffer);
+			rest = libadt_const_lptr_after(rest, comma);
+		}
+		bench_do_not_optimize(fields);
+	}
+}
+
+// Copying each field out, as splitting was done before
+static void bench_loop_split(void *ctx, size_t iterations)
+{
+	const struct split_context *context = ctx;
+	const char *const text = context->text.buffer;
+	for (size_t i = 0; i < iterations; i++) {
+		size_t fields = 0, length = 0;
+		for (ssize_t j = 0; j < context->text.length; j++) {
+			if (text[j] == ',') {
+				context->copy[length] = '\0';
+				bench_do_not_optimize(context->copy);
+				fields++;
+				length = 0;
+			} else {
+				context->copy[length++] = text[j];
+			}
+		}
+		bench_do_not_optimize(fields);
+	}
+}
+
+static void run_split(size_t field_length)
+{
+	char *const text = malloc(SPLIT_LENGTH);
+	struct split_context context = {
+		.text = { text, 1, SPLIT_LENGTH },
+		.copy = malloc(SPLIT_LENGTH + 1),
+	};
+	if (!text || !context.copy)
+		exit(1);
+
+	uint64_t state = 1;
+	size_t fields = 0;
+	for (size_t i = 0; i < SPLIT_LENGTH;) {
+		const size_t length = 1 + bench_random(&state) % field_length;
+		for (size_t j = 0; j < length && i < SPLIT_LENGTH; j++)
+			text[i++] = (char)('a' + bench_random(&state) % 26);
+		if (i < SPLIT_LENGTH)
+			text[i++] = ++fields % 8 ? ',' : '\n';
+	}
+
+	char params[64];
+	snprintf(
+		params,
+		sizeof(params),
+		"\"length\":%d,\"max_field\":%zu",
+		SPLIT_LENGTH,
+		field_length
+	);
+	const struct bench_case cases[] = {
+		{ "str_split_byte", params, bench_split_byte, &context, 1, SPLIT_LENGTH },
+		{ "str_split_any", params, bench_split_any, &context, 1, SPLIT_LENGTH },
+		{ "str_split_substring", params, bench_split_substring, &context, 1, SPLIT_LENGTH },
+		{ "find_byte_loop", params, bench_find_byte_loop, &context, 1, SPLIT_LENGTH },
+		{ "loop_split", params, bench_loop_split, &context, 1, SPLIT_LENGTH },
+	};
+	for (size_t i = 0; i < libadt_util_arrlength(cases); i++)
+		bench_run(&cases[i]);
+
+	free(text);
+	free(context.copy);
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	for (size_t l = 0; l < libadt_util_arrlength(lengths); l++) {
+		const size_t length = lengths[l];
+		struct context context = {
+			.str = malloc(length + 1),
+			.wstr = malloc(sizeof(wchar_t) * (length + 1)),
+		};
+		if (!context.str || !context.wstr)
+			return 1;
+		for (size_t i = 0; i < length; i++) {
+			context.str[i] = (char)('a' + i % 26);
+			context.wstr[i] = (wchar_t)('a' + i % 26);
+		}
+		context.str[length] = '\0';
+		context.wstr[length] = L'\0';
+
+		char params[32];
+		snprintf(params, sizeof(params), "\"length\":%zu", length);
+
+		// Log-like text, with the needle and the set only at the end
+		char *const text = malloc(length);
+		if (!text)
+			return 1;
+		static const char line[] = "2024-01-01 12:00:00 INFO request handled in 3ms";
+		for (size_t i = 0; i < length; i++)
+			text[i] = line[i % (sizeof(line) - 1)];
+		static const char needle[] = "ERROR: disk";
+		if (length >= sizeof(needle))
+			memcpy(text + length - (sizeof(needle) - 1), needle, sizeof(needle) - 1);
+		text[length - 1] = '\n';
+		context.haystack = (struct libadt_const_lptr) { text, 1, (ssize_t)length };
+		context.needle = libadt_str_literal(needle);
+		context.set = libadt_str_literal("\n\t;|");
+
+		const struct bench_case cases[] = {
+			{ "str", params, bench_str, &context, 1, (double)length },
+			{ "wstr", params, bench_wstr, &context, 1, (double)(length * sizeof(wchar_t)) },
+			{ "str_find", params, bench_find, &context, 1, (double)length },
+			{ "str_rfind", params, bench_rfind, &context, 1, (double)length },
+			{ "str_find_byte", params, bench_find_byte, &context, 1, (double)length },
+			{ "str_find_any", params, bench_find_any, &context, 1, (double)length },
+			{ "loop_find", params, bench_loop_find, &context, 1, (double)length },
+			{ "loop_find_any", params, bench_loop_find_any, &context, 1, (double)length },
+		};
+		for (size_t i = 0; i < libadt_util_arrlength(cases); i++)
+			bench_run(&cases[i]);
+
+		free(context.str);
+		free(context.wstr);
+		free(text);
+	}
+
+	for (size_t i = 0; i < libadt_util_arrlength(field_lengths); i++)
+		run_split(field_lengths[i]);
+}
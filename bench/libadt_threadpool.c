@@ -0,0 +1,186 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+#include <libadt/threadpool.h>
+#include <libadt/parallel.h>
+#include <libadt/util.h>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+static const size_t tasks = 10000;
+static const unsigned int fib_n = 22;
+static const size_t parallel_length = 1 << 16;
+
+struct context {
+	struct libadt_threadpool *pool;
+	struct libadt_threadpool_task *tasks;
+	struct libadt_parallel parallel;
+	struct libadt_lptr data;
+};
+
+static void nothing(void *context)
+{
+	bench_do_not_optimize(context);
+}
+
+static void bench_spawn(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		struct libadt_threadpool_group group = LIBADT_THREADPOOL_GROUP_INIT;
+		for (size_t j = 0; j < tasks; j++)
+			libadt_threadpool_spawn(context->pool, &group, &context->tasks[j]);
+		libadt_threadpool_wait(context->pool, &group);
+	}
+}
+
+static void bench_spawn_n(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		struct libadt_threadpool_group group = LIBADT_THREADPOOL_GROUP_INIT;
+		libadt_threadpool_spawn_n(context->pool, &group, context->tasks, tasks);
+		libadt_threadpool_wait(context->pool, &group);
+	}
+}
+
+struct fib {
+	struct libadt_threadpool *pool;
+	unsigned int n;
+	unsigned long result;
+};
+
+static void fib(void *context)
+{
+	struct fib *const f = context;
+	if (f->n < 2) {
+		f->result = f->n;
+		return;
+	}
+
+	struct fib
+		left = { f->pool, f->n - 1, 0 },
+		right = { f->pool, f->n - 2, 0 };
+	struct libadt_threadpool_task task = { .function = fib, .context = &left };
+	struct libadt_threadpool_group group = LIBADT_THREADPOOL_GROUP_INIT;
+	libadt_threadpool_spawn(f->pool, &group, &task);
+	fib(&right);
+	libadt_threadpool_wait(f->pool, &group);
+	f->result = left.result + right.result;
+}
+
+// Every call with n >= 2 spawns one task
+static double fib_spawns(unsigned int n)
+{
+	double a = 0, b = 0;
+	for (unsigned int i = 2; i <= n; i++) {
+		const double next = a + b + 1;
+		a = b;
+		b = next;
+	}
+	return b;
+}
+
+static void bench_fib(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		struct fib f = { context->pool, fib_n, 0 };
+		struct libadt_threadpool_task task = { .function = fib, .context = &f };
+		struct libadt_threadpool_group group = LIBADT_THREADPOOL_GROUP_INIT;
+		libadt_threadpool_spawn(context->pool, &group, &task);
+		libadt_threadpool_wait(context->pool, &group);
+		bench_do_not_optimize(f.result);
+	}
+}
+
+static void increment(struct libadt_lptr chunk, size_t offset, void *context)
+{
+	(void)offset;
+	(void)context;
+	uint64_t *const data = chunk.buffer;
+	for (ssize_t i = 0; i < chunk.length; i++)
+		data[i]++;
+}
+
+static void bench_parallel_for(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		libadt_parallel_for(context->data, increment, NULL, &context->parallel);
+		bench_clobber();
+	}
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	struct context context = { 0 };
+	context.tasks = calloc(tasks, sizeof(*context.tasks));
+	context.data = libadt_lptr_calloc(parallel_length, sizeof(uint64_t));
+	if (!context.tasks || !context.data.buffer)
+		return 1;
+	for (size_t i = 0; i < tasks; i++)
+		context.tasks[i] = (struct libadt_threadpool_task) { .function = nothing };
+
+	const long online = sysconf(_SC_NPROCESSORS_ONLN);
+	const unsigned int max_threads = online > 0 ? (unsigned int)online : 1;
+
+	// 1, 2, 4, ... workers, then one per online processor
+	for (unsigned int threads = 1; threads <= max_threads; threads *= 2) {
+		if (threads * 2 > max_threads)
+			threads = max_threads;
+		context.pool = libadt_threadpool_init(threads);
+		if (!context.pool)
+			return 1;
+
+		char params[64];
+		snprintf(params, sizeof(params), "\"threads\":%u", threads);
+
+		// The same work, starting threads for each call
+		context.parallel = (struct libadt_parallel) { .threads = threads + 1, .serial_bytes = 1 };
+		const struct bench_case threaded = {
+			"threadpool_parallel_for_threads", params, bench_parallel_for, &context,
+			(double)parallel_length, (double)(parallel_length * sizeof(uint64_t)),
+		};
+		bench_run(&threaded);
+
+		context.parallel.pool = context.pool;
+		const struct bench_case cases[] = {
+			{ "threadpool_spawn", params, bench_spawn, &context, (double)tasks, 0 },
+			{ "threadpool_spawn_n", params, bench_spawn_n, &context, (double)tasks, 0 },
+			{ "threadpool_fib", params, bench_fib, &context, fib_spawns(fib_n), 0 },
+			{
+				"threadpool_parallel_for", params, bench_parallel_for, &context,
+				(double)parallel_length, (double)(parallel_length * sizeof(uint64_t)),
+			},
+		};
+		for (size_t i = 0; i < libadt_util_arrlength(cases); i++)
+			bench_run(&cases[i]);
+
+		libadt_threadpool_free(context.pool);
+		if (threads == max_threads)
+			break;
+	}
+
+	free(context.tasks);
+	libadt_lptr_free(context.data);
+}
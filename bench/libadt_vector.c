@@ -0,0 +1,216 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+#include <libadt/vector.h>
+#include <libadt/util.h>
+
+static const size_t sizes[] = { 1, 4, 8, 16, 64 };
+static const size_t lengths[] = { 1024, 1 << 20 };
+
+// Elements appended per libadt_vector_append_n() call
+#define BATCH 64
+
+struct context {
+	size_t size;
+	size_t length;
+	unsigned char *source;
+	struct libadt_vector filled;
+};
+
+static void bench_append(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		struct libadt_vector vector = libadt_vector_init(context->size, 0);
+		for (size_t j = 0; j < context->length; j++)
+			vector = libadt_vector_append(vector, context->source);
+		bench_do_not_optimize(vector.buffer);
+		libadt_vector_free(vector);
+	}
+}
+
+static void bench_append_n(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		struct libadt_vector vector = libadt_vector_init(context->size, 0);
+		for (size_t j = 0; j < context->length; j += BATCH)
+			vector = libadt_vector_append_n(vector, context->source, BATCH);
+		bench_do_not_optimize(vector.buffer);
+		libadt_vector_free(vector);
+	}
+}
+
+// Simulates decoding records: each batch is produced by writing
+// every byte, either into a scratch buffer which is then appended,
+// or directly into the vector
+static void bench_decode_append_n(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	unsigned char scratch[64 * BATCH];
+	for (size_t i = 0; i < iterations; i++) {
+		struct libadt_vector vector = libadt_vector_init(context->size, 0);
+		for (size_t j = 0; j < context->length; j += BATCH) {
+			memset(scratch, (int)j, context->size * BATCH);
+			bench_clobber();
+			vector = libadt_vector_append_n(vector, scratch, BATCH);
+		}
+		bench_do_not_optimize(vector.buffer);
+		libadt_vector_free(vector);
+	}
+}
+
+static void bench_decode_extend_uninit(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		struct libadt_vector vector = libadt_vector_init(context->size, 0);
+		for (size_t j = 0; j < context->length; j += BATCH) {
+			void *slots;
+			vector = libadt_vector_extend_uninit(vector, BATCH, &slots);
+			memset(slots, (int)j, context->size * BATCH);
+			bench_clobber();
+			vector = libadt_vector_commit(vector, BATCH);
+		}
+		bench_do_not_optimize(vector.buffer);
+		libadt_vector_free(vector);
+	}
+}
+
+static void bench_append_n_huge(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		struct libadt_vector vector = libadt_vector_init_huge(context->size, 0);
+		for (size_t j = 0; j < context->length; j += BATCH)
+			vector = libadt_vector_append_n(vector, context->source, BATCH);
+		bench_do_not_optimize(vector.buffer);
+		libadt_vector_free(vector);
+	}
+}
+
+static void bench_append_growth_half(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		struct libadt_vector vector = libadt_vector_init(context->size, 0);
+		vector.growth = &libadt_vector_growth_half;
+		for (size_t j = 0; j < context->length; j++)
+			vector = libadt_vector_append(vector, context->source);
+		bench_do_not_optimize(vector.buffer);
+		libadt_vector_free(vector);
+	}
+}
+
+static void bench_append_reserved(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	for (size_t i = 0; i < iterations; i++) {
+		struct libadt_vector vector = libadt_vector_init(context->size, 0);
+		vector = libadt_vector_reserve(vector, context->length);
+		for (size_t j = 0; j < context->length; j++)
+			vector = libadt_vector_append(vector, context->source);
+		bench_do_not_optimize(vector.buffer);
+		libadt_vector_free(vector);
+	}
+}
+
+static void bench_append_preallocated(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	struct libadt_vector vector = libadt_vector_init(context->size, context->length);
+	for (size_t i = 0; i < iterations; i++) {
+		vector.length = 0;
+		for (size_t j = 0; j < context->length; j++)
+			vector = libadt_vector_append(vector, context->source);
+		bench_do_not_optimize(vector.buffer);
+	}
+	libadt_vector_free(vector);
+}
+
+static void bench_pop(void *ctx, size_t iterations)
+{
+	struct context *context = ctx;
+	unsigned char out[64];
+	for (size_t i = 0; i < iterations; i++) {
+		struct libadt_vector vector = context->filled;
+		while (vector.length)
+			vector = libadt_vector_pop(vector, out);
+		bench_do_not_optimize(out[0]);
+	}
+}
+
+static void bench_index(void *ctx, size_t iterations)
+{
+	const struct context *context = ctx;
+	const struct libadt_vector vector = context->filled;
+	for (size_t i = 0; i < iterations; i++) {
+		unsigned sum = 0;
+		for (size_t j = 0; j < vector.length; j++)
+			sum += *(unsigned char *)libadt_vector_index(vector, j);
+		bench_do_not_optimize(sum);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	unsigned char source[64 * BATCH];
+	for (size_t i = 0; i < sizeof(source); i++)
+		source[i] = (unsigned char)i;
+
+	for (size_t l = 0; l < libadt_util_arrlength(lengths); l++) {
+		for (size_t s = 0; s < libadt_util_arrlength(sizes); s++) {
+			struct context context = {
+				.size = sizes[s],
+				.length = lengths[l],
+				.source = source,
+				.filled = libadt_vector_init(sizes[s], lengths[l]),
+			};
+			if (!libadt_vector_valid(context.filled))
+				return 1;
+			for (size_t i = 0; i < context.length; i++)
+				context.filled = libadt_vector_append(context.filled, source);
+
+			char params[64];
+			snprintf(params, sizeof(params), "\"size\":%zu,\"length\":%zu", context.size, context.length);
+			const double
+				ops = (double)context.length,
+				bytes = (double)(context.length * context.size);
+
+			const struct bench_case cases[] = {
+				{ "vector_append", params, bench_append, &context, ops, bytes },
+				{ "vector_append_n", params, bench_append_n, &context, ops, bytes },
+				{ "vector_decode_append_n", params, bench_decode_append_n, &context, ops, bytes },
+				{ "vector_decode_extend_uninit", params, bench_decode_extend_uninit, &context, ops, bytes },
+				{ "vector_append_n_huge", params, bench_append_n_huge, &context, ops, bytes },
+				{ "vector_append_growth_half", params, bench_append_growth_half, &context, ops, bytes },
+				{ "vector_append_reserved", params, bench_append_reserved, &context, ops, bytes },
+				{ "vector_append_preallocated", params, bench_append_preallocated, &context, ops, bytes },
+				{ "vector_pop", params, bench_pop, &context, ops, bytes },
+				{ "vector_index", params, bench_index, &context, ops, bytes },
+			};
+			for (size_t i = 0; i < libadt_util_arrlength(cases); i++)
+				bench_run(&cases[i]);
+
+			libadt_vector_free(context.filled);
+		}
+	}
+}
@@ -0,0 +1,177 @@
+#define _GNU_SOURCE
+
+#include "libadt/allocator.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// This file just exposes the implementations in the
+// .h file as external symbols in the shared object.
+
+void *libadt_allocator_allocate(
+	const struct libadt_allocator *allocator,
+	size_t size
+);
+void *libadt_allocator_reallocate(
+	const struct libadt_allocator *allocator,
+	void *buffer,
+	size_t old_size,
+	size_t new_size
+);
+void libadt_allocator_deallocate(
+	const struct libadt_allocator *allocator,
+	void *buffer,
+	size_t size
+);
+
+/*
+ * libadt_allocator_huge
+ *
+ * Whether an allocation is mapped is decided by its size alone, which
+ * is always passed back to the allocator, so no bookkeeping is needed.
+ */
+
+#ifdef __linux__
+
+static size_t huge_threshold(void *context)
+{
+	return context ? *(const size_t *)context : LIBADT_ALLOCATOR_HUGE_THRESHOLD;
+}
+
+static size_t page_round(size_t size)
+{
+	const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+	return (size + page - 1) / page * page;
+}
+
+static void advise(void *buffer, size_t size)
+{
+#ifdef MADV_HUGEPAGE
+	madvise(buffer, page_round(size), MADV_HUGEPAGE);
+#else
+	(void)buffer;
+	(void)size;
+#endif
+}
+
+static void *huge_map(size_t size)
+{
+	if (size > SIZE_MAX / 2)
+		return NULL;
+
+	void *buffer = mmap(
+		NULL,
+		page_round(size),
+		PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS,
+		-1,
+		0
+	);
+	if (buffer == MAP_FAILED)
+		return NULL;
+
+	advise(buffer, size);
+	return buffer;
+}
+
+static void *huge_allocate(void *context, size_t size)
+{
+	if (size < huge_threshold(context))
+		return malloc(size);
+	return huge_map(size);
+}
+
+static void *huge_reallocate(
+	void *context,
+	void *buffer,
+	size_t old_size,
+	size_t new_size
+)
+{
+	const size_t threshold = huge_threshold(context);
+	const bool
+		was_mapped = old_size >= threshold,
+		mapped = new_size >= threshold;
+
+	if (!was_mapped && !mapped)
+		return realloc(buffer, new_size);
+
+	if (was_mapped && mapped) {
+		if (new_size > SIZE_MAX / 2)
+			return NULL;
+
+		const size_t
+			old_pages = page_round(old_size),
+			new_pages = page_round(new_size);
+		if (old_pages == new_pages)
+			return buffer;
+
+		void *result = mremap(buffer, old_pages, new_pages, MREMAP_MAYMOVE);
+		if (result == MAP_FAILED)
+			return NULL;
+		if (new_pages > old_pages)
+			advise(result, new_size);
+		return result;
+	}
+
+	// Crossing the threshold: copy between the heap and a mapping
+	void *result = huge_allocate(context, new_size);
+	if (!result)
+		return NULL;
+
+	memcpy(result, buffer, old_size < new_size ? old_size : new_size);
+	if (was_mapped)
+		munmap(buffer, page_round(old_size));
+	else
+		free(buffer);
+	return result;
+}
+
+static void huge_deallocate(void *context, void *buffer, size_t size)
+{
+	if (size < huge_threshold(context))
+		free(buffer);
+	else
+		munmap(buffer, page_round(size));
+}
+
+#else
+
+static void *huge_allocate(void *context, size_t size)
+{
+	(void)context;
+	return malloc(size);
+}
+
+static void *huge_reallocate(
+	void *context,
+	void *buffer,
+	size_t old_size,
+	size_t new_size
+)
+{
+	(void)context;
+	(void)old_size;
+	return realloc(buffer, new_size);
+}
+
+static void huge_deallocate(void *context, void *buffer, size_t size)
+{
+	(void)context;
+	(void)size;
+	free(buffer);
+}
+
+#endif
+
+const struct libadt_allocator libadt_allocator_huge = {
+	.allocate = huge_allocate,
+	.reallocate = huge_reallocate,
+	.deallocate = huge_deallocate,
+};
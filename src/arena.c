@@ -0,0 +1,230 @@
+#include "libadt/arena.h"
+
+bool libadt_arena_valid(struct libadt_arena arena);
+struct libadt_lptr libadt_arena_aligned_alloc(
+	struct libadt_arena *arena,
+	size_t nmemb,
+	size_t size,
+	size_t alignment
+);
+struct libadt_lptr libadt_arena_alloc(
+	struct libadt_arena *arena,
+	size_t nmemb,
+	size_t size
+);
+struct libadt_lptr libadt_arena_calloc(
+	struct libadt_arena *arena,
+	size_t nmemb,
+	size_t size
+);
+struct libadt_arena_mark libadt_arena_mark(const struct libadt_arena *arena);
+
+struct libadt_arena_chunk {
+	struct libadt_arena_chunk *next;
+	size_t size;
+	unsigned char data[];
+};
+
+static struct libadt_arena_chunk *chunk_alloc(
+	const struct libadt_allocator *allocator,
+	size_t size
+)
+{
+	if (size > SIZE_MAX - sizeof(struct libadt_arena_chunk))
+		return NULL;
+
+	struct libadt_arena_chunk *chunk = libadt_allocator_allocate(
+		allocator,
+		sizeof(*chunk) + size
+	);
+	if (chunk) {
+		chunk->next = NULL;
+		chunk->size = size;
+	}
+	return chunk;
+}
+
+static void chunk_free(
+	const struct libadt_allocator *allocator,
+	struct libadt_arena_chunk *chunk
+)
+{
+	libadt_allocator_deallocate(allocator, chunk, sizeof(*chunk) + chunk->size);
+}
+
+static unsigned char *chunk_end(struct libadt_arena_chunk *chunk)
+{
+	return &chunk->data[chunk->size];
+}
+
+/*
+ * Returns where bytes bytes with the given alignment would fit in
+ * chunk, starting from cursor, or NULL if they don't.
+ */
+static unsigned char *chunk_fit(
+	struct libadt_arena_chunk *chunk,
+	unsigned char *cursor,
+	size_t bytes,
+	size_t alignment
+)
+{
+	const size_t
+		padding = (size_t)-(uintptr_t)cursor & (alignment - 1),
+		available = (size_t)(chunk_end(chunk) - cursor);
+
+	if (padding > available || bytes > available - padding)
+		return NULL;
+	return cursor + padding;
+}
+
+static void set_current(
+	struct libadt_arena *arena,
+	struct libadt_arena_chunk *chunk,
+	unsigned char *cursor
+)
+{
+	arena->current = chunk;
+	arena->cursor = cursor;
+	arena->limit = chunk_end(chunk);
+}
+
+void *libadt_arena_grow(
+	struct libadt_arena *arena,
+	size_t bytes,
+	size_t alignment
+)
+{
+	// Chunks after the current one are left over from before a
+	// reset or rewind, so try reusing the next one
+	struct libadt_arena_chunk *const next = arena->current->next;
+	unsigned char *start;
+
+	if (next && (start = chunk_fit(next, next->data, bytes, alignment))) {
+		set_current(arena, next, start + bytes);
+		return start;
+	}
+
+	// Otherwise, insert a new chunk after the current one, keeping
+	// the too-small next chunk for later allocations
+	const size_t padded = bytes + alignment - 1;
+	if (padded < bytes)
+		return NULL;
+
+	struct libadt_arena_chunk *chunk = chunk_alloc(
+		arena->allocator,
+		padded > arena->chunk_size ? padded : arena->chunk_size
+	);
+	if (!chunk)
+		return NULL;
+
+	chunk->next = next;
+	arena->current->next = chunk;
+
+	start = chunk_fit(chunk, chunk->data, bytes, alignment);
+	set_current(arena, chunk, start + bytes);
+	return start;
+}
+
+struct libadt_arena libadt_arena_init_with_allocator(
+	size_t chunk_size,
+	const struct libadt_allocator *allocator
+)
+{
+	struct libadt_arena result = {
+		.chunk_size = chunk_size,
+		.allocator = allocator,
+	};
+
+	struct libadt_arena_chunk *first = chunk_alloc(allocator, chunk_size);
+	if (!first)
+		return (struct libadt_arena) { 0 };
+
+	result.first = first;
+	set_current(&result, first, first->data);
+	return result;
+}
+
+struct libadt_arena libadt_arena_init(size_t chunk_size)
+{
+	return libadt_arena_init_with_allocator(chunk_size, NULL);
+}
+
+struct libadt_arena libadt_arena_free(struct libadt_arena arena)
+{
+	for (struct libadt_arena_chunk *chunk = arena.first; chunk;) {
+		struct libadt_arena_chunk *next = chunk->next;
+		chunk_free(arena.allocator, chunk);
+		chunk = next;
+	}
+	return (struct libadt_arena) { 0 };
+}
+
+void libadt_arena_rewind(
+	struct libadt_arena *arena,
+	struct libadt_arena_mark mark
+)
+{
+	set_current(arena, mark.chunk, mark.cursor);
+}
+
+void libadt_arena_reset(struct libadt_arena *arena)
+{
+	set_current(arena, arena->first, arena->first->data);
+}
+
+/*
+ * libadt_allocator implementation
+ */
+
+// Whether buffer of the given size is the most recent allocation
+static bool is_last(struct libadt_arena *arena, void *buffer, size_t size)
+{
+	return (unsigned char *)buffer + size == arena->cursor
+		&& (unsigned char *)buffer >= arena->current->data;
+}
+
+static void *allocator_allocate(void *context, size_t size)
+{
+	return libadt_arena_alloc(context, size, 1).buffer;
+}
+
+static void *allocator_reallocate(
+	void *context,
+	void *buffer,
+	size_t old_size,
+	size_t new_size
+)
+{
+	struct libadt_arena *arena = context;
+
+	if (is_last(arena, buffer, old_size)) {
+		if (new_size <= (size_t)(arena->limit - (unsigned char *)buffer)) {
+			arena->cursor = (unsigned char *)buffer + new_size;
+			return buffer;
+		}
+	} else if (new_size <= old_size) {
+		return buffer;
+	}
+
+	void *result = libadt_arena_alloc(arena, new_size, 1).buffer;
+	if (result)
+		memcpy(result, buffer, old_size < new_size ? old_size : new_size);
+	return result;
+}
+
+static void allocator_deallocate(void *context, void *buffer, size_t size)
+{
+	struct libadt_arena *arena = context;
+	if (is_last(arena, buffer, size))
+		arena->cursor -= size;
+}
+
+struct libadt_allocator libadt_arena_allocator(struct libadt_arena *arena)
+{
+	return (struct libadt_allocator) {
+		.allocate = allocator_allocate,
+		.reallocate = allocator_reallocate,
+		.deallocate = allocator_deallocate,
+		.context = arena,
+	};
+}
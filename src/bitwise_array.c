@@ -1,15 +1,473 @@
 #include "libadt/bitwise_array.h"
 
+#include "cpu.h"
+
 struct libadt_bitwise_array libadt_bitwise_array_alloc(ssize_t length, int width);
 bool libadt_bitwise_array_valid(struct libadt_bitwise_array array);
 void libadt_bitwise_array_free(struct libadt_bitwise_array array);
+struct libadt_bitwise_array libadt_bitwise_array_alloc_with_allocator(
+	ssize_t length,
+	int width,
+	const struct libadt_allocator *allocator
+);
+void libadt_bitwise_array_free_with_allocator(
+	struct libadt_bitwise_array array,
+	const struct libadt_allocator *allocator
+);
+size_t libadt_bitwise_array_size(struct libadt_bitwise_array array);
+uint64_t libadt_bitwise_array_load_word(
+	const libadt_bitwise_array_bit *location
+);
+void libadt_bitwise_array_store_word(
+	libadt_bitwise_array_bit *location,
+	uint64_t word
+);
 unsigned int libadt_bitwise_array_get(
 	struct libadt_bitwise_array array,
 	ssize_t index
 );
+uint64_t libadt_bitwise_array_get64(
+	struct libadt_bitwise_array array,
+	ssize_t index
+);
+void libadt_bitwise_array_set64(
+	struct libadt_bitwise_array array,
+	ssize_t index,
+	uint64_t value
+);
 void libadt_bitwise_array_set(
 	struct libadt_bitwise_array array,
 	ssize_t index,
 	unsigned int value
 );
 
+
+/*
+ * Bulk unpacking and packing.
+ *
+ * Each SIMD kernel handles as many whole groups of elements as it
+ * can without reading or writing past the end of the buffer, and
+ * returns the number of elements it processed. The portable code
+ * then finishes whatever is left over.
+ */
+
+#if LIBADT_CPU_X86
+LIBADT_TARGET_SSE2
+static ssize_t unpack_sse2(
+	struct libadt_bitwise_array array,
+	ssize_t start,
+	ssize_t count,
+	unsigned int *out
+)
+{
+	const __m128i zero = _mm_setzero_si128();
+	ssize_t i = 0;
+
+	switch (array.width) {
+	case 8: {
+		const libadt_bitwise_array_bit *bytes = &array.bits[start];
+		for (; i + 16 <= count; i += 16) {
+			const __m128i
+				x = _mm_loadu_si128((const __m128i *)&bytes[i]),
+				low = _mm_unpacklo_epi8(x, zero),
+				high = _mm_unpackhi_epi8(x, zero);
+			_mm_storeu_si128((__m128i *)&out[i], _mm_unpacklo_epi16(low, zero));
+			_mm_storeu_si128((__m128i *)&out[i + 4], _mm_unpackhi_epi16(low, zero));
+			_mm_storeu_si128((__m128i *)&out[i + 8], _mm_unpacklo_epi16(high, zero));
+			_mm_storeu_si128((__m128i *)&out[i + 12], _mm_unpackhi_epi16(high, zero));
+		}
+		break;
+	}
+	case 16: {
+		const libadt_bitwise_array_bit *bytes = &array.bits[start * 2];
+		for (; i + 8 <= count; i += 8) {
+			__m128i x = _mm_loadu_si128((const __m128i *)&bytes[i * 2]);
+			x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+			_mm_storeu_si128((__m128i *)&out[i], _mm_unpacklo_epi16(x, zero));
+			_mm_storeu_si128((__m128i *)&out[i + 4], _mm_unpackhi_epi16(x, zero));
+		}
+		break;
+	}
+	case 32: {
+		const libadt_bitwise_array_bit *bytes = &array.bits[start * 4];
+		for (; i + 4 <= count; i += 4) {
+			__m128i x = _mm_loadu_si128((const __m128i *)&bytes[i * 4]);
+			x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+			x = _mm_shufflelo_epi16(x, 0xb1);
+			x = _mm_shufflehi_epi16(x, 0xb1);
+			_mm_storeu_si128((__m128i *)&out[i], x);
+		}
+		break;
+	}
+	}
+
+	return i;
+}
+
+LIBADT_TARGET_AVX2
+static ssize_t unpack_avx2(
+	struct libadt_bitwise_array array,
+	ssize_t start,
+	ssize_t count,
+	unsigned int *out
+)
+{
+	const int width = array.width;
+	ssize_t i = 0;
+
+	switch (width) {
+	case 0:
+		return 0;
+	case 8: {
+		const libadt_bitwise_array_bit *bytes = &array.bits[start];
+		for (; i + 8 <= count; i += 8) {
+			const __m128i x = _mm_loadl_epi64((const __m128i *)&bytes[i]);
+			_mm256_storeu_si256((__m256i *)&out[i], _mm256_cvtepu8_epi32(x));
+		}
+		return i;
+	}
+	case 16: {
+		const libadt_bitwise_array_bit *bytes = &array.bits[start * 2];
+		const __m128i swap = _mm_setr_epi8(
+			1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14
+		);
+		for (; i + 8 <= count; i += 8) {
+			const __m128i x = _mm_shuffle_epi8(
+				_mm_loadu_si128((const __m128i *)&bytes[i * 2]),
+				swap
+			);
+			_mm256_storeu_si256((__m256i *)&out[i], _mm256_cvtepu16_epi32(x));
+		}
+		return i;
+	}
+	case 32: {
+		const libadt_bitwise_array_bit *bytes = &array.bits[start * 4];
+		const __m256i swap = _mm256_setr_epi8(
+			3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+			3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+		);
+		for (; i + 8 <= count; i += 8) {
+			const __m256i x = _mm256_loadu_si256((const __m256i *)&bytes[i * 4]);
+			_mm256_storeu_si256((__m256i *)&out[i], _mm256_shuffle_epi8(x, swap));
+		}
+		return i;
+	}
+	}
+
+	/*
+	 * Any other width: gather the 64-bit word starting at each
+	 * element's first byte, then do the same shifts as
+	 * libadt_bitwise_array_get(), eight elements at a time.
+	 */
+	const size_t size = libadt_bitwise_array_size(array);
+	const __m256i
+		reverse = _mm256_setr_epi8(
+			7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+			7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8
+		),
+		steps = _mm256_setr_epi32(
+			0, width, 2 * width, 3 * width,
+			4 * width, 5 * width, 6 * width, 7 * width
+		),
+		even = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6),
+		seven = _mm256_set1_epi32(7);
+	const __m128i right = _mm_cvtsi32_si128(64 - width);
+
+	uint64_t bit = (uint64_t)start * (uint64_t)width;
+	for (
+		;
+		i + 8 <= count
+			&& (bit + 7 * (uint64_t)width) / CHAR_BIT + sizeof(uint64_t) <= size;
+		i += 8, bit += 8 * (uint64_t)width
+	) {
+		const long long *base = (const long long *)&array.bits[bit / CHAR_BIT];
+		const __m256i
+			offsets = _mm256_add_epi32(_mm256_set1_epi32((int)(bit % CHAR_BIT)), steps),
+			byte_offsets = _mm256_srli_epi32(offsets, 3),
+			shifts = _mm256_and_si256(offsets, seven);
+
+		__m256i
+			low = _mm256_i32gather_epi64(base, _mm256_castsi256_si128(byte_offsets), 1),
+			high = _mm256_i32gather_epi64(base, _mm256_extracti128_si256(byte_offsets, 1), 1);
+
+		low = _mm256_shuffle_epi8(low, reverse);
+		high = _mm256_shuffle_epi8(high, reverse);
+		low = _mm256_sllv_epi64(low, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(shifts)));
+		high = _mm256_sllv_epi64(high, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(shifts, 1)));
+		low = _mm256_srl_epi64(low, right);
+		high = _mm256_srl_epi64(high, right);
+
+		const __m256i result = _mm256_inserti128_si256(
+			_mm256_permutevar8x32_epi32(low, even),
+			_mm256_castsi256_si128(_mm256_permutevar8x32_epi32(high, even)),
+			1
+		);
+		_mm256_storeu_si256((__m256i *)&out[i], result);
+	}
+
+	return i;
+}
+
+LIBADT_TARGET_SSE2
+static ssize_t pack_sse2(
+	struct libadt_bitwise_array array,
+	ssize_t start,
+	ssize_t count,
+	const unsigned int *in
+)
+{
+	ssize_t i = 0;
+
+	switch (array.width) {
+	case 8: {
+		libadt_bitwise_array_bit *bytes = &array.bits[start];
+		const __m128i mask = _mm_set1_epi32(0xff);
+		for (; i + 16 <= count; i += 16) {
+			const __m128i
+				a = _mm_and_si128(_mm_loadu_si128((const __m128i *)&in[i]), mask),
+				b = _mm_and_si128(_mm_loadu_si128((const __m128i *)&in[i + 4]), mask),
+				c = _mm_and_si128(_mm_loadu_si128((const __m128i *)&in[i + 8]), mask),
+				d = _mm_and_si128(_mm_loadu_si128((const __m128i *)&in[i + 12]), mask);
+			_mm_storeu_si128(
+				(__m128i *)&bytes[i],
+				_mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d))
+			);
+		}
+		break;
+	}
+	case 16: {
+		libadt_bitwise_array_bit *bytes = &array.bits[start * 2];
+		// SSE2 only has a signed 32-to-16 pack, so bias into
+		// signed range and back
+		const __m128i
+			mask = _mm_set1_epi32(0xffff),
+			bias32 = _mm_set1_epi32(0x8000),
+			bias16 = _mm_set1_epi16((short)0x8000);
+		for (; i + 8 <= count; i += 8) {
+			const __m128i
+				a = _mm_sub_epi32(_mm_and_si128(_mm_loadu_si128((const __m128i *)&in[i]), mask), bias32),
+				b = _mm_sub_epi32(_mm_and_si128(_mm_loadu_si128((const __m128i *)&in[i + 4]), mask), bias32);
+			__m128i x = _mm_xor_si128(_mm_packs_epi32(a, b), bias16);
+			x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+			_mm_storeu_si128((__m128i *)&bytes[i * 2], x);
+		}
+		break;
+	}
+	case 32: {
+		libadt_bitwise_array_bit *bytes = &array.bits[start * 4];
+		for (; i + 4 <= count; i += 4) {
+			__m128i x = _mm_loadu_si128((const __m128i *)&in[i]);
+			x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+			x = _mm_shufflelo_epi16(x, 0xb1);
+			x = _mm_shufflehi_epi16(x, 0xb1);
+			_mm_storeu_si128((__m128i *)&bytes[i * 4], x);
+		}
+		break;
+	}
+	}
+
+	return i;
+}
+
+LIBADT_TARGET_AVX2
+static ssize_t pack_avx2(
+	struct libadt_bitwise_array array,
+	ssize_t start,
+	ssize_t count,
+	const unsigned int *in
+)
+{
+	ssize_t i = 0;
+
+	switch (array.width) {
+	case 8: {
+		libadt_bitwise_array_bit *bytes = &array.bits[start];
+		const __m256i
+			pick = _mm256_setr_epi8(
+				0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+				0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+			),
+			join = _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0);
+		for (; i + 8 <= count; i += 8) {
+			const __m256i x = _mm256_permutevar8x32_epi32(
+				_mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)&in[i]), pick),
+				join
+			);
+			_mm_storel_epi64((__m128i *)&bytes[i], _mm256_castsi256_si128(x));
+		}
+		break;
+	}
+	case 16: {
+		libadt_bitwise_array_bit *bytes = &array.bits[start * 2];
+		const __m256i pick = _mm256_setr_epi8(
+			1, 0, 5, 4, 9, 8, 13, 12, -1, -1, -1, -1, -1, -1, -1, -1,
+			1, 0, 5, 4, 9, 8, 13, 12, -1, -1, -1, -1, -1, -1, -1, -1
+		);
+		for (; i + 8 <= count; i += 8) {
+			const __m256i x = _mm256_permute4x64_epi64(
+				_mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)&in[i]), pick),
+				0x08
+			);
+			_mm_storeu_si128((__m128i *)&bytes[i * 2], _mm256_castsi256_si128(x));
+		}
+		break;
+	}
+	case 32: {
+		libadt_bitwise_array_bit *bytes = &array.bits[start * 4];
+		const __m256i swap = _mm256_setr_epi8(
+			3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+			3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+		);
+		for (; i + 8 <= count; i += 8) {
+			const __m256i x = _mm256_loadu_si256((const __m256i *)&in[i]);
+			_mm256_storeu_si256((__m256i *)&bytes[i * 4], _mm256_shuffle_epi8(x, swap));
+		}
+		break;
+	}
+	}
+
+	return i;
+}
+#endif
+
+static void unpack_scalar(
+	struct libadt_bitwise_array array,
+	ssize_t start,
+	ssize_t count,
+	unsigned int *out
+)
+{
+	ssize_t i = 0;
+
+#if CHAR_BIT == 8
+	// libadt_bitwise_array_get() without recomputing the bit index
+	const size_t size = libadt_bitwise_array_size(array);
+	const int width = array.width;
+	uint64_t bit = (uint64_t)start * (uint64_t)width;
+	if (width > 0) {
+		for (
+			;
+			i < count && bit / CHAR_BIT + sizeof(uint64_t) <= size;
+			i++, bit += (uint64_t)width
+		) {
+			const uint64_t word = libadt_bitwise_array_load_word(&array.bits[bit / CHAR_BIT]);
+			out[i] = (unsigned)((word << (bit % CHAR_BIT)) >> (64 - width));
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+		out[i] = libadt_bitwise_array_get(array, start + i);
+}
+
+static void pack_scalar(
+	struct libadt_bitwise_array array,
+	ssize_t start,
+	ssize_t count,
+	const unsigned int *in
+)
+{
+	const int width = array.width;
+	ssize_t i = 0;
+
+	// Set elements one-by-one until the next one starts on a
+	// byte boundary, which takes at most CHAR_BIT - 1 elements
+	for (
+		;
+		i < count && ((uint64_t)(start + i) * (uint64_t)width) % CHAR_BIT;
+		i++
+	)
+		libadt_bitwise_array_set(array, start + i, in[i]);
+
+	if (i == count || width == 0)
+		return;
+
+	/*
+	 * From here, accumulate bits and write them out whole bytes
+	 * at a time. Only the very last byte can be partially
+	 * covered, in which case its trailing bits belong to the
+	 * next element and have to be preserved.
+	 */
+	libadt_bitwise_array_bit *location =
+		&array.bits[(uint64_t)(start + i) * (uint64_t)width / CHAR_BIT];
+	const uint64_t mask = ~0ull >> (64 - width);
+	uint64_t bits = 0;
+	int pending = 0;
+
+	for (; i < count; i++) {
+		bits = (bits << width) | (in[i] & mask);
+		pending += width;
+		if (pending >= 32) {
+			pending -= 32;
+			const uint32_t chunk = (uint32_t)(bits >> pending);
+			location[0] = (libadt_bitwise_array_bit)(chunk >> 24);
+			location[1] = (libadt_bitwise_array_bit)(chunk >> 16);
+			location[2] = (libadt_bitwise_array_bit)(chunk >> 8);
+			location[3] = (libadt_bitwise_array_bit)chunk;
+			location += 4;
+		}
+	}
+
+	for (; pending >= CHAR_BIT; location++) {
+		pending -= CHAR_BIT;
+		*location = (libadt_bitwise_array_bit)(bits >> pending);
+	}
+
+	if (pending) {
+		const unsigned
+			keep = (libadt_bitwise_array_bit)~0u >> pending,
+			head = (unsigned)(bits << (CHAR_BIT - pending));
+		*location = (libadt_bitwise_array_bit)((*location & keep) | (head & ~keep));
+	}
+}
+
+void libadt_bitwise_array_unpack(
+	struct libadt_bitwise_array array,
+	ssize_t start,
+	ssize_t count,
+	unsigned int *out
+)
+{
+	// The kernels assume every element fits in an unsigned int
+	if (array.width > 32) {
+		for (ssize_t i = 0; i < count; i++)
+			out[i] = (unsigned int)libadt_bitwise_array_get64(array, start + i);
+		return;
+	}
+
+	ssize_t done = 0;
+
+#if LIBADT_CPU_X86
+	if (libadt_cpu_has_avx2())
+		done = unpack_avx2(array, start, count, out);
+	else if (libadt_cpu_has_sse2())
+		done = unpack_sse2(array, start, count, out);
+#endif
+
+	unpack_scalar(array, start + done, count - done, out + done);
+}
+
+void libadt_bitwise_array_pack(
+	struct libadt_bitwise_array array,
+	ssize_t start,
+	ssize_t count,
+	const unsigned int *in
+)
+{
+	if (array.width > 32) {
+		for (ssize_t i = 0; i < count; i++)
+			libadt_bitwise_array_set64(array, start + i, in[i]);
+		return;
+	}
+
+	ssize_t done = 0;
+
+#if LIBADT_CPU_X86
+	if (libadt_cpu_has_avx2())
+		done = pack_avx2(array, start, count, in);
+	else if (libadt_cpu_has_sse2())
+		done = pack_sse2(array, start, count, in);
+#endif
+
+	pack_scalar(array, start + done, count - done, in + done);
+}
@@ -0,0 +1,358 @@
+#include "libadt/block_codec.h"
+
+#include "cpu.h"
+
+#include <string.h>
+
+bool libadt_block_codec_valid(struct libadt_block_codec codec);
+size_t libadt_block_codec_blocks(struct libadt_block_codec codec);
+size_t libadt_block_codec_size(struct libadt_block_codec codec);
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+static int width_of(uint64_t value)
+{
+#ifdef __GNUC__
+	return value ? 64 - __builtin_clzll(value) : 0;
+#else
+	int width = 0;
+	for (; value; value >>= 1)
+		width++;
+	return width;
+#endif
+}
+
+static uint64_t zigzag(uint64_t difference)
+{
+	return (difference << 1) ^ (0 - (difference >> 63));
+}
+
+static uint64_t unzigzag(uint64_t residual)
+{
+	return (residual >> 1) ^ (0 - (residual & 1));
+}
+
+// The value after previous, given its residual
+static uint64_t next(
+	enum libadt_block_codec_mode mode,
+	const struct libadt_block_codec_header *header,
+	uint64_t residual,
+	uint64_t previous
+)
+{
+	switch (mode) {
+	case LIBADT_BLOCK_CODEC_FOR:
+		return header->base + residual;
+	case LIBADT_BLOCK_CODEC_DELTA:
+		return previous + residual + header->reference;
+	case LIBADT_BLOCK_CODEC_ZIGZAG_DELTA:
+		return previous + unzigzag(residual);
+	}
+	return 0;
+}
+
+static bool has_base(enum libadt_block_codec_mode mode)
+{
+	return mode != LIBADT_BLOCK_CODEC_FOR;
+}
+
+/*
+ * Sets out to the residual of each value of a block, which is the
+ * number packed for it, and fills in the header's base and
+ * reference. In the delta modes, the first value is the base, so
+ * there is one residual fewer than values.
+ *
+ * Returns the number of residuals.
+ */
+static size_t residuals(
+	const uint64_t *values,
+	size_t length,
+	enum libadt_block_codec_mode mode,
+	struct libadt_block_codec_header *header,
+	uint64_t *out
+)
+{
+	header->base = values[0];
+	header->reference = 0;
+	switch (mode) {
+	case LIBADT_BLOCK_CODEC_FOR:
+		for (size_t i = 1; i < length; i++)
+			header->base = MIN(header->base, values[i]);
+		for (size_t i = 0; i < length; i++)
+			out[i] = values[i] - header->base;
+		return length;
+	case LIBADT_BLOCK_CODEC_DELTA:
+		header->reference = length > 1 ? UINT64_MAX : 0;
+		for (size_t i = 1; i < length; i++)
+			header->reference = MIN(header->reference, values[i] - values[i - 1]);
+		for (size_t i = 1; i < length; i++)
+			out[i - 1] = values[i] - values[i - 1] - header->reference;
+		return length - 1;
+	case LIBADT_BLOCK_CODEC_ZIGZAG_DELTA:
+		for (size_t i = 1; i < length; i++)
+			out[i - 1] = zigzag(values[i] - values[i - 1]);
+		return length - 1;
+	}
+	return 0;
+}
+
+static size_t block_values(const struct libadt_block_codec *codec, size_t block)
+{
+	return MIN(codec->block_length, codec->length - block * codec->block_length);
+}
+
+static struct libadt_bitwise_array block_array(
+	const struct libadt_block_codec *codec,
+	size_t block
+)
+{
+	const struct libadt_block_codec_header *header = &codec->headers[block];
+	return (struct libadt_bitwise_array) {
+		.length = (ssize_t)(block_values(codec, block) - has_base(codec->mode)),
+		.width = header->width,
+		.bits = codec->data + header->offset,
+	};
+}
+
+struct libadt_block_codec libadt_block_codec_encode_with_allocator(
+	const uint64_t *values,
+	size_t length,
+	size_t block_length,
+	enum libadt_block_codec_mode mode,
+	const struct libadt_allocator *allocator
+)
+{
+	if (
+		!block_length
+		|| block_length > LIBADT_BLOCK_CODEC_MAX_BLOCK
+		|| mode < LIBADT_BLOCK_CODEC_FOR
+		|| mode > LIBADT_BLOCK_CODEC_ZIGZAG_DELTA
+	)
+		return (struct libadt_block_codec) { 0 };
+
+	struct libadt_block_codec result = {
+		.mode = mode,
+		.length = length,
+		.block_length = block_length,
+		.allocator = allocator,
+	};
+	const size_t blocks = libadt_block_codec_blocks(result);
+	if (blocks > SIZE_MAX / sizeof(*result.headers))
+		return (struct libadt_block_codec) { 0 };
+	result.headers = libadt_allocator_allocate(allocator, blocks * sizeof(*result.headers));
+	if (blocks && !result.headers)
+		return (struct libadt_block_codec) { 0 };
+
+	// Choose each block's width and place it, then pack it once the
+	// total size is known
+	uint64_t block[LIBADT_BLOCK_CODEC_MAX_BLOCK];
+	for (size_t b = 0; b < blocks; b++) {
+		struct libadt_block_codec_header *const header = &result.headers[b];
+		const size_t count = residuals(
+			values + b * block_length,
+			block_values(&result, b),
+			mode,
+			header,
+			block
+		);
+		uint64_t all = 0;
+		for (size_t i = 0; i < count; i++)
+			all |= block[i];
+		header->width = width_of(all);
+		header->offset = result.size;
+		result.size += libadt_bitwise_array_size(block_array(&result, b));
+	}
+
+	result.data = libadt_allocator_allocate(allocator, result.size);
+	if (result.size && !result.data)
+		return libadt_block_codec_free(result);
+
+	unsigned int narrow[LIBADT_BLOCK_CODEC_MAX_BLOCK];
+	for (size_t b = 0; b < blocks; b++) {
+		struct libadt_block_codec_header header;
+		const size_t count = residuals(
+			values + b * block_length,
+			block_values(&result, b),
+			mode,
+			&header,
+			block
+		);
+		const struct libadt_bitwise_array array = block_array(&result, b);
+		if (!array.width)
+			continue;
+		if (array.width <= 32) {
+			for (size_t i = 0; i < count; i++)
+				narrow[i] = (unsigned int)block[i];
+			libadt_bitwise_array_pack(array, 0, (ssize_t)count, narrow);
+		} else {
+			for (size_t i = 0; i < count; i++)
+				libadt_bitwise_array_set64(array, (ssize_t)i, block[i]);
+		}
+	}
+	return result;
+}
+
+struct libadt_block_codec libadt_block_codec_encode(
+	const uint64_t *values,
+	size_t length,
+	size_t block_length,
+	enum libadt_block_codec_mode mode
+)
+{
+	return libadt_block_codec_encode_with_allocator(values, length, block_length, mode, NULL);
+}
+
+struct libadt_block_codec libadt_block_codec_free(struct libadt_block_codec codec)
+{
+	libadt_allocator_deallocate(
+		codec.allocator,
+		codec.headers,
+		libadt_block_codec_blocks(codec) * sizeof(*codec.headers)
+	);
+	libadt_allocator_deallocate(codec.allocator, codec.data, codec.size);
+	return (struct libadt_block_codec) { 0 };
+}
+
+/*
+ * Rebuilding values from unpacked residuals.
+ *
+ * Each kernel handles whole groups of four residuals and returns
+ * how many it did; rebuild() finishes the rest.
+ */
+
+#if LIBADT_CPU_X86
+LIBADT_TARGET_AVX2
+static size_t add_base_avx2(const unsigned int *residuals, size_t count, uint64_t base, uint64_t *out)
+{
+	const __m256i bases = _mm256_set1_epi64x((long long)base);
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m128i x = _mm_loadu_si128((const __m128i *)&residuals[i]);
+		_mm256_storeu_si256(
+			(__m256i *)&out[i],
+			_mm256_add_epi64(_mm256_cvtepu32_epi64(x), bases)
+		);
+	}
+	return i;
+}
+
+LIBADT_TARGET_AVX2
+static size_t prefix_sum_avx2(
+	const unsigned int *residuals,
+	size_t count,
+	enum libadt_block_codec_mode mode,
+	const struct libadt_block_codec_header *header,
+	uint64_t *out
+)
+{
+	const __m128i one = _mm_set1_epi32(1);
+	const __m256i reference = _mm256_set1_epi64x((long long)header->reference);
+	__m256i previous = _mm256_set1_epi64x((long long)header->base);
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i x = _mm_loadu_si128((const __m128i *)&residuals[i]);
+		__m256i differences;
+		if (mode == LIBADT_BLOCK_CODEC_ZIGZAG_DELTA) {
+			// Residuals fit in 32 bits, so their differences do too
+			x = _mm_xor_si128(
+				_mm_srli_epi32(x, 1),
+				_mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(x, one))
+			);
+			differences = _mm256_cvtepi32_epi64(x);
+		} else {
+			differences = _mm256_add_epi64(_mm256_cvtepu32_epi64(x), reference);
+		}
+
+		// Sums of the first one, two, three and four differences:
+		// add each to the one after it, then the second to the
+		// last two
+		__m256i sums = _mm256_add_epi64(differences, _mm256_slli_si256(differences, 8));
+		sums = _mm256_add_epi64(
+			sums,
+			_mm256_blend_epi32(
+				_mm256_setzero_si256(),
+				_mm256_permute4x64_epi64(sums, 0x55),
+				0xf0
+			)
+		);
+		sums = _mm256_add_epi64(sums, previous);
+		_mm256_storeu_si256((__m256i *)&out[i], sums);
+		previous = _mm256_permute4x64_epi64(sums, 0xff);
+	}
+	return i;
+}
+#endif
+
+static void rebuild(
+	enum libadt_block_codec_mode mode,
+	const struct libadt_block_codec_header *header,
+	const unsigned int *residuals,
+	size_t count,
+	uint64_t *out
+)
+{
+	size_t i = 0;
+
+#if LIBADT_CPU_X86
+	if (libadt_cpu_has_avx2())
+		i = mode == LIBADT_BLOCK_CODEC_FOR
+			? add_base_avx2(residuals, count, header->base, out)
+			: prefix_sum_avx2(residuals, count, mode, header, out);
+#endif
+
+	for (uint64_t previous = i ? out[i - 1] : header->base; i < count; i++)
+		out[i] = previous = next(mode, header, residuals[i], previous);
+}
+
+size_t libadt_block_codec_decode_block(
+	const struct libadt_block_codec *codec,
+	size_t block,
+	uint64_t *out
+)
+{
+	const struct libadt_block_codec_header *const header = &codec->headers[block];
+	const struct libadt_bitwise_array array = block_array(codec, block);
+	const size_t count = (size_t)array.length;
+	if (has_base(codec->mode))
+		*out++ = header->base;
+
+	if (array.width > 32) {
+		uint64_t previous = header->base;
+		for (size_t i = 0; i < count; i++)
+			out[i] = previous = next(
+				codec->mode,
+				header,
+				libadt_bitwise_array_get64(array, (ssize_t)i),
+				previous
+			);
+	} else {
+		unsigned int residuals[LIBADT_BLOCK_CODEC_MAX_BLOCK];
+		if (array.width)
+			libadt_bitwise_array_unpack(array, 0, (ssize_t)count, residuals);
+		else
+			memset(residuals, 0, count * sizeof(*residuals));
+		rebuild(codec->mode, header, residuals, count, out);
+	}
+	return block_values(codec, block);
+}
+
+void libadt_block_codec_decode(const struct libadt_block_codec *codec, uint64_t *out)
+{
+	const size_t blocks = libadt_block_codec_blocks(*codec);
+	for (size_t b = 0; b < blocks; b++)
+		libadt_block_codec_decode_block(codec, b, out + b * codec->block_length);
+}
+
+uint64_t libadt_block_codec_get(const struct libadt_block_codec *codec, size_t index)
+{
+	const size_t block = index / codec->block_length, position = index % codec->block_length;
+	const struct libadt_block_codec_header *const header = &codec->headers[block];
+	const struct libadt_bitwise_array array = block_array(codec, block);
+	if (!has_base(codec->mode))
+		return header->base + libadt_bitwise_array_get64(array, (ssize_t)position);
+
+	uint64_t value = header->base;
+	for (size_t i = 0; i < position; i++)
+		value = next(codec->mode, header, libadt_bitwise_array_get64(array, (ssize_t)i), value);
+	return value;
+}
@@ -0,0 +1,69 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBADT_CPU_H
+#define LIBADT_CPU_H
+
+/*
+ * Internal helpers for selecting SIMD implementations at runtime.
+ *
+ * Kernels are compiled with a per-function target attribute, so the
+ * library itself can be built without -mavx2 and still run on CPUs
+ * lacking it. Callers check libadt_cpu_has_*() before calling a
+ * kernel and otherwise fall back to a portable implementation.
+ *
+ * This header is not installed.
+ */
+
+#include <stdbool.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LIBADT_CPU_X86 1
+#include <immintrin.h>
+
+#define LIBADT_TARGET_SSE2 __attribute__((target("sse2")))
+#define LIBADT_TARGET_AVX2 __attribute__((target("avx2")))
+
+static inline bool libadt_cpu_has_sse2(void)
+{
+#ifdef __SSE2__
+	return true;
+#else
+	return __builtin_cpu_supports("sse2");
+#endif
+}
+
+static inline bool libadt_cpu_has_avx2(void)
+{
+	return __builtin_cpu_supports("avx2");
+}
+#else
+#define LIBADT_CPU_X86 0
+
+static inline bool libadt_cpu_has_sse2(void)
+{
+	return false;
+}
+
+static inline bool libadt_cpu_has_avx2(void)
+{
+	return false;
+}
+#endif
+
+#endif // LIBADT_CPU_H
@@ -0,0 +1,138 @@
+#include "libadt/elias_fano.h"
+
+#include <limits.h>
+#include <string.h>
+
+bool libadt_elias_fano_valid(struct libadt_elias_fano sequence);
+size_t libadt_elias_fano_size(struct libadt_elias_fano sequence);
+uint64_t libadt_elias_fano_get(
+	const struct libadt_elias_fano *sequence,
+	size_t index
+);
+unsigned int libadt_elias_fano_leading_zeros(uint64_t word);
+bool libadt_elias_fano_iterator_next(
+	struct libadt_elias_fano_iterator *iterator,
+	uint64_t *value
+);
+
+// floor(log2(last / length)), or 0 when that is below 1, which keeps
+// the high bits to at most about 2 * length
+static int low_width(uint64_t last, size_t length)
+{
+	const uint64_t quotient = length ? last / length : 0;
+	return quotient ? 63 - (int)libadt_elias_fano_leading_zeros(quotient) : 0;
+}
+
+struct libadt_elias_fano libadt_elias_fano_init_with_allocator(
+	const uint64_t *values,
+	size_t length,
+	const struct libadt_allocator *allocator
+)
+{
+	for (size_t i = 1; i < length; i++)
+		if (values[i] < values[i - 1])
+			return (struct libadt_elias_fano) { 0 };
+
+	const uint64_t last = length ? values[length - 1] : 0;
+	const int width = low_width(last, length);
+	const uint64_t high_length = length + (last >> width) + 1;
+	if (length > SSIZE_MAX || high_length > SSIZE_MAX)
+		return (struct libadt_elias_fano) { 0 };
+
+	struct libadt_elias_fano result = {
+		.length = length,
+		.last = last,
+		.low = libadt_bitwise_array_alloc_with_allocator((ssize_t)length, width, allocator),
+		.high = libadt_bitwise_array_alloc_with_allocator((ssize_t)high_length, 1, allocator),
+		.allocator = allocator,
+	};
+	if (!libadt_bitwise_array_valid(result.low) || !libadt_bitwise_array_valid(result.high))
+		return libadt_elias_fano_free(result);
+
+	memset(result.high.bits, 0, libadt_bitwise_array_size(result.high));
+	const uint64_t mask = ((uint64_t)1 << width) - 1;
+	for (size_t i = 0; i < length; i++) {
+		const uint64_t position = (values[i] >> width) + i;
+		result.high.bits[position / CHAR_BIT] |= (libadt_bitwise_array_bit)
+			(1u << (CHAR_BIT - 1 - position % CHAR_BIT));
+		if (width)
+			libadt_bitwise_array_set64(result.low, (ssize_t)i, values[i] & mask);
+	}
+
+	result.index = libadt_rank_select_init_with_allocator(result.high, allocator);
+	if (!libadt_rank_select_valid(result.index))
+		return libadt_elias_fano_free(result);
+	return result;
+}
+
+struct libadt_elias_fano libadt_elias_fano_init(const uint64_t *values, size_t length)
+{
+	return libadt_elias_fano_init_with_allocator(values, length, NULL);
+}
+
+struct libadt_elias_fano libadt_elias_fano_free(struct libadt_elias_fano sequence)
+{
+	libadt_rank_select_free(sequence.index);
+	libadt_bitwise_array_free_with_allocator(sequence.low, sequence.allocator);
+	libadt_bitwise_array_free_with_allocator(sequence.high, sequence.allocator);
+	return (struct libadt_elias_fano) { 0 };
+}
+
+// An iterator whose next value has its one at or after position,
+// with index values before it
+static struct libadt_elias_fano_iterator iterator_from(
+	const struct libadt_elias_fano *sequence,
+	size_t index,
+	size_t position
+)
+{
+	return (struct libadt_elias_fano_iterator) {
+		.sequence = sequence,
+		.index = index,
+		.word = position / 64,
+		.bits = libadt_rank_select_word(&sequence->index, position / 64)
+			& (~(uint64_t)0 >> position % 64),
+	};
+}
+
+struct libadt_elias_fano_iterator libadt_elias_fano_iterator_at(
+	const struct libadt_elias_fano *sequence,
+	size_t index
+)
+{
+	if (index >= sequence->length)
+		return (struct libadt_elias_fano_iterator) { sequence, sequence->length, 0, 0 };
+	const size_t position = (size_t)libadt_rank_select_select(&sequence->index, index);
+	return iterator_from(sequence, index, position);
+}
+
+size_t libadt_elias_fano_next_geq(
+	const struct libadt_elias_fano *sequence,
+	uint64_t x,
+	uint64_t *value
+)
+{
+	if (!sequence->length || x > sequence->last)
+		return sequence->length;
+
+	// The values with x's high bits start after the zero ending the
+	// high bits before them, which has as many ones before it as
+	// there are values less than them
+	const uint64_t high = x >> sequence->low.width;
+	const size_t position = high
+		? (size_t)libadt_rank_select_select0(&sequence->index, (size_t)high - 1) + 1
+		: 0;
+	struct libadt_elias_fano_iterator iterator = iterator_from(
+		sequence,
+		position - (size_t)high,
+		position
+	);
+
+	// The last value is at least x, so this finds one
+	uint64_t found = 0;
+	while (libadt_elias_fano_iterator_next(&iterator, &found))
+		if (found >= x)
+			break;
+	*value = found;
+	return iterator.index - 1;
+}
@@ -0,0 +1,215 @@
+#include "libadt/hash.h"
+
+#include <string.h>
+
+// How many buffers ahead libadt_lptr_hash_batch() prefetches
+#define PREFETCH_DISTANCE 8
+
+static const uint64_t secret[4] = {
+	0x2d358dccaa6c78a5u,
+	0x8bb84b93962eacc9u,
+	0x4b33a62ed433d4a3u,
+	0x4d5a2da51de1aa47u,
+};
+
+// Replaces a and b with the low and high halves of their product
+static void multiply(uint64_t *a, uint64_t *b)
+{
+#ifdef __SIZEOF_INT128__
+	const __uint128_t product = (__uint128_t)*a * *b;
+	*a = (uint64_t)product;
+	*b = (uint64_t)(product >> 64);
+#else
+	const uint64_t
+		a_high = *a >> 32, a_low = (uint32_t)*a,
+		b_high = *b >> 32, b_low = (uint32_t)*b,
+		high_high = a_high * b_high,
+		high_low = a_high * b_low,
+		low_high = a_low * b_high,
+		low_low = a_low * b_low,
+		middle = (low_low >> 32) + (uint32_t)high_low + (uint32_t)low_high;
+	*a = (middle << 32) | (uint32_t)low_low;
+	*b = high_high + (high_low >> 32) + (low_high >> 32) + (middle >> 32);
+#endif
+}
+
+static uint64_t mix(uint64_t a, uint64_t b)
+{
+	multiply(&a, &b);
+	return a ^ b;
+}
+
+static uint64_t read8(const unsigned char *p)
+{
+	uint64_t result;
+	memcpy(&result, p, sizeof(result));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	result = __builtin_bswap64(result);
+#endif
+	return result;
+}
+
+static uint64_t read4(const unsigned char *p)
+{
+	uint32_t result;
+	memcpy(&result, p, sizeof(result));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	result = __builtin_bswap32(result);
+#endif
+	return result;
+}
+
+static uint64_t start(uint64_t seed)
+{
+	return seed ^ mix(seed ^ secret[0], secret[1]);
+}
+
+static uint64_t finish(uint64_t a, uint64_t b, uint64_t seed, uint64_t length)
+{
+	a ^= secret[1];
+	b ^= seed;
+	multiply(&a, &b);
+	return mix(a ^ secret[0] ^ length, b ^ secret[1]);
+}
+
+// Hashes inputs of at most 16 bytes
+static uint64_t finish_short(const unsigned char *p, size_t length, uint64_t seed)
+{
+	uint64_t a = 0, b = 0;
+	if (length >= 4) {
+		const size_t middle = (length >> 3) << 2;
+		a = read4(p) << 32 | read4(p + middle);
+		b = read4(p + length - 4) << 32 | read4(p + length - 4 - middle);
+	} else if (length) {
+		a = (uint64_t)p[0] << 16 | (uint64_t)p[length >> 1] << 8 | p[length - 1];
+	}
+	return finish(a, b, seed, length);
+}
+
+// Hashes the last 1 to 48 bytes of an input longer than 16 bytes,
+// starting at p. The 16 bytes before p must be readable.
+static uint64_t finish_long(const unsigned char *p, size_t remaining, uint64_t seed, uint64_t length)
+{
+	while (remaining > 16) {
+		seed = mix(read8(p) ^ secret[1], read8(p + 8) ^ seed);
+		p += 16;
+		remaining -= 16;
+	}
+	return finish(read8(p + remaining - 16), read8(p + remaining - 8), seed, length);
+}
+
+static void round48(uint64_t lanes[3], const unsigned char *p)
+{
+	lanes[0] = mix(read8(p) ^ secret[1], read8(p + 8) ^ lanes[0]);
+	lanes[1] = mix(read8(p + 16) ^ secret[2], read8(p + 24) ^ lanes[1]);
+	lanes[2] = mix(read8(p + 32) ^ secret[3], read8(p + 40) ^ lanes[2]);
+}
+
+// Hashes with a seed already passed through start()
+static uint64_t hash(const unsigned char *p, size_t length, uint64_t seed)
+{
+	if (length <= 16)
+		return finish_short(p, length, seed);
+
+	size_t remaining = length;
+	if (remaining > 48) {
+		uint64_t lanes[3] = { seed, seed, seed };
+		do {
+			round48(lanes, p);
+			p += 48;
+			remaining -= 48;
+		} while (remaining > 48);
+		seed = lanes[0] ^ lanes[1] ^ lanes[2];
+	}
+	return finish_long(p, remaining, seed, length);
+}
+
+uint64_t libadt_lptr_hash_seeded(struct libadt_const_lptr lptr, uint64_t seed)
+{
+	return hash(lptr.buffer, (size_t)libadt_const_lptr_size(lptr), start(seed));
+}
+
+uint64_t libadt_lptr_hash(struct libadt_const_lptr lptr)
+{
+	// start(0), which the compiler cannot fold through the multiply
+	return hash(lptr.buffer, (size_t)libadt_const_lptr_size(lptr), 0xca813bf4c7abf0a9u);
+}
+
+void libadt_lptr_hash_batch(
+	const struct libadt_const_lptr *lptrs,
+	uint64_t *hashes,
+	size_t number,
+	uint64_t seed
+)
+{
+	seed = start(seed);
+	for (size_t i = 0; i < number; i++) {
+#ifdef __GNUC__
+		if (i + PREFETCH_DISTANCE < number)
+			__builtin_prefetch(lptrs[i + PREFETCH_DISTANCE].buffer);
+#endif
+		hashes[i] = hash(lptrs[i].buffer, (size_t)libadt_const_lptr_size(lptrs[i]), seed);
+	}
+}
+
+struct libadt_lptr_hasher libadt_lptr_hasher_init(uint64_t seed)
+{
+	seed = start(seed);
+	return (struct libadt_lptr_hasher) {
+		.lanes = { seed, seed, seed },
+		.length = 0,
+		.buffered = 0,
+	};
+}
+
+void libadt_lptr_hasher_update(
+	struct libadt_lptr_hasher *hasher,
+	struct libadt_const_lptr chunk
+)
+{
+	const unsigned char *p = chunk.buffer;
+	size_t remaining = (size_t)libadt_const_lptr_size(chunk);
+	unsigned char *const pending = hasher->buffer + 16;
+	hasher->length += remaining;
+
+	if (hasher->buffered + remaining <= 48) {
+		memcpy(pending + hasher->buffered, p, remaining);
+		hasher->buffered += remaining;
+		return;
+	}
+
+	// More data follows the pending bytes, so they are not the last 48
+	if (hasher->buffered) {
+		const size_t take = 48 - hasher->buffered;
+		memcpy(pending + hasher->buffered, p, take);
+		p += take;
+		remaining -= take;
+		round48(hasher->lanes, pending);
+		memcpy(hasher->buffer, pending + 32, 16);
+		hasher->buffered = 0;
+	}
+
+	if (remaining > 48) {
+		do {
+			round48(hasher->lanes, p);
+			p += 48;
+			remaining -= 48;
+		} while (remaining > 48);
+		memcpy(hasher->buffer, p - 16, 16);
+	}
+
+	memcpy(pending, p, remaining);
+	hasher->buffered = remaining;
+}
+
+uint64_t libadt_lptr_hasher_final(const struct libadt_lptr_hasher *hasher)
+{
+	const unsigned char *const pending = hasher->buffer + 16;
+	if (hasher->length <= 16)
+		return finish_short(pending, hasher->buffered, hasher->lanes[0]);
+
+	const uint64_t seed = hasher->length > 48
+		? hasher->lanes[0] ^ hasher->lanes[1] ^ hasher->lanes[2]
+		: hasher->lanes[0];
+	return finish_long(pending, hasher->buffered, seed, hasher->length);
+}
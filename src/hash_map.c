@@ -0,0 +1,256 @@
+#include "libadt/hash_map.h"
+#include "libadt/hash.h"
+
+#include <stdint.h>
+#include <string.h>
+
+bool libadt_hash_map_valid(struct libadt_hash_map map);
+unsigned int libadt_hash_map_lowest(uint32_t mask);
+uint64_t libadt_hash_map_word(const signed char *group);
+uint32_t libadt_hash_map_pack(uint64_t word);
+uint32_t libadt_hash_map_match(const signed char *group, uint64_t h2);
+uint32_t libadt_hash_map_match_empty(const signed char *group);
+uint32_t libadt_hash_map_match_free(const signed char *group);
+void libadt_hash_map_set_control(
+	struct libadt_hash_map *map,
+	size_t slot,
+	signed char control
+);
+void *libadt_hash_map_key(const struct libadt_hash_map *map, size_t slot);
+void *libadt_hash_map_value(const struct libadt_hash_map *map, size_t slot);
+size_t libadt_hash_map_next(const struct libadt_hash_map *map, size_t slot);
+size_t libadt_hash_map_prepare_insert(struct libadt_hash_map *map, uint64_t hash);
+void libadt_hash_map_erase_slot(struct libadt_hash_map *map, size_t slot);
+
+// Tables are rehashed at 7/8 full, counting deleted slots
+static size_t max_load(size_t capacity)
+{
+	return capacity - capacity / 8;
+}
+
+// The smallest table holding _length_ entries, or 0 on overflow
+static size_t capacity_for(size_t length)
+{
+	size_t capacity = LIBADT_HASH_MAP_GROUP;
+	while (max_load(capacity) < length) {
+		if (capacity > SIZE_MAX / 2)
+			return 0;
+		capacity *= 2;
+	}
+	return capacity;
+}
+
+static uint64_t hash_bytes(const void *key, size_t size)
+{
+	return libadt_lptr_hash((struct libadt_const_lptr) { key, 1, (ssize_t)size });
+}
+
+static bool equal_bytes(const void *first, const void *second, size_t size)
+{
+	return !memcmp(first, second, size);
+}
+
+struct libadt_hash_map libadt_hash_map_init_with_allocator(
+	size_t key_size,
+	size_t value_size,
+	libadt_hash_map_hash *hash,
+	libadt_hash_map_equal *equal,
+	const struct libadt_allocator *allocator
+)
+{
+	return (struct libadt_hash_map) {
+		.control = NULL,
+		.keys = libadt_vector_init_with_allocator(key_size, 0, allocator),
+		.values = libadt_vector_init_with_allocator(value_size, 0, allocator),
+		.capacity = 0,
+		.length = 0,
+		.growth_left = 0,
+		.hash = hash ? hash : hash_bytes,
+		.equal = equal ? equal : equal_bytes,
+	};
+}
+
+struct libadt_hash_map libadt_hash_map_init(
+	size_t key_size,
+	size_t value_size,
+	libadt_hash_map_hash *hash,
+	libadt_hash_map_equal *equal
+)
+{
+	return libadt_hash_map_init_with_allocator(key_size, value_size, hash, equal, NULL);
+}
+
+static void free_table(struct libadt_hash_map map)
+{
+	if (map.capacity)
+		libadt_allocator_deallocate(
+			map.keys.allocator,
+			map.control,
+			map.capacity + LIBADT_HASH_MAP_GROUP
+		);
+	libadt_vector_free(map.keys);
+	libadt_vector_free(map.values);
+}
+
+struct libadt_hash_map libadt_hash_map_free(struct libadt_hash_map map)
+{
+	free_table(map);
+	return (struct libadt_hash_map) { 0 };
+}
+
+// Returns the slot holding key, or map->capacity
+static size_t find_slot(const struct libadt_hash_map *map, const void *key, uint64_t hash)
+{
+	if (!map->length)
+		return map->capacity;
+
+	const size_t mask = map->capacity - 1, size = map->keys.size;
+	size_t position = (size_t)(hash >> 7) & mask;
+	for (size_t step = LIBADT_HASH_MAP_GROUP;; step += LIBADT_HASH_MAP_GROUP) {
+		const signed char *const group = map->control + position;
+		for (
+			uint32_t match = libadt_hash_map_match(group, hash & 0x7f);
+			match;
+			match &= match - 1
+		) {
+			const size_t slot = (position + libadt_hash_map_lowest(match)) & mask;
+			if (map->equal(libadt_hash_map_key(map, slot), key, size))
+				return slot;
+		}
+		if (libadt_hash_map_match_empty(group))
+			return map->capacity;
+		position = (position + step) & mask;
+	}
+}
+
+// Moves every entry into a new table with _capacity_ slots
+static bool rehash(struct libadt_hash_map *map, size_t capacity)
+{
+	const struct libadt_allocator *const allocator = map->keys.allocator;
+	struct libadt_hash_map result = *map;
+	result.capacity = capacity;
+	result.growth_left = max_load(capacity) - map->length;
+	result.control = libadt_allocator_allocate(allocator, capacity + LIBADT_HASH_MAP_GROUP);
+	result.keys = libadt_vector_init_with_allocator(map->keys.size, capacity, allocator);
+	result.values = map->values.size
+		? libadt_vector_init_with_allocator(map->values.size, capacity, allocator)
+		: map->values;
+	if (
+		!result.control
+		|| !result.keys.buffer
+		|| (map->values.size && !result.values.buffer)
+	) {
+		libadt_allocator_deallocate(allocator, result.control, capacity + LIBADT_HASH_MAP_GROUP);
+		libadt_vector_free(result.keys);
+		if (map->values.size)
+			libadt_vector_free(result.values);
+		return false;
+	}
+	result.keys.length = capacity;
+	if (map->values.size)
+		result.values.length = capacity;
+	memset(result.control, LIBADT_HASH_MAP_EMPTY, capacity + LIBADT_HASH_MAP_GROUP);
+
+	const size_t mask = capacity - 1;
+	for (
+		size_t slot = libadt_hash_map_next(map, 0);
+		slot < map->capacity;
+		slot = libadt_hash_map_next(map, slot + 1)
+	) {
+		const void *const key = libadt_hash_map_key(map, slot);
+		const uint64_t hash = map->hash(key, map->keys.size);
+
+		// The new table has no deleted slots and no duplicates
+		size_t position = (size_t)(hash >> 7) & mask, step = 0;
+		uint32_t empty;
+		while (!(empty = libadt_hash_map_match_empty(result.control + position))) {
+			step += LIBADT_HASH_MAP_GROUP;
+			position = (position + step) & mask;
+		}
+		const size_t target = (position + libadt_hash_map_lowest(empty)) & mask;
+		libadt_hash_map_set_control(&result, target, (signed char)(hash & 0x7f));
+		memcpy(libadt_hash_map_key(&result, target), key, map->keys.size);
+		if (map->values.size)
+			memcpy(
+				libadt_hash_map_value(&result, target),
+				libadt_hash_map_value(map, slot),
+				map->values.size
+			);
+	}
+
+	if (map->capacity)
+		libadt_allocator_deallocate(allocator, map->control, map->capacity + LIBADT_HASH_MAP_GROUP);
+	libadt_vector_free(map->keys);
+	if (map->values.size)
+		libadt_vector_free(map->values);
+	*map = result;
+	return true;
+}
+
+bool libadt_hash_map_grow(struct libadt_hash_map *map)
+{
+	// Mostly deleted slots: clean them up without growing
+	if (map->capacity && map->length <= max_load(map->capacity) / 2)
+		return rehash(map, map->capacity);
+
+	const size_t capacity = capacity_for(map->length + 1);
+	if (!capacity)
+		return false;
+	return rehash(map, capacity > map->capacity ? capacity : map->capacity * 2);
+}
+
+bool libadt_hash_map_reserve(struct libadt_hash_map *map, size_t length)
+{
+	const size_t capacity = capacity_for(length);
+	if (!capacity)
+		return false;
+	if (capacity <= map->capacity)
+		return true;
+	return rehash(map, capacity);
+}
+
+void libadt_hash_map_clear(struct libadt_hash_map *map)
+{
+	if (!map->capacity)
+		return;
+	memset(map->control, LIBADT_HASH_MAP_EMPTY, map->capacity + LIBADT_HASH_MAP_GROUP);
+	map->length = 0;
+	map->growth_left = max_load(map->capacity);
+}
+
+void *libadt_hash_map_find(const struct libadt_hash_map *map, const void *key)
+{
+	const size_t slot = find_slot(map, key, map->hash(key, map->keys.size));
+	if (slot == map->capacity)
+		return NULL;
+	return libadt_hash_map_value(map, slot);
+}
+
+void *libadt_hash_map_insert(
+	struct libadt_hash_map *map,
+	const void *key,
+	const void *value
+)
+{
+	const uint64_t hash = map->hash(key, map->keys.size);
+	size_t slot = find_slot(map, key, hash);
+	if (slot == map->capacity) {
+		slot = libadt_hash_map_prepare_insert(map, hash);
+		if (slot == map->capacity)
+			return NULL;
+		memcpy(libadt_hash_map_key(map, slot), key, map->keys.size);
+	}
+	void *const result = libadt_hash_map_value(map, slot);
+	if (map->values.size)
+		memcpy(result, value, map->values.size);
+	return result;
+}
+
+bool libadt_hash_map_erase(struct libadt_hash_map *map, const void *key)
+{
+	const size_t slot = find_slot(map, key, map->hash(key, map->keys.size));
+	if (slot == map->capacity)
+		return false;
+	libadt_hash_map_erase_slot(map, slot);
+	return true;
+}
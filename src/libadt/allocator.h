@@ -0,0 +1,174 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBADT_ALLOCATOR_H
+#define LIBADT_ALLOCATOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+
+/**
+ * \file
+ * \copydoc libadt_allocator
+ */
+
+/**
+ * \brief An interface for routing libadt memory through a
+ * 	custom allocator.
+ *
+ * The _with_allocator variants of the libadt constructors accept
+ * a pointer to one of these. A NULL pointer means the standard
+ * library malloc(), realloc() and free().
+ *
+ * Every function receives the context pointer as its first
+ * argument. The sizes of existing allocations are passed back to
+ * the allocator, so allocators that don't track sizes themselves
+ * (such as arenas) can still implement reallocation.
+ *
+ * The allocator structure must outlive every object allocated
+ * with it: objects such as libadt_vector keep a pointer to it.
+ */
+struct libadt_allocator {
+	/**
+	 * \brief Allocates size bytes of uninitialized memory,
+	 * 	returning NULL on failure.
+	 */
+	void *(*allocate)(void *context, size_t size);
+
+	/**
+	 * \brief Resizes the allocation at buffer from old_size bytes
+	 * 	to new_size bytes, preserving its contents, returning
+	 * 	NULL and leaving buffer untouched on failure.
+	 *
+	 * buffer is never NULL and new_size is never 0.
+	 */
+	void *(*reallocate)(void *context, void *buffer, size_t old_size, size_t new_size);
+
+	/**
+	 * \brief Releases the allocation at buffer, which is size
+	 * 	bytes long.
+	 *
+	 * buffer is never NULL.
+	 */
+	void (*deallocate)(void *context, void *buffer, size_t size);
+
+	/**
+	 * \brief A pointer passed to each of the functions.
+	 */
+	void *context;
+};
+
+/**
+ * \brief Allocates memory using the given allocator.
+ *
+ * \param allocator The allocator to use, or NULL for malloc().
+ * \param size The number of bytes to allocate.
+ *
+ * \returns A pointer to the new memory, or NULL on failure.
+ */
+inline void *libadt_allocator_allocate(
+	const struct libadt_allocator *allocator,
+	size_t size
+)
+{
+	if (!allocator)
+		return malloc(size);
+	return allocator->allocate(allocator->context, size);
+}
+
+/**
+ * \brief Resizes memory using the given allocator.
+ *
+ * A NULL buffer is allocated instead of resized. Resizing to 0 is
+ * not supported: use libadt_allocator_deallocate() instead.
+ *
+ * \param allocator The allocator to use, or NULL for realloc().
+ * \param buffer The memory to resize, or NULL.
+ * \param old_size The current size of buffer.
+ * \param new_size The size to resize buffer to.
+ *
+ * \returns A pointer to the resized memory, or NULL on failure,
+ * 	in which case buffer is still valid.
+ */
+inline void *libadt_allocator_reallocate(
+	const struct libadt_allocator *allocator,
+	void *buffer,
+	size_t old_size,
+	size_t new_size
+)
+{
+	if (!allocator)
+		return realloc(buffer, new_size);
+	if (!buffer)
+		return allocator->allocate(allocator->context, new_size);
+	return allocator->reallocate(allocator->context, buffer, old_size, new_size);
+}
+
+/**
+ * \brief Releases memory using the given allocator.
+ *
+ * \param allocator The allocator to use, or NULL for free().
+ * \param buffer The memory to release. May be NULL.
+ * \param size The size of buffer.
+ */
+inline void libadt_allocator_deallocate(
+	const struct libadt_allocator *allocator,
+	void *buffer,
+	size_t size
+)
+{
+	if (!allocator)
+		free(buffer);
+	else if (buffer)
+		allocator->deallocate(allocator->context, buffer, size);
+}
+
+/**
+ * \brief The default size, in bytes, from which
+ * 	libadt_allocator_huge maps memory directly.
+ */
+#define LIBADT_ALLOCATOR_HUGE_THRESHOLD ((size_t)2 << 20)
+
+/**
+ * \brief An allocator for very large, growing buffers.
+ *
+ * Allocations smaller than the threshold use malloc() as usual.
+ * On Linux, larger allocations are anonymous memory mappings,
+ * advised to use transparent huge pages, and are resized with
+ * mremap(), so growing them moves page table entries instead of
+ * copying the contents. Shrinking them gives the pages back to
+ * the system.
+ *
+ * The threshold is LIBADT_ALLOCATOR_HUGE_THRESHOLD. A copy of this
+ * allocator whose context points to a size_t uses that size as the
+ * threshold instead.
+ *
+ * On other systems, every allocation uses malloc().
+ *
+ * \sa libadt_vector_init_huge()
+ */
+extern const struct libadt_allocator libadt_allocator_huge;
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // LIBADT_ALLOCATOR_H
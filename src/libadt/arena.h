@@ -0,0 +1,403 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBADT_ARENA_H
+#define LIBADT_ARENA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "lptr.h"
+#include "allocator.h"
+
+/**
+ * \file
+ * \copydoc libadt_arena
+ */
+
+/**
+ * \brief A single block of memory owned by an arena.
+ *
+ * Chunks are an implementation detail of libadt_arena.
+ */
+struct libadt_arena_chunk;
+
+/**
+ * \brief A bump allocator handing out libadt_lptr%s.
+ *
+ * An arena allocates memory in large chunks and hands out pieces
+ * of them by advancing a cursor. Individual allocations are
+ * never freed: instead, the whole arena is reset at once with
+ * libadt_arena_reset(), or rolled back to an earlier point with
+ * libadt_arena_mark() and libadt_arena_rewind().
+ *
+ * Chunks are kept after a reset or rewind and reused by later
+ * allocations. They are only released by libadt_arena_free().
+ *
+ * Allocation functions take a pointer to the arena, since they
+ * modify it.
+ *
+ * \sa LIBADT_ARENA_WITH
+ */
+struct libadt_arena {
+	/**
+	 * \brief The first chunk of the arena.
+	 */
+	struct libadt_arena_chunk *first;
+
+	/**
+	 * \brief The chunk allocations are currently taken from.
+	 *
+	 * Chunks before this one are in use, chunks after it
+	 * are free to be reused.
+	 */
+	struct libadt_arena_chunk *current;
+
+	/**
+	 * \brief The next free byte in the current chunk.
+	 */
+	unsigned char *cursor;
+
+	/**
+	 * \brief One past the last byte of the current chunk.
+	 */
+	unsigned char *limit;
+
+	/**
+	 * \brief The size of newly allocated chunks.
+	 */
+	size_t chunk_size;
+
+	/**
+	 * \brief The allocator chunks are allocated with, or NULL
+	 * 	for the standard library.
+	 */
+	const struct libadt_allocator *allocator;
+};
+
+/**
+ * \brief A saved position in an arena.
+ *
+ * \sa libadt_arena_mark(), libadt_arena_rewind()
+ */
+struct libadt_arena_mark {
+	/**
+	 * \brief The chunk that was current.
+	 */
+	struct libadt_arena_chunk *chunk;
+
+	/**
+	 * \brief The position in that chunk.
+	 */
+	unsigned char *cursor;
+};
+
+/**
+ * \public \memberof libadt_arena
+ * \brief Constructs a new arena, allocating its first chunk.
+ *
+ * \param chunk_size The size in bytes of each chunk. Allocations
+ * 	larger than a chunk get a chunk of their own.
+ *
+ * \returns A new arena, or an arena failing libadt_arena_valid()
+ * 	if allocating the first chunk failed.
+ */
+struct libadt_arena libadt_arena_init(size_t chunk_size);
+
+/**
+ * \public \memberof libadt_arena
+ * \brief Constructs a new arena whose chunks are allocated with
+ * 	the given allocator.
+ *
+ * \param chunk_size The size in bytes of each chunk.
+ * \param allocator The allocator to allocate chunks with, or NULL
+ * 	for the standard library.
+ *
+ * \returns A new arena, or an arena failing libadt_arena_valid()
+ * 	if allocating the first chunk failed.
+ */
+struct libadt_arena libadt_arena_init_with_allocator(
+	size_t chunk_size,
+	const struct libadt_allocator *allocator
+);
+
+/**
+ * \public \memberof libadt_arena
+ * \brief Releases every chunk owned by the arena.
+ *
+ * All lptrs allocated from the arena become invalid.
+ *
+ * \param arena The arena to free.
+ *
+ * \returns An arena failing libadt_arena_valid().
+ */
+struct libadt_arena libadt_arena_free(struct libadt_arena arena);
+
+/**
+ * \public \memberof libadt_arena
+ * \brief Tests whether an arena is a valid object.
+ *
+ * \param arena The arena to test.
+ *
+ * \returns True if the arena is valid for use, false otherwise.
+ */
+inline bool libadt_arena_valid(struct libadt_arena arena)
+{
+	return arena.first != NULL;
+}
+
+/**
+ * \internal
+ * \brief Allocates bytes bytes from a new or reused chunk, once
+ * 	they don't fit in the current one.
+ *
+ * \returns A pointer to the memory, or NULL on failure.
+ */
+void *libadt_arena_grow(
+	struct libadt_arena *arena,
+	size_t bytes,
+	size_t alignment
+);
+
+/**
+ * \public \memberof libadt_arena
+ * \brief Allocates an uninitialized array from the arena, with
+ * 	the given alignment.
+ *
+ * \param arena The arena to allocate from.
+ * \param nmemb The number of members (length).
+ * \param size The size of each member.
+ * \param alignment The alignment of the returned memory. Must be
+ * 	a power of two.
+ *
+ * \returns A libadt_lptr with the given size and length, failing
+ * 	libadt_lptr_allocated() if allocation failed or the alignment
+ * 	was not a power of two.
+ */
+inline struct libadt_lptr libadt_arena_aligned_alloc(
+	struct libadt_arena *arena,
+	size_t nmemb,
+	size_t size,
+	size_t alignment
+)
+{
+	struct libadt_lptr result = {
+		.buffer = NULL,
+		.size = (ssize_t)size,
+		.length = (ssize_t)nmemb,
+	};
+
+	if (!alignment || (alignment & (alignment - 1)))
+		return result;
+	if (size && nmemb > SSIZE_MAX / size)
+		return result;
+
+	const size_t
+		bytes = nmemb * size,
+		padding = (size_t)-(uintptr_t)arena->cursor & (alignment - 1);
+
+	if (padding <= (size_t)(arena->limit - arena->cursor)
+		&& bytes <= (size_t)(arena->limit - arena->cursor) - padding) {
+		result.buffer = arena->cursor + padding;
+		arena->cursor += padding + bytes;
+	} else {
+		result.buffer = libadt_arena_grow(arena, bytes, alignment);
+	}
+
+	return result;
+}
+
+/**
+ * \public \memberof libadt_arena
+ * \brief Allocates an uninitialized array from the arena.
+ *
+ * The memory is suitably aligned for any type.
+ *
+ * \param arena The arena to allocate from.
+ * \param nmemb The number of members (length).
+ * \param size The size of each member.
+ *
+ * \returns A libadt_lptr with the given size and length, failing
+ * 	libadt_lptr_allocated() if allocation failed.
+ */
+inline struct libadt_lptr libadt_arena_alloc(
+	struct libadt_arena *arena,
+	size_t nmemb,
+	size_t size
+)
+{
+	return libadt_arena_aligned_alloc(arena, nmemb, size, _Alignof(max_align_t));
+}
+
+/**
+ * \public \memberof libadt_arena
+ * \brief Allocates an array initialized to 0 from the arena.
+ *
+ * The memory is suitably aligned for any type.
+ *
+ * \param arena The arena to allocate from.
+ * \param nmemb The number of members (length).
+ * \param size The size of each member.
+ *
+ * \returns A libadt_lptr with the given size and length, failing
+ * 	libadt_lptr_allocated() if allocation failed.
+ */
+inline struct libadt_lptr libadt_arena_calloc(
+	struct libadt_arena *arena,
+	size_t nmemb,
+	size_t size
+)
+{
+	const struct libadt_lptr result = libadt_arena_alloc(arena, nmemb, size);
+	if (libadt_lptr_allocated(result))
+		memset(result.buffer, 0, nmemb * size);
+	return result;
+}
+
+/**
+ * \public \memberof libadt_arena
+ * \brief Saves the current position of the arena.
+ *
+ * \param arena The arena to mark.
+ *
+ * \returns A mark which can be passed to libadt_arena_rewind().
+ */
+inline struct libadt_arena_mark libadt_arena_mark(const struct libadt_arena *arena)
+{
+	return (struct libadt_arena_mark) {
+		.chunk = arena->current,
+		.cursor = arena->cursor,
+	};
+}
+
+/**
+ * \public \memberof libadt_arena
+ * \brief Rolls the arena back to a previously saved position.
+ *
+ * Everything allocated after the mark was taken becomes invalid.
+ * Marks taken after this mark become invalid too.
+ *
+ * \param arena The arena to rewind.
+ * \param mark A mark returned by libadt_arena_mark() on this arena.
+ */
+void libadt_arena_rewind(
+	struct libadt_arena *arena,
+	struct libadt_arena_mark mark
+);
+
+/**
+ * \public \memberof libadt_arena
+ * \brief Discards every allocation made from the arena.
+ *
+ * This is a constant-time operation: chunks are kept to be
+ * reused by later allocations.
+ *
+ * \param arena The arena to reset.
+ */
+void libadt_arena_reset(struct libadt_arena *arena);
+
+/**
+ * \public \memberof libadt_arena
+ * \brief Returns a libadt_allocator allocating from the arena.
+ *
+ * This allows arenas to be used with the _with_allocator
+ * constructors, such as libadt_vector_init_with_allocator().
+ *
+ * Deallocation is a no-op, except for the most recent allocation,
+ * which is given back to the arena. Likewise, the most recent
+ * allocation is resized in place when it fits.
+ *
+ * \param arena The arena to allocate from. Must outlive the
+ * 	returned allocator.
+ *
+ * \returns An allocator using the arena.
+ */
+struct libadt_allocator libadt_arena_allocator(struct libadt_arena *arena);
+
+/**
+ * \brief Provides a context manager interface for an arena.
+ *
+ * This macro creates an arena variable with the name NAME and
+ * the given CHUNK_SIZE. If the arena initialized correctly, the
+ * given code block is run, after which the arena is freed.
+ *
+ * Example usage:
+ *
+ * \code
+ * LIBADT_ARENA_WITH(arena, 1 << 16) {
+ * 	struct libadt_lptr a = libadt_arena_calloc(&arena, 10, sizeof(int));
+ * 	struct libadt_lptr b = libadt_arena_calloc(&arena, 20, sizeof(long));
+ *
+ * 	// As with LIBADT_VECTOR_WITH, use continue rather than
+ * 	// break or return to leave the block early.
+ * 	if (!libadt_lptr_allocated(a) || !libadt_lptr_allocated(b))
+ * 		continue;
+ *
+ * 	use(a, b);
+ * }
+ * \endcode
+ *
+ * \param NAME The name to give the arena variable.
+ * \param CHUNK_SIZE The chunk size, as passed to libadt_arena_init().
+ *
+ * \sa LIBADT_ARENA_SCOPE
+ */
+#define LIBADT_ARENA_WITH(NAME, CHUNK_SIZE) \
+for ( \
+	struct libadt_arena \
+		NAME = libadt_arena_init(CHUNK_SIZE); \
+	libadt_arena_valid(NAME); \
+	NAME = libadt_arena_free(NAME) \
+)
+
+/**
+ * \brief Runs the given code block, then rewinds the arena,
+ * 	discarding everything allocated inside the block.
+ *
+ * Example usage:
+ *
+ * \code
+ * LIBADT_ARENA_SCOPE(&arena) {
+ * 	struct libadt_lptr scratch = libadt_arena_alloc(&arena, 4096, 1);
+ * 	use(scratch);
+ * }
+ * // scratch has been given back to the arena
+ * \endcode
+ *
+ * \param ARENA A pointer to the arena.
+ */
+#define LIBADT_ARENA_SCOPE(ARENA) \
+for ( \
+	struct { struct libadt_arena_mark mark; bool done; } \
+		libadt_arena_scope = { libadt_arena_mark(ARENA), false }; \
+	!libadt_arena_scope.done; \
+	libadt_arena_rewind((ARENA), libadt_arena_scope.mark), \
+	libadt_arena_scope.done = true \
+)
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // LIBADT_ARENA_H
@@ -28,6 +28,10 @@ extern "C" {
 #include <sys/types.h>
 #include <limits.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "allocator.h"
 
 // undefined at the end of the header file
 #define _LIBADT_MAX(a, b) ((a) > (b) ? (a) : (b))
@@ -47,10 +51,14 @@ typedef unsigned char libadt_bitwise_array_bit;
  * A libadt_bitwise array is an array of fixed-width elements,
  * whose widths may be specified in terms of arbitrary
  * bit sizes (such as one-bit, 2-bit, 3-bit etc., up until
- * the number of bits in a word).
+ * 64 bits).
  *
  * The functions for libadt_bitwise_array will set and get the
- * values, correctly packed.
+ * values, correctly packed. libadt_bitwise_array_get() and
+ * libadt_bitwise_array_set() take unsigned ints, for widths up to
+ * 32 bits; libadt_bitwise_array_get64() and
+ * libadt_bitwise_array_set64() take uint64_t values, for widths up
+ * to 64 bits.
  *
  * This currently only supports unsigned values.
  */
@@ -100,11 +108,12 @@ struct libadt_bitwise_array libadt_bitwise_array_make(
  * \param width The amount of bits for each element.
  *
  * \returns An initialized array on success, or an array
- * 	failing libadt_bitwise_array_valid() on failure.
+ * 	failing libadt_bitwise_array_valid() on failure, including
+ * 	when length * width does not fit in a ssize_t.
  */
 inline struct libadt_bitwise_array libadt_bitwise_array_alloc(ssize_t length, int width)
 {
-	if (length < 0 || width < 0)
+	if (length < 0 || width < 0 || (width && length > SSIZE_MAX / width))
 		return (struct libadt_bitwise_array){ 0 };
 	const lldiv_t division = lldiv(length * width, CHAR_BIT);
 	const ssize_t bytes = division.quot + 1;
@@ -116,6 +125,44 @@ inline struct libadt_bitwise_array libadt_bitwise_array_alloc(ssize_t length, in
 	};
 }
 
+/**
+ * \brief Allocates a new libadt_bitwise_array using the given
+ * 	allocator.
+ *
+ * The array does not remember the allocator: it must be freed
+ * by passing it to libadt_bitwise_array_free_with_allocator()
+ * with the same allocator.
+ *
+ * \param length The number of elements to store in the
+ * 	array.
+ * \param width The amount of bits for each element.
+ * \param allocator The allocator to use, or NULL for the
+ * 	standard library.
+ *
+ * \returns An initialized array on success, or an array
+ * 	failing libadt_bitwise_array_valid() on failure, including
+ * 	when length * width does not fit in a ssize_t.
+ *
+ * \sa libadt_allocator
+ */
+inline struct libadt_bitwise_array libadt_bitwise_array_alloc_with_allocator(
+	ssize_t length,
+	int width,
+	const struct libadt_allocator *allocator
+)
+{
+	if (length < 0 || width < 0 || (width && length > SSIZE_MAX / width))
+		return (struct libadt_bitwise_array){ 0 };
+	const lldiv_t division = lldiv(length * width, CHAR_BIT);
+	const ssize_t bytes = division.quot + 1;
+
+	return (struct libadt_bitwise_array) {
+		.length = length,
+		.width = width,
+		.bits = libadt_allocator_allocate(allocator, (size_t)bytes),
+	};
+}
+
 /**
  * \brief Tests if a given array is valid.
  *
@@ -138,10 +185,146 @@ inline void libadt_bitwise_array_free(struct libadt_bitwise_array array)
 	free(array.bits);
 }
 
+/**
+ * \brief Frees an array allocated with
+ * 	libadt_bitwise_array_alloc_with_allocator().
+ *
+ * \param array The array to free.
+ * \param allocator The allocator the array was allocated with.
+ */
+inline void libadt_bitwise_array_free_with_allocator(
+	struct libadt_bitwise_array array,
+	const struct libadt_allocator *allocator
+)
+{
+	const uint64_t bits = (uint64_t)array.length * (uint64_t)array.width;
+	libadt_allocator_deallocate(allocator, array.bits, (size_t)(bits / CHAR_BIT) + 1);
+}
+
+/**
+ * \brief Returns the number of bytes needed to store the elements
+ * 	of the given array.
+ *
+ * \param array The array to get the size of.
+ *
+ * \returns The size of the packed data, in bytes.
+ */
+inline size_t libadt_bitwise_array_size(struct libadt_bitwise_array array)
+{
+	const uint64_t bits = (uint64_t)array.length * (uint64_t)array.width;
+	return (size_t)((bits + CHAR_BIT - 1) / CHAR_BIT);
+}
+
+/**
+ * \internal
+ * \brief Loads the 64-bit word starting at location, treating the
+ * 	first byte as the most significant.
+ *
+ * location does not need to be aligned.
+ */
+inline uint64_t libadt_bitwise_array_load_word(
+	const libadt_bitwise_array_bit *location
+)
+{
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) \
+	&& __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	uint64_t word;
+	memcpy(&word, location, sizeof(word));
+	return __builtin_bswap64(word);
+#elif defined(__GNUC__) && defined(__BYTE_ORDER__) \
+	&& __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	uint64_t word;
+	memcpy(&word, location, sizeof(word));
+	return word;
+#else
+	uint64_t word = 0;
+	for (int i = 0; i < 8; i++)
+		word = (word << 8) | location[i];
+	return word;
+#endif
+}
+
+/**
+ * \internal
+ * \brief Stores word at location, most significant byte first.
+ *
+ * location does not need to be aligned.
+ */
+inline void libadt_bitwise_array_store_word(
+	libadt_bitwise_array_bit *location,
+	uint64_t word
+)
+{
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) \
+	&& __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	word = __builtin_bswap64(word);
+	memcpy(location, &word, sizeof(word));
+#elif defined(__GNUC__) && defined(__BYTE_ORDER__) \
+	&& __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	memcpy(location, &word, sizeof(word));
+#else
+	for (int i = 7; i >= 0; i--, word >>= 8)
+		location[i] = (libadt_bitwise_array_bit)word;
+#endif
+}
+
+/**
+ * \brief Retrieves the number at the given position in an array
+ * 	of elements up to 64 bits wide.
+ *
+ * \param array The array to index into.
+ * \param index The 0-based index of the element to retrieve.
+ *
+ * \returns The number stored at the given element.
+ */
+inline uint64_t libadt_bitwise_array_get64(
+	struct libadt_bitwise_array array,
+	ssize_t index
+)
+{
+	/*
+	 * An element starting up to 7 bits into a byte and up to 64
+	 * bits wide covers up to 9 bytes: the word starting at its
+	 * first byte, and a few bits of the byte after it, when the
+	 * element spills over.
+	 */
+	const uint64_t bit_index = (uint64_t)index * (uint64_t)array.width;
+	const int width = array.width;
+
+	if (width <= 0)
+		return 0;
+
+#if CHAR_BIT == 8
+	const size_t byte_index = (size_t)(bit_index / CHAR_BIT);
+	if (byte_index + sizeof(uint64_t) <= libadt_bitwise_array_size(array)) {
+		const libadt_bitwise_array_bit *const location = &array.bits[byte_index];
+		const int
+			start_from = (int)(bit_index % CHAR_BIT),
+			spill = start_from + width - 64;
+		const uint64_t high = (libadt_bitwise_array_load_word(location) << start_from)
+			>> (64 - width);
+		if (spill <= 0)
+			return high;
+		return high | (uint64_t)(location[sizeof(uint64_t)] >> (CHAR_BIT - spill));
+	}
+#endif
+
+	// The last few bytes of the buffer, a bit at a time
+	uint64_t result = 0;
+	for (uint64_t bit = bit_index; bit < bit_index + (uint64_t)width; bit++)
+		result = (result << 1)
+			| ((array.bits[bit / CHAR_BIT] >> (CHAR_BIT - 1 - bit % CHAR_BIT)) & 1u);
+	return result;
+}
+
 /**
  * \brief Retreives the number at the given position in the
  * 	array.
  *
+ * Elements wider than 32 bits are read with
+ * libadt_bitwise_array_get64() and converted to unsigned int,
+ * keeping their low bits; use that to read them whole.
+ *
  * \param array The array to index into.
  * \param index The 0-based index of the element to retrieve.
  *
@@ -180,12 +363,33 @@ inline unsigned int libadt_bitwise_array_get(
 	 *
 	 * I also can't figure out how to write this so it's...
 	 * less confusing. And I'm sorry.
+	 *
+	 * Most of the time, though, none of that matters: an element
+	 * of at most 32 bits starting at most 7 bits into a byte always
+	 * fits in the 64-bit word starting at that byte, so we can load
+	 * the word, shift the element to the top and shift it back down.
+	 * The byte-by-byte loop is only needed for the last few bytes of
+	 * the buffer, where a whole word can't be loaded.
 	 */
-	const lldiv_t byte_index = lldiv(index * array.width, CHAR_BIT);
-	const libadt_bitwise_array_bit *location = &array.bits[byte_index.quot];
+	if (array.width > 32)
+		return (unsigned int)libadt_bitwise_array_get64(array, index);
+
+	const uint64_t bit_index = (uint64_t)index * (uint64_t)array.width;
+	const size_t byte_index = (size_t)(bit_index / CHAR_BIT);
+	int start_from = (int)(bit_index % CHAR_BIT);
+
+#if CHAR_BIT == 8
+	if (
+		array.width > 0
+		&& byte_index + sizeof(uint64_t) <= libadt_bitwise_array_size(array)
+	) {
+		const uint64_t word = libadt_bitwise_array_load_word(&array.bits[byte_index]);
+		return (unsigned)((word << start_from) >> (64 - array.width));
+	}
+#endif
 
+	const libadt_bitwise_array_bit *location = &array.bits[byte_index];
 	unsigned result = 0;
-	int start_from = (int)byte_index.rem;
 
 	for (int bits_remaining = array.width; bits_remaining > 0; location++) {
 		const libadt_bitwise_array_bit
@@ -207,24 +411,73 @@ inline unsigned int libadt_bitwise_array_get(
 }
 
 /**
- * \brief Sets the value at the given index. Setting values
- * 	greater than the bit-width supports is undefined
- * 	behaviour.
+ * \brief Sets the value at the given index, in an array of
+ * 	elements up to 64 bits wide. Setting values greater than
+ * 	the bit-width supports is undefined behaviour.
  *
  * \param array The array to set the value in.
  * \param index The location in the array to set the value at.
  * \param value The value to set.
  */
-inline void libadt_bitwise_array_set(
+inline void libadt_bitwise_array_set64(
 	struct libadt_bitwise_array array,
 	ssize_t index,
-	unsigned int value
+	uint64_t value
 )
 {
-	const lldiv_t byte_index = lldiv(index * array.width, CHAR_BIT);
-	libadt_bitwise_array_bit *location = &array.bits[byte_index.quot];
+	const uint64_t bit_index = (uint64_t)index * (uint64_t)array.width;
+	const size_t byte_index = (size_t)(bit_index / CHAR_BIT);
+	int start_from = (int)(bit_index % CHAR_BIT);
+
+#if CHAR_BIT == 8
+	/*
+	 * Unlike libadt_bitwise_array_get64(), this works on aligned
+	 * words: neighbouring elements then share the same word, so
+	 * setting them one after another reads back the exact word
+	 * just stored instead of stalling on a partially-overlapping
+	 * store. An element straddling two words updates both.
+	 */
+	const size_t
+		word_index = (size_t)(bit_index / 64),
+		size = libadt_bitwise_array_size(array);
+	const int
+		offset = (int)(bit_index % 64),
+		spill = offset + array.width - 64;
+	if (array.width > 0 && (word_index + 1) * sizeof(uint64_t) <= size) {
+		libadt_bitwise_array_bit *const location = &array.bits[word_index * sizeof(uint64_t)];
+		const uint64_t
+			bits = value & (~0ull >> (64 - array.width)),
+			word = libadt_bitwise_array_load_word(location);
 
-	int start_from = (int)byte_index.rem;
+		if (spill <= 0) {
+			const uint64_t mask = (~0ull >> (64 - array.width)) << -spill;
+			libadt_bitwise_array_store_word(
+				location,
+				(word & ~mask) | (bits << -spill)
+			);
+			return;
+		}
+
+		if ((word_index + 2) * sizeof(uint64_t) <= size) {
+			libadt_bitwise_array_bit *const next = location + sizeof(uint64_t);
+			const uint64_t
+				mask = ~0ull >> offset,
+				next_mask = ~0ull << (64 - spill),
+				next_word = libadt_bitwise_array_load_word(next);
+			libadt_bitwise_array_store_word(
+				location,
+				(word & ~mask) | (bits >> spill)
+			);
+			libadt_bitwise_array_store_word(
+				next,
+				(next_word & ~next_mask) | (bits << (64 - spill))
+			);
+			return;
+		}
+	}
+#endif
+
+	libadt_bitwise_array_bit *location = &array.bits[byte_index];
 
 	for (int bits_remaining = array.width; bits_remaining > 0; location++) {
 		const libadt_bitwise_array_bit
@@ -242,6 +495,81 @@ inline void libadt_bitwise_array_set(
 		start_from = 0;
 	}
 }
+
+/**
+ * \brief Sets the value at the given index. Setting values
+ * 	greater than the bit-width supports is undefined
+ * 	behaviour.
+ *
+ * \param array The array to set the value in.
+ * \param index The location in the array to set the value at.
+ * \param value The value to set.
+ */
+inline void libadt_bitwise_array_set(
+	struct libadt_bitwise_array array,
+	ssize_t index,
+	unsigned int value
+)
+{
+	libadt_bitwise_array_set64(array, index, value);
+}
+
+/**
+ * \brief Reads _count_ consecutive elements starting at _start_
+ * 	into a plain array of unsigned ints.
+ *
+ * This is equivalent to calling libadt_bitwise_array_get() for
+ * each index, but much faster for long runs: common widths use
+ * SIMD kernels, selected at runtime based on the CPU. Elements
+ * wider than 32 bits are read one at a time with
+ * libadt_bitwise_array_get64() and converted to unsigned int.
+ *
+ * No boundary checking is performed: start + count must not
+ * exceed the array length.
+ *
+ * \param array The array to read from.
+ * \param start The index of the first element to read.
+ * \param count The number of elements to read.
+ * \param out The array to write the elements to. Must have room
+ * 	for _count_ elements.
+ *
+ * \sa libadt_bitwise_array_pack()
+ */
+void libadt_bitwise_array_unpack(
+	struct libadt_bitwise_array array,
+	ssize_t start,
+	ssize_t count,
+	unsigned int *out
+);
+
+/**
+ * \brief Writes _count_ values from a plain array of unsigned ints
+ * 	into consecutive elements starting at _start_.
+ *
+ * This is equivalent to calling libadt_bitwise_array_set() for
+ * each index, but much faster for long runs. Bits of the array
+ * outside of the written elements are left untouched. Elements
+ * wider than 32 bits are written one at a time with
+ * libadt_bitwise_array_set64().
+ *
+ * As with libadt_bitwise_array_set(), values greater than the bit
+ * width supports are undefined behaviour. No boundary checking is
+ * performed: start + count must not exceed the array length.
+ *
+ * \param array The array to write to.
+ * \param start The index of the first element to write.
+ * \param count The number of elements to write.
+ * \param in The values to write.
+ *
+ * \sa libadt_bitwise_array_unpack()
+ */
+void libadt_bitwise_array_pack(
+	struct libadt_bitwise_array array,
+	ssize_t start,
+	ssize_t count,
+	const unsigned int *in
+);
+
 #undef _LIBADT_MAX
 
 #ifdef __cplusplus
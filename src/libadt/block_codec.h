@@ -0,0 +1,288 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBADT_BLOCK_CODEC_H
+#define LIBADT_BLOCK_CODEC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "allocator.h"
+#include "bitwise_array.h"
+
+/**
+ * \file
+ */
+
+/**
+ * \brief The largest number of values in a block.
+ */
+#define LIBADT_BLOCK_CODEC_MAX_BLOCK 256
+
+/**
+ * \brief How the values of each block are turned into the small
+ * 	numbers that are packed.
+ */
+enum libadt_block_codec_mode {
+	/**
+	 * \brief Frame of reference: each value less the smallest in
+	 * 	its block. For values within a narrow range.
+	 */
+	LIBADT_BLOCK_CODEC_FOR,
+
+	/**
+	 * \brief The difference from the value before, less the
+	 * 	smallest difference in the block. For sorted values, such
+	 * 	as IDs and timestamps; evenly spaced values take no bits.
+	 */
+	LIBADT_BLOCK_CODEC_DELTA,
+
+	/**
+	 * \brief The difference from the value before, zigzag encoded
+	 * 	so that small decreases are small too. For values that
+	 * 	mostly change a little in either direction.
+	 */
+	LIBADT_BLOCK_CODEC_ZIGZAG_DELTA,
+};
+
+/**
+ * \brief Describes one block of a libadt_block_codec.
+ */
+struct libadt_block_codec_header {
+	/**
+	 * \brief The smallest value of the block, in
+	 * 	LIBADT_BLOCK_CODEC_FOR mode, or its first value otherwise.
+	 */
+	uint64_t base;
+
+	/**
+	 * \brief The smallest difference in the block, in
+	 * 	LIBADT_BLOCK_CODEC_DELTA mode, or 0.
+	 */
+	uint64_t reference;
+
+	/**
+	 * \brief The offset of the block's packed values in
+	 * 	libadt_block_codec::data, in bytes.
+	 */
+	size_t offset;
+
+	/**
+	 * \brief The width of the block's packed values, from 0 to 64.
+	 */
+	int width;
+};
+
+/**
+ * \brief An immutable, compressed sequence of 64-bit values.
+ *
+ * Values are split into blocks of a fixed number of values, from 1
+ * to LIBADT_BLOCK_CODEC_MAX_BLOCK. Each block has a header giving a
+ * base and a bit width, and its values are packed at that width in a
+ * libadt_bitwise_array starting on a byte boundary. As the width is
+ * chosen per block, an outlier only widens its own block.
+ *
+ * Any block can be decoded on its own, with
+ * libadt_block_codec_decode_block(). Blocks of widths up to 32 are
+ * unpacked with the SIMD kernels of libadt_bitwise_array_unpack(),
+ * then have their base added or are prefix summed with SIMD too.
+ *
+ * \code
+ * struct libadt_block_codec codec = libadt_block_codec_encode(
+ * 	timestamps,
+ * 	count,
+ * 	128,
+ * 	LIBADT_BLOCK_CODEC_DELTA
+ * );
+ * uint64_t block[128];
+ * for (size_t i = 0; i < libadt_block_codec_blocks(codec); i++) {
+ * 	const size_t length = libadt_block_codec_decode_block(&codec, i, block);
+ * 	use(block, length);
+ * }
+ * codec = libadt_block_codec_free(codec);
+ * \endcode
+ */
+struct libadt_block_codec {
+	/**
+	 * \brief How the values were encoded.
+	 */
+	enum libadt_block_codec_mode mode;
+
+	/**
+	 * \brief The number of values.
+	 */
+	size_t length;
+
+	/**
+	 * \brief The number of values in each block, except perhaps
+	 * 	the last.
+	 */
+	size_t block_length;
+
+	/**
+	 * \brief The header of each block.
+	 */
+	struct libadt_block_codec_header *headers;
+
+	/**
+	 * \brief The packed values of every block.
+	 */
+	libadt_bitwise_array_bit *data;
+
+	/**
+	 * \brief The size of data, in bytes.
+	 */
+	size_t size;
+
+	/**
+	 * \brief The allocator used, or NULL for the standard library.
+	 */
+	const struct libadt_allocator *allocator;
+};
+
+/**
+ * \public \memberof libadt_block_codec
+ * \brief Encodes values, using the given allocator.
+ *
+ * \param values The values to encode.
+ * \param length The number of values.
+ * \param block_length The number of values in each block, from 1 to
+ * 	LIBADT_BLOCK_CODEC_MAX_BLOCK. 128 or 256 is usual.
+ * \param mode How to encode each block.
+ * \param allocator The allocator to use, or NULL for the standard
+ * 	library.
+ *
+ * \returns The encoded values, failing libadt_block_codec_valid()
+ * 	if block_length was out of range or allocation failed.
+ */
+struct libadt_block_codec libadt_block_codec_encode_with_allocator(
+	const uint64_t *values,
+	size_t length,
+	size_t block_length,
+	enum libadt_block_codec_mode mode,
+	const struct libadt_allocator *allocator
+);
+
+/**
+ * \public \memberof libadt_block_codec
+ * \brief Encodes values.
+ *
+ * \param values The values to encode.
+ * \param length The number of values.
+ * \param block_length The number of values in each block, from 1 to
+ * 	LIBADT_BLOCK_CODEC_MAX_BLOCK. 128 or 256 is usual.
+ * \param mode How to encode each block.
+ *
+ * \returns The encoded values, failing libadt_block_codec_valid()
+ * 	if block_length was out of range or allocation failed.
+ */
+struct libadt_block_codec libadt_block_codec_encode(
+	const uint64_t *values,
+	size_t length,
+	size_t block_length,
+	enum libadt_block_codec_mode mode
+);
+
+/**
+ * \public \memberof libadt_block_codec
+ * \brief Frees the encoded values.
+ *
+ * \returns A codec failing libadt_block_codec_valid().
+ */
+struct libadt_block_codec libadt_block_codec_free(struct libadt_block_codec codec);
+
+/**
+ * \public \memberof libadt_block_codec
+ * \brief Tests whether values were encoded.
+ */
+inline bool libadt_block_codec_valid(struct libadt_block_codec codec)
+{
+	return codec.block_length != 0;
+}
+
+/**
+ * \public \memberof libadt_block_codec
+ * \brief Returns the number of blocks.
+ */
+inline size_t libadt_block_codec_blocks(struct libadt_block_codec codec)
+{
+	return codec.block_length
+		? (codec.length + codec.block_length - 1) / codec.block_length
+		: 0;
+}
+
+/**
+ * \public \memberof libadt_block_codec
+ * \brief Returns the size of the encoded values and their headers,
+ * 	in bytes.
+ */
+inline size_t libadt_block_codec_size(struct libadt_block_codec codec)
+{
+	return codec.size + libadt_block_codec_blocks(codec) * sizeof(*codec.headers);
+}
+
+/**
+ * \public \memberof libadt_block_codec
+ * \brief Decodes one block.
+ *
+ * \param codec The encoded values.
+ * \param block The block to decode, less than
+ * 	libadt_block_codec_blocks().
+ * \param out Set to the values of the block. Must have room for
+ * 	libadt_block_codec::block_length values.
+ *
+ * \returns The number of values in the block, which is
+ * 	libadt_block_codec::block_length for every block but the last.
+ */
+size_t libadt_block_codec_decode_block(
+	const struct libadt_block_codec *codec,
+	size_t block,
+	uint64_t *out
+);
+
+/**
+ * \public \memberof libadt_block_codec
+ * \brief Decodes every value.
+ *
+ * \param codec The encoded values.
+ * \param out Set to the values. Must have room for
+ * 	libadt_block_codec::length values.
+ */
+void libadt_block_codec_decode(const struct libadt_block_codec *codec, uint64_t *out);
+
+/**
+ * \public \memberof libadt_block_codec
+ * \brief Returns the value at index, less than
+ * 	libadt_block_codec::length.
+ *
+ * In LIBADT_BLOCK_CODEC_FOR mode, this reads a single packed value.
+ * In the delta modes, it sums the differences from the start of the
+ * block, so decode whole blocks to read many values.
+ */
+uint64_t libadt_block_codec_get(const struct libadt_block_codec *codec, size_t index);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // LIBADT_BLOCK_CODEC_H
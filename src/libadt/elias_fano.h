@@ -0,0 +1,282 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBADT_ELIAS_FANO_H
+#define LIBADT_ELIAS_FANO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "allocator.h"
+#include "bitwise_array.h"
+#include "rank_select.h"
+
+/**
+ * \file
+ */
+
+/**
+ * \brief An immutable, compressed sequence of non-decreasing 64-bit
+ * 	values, such as a posting list.
+ *
+ * Each value is split into its low bits, stored at a fixed width in
+ * a libadt_bitwise_array, and its high bits, stored in unary in a
+ * bitmap: the ith value sets bit i + (value >> low width). The low
+ * width is chosen from the last value and the length so that the
+ * bitmap is at most about twice the length, for a total of about
+ * 2 + log2(last / length) bits per value.
+ *
+ * The ith value is found with a libadt_rank_select select of the
+ * ith one, and the first value at least x from a select of the
+ * zero ending the high bits before x's, then a short scan. Values
+ * are iterated a word of the bitmap at a time, without selects.
+ *
+ * \code
+ * struct libadt_elias_fano postings = libadt_elias_fano_init(
+ * 	ids.buffer,
+ * 	ids.length
+ * );
+ * uint64_t id;
+ * const size_t at = libadt_elias_fano_next_geq(&postings, 1000, &id);
+ * struct libadt_elias_fano_iterator it = libadt_elias_fano_iterator_at(&postings, at);
+ * while (libadt_elias_fano_iterator_next(&it, &id))
+ * 	use(id);
+ * postings = libadt_elias_fano_free(postings);
+ * \endcode
+ */
+struct libadt_elias_fano {
+	/**
+	 * \brief The number of values.
+	 */
+	size_t length;
+
+	/**
+	 * \brief The last, and largest, value, or 0 when empty.
+	 */
+	uint64_t last;
+
+	/**
+	 * \brief The low bits of each value, at a width from 0 to 63.
+	 */
+	struct libadt_bitwise_array low;
+
+	/**
+	 * \brief The high bits of each value in unary, as a width-1
+	 * 	array of length + (last >> low.width) + 1 bits.
+	 */
+	struct libadt_bitwise_array high;
+
+	/**
+	 * \brief The rank and select index over high.
+	 */
+	struct libadt_rank_select index;
+
+	/**
+	 * \brief The allocator used, or NULL for the standard library.
+	 */
+	const struct libadt_allocator *allocator;
+};
+
+/**
+ * \brief Visits the values of a libadt_elias_fano in order.
+ */
+struct libadt_elias_fano_iterator {
+	/**
+	 * \brief The sequence iterated over.
+	 */
+	const struct libadt_elias_fano *sequence;
+
+	/**
+	 * \brief The index of the next value.
+	 */
+	size_t index;
+
+	/**
+	 * \brief The word of the high bits holding the next value's one.
+	 */
+	size_t word;
+
+	/**
+	 * \brief The ones of that word not yet visited.
+	 */
+	uint64_t bits;
+};
+
+/**
+ * \public \memberof libadt_elias_fano
+ * \brief Encodes non-decreasing values, using the given allocator.
+ *
+ * \param values The values to encode, in non-decreasing order.
+ * \param length The number of values.
+ * \param allocator The allocator to use, or NULL for the standard
+ * 	library.
+ *
+ * \returns The encoded values, failing libadt_elias_fano_valid()
+ * 	if the values decrease anywhere or allocation failed.
+ */
+struct libadt_elias_fano libadt_elias_fano_init_with_allocator(
+	const uint64_t *values,
+	size_t length,
+	const struct libadt_allocator *allocator
+);
+
+/**
+ * \public \memberof libadt_elias_fano
+ * \brief Encodes non-decreasing values.
+ *
+ * \param values The values to encode, in non-decreasing order.
+ * \param length The number of values.
+ *
+ * \returns The encoded values, failing libadt_elias_fano_valid()
+ * 	if the values decrease anywhere or allocation failed.
+ */
+struct libadt_elias_fano libadt_elias_fano_init(const uint64_t *values, size_t length);
+
+/**
+ * \public \memberof libadt_elias_fano
+ * \brief Frees the sequence.
+ *
+ * \returns A sequence failing libadt_elias_fano_valid().
+ */
+struct libadt_elias_fano libadt_elias_fano_free(struct libadt_elias_fano sequence);
+
+/**
+ * \public \memberof libadt_elias_fano
+ * \brief Tests whether the sequence was encoded.
+ */
+inline bool libadt_elias_fano_valid(struct libadt_elias_fano sequence)
+{
+	return libadt_rank_select_valid(sequence.index);
+}
+
+/**
+ * \public \memberof libadt_elias_fano
+ * \brief Returns the size of the low and high bits, in bytes, not
+ * 	counting the index, which adds about 10% of the high bits.
+ */
+inline size_t libadt_elias_fano_size(struct libadt_elias_fano sequence)
+{
+	return libadt_bitwise_array_size(sequence.low)
+		+ libadt_bitwise_array_size(sequence.high);
+}
+
+/**
+ * \public \memberof libadt_elias_fano
+ * \brief Returns the value at an index.
+ *
+ * \param sequence The sequence.
+ * \param index An index less than the sequence's length.
+ *
+ * \returns The value.
+ */
+inline uint64_t libadt_elias_fano_get(
+	const struct libadt_elias_fano *sequence,
+	size_t index
+)
+{
+	const size_t position = (size_t)libadt_rank_select_select(&sequence->index, index);
+	return ((uint64_t)(position - index) << sequence->low.width)
+		| libadt_bitwise_array_get64(sequence->low, (ssize_t)index);
+}
+
+/**
+ * \public \memberof libadt_elias_fano
+ * \brief Finds the first value at least x.
+ *
+ * \param sequence The sequence.
+ * \param x The value to search for.
+ * \param value Set to the value found, if there is one.
+ *
+ * \returns The index of the value, or the sequence's length if every
+ * 	value is less than x.
+ */
+size_t libadt_elias_fano_next_geq(
+	const struct libadt_elias_fano *sequence,
+	uint64_t x,
+	uint64_t *value
+);
+
+/**
+ * \public \memberof libadt_elias_fano_iterator
+ * \brief Returns an iterator starting at an index.
+ *
+ * \param sequence The sequence to iterate over.
+ * \param index The index of the first value to visit, or the
+ * 	sequence's length for none.
+ */
+struct libadt_elias_fano_iterator libadt_elias_fano_iterator_at(
+	const struct libadt_elias_fano *sequence,
+	size_t index
+);
+
+/**
+ * \internal
+ * \brief Returns the number of zeros above the highest one of a
+ * 	nonzero word.
+ */
+inline unsigned int libadt_elias_fano_leading_zeros(uint64_t word)
+{
+#ifdef __GNUC__
+	return (unsigned int)__builtin_clzll(word);
+#else
+	unsigned int zeros = 0;
+	for (; !(word >> 63); word <<= 1)
+		zeros++;
+	return zeros;
+#endif
+}
+
+/**
+ * \public \memberof libadt_elias_fano_iterator
+ * \brief Moves to the next value.
+ *
+ * \param iterator The iterator.
+ * \param value Set to the value, if there is one.
+ *
+ * \returns Whether there was a value, or false at the end.
+ */
+inline bool libadt_elias_fano_iterator_next(
+	struct libadt_elias_fano_iterator *iterator,
+	uint64_t *value
+)
+{
+	const struct libadt_elias_fano *const sequence = iterator->sequence;
+	if (iterator->index >= sequence->length)
+		return false;
+	while (!iterator->bits)
+		iterator->bits = libadt_rank_select_word(&sequence->index, ++iterator->word);
+
+	const unsigned int bit = libadt_elias_fano_leading_zeros(iterator->bits);
+	iterator->bits ^= (uint64_t)1 << (63 - bit);
+	const size_t position = iterator->word * 64 + bit;
+	*value = ((uint64_t)(position - iterator->index) << sequence->low.width)
+		| libadt_bitwise_array_get64(sequence->low, (ssize_t)iterator->index);
+	iterator->index++;
+	return true;
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // LIBADT_ELIAS_FANO_H
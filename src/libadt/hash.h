@@ -0,0 +1,163 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBADT_HASH_H
+#define LIBADT_HASH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lptr.h"
+
+/**
+ * \file
+ * \brief Fast non-cryptographic hashing of the memory pointed to by
+ * 	an lptr.
+ *
+ * The algorithm follows the construction of wyhash: 8-byte words
+ * are mixed with 64x64 to 128-bit multiplies, reading 48 bytes per
+ * round on three independent lanes, and inputs up to 16 bytes take
+ * a single multiply. It is suitable for hash tables,
+ * sharding and deduplication, but not against an adversary who can
+ * choose the input: use a secret seed where that matters.
+ *
+ * Hashes are the same on every platform, and the one-shot, streaming
+ * and batched functions all give the same hash for the same bytes.
+ */
+
+/**
+ * \brief Hashes the memory pointed to by lptr, size * length bytes.
+ *
+ * \param lptr The memory to hash.
+ *
+ * \returns The hash.
+ */
+uint64_t libadt_lptr_hash(struct libadt_const_lptr lptr);
+
+/**
+ * \brief Hashes the memory pointed to by lptr with a seed.
+ *
+ * Different seeds give unrelated hashes. libadt_lptr_hash() uses a
+ * seed of 0.
+ *
+ * \param lptr The memory to hash.
+ * \param seed The seed.
+ *
+ * \returns The hash.
+ */
+uint64_t libadt_lptr_hash_seeded(struct libadt_const_lptr lptr, uint64_t seed);
+
+/**
+ * \brief Hashes many buffers at once.
+ *
+ * Prefetches the memory a few buffers ahead of the one being hashed,
+ * hiding the cache misses of buffers scattered through memory, such
+ * as the keys of a batch of lookups.
+ *
+ * \param lptrs The buffers to hash.
+ * \param hashes Receives the hash of each buffer.
+ * \param number The number of buffers.
+ * \param seed The seed, 0 to match libadt_lptr_hash().
+ */
+void libadt_lptr_hash_batch(
+	const struct libadt_const_lptr *lptrs,
+	uint64_t *hashes,
+	size_t number,
+	uint64_t seed
+);
+
+/**
+ * \brief Hashes data arriving in chunks.
+ *
+ * The result is the same as hashing the concatenation of the chunks
+ * in one go, however they are split.
+ *
+ * \code
+ * struct libadt_lptr_hasher hasher = libadt_lptr_hasher_init(0);
+ * while (read_chunk(&chunk))
+ * 	libadt_lptr_hasher_update(&hasher, chunk);
+ * uint64_t hash = libadt_lptr_hasher_final(&hasher);
+ * \endcode
+ */
+struct libadt_lptr_hasher {
+	/**
+	 * \brief The state of the three lanes.
+	 */
+	uint64_t lanes[3];
+
+	/**
+	 * \brief The number of bytes hashed so far.
+	 */
+	uint64_t length;
+
+	/**
+	 * \brief The number of bytes waiting in buffer, after the first
+	 * 	16.
+	 */
+	size_t buffered;
+
+	/**
+	 * \brief The last 16 bytes consumed by the lanes, followed by up
+	 * 	to 48 bytes not yet consumed.
+	 *
+	 * The final round of the hash reads the last 16 bytes of the
+	 * input, which can reach back into bytes the lanes have already
+	 * consumed.
+	 */
+	unsigned char buffer[64];
+};
+
+/**
+ * \public \memberof libadt_lptr_hasher
+ * \brief Starts hashing.
+ *
+ * \param seed The seed, 0 to match libadt_lptr_hash().
+ *
+ * \returns The hasher.
+ */
+struct libadt_lptr_hasher libadt_lptr_hasher_init(uint64_t seed);
+
+/**
+ * \public \memberof libadt_lptr_hasher
+ * \brief Hashes the next chunk of data.
+ *
+ * \param hasher The hasher.
+ * \param chunk The next chunk, size * length bytes.
+ */
+void libadt_lptr_hasher_update(
+	struct libadt_lptr_hasher *hasher,
+	struct libadt_const_lptr chunk
+);
+
+/**
+ * \public \memberof libadt_lptr_hasher
+ * \brief Returns the hash of everything hashed so far.
+ *
+ * The hasher is unchanged, so more chunks can follow.
+ */
+uint64_t libadt_lptr_hasher_final(const struct libadt_lptr_hasher *hasher);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // LIBADT_HASH_H
@@ -0,0 +1,588 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBADT_HASH_MAP_H
+#define LIBADT_HASH_MAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "allocator.h"
+#include "vector.h"
+
+/**
+ * \file
+ * \brief An open-addressing hash map in the style of Abseil's
+ * 	Swiss tables.
+ *
+ * Every slot has a control byte: empty, deleted, or the low 7 bits
+ * of the hash of the key stored there. Lookups compare a whole group
+ * of 16 control bytes against the hash at once, with SSE2 where
+ * available and with bit tricks on 64-bit words otherwise, and only
+ * compare keys where the 7 bits match. Keys and values are stored in
+ * two libadt_vector buffers with one element per slot.
+ *
+ * Keys and values have fixed sizes, like vector elements. Hashing
+ * and comparing keys goes through callbacks; LIBADT_HASH_MAP_DEFINE
+ * generates typed functions with both inlined.
+ */
+
+/**
+ * \brief The number of control bytes probed at once.
+ */
+#define LIBADT_HASH_MAP_GROUP 16
+
+/**
+ * \brief The control byte of an empty slot.
+ */
+#define LIBADT_HASH_MAP_EMPTY ((signed char)-128)
+
+/**
+ * \brief The control byte of a slot whose entry was erased.
+ */
+#define LIBADT_HASH_MAP_DELETED ((signed char)-2)
+
+/**
+ * \brief Hashes a key.
+ *
+ * \param key The key to hash.
+ * \param size The size of the key.
+ *
+ * \returns The hash. All 64 bits should be well mixed: the low 7
+ * 	bits are stored in the control bytes, and the rest pick the
+ * 	slot.
+ */
+typedef uint64_t libadt_hash_map_hash(const void *key, size_t size);
+
+/**
+ * \brief Compares two keys.
+ *
+ * \returns True if the keys are equal.
+ */
+typedef bool libadt_hash_map_equal(const void *first, const void *second, size_t size);
+
+/**
+ * \brief Represents a hash map from fixed-size keys to fixed-size
+ * 	values.
+ */
+struct libadt_hash_map {
+	/**
+	 * \brief The control bytes, one per slot, followed by copies of
+	 * 	the first LIBADT_HASH_MAP_GROUP - 1 so that a group can be
+	 * 	loaded from any slot without wrapping.
+	 */
+	signed char *control;
+
+	/**
+	 * \brief The keys, one per slot. The vector's size is the key
+	 * 	size, and its allocator is used for all of the map's memory.
+	 */
+	struct libadt_vector keys;
+
+	/**
+	 * \brief The values, one per slot. Empty if the values have
+	 * 	size 0, in which case the map is a set.
+	 */
+	struct libadt_vector values;
+
+	/**
+	 * \brief The number of slots: 0, or a power of two at least
+	 * 	LIBADT_HASH_MAP_GROUP.
+	 */
+	size_t capacity;
+
+	/**
+	 * \brief The number of entries in the map.
+	 */
+	size_t length;
+
+	/**
+	 * \brief The number of entries that can be inserted before the
+	 * 	map is rehashed.
+	 */
+	size_t growth_left;
+
+	/**
+	 * \brief The function hashing keys.
+	 */
+	libadt_hash_map_hash *hash;
+
+	/**
+	 * \brief The function comparing keys.
+	 */
+	libadt_hash_map_equal *equal;
+};
+
+/**
+ * \public \memberof libadt_hash_map
+ * \brief Constructs an empty hash map.
+ *
+ * No memory is allocated until the first insert.
+ *
+ * \param key_size The size of a key. Must not be 0.
+ * \param value_size The size of a value, or 0 for a set.
+ * \param hash The function hashing keys, or NULL to hash their bytes.
+ * \param equal The function comparing keys, or NULL to compare their
+ * 	bytes.
+ *
+ * \returns The new map.
+ */
+struct libadt_hash_map libadt_hash_map_init(
+	size_t key_size,
+	size_t value_size,
+	libadt_hash_map_hash *hash,
+	libadt_hash_map_equal *equal
+);
+
+/**
+ * \public \memberof libadt_hash_map
+ * \brief Constructs an empty hash map which allocates using the
+ * 	given allocator.
+ *
+ * \param key_size The size of a key. Must not be 0.
+ * \param value_size The size of a value, or 0 for a set.
+ * \param hash The function hashing keys, or NULL to hash their bytes.
+ * \param equal The function comparing keys, or NULL to compare their
+ * 	bytes.
+ * \param allocator The allocator to use, or NULL for the standard
+ * 	library. It must outlive the map.
+ *
+ * \returns The new map.
+ *
+ * \sa libadt_hash_map_init()
+ */
+struct libadt_hash_map libadt_hash_map_init_with_allocator(
+	size_t key_size,
+	size_t value_size,
+	libadt_hash_map_hash *hash,
+	libadt_hash_map_equal *equal,
+	const struct libadt_allocator *allocator
+);
+
+/**
+ * \public \memberof libadt_hash_map
+ * \brief Frees the memory managed by the map.
+ *
+ * \returns A map failing libadt_hash_map_valid().
+ */
+struct libadt_hash_map libadt_hash_map_free(struct libadt_hash_map map);
+
+/**
+ * \public \memberof libadt_hash_map
+ * \brief Tests whether a libadt_hash_map is a valid object.
+ */
+inline bool libadt_hash_map_valid(struct libadt_hash_map map)
+{
+	return libadt_vector_valid(map.keys);
+}
+
+/**
+ * \public \memberof libadt_hash_map
+ * \brief Looks up a key.
+ *
+ * \param map The map to search.
+ * \param key The key to look for.
+ *
+ * \returns A pointer to the key's value, or to the stored key if the
+ * 	map is a set, or NULL if the key is not in the map. The
+ * 	pointer is invalidated by inserting into the map.
+ */
+void *libadt_hash_map_find(const struct libadt_hash_map *map, const void *key);
+
+/**
+ * \public \memberof libadt_hash_map
+ * \brief Inserts a key and value, replacing the value if the key
+ * 	was already in the map.
+ *
+ * \param map The map to insert into.
+ * \param key The key to insert.
+ * \param value The value to insert. Ignored if the map is a set.
+ *
+ * \returns A pointer to the stored value, or to the stored key if
+ * 	the map is a set, or NULL if memory could not be allocated.
+ */
+void *libadt_hash_map_insert(
+	struct libadt_hash_map *map,
+	const void *key,
+	const void *value
+);
+
+/**
+ * \public \memberof libadt_hash_map
+ * \brief Removes a key and its value.
+ *
+ * \returns True if the key was in the map.
+ */
+bool libadt_hash_map_erase(struct libadt_hash_map *map, const void *key);
+
+/**
+ * \public \memberof libadt_hash_map
+ * \brief Makes room for at least _length_ entries, so that inserts
+ * 	up to that length don't rehash.
+ *
+ * \returns True on success, false if memory could not be allocated.
+ */
+bool libadt_hash_map_reserve(struct libadt_hash_map *map, size_t length);
+
+/**
+ * \public \memberof libadt_hash_map
+ * \brief Removes every entry, keeping the memory.
+ */
+void libadt_hash_map_clear(struct libadt_hash_map *map);
+
+/**
+ * \internal
+ * \brief Rehashes the map to make room for one more entry.
+ *
+ * \returns False if memory could not be allocated.
+ */
+bool libadt_hash_map_grow(struct libadt_hash_map *map);
+
+/**
+ * \internal
+ * \brief Returns the index of the lowest set bit, which must exist.
+ */
+inline unsigned int libadt_hash_map_lowest(uint32_t mask)
+{
+#ifdef __GNUC__
+	return (unsigned int)__builtin_ctz(mask);
+#else
+	unsigned int result = 0;
+	while (!(mask & 1)) {
+		mask >>= 1;
+		result++;
+	}
+	return result;
+#endif
+}
+
+/**
+ * \internal
+ * \brief Loads 8 control bytes as a word with byte i in bits
+ * 	8i to 8i + 7.
+ */
+inline uint64_t libadt_hash_map_word(const signed char *group)
+{
+	uint64_t word;
+	memcpy(&word, group, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	word = __builtin_bswap64(word);
+#endif
+	return word;
+}
+
+/**
+ * \internal
+ * \brief Packs the top bit of each byte into the low 8 bits, like
+ * 	_mm_movemask_epi8.
+ */
+inline uint32_t libadt_hash_map_pack(uint64_t word)
+{
+	return (uint32_t)((((word >> 7) & 0x0101010101010101u) * 0x0102040810204080u) >> 56);
+}
+
+/**
+ * \internal
+ * \brief Returns a mask with bit i set where group[i] might be h2.
+ *
+ * The fallback can report false positives next to true ones, which
+ * only cost a key comparison.
+ */
+inline uint32_t libadt_hash_map_match(const signed char *group, uint64_t h2)
+{
+#ifdef __SSE2__
+	const __m128i control = _mm_loadu_si128((const __m128i *)group);
+	return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(control, _mm_set1_epi8((char)h2)));
+#else
+	const uint64_t lsbs = 0x0101010101010101u, msbs = 0x8080808080808080u;
+	uint32_t result = 0;
+	for (unsigned int half = 0; half < 2; half++) {
+		const uint64_t x = libadt_hash_map_word(group + 8 * half) ^ (lsbs * h2);
+		result |= libadt_hash_map_pack((x - lsbs) & ~x & msbs) << (8 * half);
+	}
+	return result;
+#endif
+}
+
+/**
+ * \internal
+ * \brief Returns a mask with bit i set where group[i] is empty.
+ */
+inline uint32_t libadt_hash_map_match_empty(const signed char *group)
+{
+#ifdef __SSE2__
+	const __m128i control = _mm_loadu_si128((const __m128i *)group);
+	return (uint32_t)_mm_movemask_epi8(
+		_mm_cmpeq_epi8(control, _mm_set1_epi8(LIBADT_HASH_MAP_EMPTY))
+	);
+#else
+	// Empty is the only control byte with bit 7 set and bit 1 clear
+	uint32_t result = 0;
+	for (unsigned int half = 0; half < 2; half++) {
+		const uint64_t word = libadt_hash_map_word(group + 8 * half);
+		result |= libadt_hash_map_pack(word & ~(word << 6) & 0x8080808080808080u) << (8 * half);
+	}
+	return result;
+#endif
+}
+
+/**
+ * \internal
+ * \brief Returns a mask with bit i set where group[i] is empty or
+ * 	deleted.
+ */
+inline uint32_t libadt_hash_map_match_free(const signed char *group)
+{
+#ifdef __SSE2__
+	return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group));
+#else
+	return libadt_hash_map_pack(libadt_hash_map_word(group))
+		| libadt_hash_map_pack(libadt_hash_map_word(group + 8)) << 8;
+#endif
+}
+
+/**
+ * \internal
+ * \brief Sets the control byte of a slot, and its copy.
+ */
+inline void libadt_hash_map_set_control(
+	struct libadt_hash_map *map,
+	size_t slot,
+	signed char control
+)
+{
+	const size_t mask = map->capacity - 1;
+	map->control[slot] = control;
+	// For slots past the copied ones, this writes the slot again
+	map->control[((slot - (LIBADT_HASH_MAP_GROUP - 1)) & mask) + (LIBADT_HASH_MAP_GROUP - 1)] = control;
+}
+
+/**
+ * \public \memberof libadt_hash_map
+ * \brief Returns a pointer to the key in a slot.
+ */
+inline void *libadt_hash_map_key(const struct libadt_hash_map *map, size_t slot)
+{
+	return (char *)map->keys.buffer + slot * map->keys.size;
+}
+
+/**
+ * \public \memberof libadt_hash_map
+ * \brief Returns a pointer to the value in a slot, or to the key if
+ * 	the map is a set.
+ */
+inline void *libadt_hash_map_value(const struct libadt_hash_map *map, size_t slot)
+{
+	if (!map->values.size)
+		return libadt_hash_map_key(map, slot);
+	return (char *)map->values.buffer + slot * map->values.size;
+}
+
+/**
+ * \public \memberof libadt_hash_map
+ * \brief Returns the first slot at or after _slot_ holding an
+ * 	entry, or libadt_hash_map::capacity if there is none.
+ *
+ * Iterates over a map as follows:
+ *
+ * \code
+ * for (
+ * 	size_t slot = libadt_hash_map_next(&map, 0);
+ * 	slot < map.capacity;
+ * 	slot = libadt_hash_map_next(&map, slot + 1)
+ * )
+ * 	use(libadt_hash_map_key(&map, slot), libadt_hash_map_value(&map, slot));
+ * \endcode
+ */
+inline size_t libadt_hash_map_next(const struct libadt_hash_map *map, size_t slot)
+{
+	while (slot < map->capacity && map->control[slot] < 0)
+		slot++;
+	return slot;
+}
+
+/**
+ * \internal
+ * \brief Claims a free slot for a new entry with the given hash,
+ * 	which must not already be in the map.
+ *
+ * \returns The slot, with its control byte set, or map->capacity if
+ * 	memory could not be allocated.
+ */
+inline size_t libadt_hash_map_prepare_insert(struct libadt_hash_map *map, uint64_t hash)
+{
+	if (!map->growth_left && !libadt_hash_map_grow(map))
+		return map->capacity;
+
+	const size_t mask = map->capacity - 1;
+	size_t position = (size_t)(hash >> 7) & mask;
+	for (size_t step = LIBADT_HASH_MAP_GROUP;; step += LIBADT_HASH_MAP_GROUP) {
+		const uint32_t free = libadt_hash_map_match_free(map->control + position);
+		if (free) {
+			const size_t slot = (position + libadt_hash_map_lowest(free)) & mask;
+			map->growth_left -= map->control[slot] == LIBADT_HASH_MAP_EMPTY;
+			libadt_hash_map_set_control(map, slot, (signed char)(hash & 0x7f));
+			map->length++;
+			return slot;
+		}
+		position = (position + step) & mask;
+	}
+}
+
+/**
+ * \internal
+ * \brief Marks a slot as deleted.
+ */
+inline void libadt_hash_map_erase_slot(struct libadt_hash_map *map, size_t slot)
+{
+	libadt_hash_map_set_control(map, slot, LIBADT_HASH_MAP_DELETED);
+	map->length--;
+}
+
+/**
+ * \brief Defines hash map functions specialized for one key and
+ * 	value type, with hashing and comparison inlined.
+ *
+ * The following static functions are defined:
+ *
+ * - `struct libadt_hash_map NAME##_init(void)`, constructing a map
+ * 	whose callbacks wrap HASH and EQUAL, so that the generic
+ * 	functions work on it too.
+ * - `VALUE *NAME##_find(const struct libadt_hash_map *map, KEY key)`
+ * - `VALUE *NAME##_insert(struct libadt_hash_map *map, KEY key, VALUE value)`
+ * - `bool NAME##_erase(struct libadt_hash_map *map, KEY key)`
+ *
+ * which behave like the generic functions of the same names.
+ *
+ * \code
+ * #define u64_equal(a, b) ((a) == (b))
+ * LIBADT_HASH_MAP_DEFINE(u64_map, uint64_t, uint64_t, mix64, u64_equal)
+ *
+ * struct libadt_hash_map map = u64_map_init();
+ * u64_map_insert(&map, 42, 1);
+ * uint64_t *value = u64_map_find(&map, 42);
+ * \endcode
+ *
+ * \param NAME The prefix of the generated functions.
+ * \param KEY The key type.
+ * \param VALUE The value type.
+ * \param HASH A function or function-like macro taking a KEY and
+ * 	returning a well-mixed uint64_t.
+ * \param EQUAL A function or function-like macro taking two KEYs
+ * 	and returning true if they are equal.
+ */
+#define LIBADT_HASH_MAP_DEFINE(NAME, KEY, VALUE, HASH, EQUAL) \
+static inline uint64_t NAME##_hash_callback(const void *key, size_t size) \
+{ \
+	KEY value; \
+	(void)size; \
+	memcpy(&value, key, sizeof(value)); \
+	return HASH(value); \
+} \
+\
+static inline bool NAME##_equal_callback(const void *first, const void *second, size_t size) \
+{ \
+	KEY a, b; \
+	(void)size; \
+	memcpy(&a, first, sizeof(a)); \
+	memcpy(&b, second, sizeof(b)); \
+	return EQUAL(a, b); \
+} \
+\
+static inline struct libadt_hash_map NAME##_init(void) \
+{ \
+	return libadt_hash_map_init( \
+		sizeof(KEY), \
+		sizeof(VALUE), \
+		NAME##_hash_callback, \
+		NAME##_equal_callback \
+	); \
+} \
+\
+/* Returns the slot holding key, or map->capacity */ \
+static inline size_t NAME##_slot(const struct libadt_hash_map *map, KEY key, uint64_t hash) \
+{ \
+	if (!map->length) \
+		return map->capacity; \
+	const size_t mask = map->capacity - 1; \
+	const KEY *const keys = (const KEY *)map->keys.buffer; \
+	size_t position = (size_t)(hash >> 7) & mask; \
+	for (size_t step = LIBADT_HASH_MAP_GROUP;; step += LIBADT_HASH_MAP_GROUP) { \
+		const signed char *const group = map->control + position; \
+		for ( \
+			uint32_t match = libadt_hash_map_match(group, hash & 0x7f); \
+			match; \
+			match &= match - 1 \
+		) { \
+			const size_t slot = (position + libadt_hash_map_lowest(match)) & mask; \
+			if (EQUAL(keys[slot], key)) \
+				return slot; \
+		} \
+		if (libadt_hash_map_match_empty(group)) \
+			return map->capacity; \
+		position = (position + step) & mask; \
+	} \
+} \
+\
+static inline VALUE *NAME##_find(const struct libadt_hash_map *map, KEY key) \
+{ \
+	const size_t slot = NAME##_slot(map, key, HASH(key)); \
+	if (slot == map->capacity) \
+		return NULL; \
+	return &((VALUE *)map->values.buffer)[slot]; \
+} \
+\
+static inline VALUE *NAME##_insert(struct libadt_hash_map *map, KEY key, VALUE value) \
+{ \
+	const uint64_t hash = HASH(key); \
+	size_t slot = NAME##_slot(map, key, hash); \
+	if (slot == map->capacity) { \
+		slot = libadt_hash_map_prepare_insert(map, hash); \
+		if (slot == map->capacity) \
+			return NULL; \
+		((KEY *)map->keys.buffer)[slot] = key; \
+	} \
+	VALUE *const result = &((VALUE *)map->values.buffer)[slot]; \
+	*result = value; \
+	return result; \
+} \
+\
+static inline bool NAME##_erase(struct libadt_hash_map *map, KEY key) \
+{ \
+	const size_t slot = NAME##_slot(map, key, HASH(key)); \
+	if (slot == map->capacity) \
+		return false; \
+	libadt_hash_map_erase_slot(map, slot); \
+	return true; \
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // LIBADT_HASH_MAP_H
@@ -34,6 +34,7 @@ extern "C" {
 #include <string.h>
 
 #include "util.h"
+#include "allocator.h"
 
 /**
  * \brief Defines a constant long- or length-pointer type.
@@ -351,6 +352,104 @@ inline struct libadt_lptr libadt_lptr_free(struct libadt_lptr lptr)
 	return (struct libadt_lptr) { 0 };
 }
 
+/**
+ * \brief Allocates an array buffer, initialized to 0,
+ * 	using the given allocator.
+ *
+ * The lptr does not remember the allocator: it must be
+ * reallocated with libadt_lptr_reallocarray_with_allocator()
+ * and freed with libadt_lptr_free_with_allocator(), passing
+ * the same allocator.
+ *
+ * \param nmemb The number of members (length).
+ * \param size The size of each member.
+ * \param allocator The allocator to use, or NULL for the
+ * 	standard library.
+ *
+ * \returns A new libadt_lptr object passing libadt_lptr_valid()
+ * 	if allocation succeeded, or failing libadt_lptr_valid() if
+ * 	allocation failed.
+ *
+ * \sa libadt_allocator
+ */
+inline struct libadt_lptr libadt_lptr_calloc_with_allocator(
+	size_t nmemb,
+	size_t size,
+	const struct libadt_allocator *allocator
+)
+{
+	struct libadt_lptr result = {
+		.buffer = NULL,
+		.size = (ssize_t)size,
+		.length = (ssize_t)nmemb,
+	};
+
+	if (size && nmemb > SSIZE_MAX / size)
+		return result;
+
+	result.buffer = libadt_allocator_allocate(allocator, nmemb * size);
+	if (result.buffer)
+		memset(result.buffer, 0, nmemb * size);
+	return result;
+}
+
+/**
+ * \brief Reallocates an lptr allocated with
+ * 	libadt_lptr_calloc_with_allocator(), reusing the old size.
+ *
+ * \param lptr The lptr to reallocate.
+ * \param nmemb The new number of members (length) to
+ * 	reallocate the pointer to. Must not be 0.
+ * \param allocator The allocator lptr was allocated with.
+ *
+ * \returns A new libadt_ptr object, either containing the
+ * 	new length if reallocation was successful or the
+ * 	old length if it failed.
+ */
+inline struct libadt_lptr libadt_lptr_reallocarray_with_allocator(
+	struct libadt_lptr lptr,
+	size_t nmemb,
+	const struct libadt_allocator *allocator
+)
+{
+	if (!nmemb || SSIZE_MAX / (ssize_t)nmemb < lptr.size)
+		return lptr;
+
+	void *const attempt = libadt_allocator_reallocate(
+		allocator,
+		lptr.buffer,
+		(size_t)(lptr.size * lptr.length),
+		(size_t)lptr.size * nmemb
+	);
+	if (attempt) {
+		lptr.buffer = attempt;
+		lptr.length = (ssize_t)nmemb;
+	}
+	return lptr;
+}
+
+/**
+ * \brief Frees an lptr allocated with
+ * 	libadt_lptr_calloc_with_allocator(), returning an invalid lptr.
+ *
+ * \param lptr The lptr to free.
+ * \param allocator The allocator lptr was allocated with.
+ *
+ * \returns A libadt_lptr failing libadt_lptr_valid().
+ */
+inline struct libadt_lptr libadt_lptr_free_with_allocator(
+	struct libadt_lptr lptr,
+	const struct libadt_allocator *allocator
+)
+{
+	libadt_allocator_deallocate(
+		allocator,
+		lptr.buffer,
+		(size_t)(lptr.size * lptr.length)
+	);
+	return (struct libadt_lptr) { 0 };
+}
+
 /**
  * \brief Returns raw pointer the given lptr contains.
  *
@@ -0,0 +1,147 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBADT_MMAP_H
+#define LIBADT_MMAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lptr.h"
+
+/**
+ * \file
+ * \brief Views of whole files as lptrs, through mmap().
+ *
+ * A mapped file is read straight from the page cache, without the
+ * copy into a buffer that read() makes, so the str functions can
+ * parse files of any size in place:
+ *
+ * \code
+ * struct libadt_const_lptr file = libadt_lptr_mmap_file(path, LIBADT_MMAP_SEQUENTIAL);
+ * if (!libadt_const_lptr_allocated(file))
+ * 	return -1;
+ * for (
+ * 	struct libadt_str_split line = libadt_str_split_next(libadt_str_split_byte(file, '\n'));
+ * 	libadt_str_split_valid(line);
+ * 	line = libadt_str_split_next(line)
+ * )
+ * 	parse(line.token);
+ * libadt_const_lptr_munmap(file);
+ * \endcode
+ *
+ * The lptrs have a size of 1 and a length of the file size in bytes.
+ *
+ * Mapping and unmapping cost more than reading a small file, so
+ * read() into a reused buffer is faster for files under about a
+ * megabyte.
+ */
+
+/**
+ * \brief Hints about how a mapped file will be used, combined with
+ * 	bitwise or.
+ *
+ * Hints the platform does not support are ignored.
+ */
+enum libadt_mmap_flags {
+	/**
+	 * \brief The file will be read from start to end, so the kernel
+	 * 	can read ahead aggressively and drop pages once read.
+	 */
+	LIBADT_MMAP_SEQUENTIAL = 1 << 0,
+
+	/**
+	 * \brief The whole file will be needed soon, so the kernel can
+	 * 	start reading it in the background.
+	 */
+	LIBADT_MMAP_WILLNEED = 1 << 1,
+
+	/**
+	 * \brief Back the mapping with huge pages where the kernel and
+	 * 	filesystem support it, cutting TLB misses on large files.
+	 * 	The mapping is aligned to a huge page for this.
+	 */
+	LIBADT_MMAP_HUGEPAGE = 1 << 2,
+
+	/**
+	 * \brief Read the whole file and fill in the page tables before
+	 * 	returning, so that no access faults. Without MAP_POPULATE,
+	 * 	this is the same as LIBADT_MMAP_WILLNEED.
+	 */
+	LIBADT_MMAP_POPULATE = 1 << 3,
+};
+
+/**
+ * \brief Maps a file read-only.
+ *
+ * Changes made to the file by others while it is mapped may or may
+ * not be seen, and truncating it makes reading past the new end
+ * raise SIGBUS.
+ *
+ * \param path The file to map, which must be a regular file.
+ * \param flags A combination of libadt_mmap_flags, or 0.
+ *
+ * \returns The contents of the file, which must be unmapped with
+ * 	libadt_const_lptr_munmap(), or an lptr failing
+ * 	libadt_const_lptr_allocated() with errno set. An empty file
+ * 	gives an allocated lptr of length 0.
+ */
+struct libadt_const_lptr libadt_lptr_mmap_file(const char *path, int flags);
+
+/**
+ * \brief Maps a file for reading and writing, with MAP_SHARED.
+ *
+ * Writes go to the page cache and reach the file without a
+ * write(). The file keeps its size.
+ *
+ * \param path The file to map, which must be a regular file.
+ * \param flags A combination of libadt_mmap_flags, or 0.
+ *
+ * \returns The contents of the file, which must be unmapped with
+ * 	libadt_lptr_munmap(), or an lptr failing
+ * 	libadt_lptr_allocated() with errno set. An empty file gives an
+ * 	allocated lptr of length 0.
+ */
+struct libadt_lptr libadt_lptr_mmap_file_shared(const char *path, int flags);
+
+/**
+ * \brief Unmaps a file mapped with libadt_lptr_mmap_file().
+ *
+ * \param lptr The mapping, or an lptr failing
+ * 	libadt_const_lptr_allocated().
+ *
+ * \returns An lptr failing libadt_const_lptr_allocated().
+ */
+struct libadt_const_lptr libadt_const_lptr_munmap(struct libadt_const_lptr lptr);
+
+/**
+ * \brief Unmaps a file mapped with libadt_lptr_mmap_file_shared().
+ *
+ * \param lptr The mapping, or an lptr failing
+ * 	libadt_lptr_allocated().
+ *
+ * \returns An lptr failing libadt_lptr_allocated().
+ */
+struct libadt_lptr libadt_lptr_munmap(struct libadt_lptr lptr);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // LIBADT_MMAP_H
@@ -0,0 +1,358 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBADT_PACKED_VECTOR_H
+#define LIBADT_PACKED_VECTOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <limits.h>
+
+#include "allocator.h"
+#include "bitwise_array.h"
+
+/**
+ * \file
+ */
+
+/**
+ * \brief A vector of unsigned integers, each stored in the same
+ * 	number of bits, like a libadt_bitwise_array that grows.
+ *
+ * Appending to a full vector doubles its capacity. Appending a value
+ * too large for the current width re-packs every element at the
+ * width the value needs, in place. Widths only grow, so elements are
+ * re-packed at most 31 times over the life of the vector, and
+ * appending stays amortized constant time.
+ *
+ * \code
+ * struct libadt_packed_vector ids = libadt_packed_vector_init(1, 0);
+ * for (size_t i = 0; i < count; i++) {
+ * 	const size_t length = ids.length;
+ * 	ids = libadt_packed_vector_append(ids, source[i]);
+ * 	if (ids.length == length)
+ * 		handle_error();
+ * }
+ * \endcode
+ */
+struct libadt_packed_vector {
+	/**
+	 * \brief The packed elements, in the layout of a
+	 * 	libadt_bitwise_array of capacity elements.
+	 */
+	libadt_bitwise_array_bit *bits;
+
+	/**
+	 * \brief The number of bits in each element, from 1 to 32.
+	 */
+	int width;
+
+	/**
+	 * \brief The number of elements currently stored.
+	 */
+	size_t length;
+
+	/**
+	 * \brief The number of elements the buffer holds at the
+	 * 	current width.
+	 */
+	size_t capacity;
+
+	/**
+	 * \brief The allocator used for the buffer, or NULL for the
+	 * 	standard library.
+	 */
+	const struct libadt_allocator *allocator;
+};
+
+/**
+ * \public \memberof libadt_packed_vector
+ * \brief Constructs a packed vector using the given allocator.
+ *
+ * \param width The starting width of each element, from 1 to 32.
+ * \param initial_capacity The number of elements to allocate room
+ * 	for. 0 delays allocation until the first append.
+ * \param allocator The allocator to use, or NULL for the standard
+ * 	library.
+ *
+ * \returns A vector, failing libadt_packed_vector_valid() if the
+ * 	width was out of range or allocation failed.
+ */
+struct libadt_packed_vector libadt_packed_vector_init_with_allocator(
+	int width,
+	size_t initial_capacity,
+	const struct libadt_allocator *allocator
+);
+
+/**
+ * \public \memberof libadt_packed_vector
+ * \brief Constructs a packed vector.
+ *
+ * \param width The starting width of each element, from 1 to 32.
+ * 	Appending larger values widens it.
+ * \param initial_capacity The number of elements to allocate room
+ * 	for. 0 delays allocation until the first append.
+ *
+ * \returns A vector, failing libadt_packed_vector_valid() if the
+ * 	width was out of range or allocation failed.
+ */
+struct libadt_packed_vector libadt_packed_vector_init(int width, size_t initial_capacity);
+
+/**
+ * \public \memberof libadt_packed_vector
+ * \brief Frees the memory managed by the vector.
+ *
+ * \returns A vector failing libadt_packed_vector_valid().
+ */
+struct libadt_packed_vector libadt_packed_vector_free(struct libadt_packed_vector vector);
+
+/**
+ * \public \memberof libadt_packed_vector
+ * \brief Tests whether a packed vector is a valid object.
+ */
+inline bool libadt_packed_vector_valid(struct libadt_packed_vector vector)
+{
+	return vector.width > 0;
+}
+
+/**
+ * \public \memberof libadt_packed_vector
+ * \brief Returns the number of bits needed to store value, which is
+ * 	at least 1.
+ */
+inline int libadt_packed_vector_width_for(unsigned int value)
+{
+#ifdef __GNUC__
+	return value ? (int)(sizeof(value) * CHAR_BIT) - __builtin_clz(value) : 1;
+#else
+	int width = 1;
+	while (value >>= 1)
+		width++;
+	return width;
+#endif
+}
+
+/**
+ * \internal
+ * \brief Tests whether value fits in the vector's width, which may
+ * 	be the whole of an unsigned int.
+ */
+inline bool libadt_packed_vector_fits(struct libadt_packed_vector vector, unsigned int value)
+{
+	return !(value >> (vector.width - 1) >> 1);
+}
+
+/**
+ * \public \memberof libadt_packed_vector
+ * \brief Views the elements as a libadt_bitwise_array, to use with
+ * 	libadt_bitwise_array_unpack() or libadt_rank_select.
+ *
+ * The view is valid until the vector is next changed.
+ */
+inline struct libadt_bitwise_array libadt_packed_vector_array(struct libadt_packed_vector vector)
+{
+	return (struct libadt_bitwise_array) {
+		.length = (ssize_t)vector.length,
+		.width = vector.width,
+		.bits = vector.bits,
+	};
+}
+
+/**
+ * \internal
+ * \brief The whole buffer as a libadt_bitwise_array, so that
+ * 	elements near the end of the vector still take the word-sized
+ * 	path of libadt_bitwise_array_get().
+ */
+inline struct libadt_bitwise_array libadt_packed_vector_buffer(struct libadt_packed_vector vector)
+{
+	return (struct libadt_bitwise_array) {
+		.length = (ssize_t)vector.capacity,
+		.width = vector.width,
+		.bits = vector.bits,
+	};
+}
+
+/**
+ * \public \memberof libadt_packed_vector
+ * \brief Returns the element at index.
+ *
+ * No check is performed: index must be less than the length.
+ */
+inline unsigned int libadt_packed_vector_get(struct libadt_packed_vector vector, size_t index)
+{
+	return libadt_bitwise_array_get(libadt_packed_vector_buffer(vector), (ssize_t)index);
+}
+
+/**
+ * \internal
+ * \brief The bytes allocated past the packed elements, so that
+ * 	libadt_packed_vector_append() can always store two whole words.
+ */
+#define LIBADT_PACKED_VECTOR_PADDING (2 * sizeof(uint64_t))
+
+/**
+ * \internal
+ * \brief Writes value as the element starting at bit, clearing the
+ * 	bits after it to the end of its word.
+ *
+ * Unlike libadt_bitwise_array_set(), nothing after the element is
+ * kept, as it is past the end of the vector. This works on aligned
+ * words, so that each append reads back the word the last one stored.
+ */
+inline void libadt_packed_vector_store_last(
+	libadt_bitwise_array_bit *bits,
+	uint64_t bit,
+	int width,
+	unsigned int value
+)
+{
+	libadt_bitwise_array_bit *const location = &bits[bit / 64 * sizeof(uint64_t)];
+	const int offset = (int)(bit % 64), spill = offset + width - 64;
+	const uint64_t kept = offset
+		? libadt_bitwise_array_load_word(location) & ~(~0ull >> offset)
+		: 0;
+	if (spill <= 0) {
+		libadt_bitwise_array_store_word(location, kept | (uint64_t)value << -spill);
+	} else {
+		libadt_bitwise_array_store_word(location, kept | (uint64_t)value >> spill);
+		libadt_bitwise_array_store_word(
+			location + sizeof(uint64_t),
+			(uint64_t)value << (64 - spill)
+		);
+	}
+}
+
+/**
+ * \internal
+ * \brief Appends a value that needs the vector to grow or widen
+ * 	first.
+ *
+ * This takes the vector by pointer, for the same reason as
+ * libadt_vector_append_lptr_grow().
+ */
+void libadt_packed_vector_append_grow(struct libadt_packed_vector *vector, unsigned int value);
+
+/**
+ * \public \memberof libadt_packed_vector
+ * \brief Appends value, growing or widening the vector as needed.
+ *
+ * \param vector The vector to append to.
+ * \param value The value to append.
+ *
+ * \returns The vector with the value appended. If an allocation
+ * 	failed, the old vector is returned, which can be checked by
+ * 	comparing lengths.
+ */
+inline struct libadt_packed_vector libadt_packed_vector_append(
+	struct libadt_packed_vector vector,
+	unsigned int value
+)
+{
+	if (vector.length == vector.capacity || !libadt_packed_vector_fits(vector, value)) {
+		// Only this copy has its address taken, so that vector
+		// can stay in registers on the fast path
+		struct libadt_packed_vector grown = vector;
+		libadt_packed_vector_append_grow(&grown, value);
+		return grown;
+	}
+
+	libadt_packed_vector_store_last(
+		vector.bits,
+		(uint64_t)vector.length * (uint64_t)vector.width,
+		vector.width,
+		value
+	);
+	vector.length++;
+	return vector;
+}
+
+/**
+ * \public \memberof libadt_packed_vector
+ * \brief Appends number values, growing and widening the vector
+ * 	once for all of them.
+ *
+ * \param vector The vector to append to.
+ * \param values The values to append.
+ * \param number The number of values.
+ *
+ * \returns The vector with the values appended. If an allocation
+ * 	failed, the old vector is returned, which can be checked by
+ * 	comparing lengths.
+ */
+struct libadt_packed_vector libadt_packed_vector_append_n(
+	struct libadt_packed_vector vector,
+	const unsigned int *values,
+	size_t number
+);
+
+/**
+ * \public \memberof libadt_packed_vector
+ * \brief Removes the last element.
+ *
+ * Like libadt_vector_pop(), this is a logical remove: the memory is
+ * kept, and the width is not narrowed. The vector must not be empty.
+ *
+ * \param vector The vector to remove from.
+ * \param out Set to the removed element, if not NULL.
+ *
+ * \returns The vector without its last element.
+ */
+inline struct libadt_packed_vector libadt_packed_vector_pop(
+	struct libadt_packed_vector vector,
+	unsigned int *out
+)
+{
+	vector.length--;
+	if (out)
+		*out = libadt_packed_vector_get(vector, vector.length);
+	return vector;
+}
+
+/**
+ * \public \memberof libadt_packed_vector
+ * \brief Ensures the vector can hold at least capacity elements at
+ * 	its current width without reallocating.
+ *
+ * \returns The vector with the new capacity. If the allocation
+ * 	failed, the old vector is returned.
+ */
+struct libadt_packed_vector libadt_packed_vector_reserve(
+	struct libadt_packed_vector vector,
+	size_t capacity
+);
+
+/**
+ * \public \memberof libadt_packed_vector
+ * \brief Reallocates the buffer down to the elements stored.
+ *
+ * \returns The vector with the new capacity. If the allocation
+ * 	failed, the old vector is returned.
+ */
+struct libadt_packed_vector libadt_packed_vector_vacuum(struct libadt_packed_vector vector);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // LIBADT_PACKED_VECTOR_H
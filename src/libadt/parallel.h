@@ -0,0 +1,209 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBADT_PARALLEL_H
+#define LIBADT_PARALLEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "lptr.h"
+#include "sort.h"
+#include "threadpool.h"
+
+/**
+ * \file
+ * \brief Parallel algorithms over the elements of a libadt_lptr,
+ * 	using POSIX threads.
+ *
+ * Each call splits the lptr into chunks, starts its threads, and
+ * joins them before returning. The calling thread works on chunks
+ * too. Threads take chunks from a shared counter, so uneven chunks
+ * are balanced across threads.
+ *
+ * Chunk lengths are chosen so that every chunk spans a whole number
+ * of cache lines: if the lptr's buffer is cache-line aligned, no two
+ * threads write to the same cache line.
+ *
+ * By default each call starts its own threads. Setting
+ * libadt_parallel::pool runs the chunks on a libadt_threadpool
+ * instead, which avoids the cost of starting threads and lets the
+ * functions be called from tasks on that pool.
+ *
+ * Inputs smaller than libadt_parallel::serial_bytes are processed
+ * on the calling thread without starting any threads. The functions
+ * also fall back to the calling thread if threads can't be started.
+ */
+
+/**
+ * \brief The default for libadt_parallel::serial_bytes.
+ */
+#define LIBADT_PARALLEL_SERIAL_BYTES ((size_t)1 << 18)
+
+/**
+ * \brief The size chunk boundaries are aligned to.
+ */
+#define LIBADT_PARALLEL_CACHE_LINE 64
+
+/**
+ * \brief Settings for the parallel algorithms.
+ *
+ * Every function takes a pointer to these settings, where NULL
+ * selects the defaults.
+ */
+struct libadt_parallel {
+	/**
+	 * \brief The number of threads to use, including the calling
+	 * 	thread, or 0 for the number of online processors, or
+	 * 	the pool's workers and the calling thread.
+	 */
+	unsigned int threads;
+
+	/**
+	 * \brief The pool to run chunks on, or NULL to start threads
+	 * 	for each call.
+	 */
+	struct libadt_threadpool *pool;
+
+	/**
+	 * \brief Inputs smaller than this many bytes are processed
+	 * 	serially, or 0 for LIBADT_PARALLEL_SERIAL_BYTES.
+	 */
+	size_t serial_bytes;
+};
+
+/**
+ * \brief Processes one chunk for libadt_parallel_for().
+ *
+ * \param chunk The elements to process.
+ * \param offset The index of the chunk's first element in the
+ * 	whole lptr.
+ * \param context The context passed to libadt_parallel_for().
+ */
+typedef void libadt_parallel_body(
+	struct libadt_lptr chunk,
+	size_t offset,
+	void *context
+);
+
+/**
+ * \brief Folds one chunk into an accumulator for
+ * 	libadt_parallel_reduce().
+ *
+ * \param accumulator The chunk's accumulator, which starts as a
+ * 	copy of the identity.
+ * \param chunk The elements to fold.
+ * \param context The context passed to libadt_parallel_reduce().
+ */
+typedef void libadt_parallel_fold(
+	void *accumulator,
+	struct libadt_lptr chunk,
+	void *context
+);
+
+/**
+ * \brief Combines two accumulators for libadt_parallel_reduce(),
+ * 	storing the result in the first.
+ *
+ * \param accumulator The accumulator for the earlier elements.
+ * \param other The accumulator for the later elements.
+ * \param context The context passed to libadt_parallel_reduce().
+ */
+typedef void libadt_parallel_combine(
+	void *accumulator,
+	const void *other,
+	void *context
+);
+
+/**
+ * \brief Calls _body_ on chunks of _lptr_ in parallel.
+ *
+ * Chunks don't overlap and together cover the whole lptr. The order
+ * in which they are processed is unspecified.
+ *
+ * \param lptr The elements to process.
+ * \param body The function to call on each chunk.
+ * \param context Passed to body.
+ * \param parallel The settings to use, or NULL for the defaults.
+ */
+void libadt_parallel_for(
+	struct libadt_lptr lptr,
+	libadt_parallel_body *body,
+	void *context,
+	const struct libadt_parallel *parallel
+);
+
+/**
+ * \brief Reduces the elements of _lptr_ in parallel.
+ *
+ * Each chunk is folded into its own copy of the identity, then the
+ * accumulators are combined in order, so _combine_ needs to be
+ * associative but not commutative.
+ *
+ * \param lptr The elements to reduce.
+ * \param accumulator A single element, whose size is the size of an
+ * 	accumulator. It holds the identity on entry and the result on
+ * 	return.
+ * \param fold The function folding a chunk into an accumulator.
+ * \param combine The function combining two accumulators.
+ * \param context Passed to fold and combine.
+ * \param parallel The settings to use, or NULL for the defaults.
+ */
+void libadt_parallel_reduce(
+	struct libadt_lptr lptr,
+	struct libadt_lptr accumulator,
+	libadt_parallel_fold *fold,
+	libadt_parallel_combine *combine,
+	void *context,
+	const struct libadt_parallel *parallel
+);
+
+/**
+ * \brief Sorts the elements of an lptr using a parallel merge sort,
+ * 	keeping equal elements in order.
+ *
+ * Chunks are sorted with libadt_sort_stable(), then merged in
+ * rounds. Each merge is split between threads, so the last rounds
+ * keep every thread busy too.
+ *
+ * \param lptr The elements to sort.
+ * \param scratch Memory to use while merging, at least as many bytes
+ * 	as lptr. Its contents are overwritten.
+ * \param compare The comparison function, which must be safe to
+ * 	call from several threads.
+ * \param parallel The settings to use, or NULL for the defaults.
+ *
+ * \returns True on success, false if scratch was too small, in which
+ * 	case lptr is untouched.
+ */
+bool libadt_parallel_sort(
+	struct libadt_lptr lptr,
+	struct libadt_lptr scratch,
+	libadt_sort_compare *compare,
+	const struct libadt_parallel *parallel
+);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // LIBADT_PARALLEL_H
@@ -0,0 +1,298 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBADT_POOL_H
+#define LIBADT_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "lptr.h"
+
+/**
+ * \file
+ * \copydoc libadt_pool
+ */
+
+/**
+ * \brief A slab of slots owned by a pool.
+ *
+ * Slabs are an implementation detail of libadt_pool. They are
+ * aligned to their own size, so the slab owning a slot can be
+ * found by masking the slot's address.
+ */
+struct libadt_pool_slab {
+	/**
+	 * \brief The neighbouring slabs in the pool's list.
+	 */
+	struct libadt_pool_slab *prev, *next;
+
+	/**
+	 * \brief The first freed slot, each free slot storing a
+	 * 	pointer to the next.
+	 */
+	void *free;
+
+	/**
+	 * \brief The next slot that has never been handed out.
+	 */
+	unsigned char *fresh;
+
+	/**
+	 * \brief One past the last slot in the slab.
+	 */
+	unsigned char *end;
+
+	/**
+	 * \brief The number of slots currently handed out.
+	 */
+	size_t used;
+};
+
+/**
+ * \brief An allocator for objects of a single fixed size.
+ *
+ * A pool carves large, aligned slabs into fixed-size slots and
+ * keeps freed slots on an intrusive free list, so allocating
+ * and freeing are both constant-time and rarely reach malloc().
+ *
+ * Slabs with free slots are kept at the front of the pool's slab
+ * list and full slabs at the back. When the last slot of a slab is
+ * freed, the slab is released back to the system, unless the pool
+ * is already keeping max_empty empty slabs for reuse. Keeping a few
+ * avoids going back to the system every time a pool's usage
+ * crosses a slab boundary. libadt_pool_trim() releases them all.
+ *
+ * Pools are not thread-safe. For multi-threaded use, give each
+ * thread its own pool (for example a `_Thread_local` one), which
+ * lets threads allocate without any locking at all. Objects must
+ * be freed to the pool they were allocated from.
+ */
+struct libadt_pool {
+	/**
+	 * \brief The first slab: the one allocations come from.
+	 */
+	struct libadt_pool_slab *head;
+
+	/**
+	 * \brief The last slab.
+	 */
+	struct libadt_pool_slab *tail;
+
+	/**
+	 * \brief The size of the objects, as requested.
+	 */
+	size_t size;
+
+	/**
+	 * \brief The size of a slot: the object size rounded up to a
+	 * 	multiple of _Alignof(max_align_t), so that every slot is
+	 * 	aligned for any type and has room for a pointer.
+	 */
+	size_t slot_size;
+
+	/**
+	 * \brief The size and alignment of each slab, in bytes.
+	 */
+	size_t slab_size;
+
+	/**
+	 * \brief The number of slots in each slab.
+	 */
+	size_t slots;
+
+	/**
+	 * \brief The number of empty slabs kept for reuse, not
+	 * 	counting the first slab.
+	 */
+	size_t empty;
+
+	/**
+	 * \brief The most empty slabs to keep for reuse.
+	 *
+	 * libadt_pool_init() sets this to 4. It may be changed at
+	 * any time, taking effect as slabs are emptied.
+	 */
+	size_t max_empty;
+};
+
+/**
+ * \public \memberof libadt_pool
+ * \brief Constructs a pool for objects of the given size.
+ *
+ * No memory is allocated until the first object is.
+ *
+ * \param size The size of each object.
+ *
+ * \returns A new pool, or a pool failing libadt_pool_valid() if
+ * 	size was 0 or too large.
+ */
+struct libadt_pool libadt_pool_init(size_t size);
+
+/**
+ * \public \memberof libadt_pool
+ * \brief Releases every slab owned by the pool.
+ *
+ * All objects allocated from the pool become invalid.
+ *
+ * \param pool The pool to destroy.
+ *
+ * \returns A pool failing libadt_pool_valid().
+ */
+struct libadt_pool libadt_pool_destroy(struct libadt_pool pool);
+
+/**
+ * \public \memberof libadt_pool
+ * \brief Releases the empty slabs the pool is keeping for reuse.
+ *
+ * \param pool The pool to trim.
+ */
+void libadt_pool_trim(struct libadt_pool *pool);
+
+/**
+ * \public \memberof libadt_pool
+ * \brief Tests whether a pool is a valid object.
+ *
+ * \param pool The pool to test.
+ *
+ * \returns True if the pool is valid for use, false otherwise.
+ */
+inline bool libadt_pool_valid(struct libadt_pool pool)
+{
+	return pool.slot_size != 0;
+}
+
+/**
+ * \internal
+ * \brief Allocates a slot once the head slab is full, adding a
+ * 	new slab if necessary.
+ */
+void *libadt_pool_grow(struct libadt_pool *pool);
+
+/**
+ * \internal
+ * \brief Handles freeing a slot into a slab that was full or is
+ * 	now empty.
+ */
+void libadt_pool_rebalance(struct libadt_pool *pool, struct libadt_pool_slab *slab);
+
+/**
+ * \internal
+ * \brief Returns the slab owning the given slot.
+ */
+inline struct libadt_pool_slab *libadt_pool_slab(
+	const struct libadt_pool *pool,
+	void *slot
+)
+{
+	return (struct libadt_pool_slab *)((uintptr_t)slot & ~(uintptr_t)(pool->slab_size - 1));
+}
+
+/**
+ * \public \memberof libadt_pool
+ * \brief Allocates an uninitialized object from the pool.
+ *
+ * \param pool The pool to allocate from.
+ *
+ * \returns A libadt_lptr to a single object of the pool's size,
+ * 	failing libadt_lptr_allocated() if allocation failed.
+ */
+inline struct libadt_lptr libadt_pool_alloc(struct libadt_pool *pool)
+{
+	struct libadt_pool_slab *const slab = pool->head;
+	void *slot;
+
+	if (slab && slab->free) {
+		slot = slab->free;
+		slab->free = *(void **)slot;
+		slab->used++;
+	} else if (slab && slab->fresh != slab->end) {
+		slot = slab->fresh;
+		slab->fresh += pool->slot_size;
+		slab->used++;
+	} else {
+		slot = libadt_pool_grow(pool);
+	}
+
+	return (struct libadt_lptr) {
+		.buffer = slot,
+		.size = (ssize_t)pool->size,
+		.length = 1,
+	};
+}
+
+/**
+ * \public \memberof libadt_pool
+ * \brief Allocates an object initialized to 0 from the pool.
+ *
+ * \param pool The pool to allocate from.
+ *
+ * \returns A libadt_lptr to a single object of the pool's size,
+ * 	failing libadt_lptr_allocated() if allocation failed.
+ */
+inline struct libadt_lptr libadt_pool_calloc(struct libadt_pool *pool)
+{
+	const struct libadt_lptr result = libadt_pool_alloc(pool);
+	if (libadt_lptr_allocated(result))
+		memset(result.buffer, 0, pool->size);
+	return result;
+}
+
+/**
+ * \public \memberof libadt_pool
+ * \brief Returns an object to the pool.
+ *
+ * \param pool The pool the object was allocated from.
+ * \param lptr The object to free. Freeing an lptr failing
+ * 	libadt_lptr_allocated() does nothing.
+ *
+ * \returns A libadt_lptr failing libadt_lptr_valid().
+ */
+inline struct libadt_lptr libadt_pool_free(
+	struct libadt_pool *pool,
+	struct libadt_lptr lptr
+)
+{
+	void *const slot = lptr.buffer;
+	if (!slot)
+		return (struct libadt_lptr) { 0 };
+
+	struct libadt_pool_slab *const slab = libadt_pool_slab(pool, slot);
+	const bool was_full = !slab->free && slab->fresh == slab->end;
+
+	*(void **)slot = slab->free;
+	slab->free = slot;
+	slab->used--;
+
+	if (was_full || !slab->used)
+		libadt_pool_rebalance(pool, slab);
+
+	return (struct libadt_lptr) { 0 };
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // LIBADT_POOL_H
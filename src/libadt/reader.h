@@ -0,0 +1,257 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBADT_READER_H
+#define LIBADT_READER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "allocator.h"
+#include "lptr.h"
+#include "str.h"
+
+/**
+ * \file
+ */
+
+/**
+ * \brief The buffer size libadt_reader_init() uses when given 0.
+ */
+#define LIBADT_READER_DEFAULT_CAPACITY ((size_t)128 << 10)
+
+/**
+ * \brief Reads lines or records from a file descriptor, such as a
+ * 	pipe or socket that cannot be mapped, without copying them out.
+ *
+ * Each record is returned as a slice of the reader's buffer, valid
+ * until the next call on the reader. Delimiters are found 64 bytes
+ * at a time with the SIMD scan of libadt_str_split, so short records
+ * cost a bit operation each. The buffer is filled with reads
+ * as large as the free space at its end. Once less than half of it
+ * is free, the start of a record cut off by the end moves to the
+ * front with libadt_lptr_memmove(), if that frees at least half;
+ * when a single record fills the buffer, it doubles.
+ *
+ * \code
+ * struct libadt_reader reader = libadt_reader_init(STDIN_FILENO, 0);
+ * for (
+ * 	struct libadt_const_lptr line = libadt_reader_next_line(&reader);
+ * 	libadt_const_lptr_allocated(line);
+ * 	line = libadt_reader_next_line(&reader)
+ * )
+ * 	parse(line);
+ * if (reader.error)
+ * 	report(reader.error);
+ * reader = libadt_reader_free(reader);
+ * \endcode
+ */
+struct libadt_reader {
+	/**
+	 * \brief The file descriptor read from, which the reader does
+	 * 	not close.
+	 */
+	int fd;
+
+	/**
+	 * \brief The whole buffer, of bytes.
+	 */
+	struct libadt_lptr buffer;
+
+	/**
+	 * \brief The offset of the first byte not yet returned.
+	 */
+	size_t start;
+
+	/**
+	 * \brief The offset after the last byte read.
+	 */
+	size_t end;
+
+	/**
+	 * \brief The offset after the last byte scanned for delimiters,
+	 * 	so that long records are searched once.
+	 */
+	size_t scanned;
+
+	/**
+	 * \brief The offset of the 64 bytes that mask covers.
+	 */
+	size_t window;
+
+	/**
+	 * \brief The delimiters in the window not yet returned, bit i
+	 * 	standing for the byte at window + i, as in libadt_str_split.
+	 */
+	uint64_t mask;
+
+	/**
+	 * \brief The delimiter mask was scanned for.
+	 */
+	char delimiter;
+
+	/**
+	 * \brief Whether a read has returned end of file.
+	 */
+	bool eof;
+
+	/**
+	 * \brief 0, or the errno of the read or allocation that failed.
+	 * 	The reader returns no more records once it is set.
+	 */
+	int error;
+
+	/**
+	 * \brief The allocator used for the buffer, or NULL for the
+	 * 	standard library.
+	 */
+	const struct libadt_allocator *allocator;
+};
+
+/**
+ * \public \memberof libadt_reader
+ * \brief Creates a reader using the given allocator.
+ *
+ * \param fd The file descriptor to read from.
+ * \param capacity The initial buffer size in bytes, or 0 for
+ * 	LIBADT_READER_DEFAULT_CAPACITY.
+ * \param allocator The allocator to use, or NULL for the standard
+ * 	library.
+ *
+ * \returns A reader, failing libadt_reader_valid() if allocation
+ * 	failed.
+ */
+struct libadt_reader libadt_reader_init_with_allocator(
+	int fd,
+	size_t capacity,
+	const struct libadt_allocator *allocator
+);
+
+/**
+ * \public \memberof libadt_reader
+ * \brief Creates a reader.
+ *
+ * \param fd The file descriptor to read from.
+ * \param capacity The initial buffer size in bytes, or 0 for
+ * 	LIBADT_READER_DEFAULT_CAPACITY.
+ *
+ * \returns A reader, failing libadt_reader_valid() if allocation
+ * 	failed.
+ */
+struct libadt_reader libadt_reader_init(int fd, size_t capacity);
+
+/**
+ * \public \memberof libadt_reader
+ * \brief Frees the reader's buffer, leaving the file descriptor open.
+ *
+ * \returns A reader failing libadt_reader_valid().
+ */
+struct libadt_reader libadt_reader_free(struct libadt_reader reader);
+
+/**
+ * \public \memberof libadt_reader
+ * \brief Tests whether the reader's buffer was allocated.
+ */
+bool libadt_reader_valid(struct libadt_reader reader);
+
+/**
+ * \internal
+ * \brief Finds the next record when the delimiter is not already in
+ * 	the scanned window, reading more input as needed.
+ */
+struct libadt_const_lptr libadt_reader_next_record_slow(
+	struct libadt_reader *reader,
+	char delimiter
+);
+
+/**
+ * \public \memberof libadt_reader
+ * \brief Returns the next record ending in delimiter.
+ *
+ * The delimiter is not part of the record. The last record may end
+ * at the end of input instead, so input ending in a delimiter has no
+ * empty record after it.
+ *
+ * \param reader The reader.
+ * \param delimiter The byte ending each record.
+ *
+ * \returns The record, valid until the next call on the reader, or
+ * 	an lptr failing libadt_const_lptr_allocated() at the end of
+ * 	input or on an error, which sets reader->error.
+ */
+inline struct libadt_const_lptr libadt_reader_next_record(
+	struct libadt_reader *reader,
+	char delimiter
+)
+{
+	if (reader->mask && delimiter == reader->delimiter) {
+		const size_t found = reader->window + libadt_str_lowest(reader->mask);
+		if (found >= reader->start) {
+			const struct libadt_const_lptr result = {
+				(char *)reader->buffer.buffer + reader->start,
+				1,
+				(ssize_t)(found - reader->start),
+			};
+			reader->mask &= reader->mask - 1;
+			reader->start = found + 1;
+			return result;
+		}
+	}
+	return libadt_reader_next_record_slow(reader, delimiter);
+}
+
+/**
+ * \public \memberof libadt_reader
+ * \brief Returns the next line, without its newline.
+ *
+ * \returns The same as libadt_reader_next_record() with a delimiter
+ * 	of '\\n'.
+ */
+inline struct libadt_const_lptr libadt_reader_next_line(struct libadt_reader *reader)
+{
+	return libadt_reader_next_record(reader, '\n');
+}
+
+/**
+ * \public \memberof libadt_reader
+ * \brief Returns the next size bytes, for fixed-size records.
+ *
+ * \param reader The reader.
+ * \param size The record size in bytes.
+ *
+ * \returns The record, valid until the next call on the reader, or
+ * 	an lptr failing libadt_const_lptr_allocated() at the end of
+ * 	input or on an error, which sets reader->error. Only the last
+ * 	record can be shorter than size, if input ends part way
+ * 	through it.
+ */
+struct libadt_const_lptr libadt_reader_next_bytes(
+	struct libadt_reader *reader,
+	size_t size
+);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // LIBADT_READER_H
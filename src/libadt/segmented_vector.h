@@ -0,0 +1,381 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBADT_SEGMENTED_VECTOR_H
+#define LIBADT_SEGMENTED_VECTOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+
+#include "allocator.h"
+#include "lptr.h"
+
+/**
+ * \file
+ */
+
+/**
+ * \brief Represents a segmented vector: a dynamic array whose
+ * 	elements never move.
+ *
+ * Instead of reallocating its buffer, a segmented vector grows by
+ * adding blocks, each twice the size of the one before. Pointers
+ * returned by libadt_segmented_vector_index() stay valid until the
+ * element is popped or the vector is vacuumed or freed, and growing
+ * never copies the existing elements.
+ *
+ * Block k holds first_block << k elements, so the block holding an
+ * element is found from the position of the highest set bit of its
+ * index, and indexing is constant-time.
+ *
+ * The interface mirrors libadt_vector. Elements are not contiguous,
+ * so there is no equivalent to libadt_vector_end().
+ *
+ * \sa LIBADT_SEGMENTED_VECTOR_WITH
+ */
+struct libadt_segmented_vector {
+	/**
+	 * \brief The table of blocks, or NULL if none have been
+	 * 	allocated yet.
+	 *
+	 * The table has room for every block the vector could ever
+	 * need, so it is never reallocated.
+	 */
+	void **blocks;
+
+	/**
+	 * \brief The size of each element.
+	 */
+	size_t size;
+
+	/**
+	 * \brief The number of elements currently
+	 * 	being stored.
+	 */
+	size_t length;
+
+	/**
+	 * \brief The total number of elements that
+	 * 	the allocated blocks can store.
+	 */
+	size_t capacity;
+
+	/**
+	 * \brief The base 2 logarithm of the number of elements in
+	 * 	the first block.
+	 */
+	unsigned int shift;
+
+	/**
+	 * \brief The allocator used for the blocks, or NULL
+	 * 	for the standard library.
+	 */
+	const struct libadt_allocator *allocator;
+};
+
+/**
+ * \public \memberof libadt_segmented_vector
+ * \brief Constructs a new libadt_segmented_vector with the
+ * 	given element size.
+ *
+ * No memory is allocated until the vector is appended to.
+ *
+ * \param size The size of an individual element.
+ * \param first_block The number of elements in the first block,
+ * 	rounded up to a power of two. Following blocks double in
+ * 	size. 0 selects a default of 16.
+ *
+ * \returns A vector ready to append elements to.
+ */
+struct libadt_segmented_vector libadt_segmented_vector_init(
+	size_t size,
+	size_t first_block
+);
+
+/**
+ * \public \memberof libadt_segmented_vector
+ * \brief Constructs a new libadt_segmented_vector which
+ * 	allocates its blocks using the given allocator.
+ *
+ * \param size The size of an individual element.
+ * \param first_block The number of elements in the first block.
+ * \param allocator The allocator to use, or NULL for the
+ * 	standard library. It must outlive the vector.
+ *
+ * \returns A vector ready to append elements to.
+ *
+ * \sa libadt_segmented_vector_init()
+ */
+struct libadt_segmented_vector libadt_segmented_vector_init_with_allocator(
+	size_t size,
+	size_t first_block,
+	const struct libadt_allocator *allocator
+);
+
+/**
+ * \public \memberof libadt_segmented_vector
+ * \brief Frees the memory managed by the vector.
+ *
+ * \param vector The vector to free.
+ *
+ * \returns A vector failing libadt_segmented_vector_valid().
+ */
+struct libadt_segmented_vector libadt_segmented_vector_free(
+	struct libadt_segmented_vector vector
+);
+
+/**
+ * \public \memberof libadt_segmented_vector
+ * \brief Tests whether a libadt_segmented_vector is a valid
+ * 	object.
+ *
+ * \param vector The vector to test.
+ *
+ * \returns True if the vector is valid for use, false otherwise.
+ */
+inline bool libadt_segmented_vector_valid(struct libadt_segmented_vector vector)
+{
+	return !!vector.size;
+}
+
+/**
+ * \brief Provides a context manager interface for a segmented
+ * 	vector.
+ *
+ * \param NAME The name to give the vector variable
+ * \param SIZE The size of each element, as passed to
+ * 	libadt_segmented_vector_init()
+ * \param FIRST_BLOCK The size of the first block, as passed to
+ * 	libadt_segmented_vector_init()
+ *
+ * \sa LIBADT_VECTOR_WITH
+ */
+#define LIBADT_SEGMENTED_VECTOR_WITH(NAME, SIZE, FIRST_BLOCK) \
+for ( \
+	struct libadt_segmented_vector \
+		NAME = libadt_segmented_vector_init(SIZE, FIRST_BLOCK); \
+	libadt_segmented_vector_valid(NAME); \
+	NAME = libadt_segmented_vector_free(NAME) \
+)
+
+/**
+ * \public \memberof libadt_segmented_vector
+ * \brief Checks if the first vector and the second vector
+ * 	refer to the same vector.
+ *
+ * \param first The first vector to compare.
+ * \param second The second vector to compare.
+ *
+ * \returns True if the vectors are identical, false otherwise.
+ */
+inline bool libadt_segmented_vector_identity(
+	struct libadt_segmented_vector first,
+	struct libadt_segmented_vector second
+)
+{
+	return first.blocks == second.blocks
+		&& first.size == second.size
+		&& first.length == second.length
+		&& first.capacity == second.capacity;
+}
+
+/**
+ * \internal
+ * \brief Returns the position of the highest set bit in value,
+ * 	which must not be 0.
+ */
+inline unsigned int libadt_segmented_vector_msb(size_t value)
+{
+#if defined(__GNUC__) && SIZE_MAX == ULLONG_MAX
+	return (unsigned int)(sizeof(value) * CHAR_BIT - 1) - (unsigned int)__builtin_clzll(value);
+#elif defined(__GNUC__) && SIZE_MAX == ULONG_MAX
+	return (unsigned int)(sizeof(value) * CHAR_BIT - 1) - (unsigned int)__builtin_clzl(value);
+#else
+	unsigned int result = 0;
+	while (value >>= 1)
+		result++;
+	return result;
+#endif
+}
+
+/**
+ * \public \memberof libadt_segmented_vector
+ * \brief Returns a pointer to the item at _index_ in the
+ * 	vector _vector._
+ *
+ * No check is performed. You must compare against
+ * libadt_segmented_vector::length.
+ *
+ * The pointer stays valid as the vector grows.
+ *
+ * \param vector The vector to index into.
+ * \param index The item index to get, starting from zero.
+ *
+ * \returns A pointer to the item at the given index.
+ */
+inline void *libadt_segmented_vector_index(
+	struct libadt_segmented_vector vector,
+	size_t index
+)
+{
+	// Block k starts at index (first_block << k) - first_block,
+	// so offsetting by first_block makes the highest set bit
+	// select the block and the rest the position in it
+	const size_t position = index + ((size_t)1 << vector.shift);
+	const unsigned int msb = libadt_segmented_vector_msb(position);
+	const size_t offset = position - ((size_t)1 << msb);
+
+	return (char *)vector.blocks[msb - vector.shift] + offset * vector.size;
+}
+
+/**
+ * \public \memberof libadt_segmented_vector
+ * \brief Returns the run of contiguous elements starting at
+ * 	_index_ in the vector _vector._
+ *
+ * The run ends at the end of the block holding the element, or at
+ * the end of the vector. Walking a vector run by run avoids
+ * looking up the block for every element:
+ *
+ * \code
+ * for (size_t i = 0; i < vector.length;) {
+ * 	struct libadt_lptr run = libadt_segmented_vector_segment(vector, i);
+ * 	use(run);
+ * 	i += (size_t)run.length;
+ * }
+ * \endcode
+ *
+ * \param vector The vector to index into.
+ * \param index The index of the first element of the run, which
+ * 	must be less than libadt_segmented_vector::length.
+ *
+ * \returns A libadt_lptr over the run of elements.
+ */
+inline struct libadt_lptr libadt_segmented_vector_segment(
+	struct libadt_segmented_vector vector,
+	size_t index
+)
+{
+	const size_t position = index + ((size_t)1 << vector.shift);
+	const unsigned int msb = libadt_segmented_vector_msb(position);
+	const size_t
+		offset = position - ((size_t)1 << msb),
+		block_end = ((size_t)2 << msb) - ((size_t)1 << vector.shift),
+		end = block_end < vector.length ? block_end : vector.length;
+
+	return (struct libadt_lptr) {
+		.buffer = (char *)vector.blocks[msb - vector.shift] + offset * vector.size,
+		.size = (ssize_t)vector.size,
+		.length = (ssize_t)(end - index),
+	};
+}
+
+/**
+ * \public \memberof libadt_segmented_vector
+ * \brief Appends _number_ new elements to the vector _vector_,
+ * 	beginning from _data._
+ *
+ * If the append fails, the old vector will be returned. This
+ * error can be checked with libadt_segmented_vector_identity(old, new).
+ *
+ * \param vector The vector to append elements to.
+ * \param data The beginning of the elements to append.
+ * \param number The number of elements to append.
+ *
+ * \returns A vector with the new data appended. If the append
+ * 	failed, the old vector is returned.
+ */
+struct libadt_segmented_vector libadt_segmented_vector_append_n(
+	struct libadt_segmented_vector vector,
+	const void *data,
+	size_t number
+);
+
+/**
+ * \public \memberof libadt_segmented_vector
+ * \brief Appends a single new element to the vector _vector_,
+ * 	given by _data._
+ *
+ * \param vector The vector to append the element to.
+ * \param data The element to append.
+ *
+ * \returns A vector with the new element appended. On error,
+ * 	the old vector is returned.
+ */
+inline struct libadt_segmented_vector libadt_segmented_vector_append(
+	struct libadt_segmented_vector vector,
+	const void *data
+)
+{
+	if (vector.length < vector.capacity) {
+		memcpy(
+			libadt_segmented_vector_index(vector, vector.length),
+			data,
+			vector.size
+		);
+		vector.length++;
+		return vector;
+	}
+	return libadt_segmented_vector_append_n(vector, data, 1);
+}
+
+/**
+ * \public \memberof libadt_segmented_vector
+ * \brief Writes the last element of the vector to _out_ and
+ * 	removes it from _vector_.
+ *
+ * As with libadt_vector_pop(), the memory is kept. To reclaim it,
+ * use libadt_segmented_vector_vacuum().
+ *
+ * \param vector The vector to pop a value from.
+ * \param out The location to write the value to.
+ *
+ * \returns The vector with the modified length.
+ */
+struct libadt_segmented_vector libadt_segmented_vector_pop(
+	struct libadt_segmented_vector vector,
+	void *out
+);
+
+/**
+ * \public \memberof libadt_segmented_vector
+ * \brief Frees the blocks no longer needed to store the
+ * 	vector's elements.
+ *
+ * Elements that remain keep their addresses.
+ *
+ * \param vector The vector to vacuum.
+ *
+ * \returns The vector with the reduced capacity.
+ */
+struct libadt_segmented_vector libadt_segmented_vector_vacuum(
+	struct libadt_segmented_vector vector
+);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // LIBADT_SEGMENTED_VECTOR_H
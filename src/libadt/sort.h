@@ -0,0 +1,297 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBADT_SORT_H
+#define LIBADT_SORT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "lptr.h"
+
+/**
+ * \file
+ * \brief Sorting functions for the elements of a libadt_lptr.
+ *
+ * The functions sort lptr.length elements of lptr.size bytes each.
+ * To sort a libadt_vector, pass libadt_vector_lptr(vector).
+ *
+ * Three algorithms are provided:
+ *
+ * - libadt_sort() is an introsort (quicksort falling back to
+ * 	heapsort), taking a qsort()-style comparison function.
+ * 	LIBADT_SORT_DEFINE generates the same algorithm for a specific
+ * 	type, with the comparison inlined, which is considerably
+ * 	faster.
+ * - libadt_sort_stable() is a merge sort, keeping equal elements in
+ * 	their original order. It needs a scratch lptr at least as
+ * 	large as the input.
+ * - libadt_sort_radix_u32() and libadt_sort_radix_u64() are LSD
+ * 	radix sorts for unsigned integer keys. They are stable, and
+ * 	also need a scratch lptr.
+ */
+
+/**
+ * \brief A qsort()-style comparison function, returning a negative
+ * 	value, zero or a positive value when the first element is
+ * 	less than, equal to or greater than the second.
+ */
+typedef int libadt_sort_compare(const void *first, const void *second);
+
+/**
+ * \brief Sorts the elements of an lptr using introsort.
+ *
+ * Not stable. Runs in O(n log n) time in the worst case.
+ *
+ * \param lptr The elements to sort.
+ * \param compare The comparison function.
+ */
+void libadt_sort(struct libadt_lptr lptr, libadt_sort_compare *compare);
+
+/**
+ * \brief Sorts the elements of an lptr using merge sort, keeping
+ * 	equal elements in order.
+ *
+ * \param lptr The elements to sort.
+ * \param scratch Memory to use while merging, at least as many bytes
+ * 	as lptr. Its contents are overwritten.
+ * \param compare The comparison function.
+ *
+ * \returns True on success, false if scratch was too small, in which
+ * 	case lptr is untouched.
+ */
+bool libadt_sort_stable(
+	struct libadt_lptr lptr,
+	struct libadt_lptr scratch,
+	libadt_sort_compare *compare
+);
+
+/**
+ * \brief Sorts an lptr of uint32_t using LSD radix sort.
+ *
+ * \param lptr The elements to sort. lptr.size must be 4.
+ * \param scratch Memory to use while sorting, at least as many bytes
+ * 	as lptr. Its contents are overwritten.
+ *
+ * \returns True on success, false if the sizes were wrong, in which
+ * 	case lptr is untouched.
+ */
+bool libadt_sort_radix_u32(struct libadt_lptr lptr, struct libadt_lptr scratch);
+
+/**
+ * \brief Sorts an lptr of uint64_t using LSD radix sort.
+ *
+ * \param lptr The elements to sort. lptr.size must be 8.
+ * \param scratch Memory to use while sorting, at least as many bytes
+ * 	as lptr. Its contents are overwritten.
+ *
+ * \returns True on success, false if the sizes were wrong, in which
+ * 	case lptr is untouched.
+ */
+bool libadt_sort_radix_u64(struct libadt_lptr lptr, struct libadt_lptr scratch);
+
+/**
+ * \brief Runs shorter than this are insertion sorted.
+ */
+#define LIBADT_SORT_INSERTION_THRESHOLD 16
+
+/**
+ * \brief Defines sorting functions specialized for one type.
+ *
+ * Two functions are defined, with the comparison inlined:
+ *
+ * - `void NAME(struct libadt_lptr lptr)`, an introsort like
+ * 	libadt_sort().
+ * - `bool NAME##_stable(struct libadt_lptr lptr, struct libadt_lptr scratch)`,
+ * 	a merge sort like libadt_sort_stable().
+ *
+ * Both are static, so the macro can be used in several translation
+ * units. Example usage:
+ *
+ * \code
+ * #define point_less(a, b) ((a).x < (b).x || ((a).x == (b).x && (a).y < (b).y))
+ * LIBADT_SORT_DEFINE(sort_points, struct point, point_less)
+ *
+ * sort_points(libadt_vector_lptr(points));
+ * \endcode
+ *
+ * \param NAME The name of the introsort function, and prefix of the
+ * 	other generated functions.
+ * \param TYPE The element type.
+ * \param LESS A function or function-like macro taking two TYPE
+ * 	values and returning true if the first sorts before the second.
+ */
+#define LIBADT_SORT_DEFINE(NAME, TYPE, LESS) \
+static inline void NAME##_insertion(TYPE *array, size_t length) \
+{ \
+	for (size_t i = 1; i < length; i++) { \
+		TYPE value = array[i]; \
+		size_t j = i; \
+		for (; j > 0 && LESS(value, array[j - 1]); j--) \
+			array[j] = array[j - 1]; \
+		array[j] = value; \
+	} \
+} \
+\
+static inline void NAME##_sift(TYPE *array, size_t root, size_t length) \
+{ \
+	TYPE value = array[root]; \
+	for (size_t child; (child = 2 * root + 1) < length; root = child) { \
+		if (child + 1 < length && LESS(array[child], array[child + 1])) \
+			child++; \
+		if (!LESS(value, array[child])) \
+			break; \
+		array[root] = array[child]; \
+	} \
+	array[root] = value; \
+} \
+\
+static inline void NAME##_heapsort(TYPE *array, size_t length) \
+{ \
+	for (size_t i = length / 2; i-- > 0;) \
+		NAME##_sift(array, i, length); \
+	for (size_t end = length; end-- > 1;) { \
+		TYPE top = array[0]; \
+		array[0] = array[end]; \
+		array[end] = top; \
+		NAME##_sift(array, 0, end); \
+	} \
+} \
+\
+static inline void NAME##_swap(TYPE *a, TYPE *b) \
+{ \
+	TYPE temp = *a; \
+	*a = *b; \
+	*b = temp; \
+} \
+\
+static inline void NAME##_introsort(TYPE *array, size_t length, unsigned int depth) \
+{ \
+	while (length > LIBADT_SORT_INSERTION_THRESHOLD) { \
+		if (!depth--) { \
+			NAME##_heapsort(array, length); \
+			return; \
+		} \
+		\
+		/* Median of three, which also places sentinels at both ends */ \
+		TYPE *const middle = &array[length / 2], *const last = &array[length - 1]; \
+		if (LESS(*middle, array[0])) NAME##_swap(middle, array); \
+		if (LESS(*last, *middle)) { \
+			NAME##_swap(last, middle); \
+			if (LESS(*middle, array[0])) NAME##_swap(middle, array); \
+		} \
+		const TYPE pivot = *middle; \
+		\
+		size_t i = 0, j = length - 1; \
+		for (;;) { \
+			do i++; while (LESS(array[i], pivot)); \
+			do j--; while (LESS(pivot, array[j])); \
+			if (i >= j) \
+				break; \
+			NAME##_swap(&array[i], &array[j]); \
+		} \
+		\
+		/* Recurse into the smaller half, loop on the larger */ \
+		if (i < length - i) { \
+			NAME##_introsort(array, i, depth); \
+			array += i; \
+			length -= i; \
+		} else { \
+			NAME##_introsort(array + i, length - i, depth); \
+			length = i; \
+		} \
+	} \
+	NAME##_insertion(array, length); \
+} \
+\
+static inline void NAME(struct libadt_lptr lptr) \
+{ \
+	size_t length = (size_t)lptr.length; \
+	unsigned int depth = 0; \
+	while (length >>= 1) \
+		depth += 2; \
+	NAME##_introsort((TYPE *)lptr.buffer, (size_t)lptr.length, depth); \
+} \
+\
+static inline void NAME##_merge( \
+	const TYPE *restrict left, \
+	size_t left_length, \
+	const TYPE *restrict right, \
+	size_t right_length, \
+	TYPE *restrict out \
+) \
+{ \
+	const TYPE *const left_end = left + left_length, *const right_end = right + right_length; \
+	while (left < left_end && right < right_end) { \
+		/* Take from the right only if strictly less, for stability */ \
+		if (LESS(*right, *left)) \
+			*out++ = *right++; \
+		else \
+			*out++ = *left++; \
+	} \
+	while (left < left_end) \
+		*out++ = *left++; \
+	while (right < right_end) \
+		*out++ = *right++; \
+} \
+\
+static inline bool NAME##_stable(struct libadt_lptr lptr, struct libadt_lptr scratch) \
+{ \
+	const size_t length = (size_t)lptr.length; \
+	if ( \
+		libadt_const_lptr_size(libadt_const_lptr(scratch)) \
+		< libadt_const_lptr_size(libadt_const_lptr(lptr)) \
+	) \
+		return false; \
+	\
+	TYPE *from = lptr.buffer, *to = scratch.buffer; \
+	for (size_t i = 0; i < length; i += LIBADT_SORT_INSERTION_THRESHOLD) { \
+		const size_t left = length - i; \
+		NAME##_insertion( \
+			from + i, \
+			left < LIBADT_SORT_INSERTION_THRESHOLD ? left : LIBADT_SORT_INSERTION_THRESHOLD \
+		); \
+	} \
+	\
+	for (size_t width = LIBADT_SORT_INSERTION_THRESHOLD; width < length; width *= 2) { \
+		for (size_t i = 0; i < length; i += 2 * width) { \
+			const size_t \
+				middle = i + width < length ? i + width : length, \
+				end = middle + width < length ? middle + width : length; \
+			NAME##_merge(from + i, middle - i, from + middle, end - middle, to + i); \
+		} \
+		TYPE *const swap = from; \
+		from = to; \
+		to = swap; \
+	} \
+	\
+	if (from != (TYPE *)lptr.buffer) \
+		memcpy(lptr.buffer, from, length * sizeof(TYPE)); \
+	return true; \
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // LIBADT_SORT_H
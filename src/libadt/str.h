@@ -23,6 +23,8 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 #include <wchar.h>
 #include <limits.h>
@@ -99,6 +101,393 @@ inline struct libadt_lptr libadt_wstr(wchar_t *const str)
 	};
 }
 
+/**
+ * \brief Finds the first occurrence of needle in haystack.
+ *
+ * Both strings are byte strings: their size must be 1. Searches with
+ * SSE2 or AVX2 where the CPU supports it, comparing the first and
+ * last bytes of needle against 16 or 32 positions at once and only
+ * comparing the rest where both match.
+ *
+ * \param haystack The string to search.
+ * \param needle The string to search for.
+ *
+ * \returns The part of haystack matching needle, or an lptr with a
+ * 	NULL buffer, failing libadt_const_lptr_allocated(), if needle
+ * 	doesn't occur. An empty needle matches at the start.
+ */
+struct libadt_const_lptr libadt_str_find(
+	struct libadt_const_lptr haystack,
+	struct libadt_const_lptr needle
+);
+
+/**
+ * \brief Finds the last occurrence of needle in haystack.
+ *
+ * \param haystack The string to search.
+ * \param needle The string to search for.
+ *
+ * \returns The part of haystack matching needle, or an lptr with a
+ * 	NULL buffer if needle doesn't occur. An empty needle matches at
+ * 	the end.
+ *
+ * \sa libadt_str_find()
+ */
+struct libadt_const_lptr libadt_str_rfind(
+	struct libadt_const_lptr haystack,
+	struct libadt_const_lptr needle
+);
+
+/**
+ * \brief Finds the first occurrence of a byte in haystack.
+ *
+ * \param haystack The string to search. Its size must be 1.
+ * \param byte The byte to search for.
+ *
+ * \returns The byte found, as an lptr of length 1 into haystack, or
+ * 	an lptr with a NULL buffer if it doesn't occur.
+ */
+struct libadt_const_lptr libadt_str_find_byte(
+	struct libadt_const_lptr haystack,
+	char byte
+);
+
+/**
+ * \brief Finds the first byte in haystack which is one of the bytes
+ * 	in set.
+ *
+ * Sets of up to 16 bytes are searched with SSE2 or AVX2, larger ones
+ * with a lookup table.
+ *
+ * \code
+ * struct libadt_const_lptr space = libadt_str_find_any(
+ * 	line,
+ * 	libadt_str_literal(" \t")
+ * );
+ * \endcode
+ *
+ * \param haystack The string to search. Its size must be 1.
+ * \param set The bytes to search for. Its size must be 1.
+ *
+ * \returns The byte found, as an lptr of length 1 into haystack, or
+ * 	an lptr with a NULL buffer if none of the bytes occur.
+ */
+struct libadt_const_lptr libadt_str_find_any(
+	struct libadt_const_lptr haystack,
+	struct libadt_const_lptr set
+);
+
+/**
+ * \brief The kinds of delimiter a libadt_str_split can split on.
+ */
+enum libadt_str_split_mode {
+	/**
+	 * \brief Split on a single byte.
+	 */
+	LIBADT_STR_SPLIT_BYTE,
+
+	/**
+	 * \brief Split on any byte of a set.
+	 */
+	LIBADT_STR_SPLIT_ANY,
+
+	/**
+	 * \brief Split on a substring.
+	 */
+	LIBADT_STR_SPLIT_SUBSTRING,
+};
+
+/**
+ * \brief Iterates over the fields of a string separated by
+ * 	delimiters, without copying or allocating.
+ *
+ * Each field is a slice of the original string. A string with n
+ * delimiters has n + 1 fields, some of which may be empty.
+ *
+ * The iterator scans 64 bytes at a time with SSE2 or AVX2, keeping
+ * a bitmask of the delimiters found, so short fields cost a bit
+ * operation each rather than a search. Substrings are scanned for
+ * their first byte and each candidate compared in full.
+ *
+ * \code
+ * for (
+ * 	struct libadt_str_split field = libadt_str_split_next(libadt_str_split_byte(line, ','));
+ * 	libadt_str_split_valid(field);
+ * 	field = libadt_str_split_next(field)
+ * )
+ * 	use(field.token);
+ * \endcode
+ */
+struct libadt_str_split {
+	/**
+	 * \brief The current field.
+	 */
+	struct libadt_const_lptr token;
+
+	/**
+	 * \brief The rest of the string after the current field and its
+	 * 	delimiter. The buffer is NULL once the last field has been
+	 * 	returned.
+	 */
+	struct libadt_const_lptr rest;
+
+	/**
+	 * \brief The delimiter: a byte, a set of bytes or a substring.
+	 */
+	struct libadt_const_lptr delimiter;
+
+	/**
+	 * \brief How to interpret delimiter.
+	 */
+	enum libadt_str_split_mode mode;
+
+	/**
+	 * \brief The delimiter when splitting on a byte, or the first
+	 * 	byte of a substring.
+	 */
+	char byte;
+
+	/**
+	 * \brief The start of the 64 bytes that mask covers.
+	 */
+	const char *window;
+
+	/**
+	 * \brief The end of the bytes scanned so far.
+	 */
+	const char *scanned;
+
+	/**
+	 * \brief The delimiters in the window not yet consumed, bit i
+	 * 	standing for window[i].
+	 */
+	uint64_t mask;
+};
+
+/**
+ * \internal
+ * \brief Constructs a split iterator positioned before the first
+ * 	field.
+ */
+inline struct libadt_str_split libadt_str_split_init(
+	struct libadt_const_lptr str,
+	struct libadt_const_lptr delimiter,
+	enum libadt_str_split_mode mode
+)
+{
+	return (struct libadt_str_split) {
+		.token = { NULL, 1, 0 },
+		.rest = str,
+		.delimiter = delimiter,
+		.mode = mode,
+		.byte = 0,
+		.window = str.buffer,
+		.scanned = str.buffer,
+		.mask = 0,
+	};
+}
+
+/**
+ * \public \memberof libadt_str_split
+ * \brief Splits a string on a byte.
+ *
+ * \param str The string to split. Its size must be 1.
+ * \param delimiter The byte to split on. It is stored in the
+ * 	iterator, so a literal can be passed.
+ *
+ * \returns An iterator to pass to libadt_str_split_next() for the
+ * 	first field.
+ */
+inline struct libadt_str_split libadt_str_split_byte(
+	struct libadt_const_lptr str,
+	char delimiter
+)
+{
+	struct libadt_str_split result = libadt_str_split_init(
+		str,
+		(struct libadt_const_lptr) { NULL, 1, 1 },
+		LIBADT_STR_SPLIT_BYTE
+	);
+	result.byte = delimiter;
+	return result;
+}
+
+/**
+ * \public \memberof libadt_str_split
+ * \brief Splits a string on any of a set of bytes.
+ *
+ * Sets of up to 16 bytes are scanned with SIMD.
+ *
+ * \param str The string to split. Its size must be 1.
+ * \param set The bytes to split on, which must outlive the
+ * 	iterator. Its size must be 1.
+ *
+ * \returns An iterator to pass to libadt_str_split_next() for the
+ * 	first field.
+ */
+inline struct libadt_str_split libadt_str_split_any(
+	struct libadt_const_lptr str,
+	struct libadt_const_lptr set
+)
+{
+	return libadt_str_split_init(str, set, LIBADT_STR_SPLIT_ANY);
+}
+
+/**
+ * \public \memberof libadt_str_split
+ * \brief Splits a string on a substring.
+ *
+ * An empty substring never matches.
+ *
+ * \param str The string to split. Its size must be 1.
+ * \param substring The substring to split on, which must outlive
+ * 	the iterator. Its size must be 1.
+ *
+ * \returns An iterator to pass to libadt_str_split_next() for the
+ * 	first field.
+ */
+inline struct libadt_str_split libadt_str_split(
+	struct libadt_const_lptr str,
+	struct libadt_const_lptr substring
+)
+{
+	struct libadt_str_split result = libadt_str_split_init(
+		str,
+		substring,
+		LIBADT_STR_SPLIT_SUBSTRING
+	);
+	if (substring.length > 0)
+		result.byte = *(const char *)substring.buffer;
+	return result;
+}
+
+/**
+ * \public \memberof libadt_str_split
+ * \brief Tests whether the iterator holds a field.
+ *
+ * \returns False once libadt_str_split_next() has run out of fields.
+ */
+inline bool libadt_str_split_valid(struct libadt_str_split split)
+{
+	return libadt_const_lptr_allocated(split.token);
+}
+
+/**
+ * \internal
+ * \brief Returns the index of the lowest set bit, which must exist.
+ */
+inline unsigned int libadt_str_lowest(uint64_t mask)
+{
+#ifdef __GNUC__
+	return (unsigned int)__builtin_ctzll(mask);
+#else
+	unsigned int result = 0;
+	while (!(mask & 1)) {
+		mask >>= 1;
+		result++;
+	}
+	return result;
+#endif
+}
+
+/**
+ * \internal
+ * \brief Scans 64 bytes at a time from *window for delimiters, or
+ * 	the first bytes of a substring.
+ *
+ * Takes the fields it needs rather than the iterator, so that the
+ * iterator never has its address taken and can stay in registers.
+ *
+ * \returns A bitmask of the delimiters in the first window that has
+ * 	any, with *window set to that window, or 0 with *window set to
+ * 	end.
+ */
+uint64_t libadt_str_split_scan(
+	const char **window,
+	const char *end,
+	enum libadt_str_split_mode mode,
+	char byte,
+	const char *set,
+	ssize_t set_length
+);
+
+/**
+ * \internal
+ * \brief Tests whether a candidate found by the scan starts a
+ * 	delimiter in the rest of the string.
+ */
+inline bool libadt_str_split_match(struct libadt_str_split split, const char *candidate)
+{
+	if (split.mode != LIBADT_STR_SPLIT_SUBSTRING)
+		return true;
+
+	// Candidates inside the last match or too close to the end fail
+	const char *const rest = split.rest.buffer;
+	const ssize_t length = split.delimiter.length;
+	return length > 0
+		&& candidate >= rest
+		&& rest + split.rest.length - candidate >= length
+		&& !memcmp(candidate + 1, (const char *)split.delimiter.buffer + 1, (size_t)length - 1);
+}
+
+/**
+ * \public \memberof libadt_str_split
+ * \brief Advances the iterator to the next field.
+ *
+ * \param split The iterator.
+ *
+ * \returns The iterator with token set to the next field, or
+ * 	failing libadt_str_split_valid() if there are no more.
+ */
+inline struct libadt_str_split libadt_str_split_next(struct libadt_str_split split)
+{
+	if (!split.rest.buffer) {
+		split.token = (struct libadt_const_lptr) { NULL, 1, 0 };
+		return split;
+	}
+
+	const char *const end = (const char *)split.rest.buffer + split.rest.length;
+	for (;;) {
+		while (!split.mask) {
+			if (split.scanned == end) {
+				split.token = split.rest;
+				split.rest = (struct libadt_const_lptr) { NULL, 1, 0 };
+				return split;
+			}
+			const char *window = split.scanned;
+			split.mask = libadt_str_split_scan(
+				&window,
+				end,
+				split.mode,
+				split.byte,
+				split.delimiter.buffer,
+				split.delimiter.length
+			);
+			split.window = window;
+			split.scanned = end - window < 64 ? end : window + 64;
+		}
+
+		const char *const delimiter = split.window + libadt_str_lowest(split.mask);
+		split.mask &= split.mask - 1;
+		if (!libadt_str_split_match(split, delimiter))
+			continue;
+
+		split.token = libadt_const_lptr_truncate(
+			split.rest,
+			(size_t)(delimiter - (const char *)split.rest.buffer)
+		);
+		split.rest = libadt_const_lptr_after(
+			split.rest,
+			(struct libadt_const_lptr) {
+				delimiter,
+				1,
+				split.mode == LIBADT_STR_SPLIT_SUBSTRING ? split.delimiter.length : 1,
+			}
+		);
+		return split;
+	}
+}
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -0,0 +1,204 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBADT_THREADPOOL_H
+#define LIBADT_THREADPOOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+/**
+ * \file
+ * \brief A work-stealing thread pool.
+ *
+ * Each worker thread owns a Chase-Lev deque. Tasks spawned from a
+ * worker go to the bottom of its own deque, where it takes them
+ * back last-in first-out, while idle workers steal from the top.
+ * Tasks submitted from other threads go to a shared injection
+ * queue.
+ *
+ * Tasks are owned by the caller: the pool never allocates them, so
+ * spawning a task costs a few atomic operations. A task must stay
+ * valid until it has run, which libadt_threadpool_wait() on its
+ * group guarantees.
+ *
+ * Deques have a fixed capacity. A task spawned onto a full deque
+ * is run immediately by the spawning thread, which bounds memory
+ * use and is always correct for fork/join code.
+ *
+ * Fork/join code spawns tasks into a libadt_threadpool_group and
+ * waits for the group. A worker waiting from inside a task runs
+ * other spawned tasks until the group is done, so waiting does not
+ * tie up the worker:
+ *
+ * \code
+ * struct libadt_threadpool_group group = LIBADT_THREADPOOL_GROUP_INIT;
+ * struct libadt_threadpool_task left = { .function = sum, .context = &halves[0] };
+ * struct libadt_threadpool_task right = { .function = sum, .context = &halves[1] };
+ * libadt_threadpool_spawn(pool, &group, &left);
+ * libadt_threadpool_spawn(pool, &group, &right);
+ * libadt_threadpool_wait(pool, &group);
+ * \endcode
+ */
+
+/**
+ * \brief The number of tasks each worker's deque can hold.
+ */
+#define LIBADT_THREADPOOL_DEQUE_CAPACITY 1024
+
+/**
+ * \brief A thread pool. Create one with libadt_threadpool_init().
+ */
+struct libadt_threadpool;
+
+/**
+ * \brief Counts the unfinished tasks spawned into it.
+ *
+ * Initialize with LIBADT_THREADPOOL_GROUP_INIT. A group can be
+ * reused once libadt_threadpool_wait() has returned.
+ */
+struct libadt_threadpool_group {
+	/**
+	 * \brief The number of tasks spawned and not yet finished.
+	 */
+	atomic_size_t pending;
+};
+
+/**
+ * \brief An initializer for an empty libadt_threadpool_group.
+ */
+#define LIBADT_THREADPOOL_GROUP_INIT { 0 }
+
+/**
+ * \brief A task to run on the pool.
+ *
+ * The caller fills in function and context. The other members are
+ * managed by the pool.
+ */
+struct libadt_threadpool_task {
+	/**
+	 * \brief The function to run.
+	 */
+	void (*function)(void *context);
+
+	/**
+	 * \brief The argument to function.
+	 */
+	void *context;
+
+	/**
+	 * \brief The group the task was spawned into, or NULL.
+	 */
+	struct libadt_threadpool_group *group;
+
+	/**
+	 * \brief The next task in the injection queue.
+	 */
+	struct libadt_threadpool_task *next;
+};
+
+/**
+ * \public \memberof libadt_threadpool
+ * \brief Starts a thread pool.
+ *
+ * \param threads The number of worker threads, or 0 for the number
+ * 	of online processors.
+ *
+ * \returns The new pool, or NULL on failure.
+ */
+struct libadt_threadpool *libadt_threadpool_init(unsigned int threads);
+
+/**
+ * \public \memberof libadt_threadpool
+ * \brief Runs every task still queued, then stops the worker
+ * 	threads and frees the pool.
+ *
+ * Must not be called from a task.
+ *
+ * \param pool The pool to free, or NULL.
+ */
+void libadt_threadpool_free(struct libadt_threadpool *pool);
+
+/**
+ * \public \memberof libadt_threadpool
+ * \brief Returns the number of worker threads in the pool.
+ */
+unsigned int libadt_threadpool_threads(const struct libadt_threadpool *pool);
+
+/**
+ * \public \memberof libadt_threadpool
+ * \brief Queues a task to run on the pool.
+ *
+ * If called from a worker of this pool, the task goes to the
+ * worker's own deque, or runs immediately if the deque is full.
+ * Otherwise, it goes to the injection queue.
+ *
+ * \param pool The pool to run the task on.
+ * \param group The group to count the task in, or NULL.
+ * \param task The task, which must stay valid until it has run.
+ */
+void libadt_threadpool_spawn(
+	struct libadt_threadpool *pool,
+	struct libadt_threadpool_group *group,
+	struct libadt_threadpool_task *task
+);
+
+/**
+ * \public \memberof libadt_threadpool
+ * \brief Queues several tasks at once.
+ *
+ * Equivalent to spawning each task in turn, but from outside the
+ * pool the injection queue is locked once for the whole batch.
+ *
+ * \param pool The pool to run the tasks on.
+ * \param group The group to count the tasks in, or NULL.
+ * \param tasks The tasks, which must stay valid until they have run.
+ * \param number The number of tasks.
+ */
+void libadt_threadpool_spawn_n(
+	struct libadt_threadpool *pool,
+	struct libadt_threadpool_group *group,
+	struct libadt_threadpool_task *tasks,
+	size_t number
+);
+
+/**
+ * \public \memberof libadt_threadpool
+ * \brief Waits for every task in the group to finish.
+ *
+ * Called from a task, the worker runs tasks from its own deque and
+ * steals from other workers in the meantime. Called from any other
+ * thread, it just waits.
+ *
+ * \param pool The pool the tasks were spawned on.
+ * \param group The group to wait for.
+ */
+void libadt_threadpool_wait(
+	struct libadt_threadpool *pool,
+	struct libadt_threadpool_group *group
+);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // LIBADT_THREADPOOL_H
@@ -25,11 +25,18 @@ extern "C" {
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "allocator.h"
+#include "lptr.h"
 
 /**
  * \file
  */
 
+struct libadt_vector_growth;
+
 /**
  * \brief Represents a vector, or dynamic array.
  *
@@ -66,8 +73,144 @@ struct libadt_vector {
 	 * 	requiring a reallocation.
 	 */
 	size_t capacity;
+
+	/**
+	 * \brief The allocator used for the buffer, or NULL
+	 * 	for the standard library.
+	 *
+	 * \sa libadt_vector_init_with_allocator()
+	 */
+	const struct libadt_allocator *allocator;
+
+	/**
+	 * \brief The growth policy used when appending to a full
+	 * 	vector, or NULL to double the capacity.
+	 *
+	 * This may be set at any time, and is kept by the vector
+	 * functions. The policy must outlive the vector.
+	 *
+	 * \sa libadt_vector_growth
+	 */
+	const struct libadt_vector_growth *growth;
 };
 
+/**
+ * \brief Decides how much a full vector grows by.
+ *
+ * Appending to a full vector asks the policy for a new capacity.
+ * Doubling keeps the number of reallocations low, but can leave up
+ * to half of a large vector's memory unused. The policies provided
+ * trade memory against reallocation count:
+ *
+ * - libadt_vector_growth_double doubles the capacity (the default).
+ * - libadt_vector_growth_half grows the capacity by half.
+ * - libadt_vector_growth_pages grows the capacity by half, rounded
+ * 	up to whole 4 KiB pages.
+ * - libadt_vector_grow_chunk() adds parameter elements at a time,
+ * 	and needs a policy of your own to set the parameter.
+ *
+ * Custom policies provide their own grow function. For example:
+ *
+ * \code
+ * static const struct libadt_vector_growth by_chunk = {
+ * 	.grow = libadt_vector_grow_chunk,
+ * 	.parameter = 1 << 20,
+ * };
+ *
+ * struct libadt_vector vector = libadt_vector_init(sizeof(int), 0);
+ * vector.growth = &by_chunk;
+ * \endcode
+ */
+struct libadt_vector_growth {
+	/**
+	 * \brief Returns the new capacity of a vector.
+	 *
+	 * \param growth The policy itself, for access to its
+	 * 	parameter and context.
+	 * \param size The size of each element.
+	 * \param capacity The current capacity, in elements.
+	 * \param required The smallest capacity that will fit the
+	 * 	new elements. Smaller results are raised to this.
+	 *
+	 * \returns The capacity to reallocate to, in elements.
+	 */
+	size_t (*grow)(
+		const struct libadt_vector_growth *growth,
+		size_t size,
+		size_t capacity,
+		size_t required
+	);
+
+	/**
+	 * \brief A parameter for the grow function, such as a chunk
+	 * 	or page size.
+	 */
+	size_t parameter;
+
+	/**
+	 * \brief A pointer for use by custom grow functions.
+	 */
+	void *context;
+};
+
+/**
+ * \brief Doubles the capacity.
+ */
+size_t libadt_vector_grow_double(
+	const struct libadt_vector_growth *growth,
+	size_t size,
+	size_t capacity,
+	size_t required
+);
+
+/**
+ * \brief Grows the capacity by half.
+ */
+size_t libadt_vector_grow_half(
+	const struct libadt_vector_growth *growth,
+	size_t size,
+	size_t capacity,
+	size_t required
+);
+
+/**
+ * \brief Grows the capacity by libadt_vector_growth::parameter
+ * 	elements.
+ */
+size_t libadt_vector_grow_chunk(
+	const struct libadt_vector_growth *growth,
+	size_t size,
+	size_t capacity,
+	size_t required
+);
+
+/**
+ * \brief Grows the capacity by half, then rounds the buffer size
+ * 	up to a multiple of libadt_vector_growth::parameter bytes.
+ */
+size_t libadt_vector_grow_pages(
+	const struct libadt_vector_growth *growth,
+	size_t size,
+	size_t capacity,
+	size_t required
+);
+
+/**
+ * \brief A growth policy using libadt_vector_grow_double().
+ */
+extern const struct libadt_vector_growth libadt_vector_growth_double;
+
+/**
+ * \brief A growth policy using libadt_vector_grow_half().
+ */
+extern const struct libadt_vector_growth libadt_vector_growth_half;
+
+/**
+ * \brief A growth policy using libadt_vector_grow_pages() with
+ * 	4096 byte pages.
+ */
+extern const struct libadt_vector_growth libadt_vector_growth_pages;
+
 /**
  * \public \memberof libadt_vector
  * \brief Constructs a new libadt_vector with the given
@@ -88,6 +231,55 @@ struct libadt_vector {
  */
 struct libadt_vector libadt_vector_init(size_t size, size_t initial_capacity);
 
+/**
+ * \public \memberof libadt_vector
+ * \brief Constructs a new libadt_vector which allocates its
+ * 	memory using the given allocator.
+ *
+ * The vector keeps a pointer to the allocator and uses it for
+ * every reallocation, and to free the buffer in
+ * libadt_vector_free(). The allocator must outlive the vector.
+ *
+ * \param size The size of an individual element.
+ * \param initial_capacity The initial capacity to allocate.
+ * \param allocator The allocator to use, or NULL for the
+ * 	standard library.
+ *
+ * \returns A vector ready to append elements to, or a
+ * 	vector failing libadt_vector_valid() if an allocation
+ * 	attempt failed.
+ *
+ * \sa libadt_vector_init()
+ */
+struct libadt_vector libadt_vector_init_with_allocator(
+	size_t size,
+	size_t initial_capacity,
+	const struct libadt_allocator *allocator
+);
+
+/**
+ * \public \memberof libadt_vector
+ * \brief Constructs a new libadt_vector for very large numbers
+ * 	of elements.
+ *
+ * Once the buffer reaches LIBADT_ALLOCATOR_HUGE_THRESHOLD bytes, it
+ * is backed by anonymous memory mappings using huge pages, and
+ * grows with mremap() rather than copying. libadt_vector_vacuum()
+ * gives the unused pages back to the system. This is only
+ * supported on Linux: elsewhere, the vector behaves as if it was
+ * constructed with libadt_vector_init().
+ *
+ * \param size The size of an individual element.
+ * \param initial_capacity The initial capacity to allocate.
+ *
+ * \returns A vector ready to append elements to, or a
+ * 	vector failing libadt_vector_valid() if an allocation
+ * 	attempt failed.
+ *
+ * \sa libadt_allocator_huge
+ */
+struct libadt_vector libadt_vector_init_huge(size_t size, size_t initial_capacity);
+
 /**
  * \public \memberof libadt_vector
  * \brief Frees the memory managed by the vector.
@@ -184,11 +376,231 @@ bool libadt_vector_identity(
 	&& (first).length == (second).length \
 	&& (first).capacity == (second).capacity)
 
+/**
+ * \public \memberof libadt_vector
+ * \brief Appends a single new element to the vector _vector_,
+ * 	given by _data._
+ *
+ * Identical to libadt_vector_append_n(vector, data, 1).
+ *
+ * A function-like macro with the same name is provided, and will
+ * be used by default for function call syntax.
+ *
+ * \param vector The vector to append the element to.
+ * \param data The element to append.
+ *
+ * \returns A vector with the new element appended. On error,
+ * 	the old vector is returned.
+ */
+struct libadt_vector libadt_vector_append(
+	struct libadt_vector vector,
+	void *data
+);
+#define libadt_vector_append(vec, data) \
+	libadt_vector_append_n((vec), (data), 1)
+
+/**
+ * \internal
+ * \brief Grows the vector so _number_ more elements fit, following
+ * 	its growth policy.
+ *
+ * \returns True on success. On failure, false is returned and the
+ * 	vector is untouched.
+ */
+bool libadt_vector_make_room(struct libadt_vector *vector, size_t number);
+
+/**
+ * \internal
+ * \brief Inline fast path of libadt_vector_make_room().
+ */
+inline bool libadt_vector_has_room(struct libadt_vector vector, size_t number)
+{
+	return number <= vector.capacity - vector.length;
+}
+
+/**
+ * \public \memberof libadt_vector
+ * \brief Makes room for _number_ new elements at the end of the
+ * 	vector, to be written in place.
+ *
+ * This avoids building elements elsewhere only to copy them in
+ * with libadt_vector_append_n(). The vector grows following its
+ * growth policy, but its length is untouched: once the new
+ * elements have been written, add them to the vector with
+ * libadt_vector_commit(). Committing fewer than _number_ elements
+ * is fine, for fills that end early.
+ *
+ * Example usage:
+ *
+ * \code
+ * struct record *records;
+ * vector = libadt_vector_extend_uninit(vector, 64, (void **)&records);
+ * if (!records)
+ * 	handle_error();
+ *
+ * size_t decoded = decode_into(records, 64);
+ * vector = libadt_vector_commit(vector, decoded);
+ * \endcode
+ *
+ * \param vector The vector to extend.
+ * \param number The number of elements to make room for.
+ * \param out Set to the first of the new slots, or to NULL if
+ * 	the allocation failed.
+ *
+ * \returns The vector with the new capacity. If the allocation
+ * 	failed, the old vector is returned.
+ */
+inline struct libadt_vector libadt_vector_extend_uninit(
+	struct libadt_vector vector,
+	size_t number,
+	void **out
+)
+{
+	if (libadt_vector_has_room(vector, number)
+		|| libadt_vector_make_room(&vector, number))
+		*out = (char *)vector.buffer + vector.size * vector.length;
+	else
+		*out = NULL;
+	return vector;
+}
+
+/**
+ * \public \memberof libadt_vector
+ * \brief Adds _number_ elements, already written past the end of
+ * 	the vector, to its length.
+ *
+ * The length never grows past the capacity.
+ *
+ * \param vector The vector to commit elements to.
+ * \param number The number of elements written.
+ *
+ * \returns The vector with the new length.
+ *
+ * \sa libadt_vector_extend_uninit()
+ */
+inline struct libadt_vector libadt_vector_commit(
+	struct libadt_vector vector,
+	size_t number
+)
+{
+	const size_t room = vector.capacity - vector.length;
+	vector.length += number < room ? number : room;
+	return vector;
+}
+
+/**
+ * \public \memberof libadt_vector
+ * \brief Removes the last _number_ elements from the vector,
+ * 	undoing a commit.
+ *
+ * Like libadt_vector_pop(), this is a logical remove: the memory
+ * is kept.
+ *
+ * \param vector The vector to remove elements from.
+ * \param number The number of elements to remove. Removing more
+ * 	elements than the vector holds empties it.
+ *
+ * \returns The vector with the new length.
+ */
+inline struct libadt_vector libadt_vector_rollback(
+	struct libadt_vector vector,
+	size_t number
+)
+{
+	vector.length -= number < vector.length ? number : vector.length;
+	return vector;
+}
+
+/**
+ * \internal
+ * \brief Appends source to a vector without room for it, growing
+ * 	the vector first.
+ *
+ * This takes the vector by pointer: returning a vector from the
+ * slow path forces compilers to keep the caller's vector in memory
+ * on the fast path too.
+ */
+void libadt_vector_append_lptr_grow(
+	struct libadt_vector *vector,
+	struct libadt_const_lptr source
+);
+
+/**
+ * \internal
+ * \brief Copies number elements of the given size from source to
+ * 	the end of a vector, where they may overlap.
+ *
+ * Copies that do not overlap use memcpy(), which the compiler
+ * can turn into a load and a store once it knows the size.
+ */
+inline void libadt_vector_copy(
+	void *destination,
+	const void *source,
+	size_t size,
+	size_t number
+)
+{
+	const size_t bytes = size * number;
+	const uintptr_t
+		to = (uintptr_t)destination,
+		from = (uintptr_t)source;
+
+	if (from + bytes <= to || to + bytes <= from)
+		memcpy(destination, source, bytes);
+	else
+		memmove(destination, source, bytes);
+}
+
+/**
+ * \public \memberof libadt_vector
+ * \brief Appends the elements pointed to by _source_ to the
+ * 	vector _vector._
+ *
+ * The source may point into the vector itself: if appending
+ * reallocates the buffer, the source is moved along with it.
+ *
+ * If the append fails, the old vector will be returned. This
+ * error can be checked with libadt_vector_identity(old, new).
+ *
+ * \param vector The vector to append elements to.
+ * \param source The elements to append. Its size must match the
+ * 	vector's element size.
+ *
+ * \returns A vector with the new data appended. If the append
+ * 	failed, or the sizes didn't match, the old vector is returned.
+ */
+inline struct libadt_vector libadt_vector_append_lptr(
+	struct libadt_vector vector,
+	struct libadt_const_lptr source
+)
+{
+	if (source.size != (ssize_t)vector.size || source.length < 0)
+		return vector;
+
+	const size_t number = (size_t)source.length;
+	if (!libadt_vector_has_room(vector, number)) {
+		libadt_vector_append_lptr_grow(&vector, source);
+		return vector;
+	}
+
+	libadt_vector_copy(
+		(char *)vector.buffer + vector.size * vector.length,
+		source.buffer,
+		vector.size,
+		number
+	);
+	vector.length += number;
+	return vector;
+}
+
 /**
  * \public \memberof libadt_vector
  * \brief Appends _number_ new elements to the vector _vector_,
  * 	beginning from _data._
  *
+ * Identical to libadt_vector_append_lptr() with an lptr over
+ * _number_ elements at _data_.
+ *
  * If the append fails, the old vector will be returned. This
  * error can be checked with libadt_vector_identity(old, new).
  *
@@ -199,34 +611,41 @@ bool libadt_vector_identity(
  * \returns A vector with the new data appended. If the append
  * 	failed, the old vector is returned.
  */
-struct libadt_vector libadt_vector_append_n(
+inline struct libadt_vector libadt_vector_append_n(
 	struct libadt_vector vector,
 	void *data,
 	size_t number
-);
+)
+{
+	if (number > SSIZE_MAX)
+		return vector;
+
+	return libadt_vector_append_lptr(vector, (struct libadt_const_lptr) {
+		.buffer = data,
+		.size = (ssize_t)vector.size,
+		.length = (ssize_t)number,
+	});
+}
 
 /**
  * \public \memberof libadt_vector
- * \brief Appends a single new element to the vector _vector_,
- * 	given by _data._
+ * \brief Ensures the vector can hold at least capacity
+ * 	elements without reallocating.
  *
- * Identical to libadt_vector_append_n(vector, data, 1).
+ * The length and elements are untouched. Unlike appending, no
+ * growth policy is applied: the capacity becomes exactly the one
+ * requested, if it was larger than the current capacity.
  *
- * A function-like macro with the same name is provided, and will
- * be used by default for function call syntax.
+ * \param vector The vector to reserve memory in.
+ * \param capacity The capacity to reserve.
  *
- * \param vector The vector to append the element to.
- * \param data The element to append.
- *
- * \returns A vector with the new element appended. On error,
- * 	the old vector is returned.
+ * \returns The vector with the new capacity. If the allocation
+ * 	failed, the old vector is returned.
  */
-struct libadt_vector libadt_vector_append(
+struct libadt_vector libadt_vector_reserve(
 	struct libadt_vector vector,
-	void *data
+	size_t capacity
 );
-#define libadt_vector_append(vec, data) \
-	libadt_vector_append_n((vec), (data), 1)
 
 /**
  * \public \memberof libadt_vector
@@ -247,6 +666,8 @@ struct libadt_vector libadt_vector_vacuum(struct libadt_vector vector);
  * than the current length, the new memory is uninitialized
  * and the length is untouched.
  *
+ * Truncating to a capacity of 0 frees the buffer.
+ *
  * \param vector The vector to modify.
  * \param new_capacity The new capacity to resize the
  * 	vector to.
@@ -298,6 +719,27 @@ void *libadt_vector_end(struct libadt_vector vector);
 #define libadt_vector_end(vec) \
 	libadt_vector_index((vec), (vec).length)
 
+/**
+ * \public \memberof libadt_vector
+ * \brief Returns a libadt_lptr over the elements stored in
+ * 	_vector._
+ *
+ * The lptr is invalidated by anything that reallocates the
+ * vector's buffer.
+ *
+ * \param vector The vector to get the elements of.
+ *
+ * \returns An lptr over the vector's elements.
+ */
+inline struct libadt_lptr libadt_vector_lptr(struct libadt_vector vector)
+{
+	return (struct libadt_lptr) {
+		.buffer = vector.buffer,
+		.size = (ssize_t)vector.size,
+		.length = (ssize_t)vector.length,
+	};
+}
+
 /**
  * \public \memberof libadt_vector
  * \brief Writes the last element of the vector to _out_ and
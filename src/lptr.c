@@ -29,6 +29,20 @@ struct libadt_lptr libadt_lptr_reallocarray(
 	size_t nmemb
 );
 struct libadt_lptr libadt_lptr_free(struct libadt_lptr lptr);
+struct libadt_lptr libadt_lptr_calloc_with_allocator(
+	size_t nmemb,
+	size_t size,
+	const struct libadt_allocator *allocator
+);
+struct libadt_lptr libadt_lptr_reallocarray_with_allocator(
+	struct libadt_lptr lptr,
+	size_t nmemb,
+	const struct libadt_allocator *allocator
+);
+struct libadt_lptr libadt_lptr_free_with_allocator(
+	struct libadt_lptr lptr,
+	const struct libadt_allocator *allocator
+);
 void *libadt_lptr_raw(struct libadt_lptr lptr);
 bool libadt_lptr_allocated(struct libadt_lptr lptr);
 bool libadt_lptr_in_bounds(struct libadt_lptr lptr);
@@ -0,0 +1,147 @@
+#include "libadt/mmap.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// The size of a transparent huge page on x86-64 and arm64
+#define HUGE_PAGE ((size_t)2 << 20)
+
+// What empty files map to: an allocated lptr with nothing to unmap
+static char empty;
+
+#ifdef MADV_HUGEPAGE
+// Reserves address space with room for a huge page boundary, and
+// returns the boundary with size bytes reserved after it, or NULL
+static void *reserve_aligned(size_t size)
+{
+	const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+	const size_t rounded = (size + page - 1) & ~(page - 1);
+	char *const reserved = mmap(
+		NULL,
+		rounded + HUGE_PAGE,
+		PROT_NONE,
+		MAP_PRIVATE | MAP_ANONYMOUS,
+		-1,
+		0
+	);
+	if (reserved == MAP_FAILED)
+		return NULL;
+
+	char *const aligned = (char *)(((uintptr_t)reserved + HUGE_PAGE - 1) & ~(uintptr_t)(HUGE_PAGE - 1));
+	if (aligned != reserved)
+		munmap(reserved, (size_t)(aligned - reserved));
+	munmap(aligned + rounded, (size_t)(reserved + HUGE_PAGE - aligned));
+	return aligned;
+}
+#endif
+
+static void advise(void *address, size_t size, int flags)
+{
+	// Advice is best effort: the mapping works without it
+#ifdef MADV_SEQUENTIAL
+	if (flags & LIBADT_MMAP_SEQUENTIAL)
+		madvise(address, size, MADV_SEQUENTIAL);
+#endif
+#ifdef MADV_HUGEPAGE
+	if (flags & LIBADT_MMAP_HUGEPAGE)
+		madvise(address, size, MADV_HUGEPAGE);
+#endif
+#ifdef MADV_WILLNEED
+#ifdef MAP_POPULATE
+	const int willneed = LIBADT_MMAP_WILLNEED;
+#else
+	const int willneed = LIBADT_MMAP_WILLNEED | LIBADT_MMAP_POPULATE;
+#endif
+	if (flags & willneed)
+		madvise(address, size, MADV_WILLNEED);
+#endif
+}
+
+static struct libadt_lptr map_fd(int fd, int flags, int protection, int sharing)
+{
+	const struct libadt_lptr failed = { NULL, 1, 0 };
+
+	struct stat status;
+	if (fstat(fd, &status))
+		return failed;
+	if (!S_ISREG(status.st_mode)) {
+		errno = ENODEV;
+		return failed;
+	}
+	if ((uintmax_t)status.st_size > (uintmax_t)PTRDIFF_MAX) {
+		errno = EFBIG;
+		return failed;
+	}
+
+	// mmap() rejects a length of 0
+	const size_t size = (size_t)status.st_size;
+	if (!size)
+		return (struct libadt_lptr) { &empty, 1, 0 };
+
+#ifdef MAP_POPULATE
+	if (flags & LIBADT_MMAP_POPULATE)
+		sharing |= MAP_POPULATE;
+#endif
+
+	void *address = NULL;
+#ifdef MADV_HUGEPAGE
+	if ((flags & LIBADT_MMAP_HUGEPAGE) && size >= HUGE_PAGE) {
+		address = reserve_aligned(size);
+		if (address)
+			sharing |= MAP_FIXED;
+	}
+#endif
+
+	void *const buffer = mmap(address, size, protection, sharing, fd, 0);
+	if (buffer == MAP_FAILED) {
+		const int error = errno;
+		if (address)
+			munmap(address, size);
+		errno = error;
+		return failed;
+	}
+
+	advise(buffer, size, flags);
+	return (struct libadt_lptr) { buffer, 1, (ssize_t)size };
+}
+
+static struct libadt_lptr map_file(const char *path, int flags, int access, int protection, int sharing)
+{
+	const int fd = open(path, access | O_CLOEXEC);
+	if (fd < 0)
+		return (struct libadt_lptr) { NULL, 1, 0 };
+
+	// The mapping outlives the descriptor
+	const struct libadt_lptr result = map_fd(fd, flags, protection, sharing);
+	const int error = errno;
+	close(fd);
+	errno = error;
+	return result;
+}
+
+struct libadt_const_lptr libadt_lptr_mmap_file(const char *path, int flags)
+{
+	return libadt_const_lptr(map_file(path, flags, O_RDONLY, PROT_READ, MAP_PRIVATE));
+}
+
+struct libadt_lptr libadt_lptr_mmap_file_shared(const char *path, int flags)
+{
+	return map_file(path, flags, O_RDWR, PROT_READ | PROT_WRITE, MAP_SHARED);
+}
+
+struct libadt_const_lptr libadt_const_lptr_munmap(struct libadt_const_lptr lptr)
+{
+	if (libadt_const_lptr_allocated(lptr) && lptr.buffer != &empty)
+		munmap((void *)lptr.buffer, (size_t)libadt_const_lptr_size(lptr));
+	return (struct libadt_const_lptr) { 0 };
+}
+
+struct libadt_lptr libadt_lptr_munmap(struct libadt_lptr lptr)
+{
+	libadt_const_lptr_munmap(libadt_const_lptr(lptr));
+	return (struct libadt_lptr) { 0 };
+}
@@ -0,0 +1,202 @@
+#include "libadt/packed_vector.h"
+
+#include <stdint.h>
+
+// Elements are moved to their new width a chunk at a time
+#define CHUNK 256
+
+bool libadt_packed_vector_valid(struct libadt_packed_vector vector);
+int libadt_packed_vector_width_for(unsigned int value);
+bool libadt_packed_vector_fits(struct libadt_packed_vector vector, unsigned int value);
+struct libadt_bitwise_array libadt_packed_vector_array(struct libadt_packed_vector vector);
+struct libadt_bitwise_array libadt_packed_vector_buffer(struct libadt_packed_vector vector);
+unsigned int libadt_packed_vector_get(struct libadt_packed_vector vector, size_t index);
+void libadt_packed_vector_store_last(
+	libadt_bitwise_array_bit *bits,
+	uint64_t bit,
+	int width,
+	unsigned int value
+);
+struct libadt_packed_vector libadt_packed_vector_append(
+	struct libadt_packed_vector vector,
+	unsigned int value
+);
+struct libadt_packed_vector libadt_packed_vector_pop(
+	struct libadt_packed_vector vector,
+	unsigned int *out
+);
+
+static size_t bytes_for(size_t capacity, int width)
+{
+	return capacity * (size_t)width / CHAR_BIT + LIBADT_PACKED_VECTOR_PADDING;
+}
+
+static size_t buffer_bytes(struct libadt_packed_vector vector)
+{
+	return vector.bits ? bytes_for(vector.capacity, vector.width) : 0;
+}
+
+static size_t grow_capacity(size_t capacity, size_t required)
+{
+	const size_t doubled = capacity > SIZE_MAX / 2 ? SIZE_MAX : (capacity ? capacity * 2 : 64);
+	return doubled > required ? doubled : required;
+}
+
+/*
+ * Reallocates the buffer for capacity elements of width bits, and
+ * widens the elements in place. Widening moves every element to a
+ * position at or after its old one, so going from the last element
+ * to the first never overwrites one before it is read.
+ *
+ * Returns false, leaving the vector untouched, if the allocation
+ * failed. width is never less than the current one.
+ */
+static bool resize(struct libadt_packed_vector *vector, int width, size_t capacity)
+{
+	if (capacity > ((size_t)SSIZE_MAX - LIBADT_PACKED_VECTOR_PADDING) / (size_t)width)
+		return false;
+
+	libadt_bitwise_array_bit *const bits = libadt_allocator_reallocate(
+		vector->allocator,
+		vector->bits,
+		buffer_bytes(*vector),
+		bytes_for(capacity, width)
+	);
+	if (!bits)
+		return false;
+
+	if (width != vector->width) {
+		const struct libadt_bitwise_array
+			from = { (ssize_t)vector->capacity, vector->width, bits },
+			to = { (ssize_t)capacity, width, bits };
+		unsigned int chunk[CHUNK];
+		for (size_t end = vector->length; end;) {
+			const size_t start = end > CHUNK ? end - CHUNK : 0;
+			libadt_bitwise_array_unpack(from, (ssize_t)start, (ssize_t)(end - start), chunk);
+			libadt_bitwise_array_pack(to, (ssize_t)start, (ssize_t)(end - start), chunk);
+			end = start;
+		}
+	}
+
+	vector->bits = bits;
+	vector->width = width;
+	vector->capacity = capacity;
+	if (vector->length > capacity)
+		vector->length = capacity;
+	return true;
+}
+
+struct libadt_packed_vector libadt_packed_vector_init_with_allocator(
+	int width,
+	size_t initial_capacity,
+	const struct libadt_allocator *allocator
+)
+{
+	if (width < 1 || width > (int)(sizeof(unsigned int) * CHAR_BIT))
+		return (struct libadt_packed_vector) { 0 };
+
+	struct libadt_packed_vector result = {
+		.bits = NULL,
+		.width = width,
+		.length = 0,
+		.capacity = 0,
+		.allocator = allocator,
+	};
+	if (initial_capacity && !resize(&result, width, initial_capacity))
+		return (struct libadt_packed_vector) { 0 };
+	return result;
+}
+
+struct libadt_packed_vector libadt_packed_vector_init(int width, size_t initial_capacity)
+{
+	return libadt_packed_vector_init_with_allocator(width, initial_capacity, NULL);
+}
+
+struct libadt_packed_vector libadt_packed_vector_free(struct libadt_packed_vector vector)
+{
+	libadt_allocator_deallocate(vector.allocator, vector.bits, buffer_bytes(vector));
+	return (struct libadt_packed_vector) { 0 };
+}
+
+static struct libadt_packed_vector append_grow(
+	struct libadt_packed_vector vector,
+	unsigned int value
+)
+{
+	const int width = libadt_packed_vector_fits(vector, value)
+		? vector.width
+		: libadt_packed_vector_width_for(value);
+	const size_t capacity = vector.length == vector.capacity
+		? grow_capacity(vector.capacity, vector.length + 1)
+		: vector.capacity;
+	if (!resize(&vector, width, capacity))
+		return vector;
+
+	libadt_packed_vector_store_last(
+		vector.bits,
+		(uint64_t)vector.length * (uint64_t)vector.width,
+		width,
+		value
+	);
+	vector.length++;
+	return vector;
+}
+
+void libadt_packed_vector_append_grow(struct libadt_packed_vector *vector, unsigned int value)
+{
+	*vector = append_grow(*vector, value);
+}
+
+struct libadt_packed_vector libadt_packed_vector_append_n(
+	struct libadt_packed_vector vector,
+	const unsigned int *values,
+	size_t number
+)
+{
+	if (number > (size_t)SSIZE_MAX - vector.length)
+		return vector;
+
+	unsigned int all = 0;
+	for (size_t i = 0; i < number; i++)
+		all |= values[i];
+
+	const int width = libadt_packed_vector_fits(vector, all)
+		? vector.width
+		: libadt_packed_vector_width_for(all);
+	const size_t
+		required = vector.length + number,
+		capacity = required > vector.capacity
+			? grow_capacity(vector.capacity, required)
+			: vector.capacity;
+	if (
+		(width != vector.width || capacity != vector.capacity)
+		&& !resize(&vector, width, capacity)
+	)
+		return vector;
+
+	libadt_bitwise_array_pack(
+		libadt_packed_vector_buffer(vector),
+		(ssize_t)vector.length,
+		(ssize_t)number,
+		values
+	);
+	vector.length += number;
+	return vector;
+}
+
+struct libadt_packed_vector libadt_packed_vector_reserve(
+	struct libadt_packed_vector vector,
+	size_t capacity
+)
+{
+	if (capacity > vector.capacity)
+		resize(&vector, vector.width, capacity);
+	return vector;
+}
+
+struct libadt_packed_vector libadt_packed_vector_vacuum(struct libadt_packed_vector vector)
+{
+	if (vector.length < vector.capacity)
+		resize(&vector, vector.width, vector.length);
+	return vector;
+}
@@ -0,0 +1,425 @@
+#include "libadt/parallel.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+
+// More chunks than threads lets fast threads take up the slack of
+// slow ones
+static const size_t chunks_per_thread = 4;
+
+typedef void task_function(size_t index, void *context);
+
+struct job {
+	task_function *task;
+	void *context;
+	size_t tasks;
+	atomic_size_t next;
+};
+
+static void *work(void *argument)
+{
+	struct job *const job = argument;
+	for (
+		size_t index;
+		(index = atomic_fetch_add_explicit(&job->next, 1, memory_order_relaxed)) < job->tasks;
+	)
+		job->task(index, job->context);
+	return NULL;
+}
+
+static void work_task(void *argument)
+{
+	work(argument);
+}
+
+// Runs every task, on up to _threads_ threads including the caller.
+// If threads can't be started, the caller does the rest itself.
+static void run(
+	size_t tasks,
+	task_function *task,
+	void *context,
+	unsigned int threads,
+	struct libadt_threadpool *pool
+)
+{
+	struct job job = { .task = task, .context = context, .tasks = tasks };
+	atomic_init(&job.next, 0);
+
+	const size_t helpers = tasks ? MIN(threads, tasks) - 1 : 0;
+
+	if (pool) {
+		struct libadt_threadpool_task *const spawned = helpers
+			? malloc(helpers * sizeof(*spawned))
+			: NULL;
+		struct libadt_threadpool_group group = LIBADT_THREADPOOL_GROUP_INIT;
+		if (spawned) {
+			for (size_t i = 0; i < helpers; i++)
+				spawned[i] = (struct libadt_threadpool_task) {
+					.function = work_task,
+					.context = &job,
+				};
+			libadt_threadpool_spawn_n(pool, &group, spawned, helpers);
+		}
+		work(&job);
+		libadt_threadpool_wait(pool, &group);
+		free(spawned);
+		return;
+	}
+
+	pthread_t *const ids = helpers ? malloc(helpers * sizeof(*ids)) : NULL;
+	size_t started = 0;
+	if (ids)
+		while (started < helpers && !pthread_create(&ids[started], NULL, work, &job))
+			started++;
+
+	work(&job);
+
+	for (size_t i = 0; i < started; i++)
+		pthread_join(ids[i], NULL);
+	free(ids);
+}
+
+static unsigned int thread_count(const struct libadt_parallel *parallel)
+{
+	if (parallel && parallel->threads)
+		return parallel->threads;
+	if (parallel && parallel->pool)
+		return libadt_threadpool_threads(parallel->pool) + 1;
+	const long online = sysconf(_SC_NPROCESSORS_ONLN);
+	return online > 0 ? (unsigned int)online : 1;
+}
+
+static bool serial(struct libadt_lptr lptr, const struct libadt_parallel *parallel)
+{
+	const size_t threshold = parallel && parallel->serial_bytes
+		? parallel->serial_bytes
+		: LIBADT_PARALLEL_SERIAL_BYTES;
+	return thread_count(parallel) <= 1
+		|| lptr.length <= 1
+		|| (size_t)libadt_const_lptr_size(libadt_const_lptr(lptr)) < threshold;
+}
+
+static size_t gcd(size_t a, size_t b)
+{
+	while (b) {
+		const size_t remainder = a % b;
+		a = b;
+		b = remainder;
+	}
+	return a;
+}
+
+struct chunks {
+	struct libadt_lptr lptr;
+	size_t length;
+	size_t count;
+};
+
+// Splits lptr into about _target_ chunks, each a whole number of
+// cache lines long
+static struct chunks split(struct libadt_lptr lptr, size_t target)
+{
+	const size_t
+		length = (size_t)lptr.length,
+		align = LIBADT_PARALLEL_CACHE_LINE / gcd((size_t)lptr.size, LIBADT_PARALLEL_CACHE_LINE),
+		chunk = (length + target - 1) / target,
+		aligned = MAX((chunk + align - 1) / align * align, 1);
+
+	return (struct chunks) {
+		.lptr = lptr,
+		.length = aligned,
+		.count = (length + aligned - 1) / aligned,
+	};
+}
+
+static struct libadt_lptr chunk_at(struct chunks chunks, size_t index)
+{
+	const size_t start = index * chunks.length;
+	return libadt_lptr_truncate(
+		libadt_lptr_index(chunks.lptr, (ssize_t)start),
+		MIN(chunks.length, (size_t)chunks.lptr.length - start)
+	);
+}
+
+struct for_context {
+	struct chunks chunks;
+	libadt_parallel_body *body;
+	void *context;
+};
+
+static struct libadt_threadpool *pool_of(const struct libadt_parallel *parallel)
+{
+	return parallel ? parallel->pool : NULL;
+}
+
+static void for_task(size_t index, void *argument)
+{
+	const struct for_context *const context = argument;
+	context->body(
+		chunk_at(context->chunks, index),
+		index * context->chunks.length,
+		context->context
+	);
+}
+
+void libadt_parallel_for(
+	struct libadt_lptr lptr,
+	libadt_parallel_body *body,
+	void *context,
+	const struct libadt_parallel *parallel
+)
+{
+	if (serial(lptr, parallel)) {
+		body(lptr, 0, context);
+		return;
+	}
+
+	const unsigned int threads = thread_count(parallel);
+	struct for_context for_context = {
+		.chunks = split(lptr, threads * chunks_per_thread),
+		.body = body,
+		.context = context,
+	};
+	run(for_context.chunks.count, for_task, &for_context, threads, pool_of(parallel));
+}
+
+struct reduce_context {
+	struct chunks chunks;
+	const void *identity;
+	size_t size;
+	unsigned char *accumulators;
+	size_t stride;
+	libadt_parallel_fold *fold;
+	void *context;
+};
+
+static void reduce_task(size_t index, void *argument)
+{
+	const struct reduce_context *const context = argument;
+	void *const accumulator = context->accumulators + index * context->stride;
+	memcpy(accumulator, context->identity, context->size);
+	context->fold(accumulator, chunk_at(context->chunks, index), context->context);
+}
+
+void libadt_parallel_reduce(
+	struct libadt_lptr lptr,
+	struct libadt_lptr accumulator,
+	libadt_parallel_fold *fold,
+	libadt_parallel_combine *combine,
+	void *context,
+	const struct libadt_parallel *parallel
+)
+{
+	if (serial(lptr, parallel)) {
+		fold(accumulator.buffer, lptr, context);
+		return;
+	}
+
+	const unsigned int threads = thread_count(parallel);
+	const size_t
+		size = (size_t)accumulator.size,
+		// Each accumulator gets its own cache lines
+		stride = (size + LIBADT_PARALLEL_CACHE_LINE - 1)
+			/ LIBADT_PARALLEL_CACHE_LINE * LIBADT_PARALLEL_CACHE_LINE;
+	struct reduce_context reduce_context = {
+		.chunks = split(lptr, threads * chunks_per_thread),
+		.identity = accumulator.buffer,
+		.size = size,
+		.stride = stride,
+		.fold = fold,
+		.context = context,
+	};
+	reduce_context.accumulators = aligned_alloc(
+		LIBADT_PARALLEL_CACHE_LINE,
+		reduce_context.chunks.count * stride
+	);
+	if (!reduce_context.accumulators) {
+		fold(accumulator.buffer, lptr, context);
+		return;
+	}
+
+	run(reduce_context.chunks.count, reduce_task, &reduce_context, threads, pool_of(parallel));
+
+	for (size_t i = 0; i < reduce_context.chunks.count; i++)
+		combine(accumulator.buffer, reduce_context.accumulators + i * stride, context);
+	free(reduce_context.accumulators);
+}
+
+struct sort_context {
+	struct chunks chunks;
+	struct chunks scratch;
+	libadt_sort_compare *compare;
+
+	// The current merge round
+	const unsigned char *from;
+	unsigned char *to;
+	size_t size;
+	size_t length;
+	size_t width;
+	size_t pieces;
+};
+
+static void sort_task(size_t index, void *argument)
+{
+	const struct sort_context *const context = argument;
+	libadt_sort_stable(
+		chunk_at(context->chunks, index),
+		chunk_at(context->scratch, index),
+		context->compare
+	);
+}
+
+// Returns how many of the first _rank_ elements of the merge of left
+// and right come from left. Ties go to left, as in a stable merge.
+static size_t co_rank(
+	size_t rank,
+	const unsigned char *left,
+	size_t left_length,
+	const unsigned char *right,
+	size_t right_length,
+	size_t size,
+	libadt_sort_compare *compare
+)
+{
+	size_t
+		low = rank > right_length ? rank - right_length : 0,
+		high = MIN(rank, left_length);
+	while (low < high) {
+		const size_t i = low + (high - low) / 2, j = rank - i;
+		if (compare(right + (j - 1) * size, left + i * size) >= 0)
+			low = i + 1;
+		else
+			high = i;
+	}
+	return low;
+}
+
+static void merge(
+	const unsigned char *left,
+	const unsigned char *left_end,
+	const unsigned char *right,
+	const unsigned char *right_end,
+	unsigned char *out,
+	size_t size,
+	libadt_sort_compare *compare
+)
+{
+	while (left < left_end && right < right_end) {
+		if (compare(right, left) < 0) {
+			memcpy(out, right, size);
+			right += size;
+		} else {
+			memcpy(out, left, size);
+			left += size;
+		}
+		out += size;
+	}
+	memcpy(out, left, (size_t)(left_end - left));
+	out += left_end - left;
+	memcpy(out, right, (size_t)(right_end - right));
+}
+
+// Merges one piece of the output of one pair of runs
+static void merge_task(size_t index, void *argument)
+{
+	const struct sort_context *const context = argument;
+	const size_t
+		size = context->size,
+		pair = index / context->pieces,
+		piece = index % context->pieces,
+		start = pair * 2 * context->width,
+		middle = MIN(start + context->width, context->length),
+		end = MIN(middle + context->width, context->length),
+		output = end - start,
+		share = output / context->pieces,
+		extra = output % context->pieces,
+		first = share * piece + MIN(piece, extra),
+		last = first + share + (piece < extra);
+
+	const unsigned char
+		*const left = context->from + start * size,
+		*const right = context->from + middle * size;
+	const size_t
+		left_length = middle - start,
+		right_length = end - middle,
+		left_first = co_rank(first, left, left_length, right, right_length, size, context->compare),
+		left_last = co_rank(last, left, left_length, right, right_length, size, context->compare);
+
+	merge(
+		left + left_first * size,
+		left + left_last * size,
+		right + (first - left_first) * size,
+		right + (last - left_last) * size,
+		context->to + (start + first) * size,
+		size,
+		context->compare
+	);
+}
+
+static void copy_task(size_t index, void *argument)
+{
+	const struct sort_context *const context = argument;
+	const struct libadt_lptr destination = chunk_at(context->chunks, index);
+	memcpy(
+		destination.buffer,
+		chunk_at(context->scratch, index).buffer,
+		(size_t)libadt_const_lptr_size(libadt_const_lptr(destination))
+	);
+}
+
+bool libadt_parallel_sort(
+	struct libadt_lptr lptr,
+	struct libadt_lptr scratch,
+	libadt_sort_compare *compare,
+	const struct libadt_parallel *parallel
+)
+{
+	if (lptr.length < 0 || lptr.size <= 0)
+		return false;
+	if (
+		libadt_const_lptr_size(libadt_const_lptr(scratch))
+		< libadt_const_lptr_size(libadt_const_lptr(lptr))
+	)
+		return false;
+	if (serial(lptr, parallel))
+		return libadt_sort_stable(lptr, scratch, compare);
+
+	const unsigned int threads = thread_count(parallel);
+	scratch.size = lptr.size;
+	scratch.length = lptr.length;
+	struct sort_context context = {
+		.chunks = split(lptr, threads),
+		.compare = compare,
+		.size = (size_t)lptr.size,
+		.length = (size_t)lptr.length,
+	};
+	context.scratch = context.chunks;
+	context.scratch.lptr = scratch;
+
+	run(context.chunks.count, sort_task, &context, threads, pool_of(parallel));
+
+	unsigned char *from = lptr.buffer, *to = scratch.buffer;
+	for (size_t width = context.chunks.length; width < context.length; width *= 2) {
+		const size_t pairs = (context.length + 2 * width - 1) / (2 * width);
+		context.from = from;
+		context.to = to;
+		context.width = width;
+		context.pieces = MAX(threads / pairs, 1);
+		run(pairs * context.pieces, merge_task, &context, threads, pool_of(parallel));
+
+		unsigned char *const swap = from;
+		from = to;
+		to = swap;
+	}
+
+	if (from != lptr.buffer)
+		run(context.chunks.count, copy_task, &context, threads, pool_of(parallel));
+	return true;
+}
@@ -0,0 +1,209 @@
+#include "libadt/pool.h"
+
+#include <stdlib.h>
+
+bool libadt_pool_valid(struct libadt_pool pool);
+struct libadt_pool_slab *libadt_pool_slab(
+	const struct libadt_pool *pool,
+	void *slot
+);
+struct libadt_lptr libadt_pool_alloc(struct libadt_pool *pool);
+struct libadt_lptr libadt_pool_calloc(struct libadt_pool *pool);
+struct libadt_lptr libadt_pool_free(
+	struct libadt_pool *pool,
+	struct libadt_lptr lptr
+);
+
+// Slabs are at least this large, and hold at least min_slots slots
+static const size_t min_slab_size = 1 << 16;
+static const size_t min_slots = 16;
+
+// The default for libadt_pool.max_empty
+static const size_t default_max_empty = 4;
+
+// The slots start after the slab header, aligned for any type
+static size_t slab_header_size(void)
+{
+	const size_t alignment = _Alignof(max_align_t);
+	return (sizeof(struct libadt_pool_slab) + alignment - 1) & ~(alignment - 1);
+}
+
+static unsigned char *slab_slots(struct libadt_pool_slab *slab)
+{
+	return (unsigned char *)slab + slab_header_size();
+}
+
+static bool slab_full(struct libadt_pool_slab *slab)
+{
+	return !slab->free && slab->fresh == slab->end;
+}
+
+static void unlink_slab(struct libadt_pool *pool, struct libadt_pool_slab *slab)
+{
+	if (slab->prev)
+		slab->prev->next = slab->next;
+	else
+		pool->head = slab->next;
+
+	if (slab->next)
+		slab->next->prev = slab->prev;
+	else
+		pool->tail = slab->prev;
+
+	slab->prev = slab->next = NULL;
+}
+
+static void push_front(struct libadt_pool *pool, struct libadt_pool_slab *slab)
+{
+	slab->prev = NULL;
+	slab->next = pool->head;
+	if (pool->head)
+		pool->head->prev = slab;
+	else
+		pool->tail = slab;
+	pool->head = slab;
+}
+
+static void push_back(struct libadt_pool *pool, struct libadt_pool_slab *slab)
+{
+	slab->next = NULL;
+	slab->prev = pool->tail;
+	if (pool->tail)
+		pool->tail->next = slab;
+	else
+		pool->head = slab;
+	pool->tail = slab;
+}
+
+/*
+ * The slab list is kept as the head slab, in any state, followed by
+ * slabs with free slots, followed by full slabs. The head is only
+ * moved to the back once an allocation finds it full, which keeps
+ * the inline fast paths free of list manipulation.
+ */
+
+void *libadt_pool_grow(struct libadt_pool *pool)
+{
+	struct libadt_pool_slab *slab = pool->head;
+
+	if (slab && slab != pool->tail) {
+		unlink_slab(pool, slab);
+		push_back(pool, slab);
+		slab = pool->head;
+		if (!slab->used)
+			pool->empty--;
+	}
+
+	if (!slab || slab_full(slab)) {
+		slab = aligned_alloc(pool->slab_size, pool->slab_size);
+		if (!slab)
+			return NULL;
+
+		*slab = (struct libadt_pool_slab) {
+			.fresh = slab_slots(slab),
+			.end = slab_slots(slab) + pool->slots * pool->slot_size,
+		};
+		push_front(pool, slab);
+	}
+
+	void *slot;
+	if (slab->free) {
+		slot = slab->free;
+		slab->free = *(void **)slot;
+	} else {
+		slot = slab->fresh;
+		slab->fresh += pool->slot_size;
+	}
+	slab->used++;
+	return slot;
+}
+
+// Releases or keeps a slab that is empty and no longer the head
+static void retire(struct libadt_pool *pool, struct libadt_pool_slab *slab)
+{
+	if (pool->empty >= pool->max_empty) {
+		unlink_slab(pool, slab);
+		free(slab);
+	} else {
+		pool->empty++;
+	}
+}
+
+void libadt_pool_rebalance(struct libadt_pool *pool, struct libadt_pool_slab *slab)
+{
+	struct libadt_pool_slab *const head = pool->head;
+
+	// The head is never released, so a pool alternating between
+	// allocating and freeing a single object never hits the system
+	if (slab == head)
+		return;
+
+	if (!slab->used) {
+		retire(pool, slab);
+		return;
+	}
+
+	if (slab->used != pool->slots - 1)
+		return;
+
+	// A full slab has just had a slot freed, so it goes to the front
+	unlink_slab(pool, slab);
+	push_front(pool, slab);
+
+	if (slab_full(head)) {
+		unlink_slab(pool, head);
+		push_back(pool, head);
+	} else if (!head->used) {
+		retire(pool, head);
+	}
+}
+
+struct libadt_pool libadt_pool_init(size_t size)
+{
+	if (!size || size > SSIZE_MAX)
+		return (struct libadt_pool) { 0 };
+
+	// Every slot is aligned for any type, as malloc() memory is
+	const size_t
+		header = slab_header_size(),
+		alignment = _Alignof(max_align_t),
+		slot_size = (size + alignment - 1) & ~(alignment - 1);
+
+	if (slot_size < size || slot_size > (SIZE_MAX / 2 - header) / min_slots)
+		return (struct libadt_pool) { 0 };
+
+	size_t slab_size = min_slab_size;
+	while (slab_size < header + min_slots * slot_size)
+		slab_size *= 2;
+
+	return (struct libadt_pool) {
+		.size = size,
+		.slot_size = slot_size,
+		.slab_size = slab_size,
+		.slots = (slab_size - header) / slot_size,
+		.max_empty = default_max_empty,
+	};
+}
+
+void libadt_pool_trim(struct libadt_pool *pool)
+{
+	for (struct libadt_pool_slab *slab = pool->head; slab;) {
+		struct libadt_pool_slab *next = slab->next;
+		if (slab != pool->head && !slab->used) {
+			unlink_slab(pool, slab);
+			free(slab);
+		}
+		slab = next;
+	}
+	pool->empty = 0;
+}
+
+struct libadt_pool libadt_pool_destroy(struct libadt_pool pool)
+{
+	for (struct libadt_pool_slab *slab = pool.head; slab;) {
+		struct libadt_pool_slab *next = slab->next;
+		free(slab);
+		slab = next;
+	}
+	return (struct libadt_pool) { 0 };
+}
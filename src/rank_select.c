@@ -0,0 +1,232 @@
+#include "libadt/rank_select.h"
+
+#include <limits.h>
+
+#define BLOCK LIBADT_RANK_SELECT_BLOCK
+#define SUPERBLOCK LIBADT_RANK_SELECT_SUPERBLOCK
+#define SAMPLE LIBADT_RANK_SELECT_SAMPLE
+#define WORDS_PER_BLOCK (BLOCK / 64)
+#define BLOCKS_PER_SUPERBLOCK (SUPERBLOCK / BLOCK)
+
+_Static_assert(
+	SUPERBLOCK <= UINT16_MAX + 1,
+	"block counts must fit in 16 bits"
+);
+
+uint64_t libadt_rank_select_word(
+	const struct libadt_rank_select *index,
+	size_t word
+);
+unsigned int libadt_rank_select_popcount(uint64_t word);
+size_t libadt_rank_select_rank(
+	const struct libadt_rank_select *index,
+	ssize_t position
+);
+size_t libadt_rank_select_rank0(
+	const struct libadt_rank_select *index,
+	ssize_t position
+);
+
+// The number of entries in each table of an index over length bits.
+// Ranks are kept for the position at the end as well, and samples
+// of count ones or zeros have an extra block at the end to bound the
+// last search.
+static size_t superblocks_for(size_t length)
+{
+	return length / SUPERBLOCK + 1;
+}
+
+static size_t blocks_for(size_t length)
+{
+	return length / BLOCK + 1;
+}
+
+static size_t samples_for(size_t count)
+{
+	return count / SAMPLE + 2;
+}
+
+// The ones, or zeros, before a block
+static size_t block_rank(const struct libadt_rank_select *index, size_t block, bool one)
+{
+	const size_t ones = index->superblocks[block / BLOCKS_PER_SUPERBLOCK] + index->blocks[block];
+	if (one)
+		return ones;
+	const size_t start = block * BLOCK, length = (size_t)index->array.length;
+	return (start < length ? start : length) - ones;
+}
+
+struct libadt_rank_select libadt_rank_select_init_with_allocator(
+	struct libadt_bitwise_array array,
+	const struct libadt_allocator *allocator
+)
+{
+	if (array.width != 1 || array.length < 0 || !array.bits)
+		return (struct libadt_rank_select) { 0 };
+
+	const size_t length = (size_t)array.length;
+	struct libadt_rank_select result = {
+		.array = array,
+		.ones = 0,
+		.superblocks = libadt_allocator_allocate(
+			allocator,
+			superblocks_for(length) * sizeof(uint64_t)
+		),
+		.blocks = libadt_allocator_allocate(allocator, blocks_for(length) * sizeof(uint16_t)),
+		.last = 0,
+		.allocator = allocator,
+	};
+	if (!result.superblocks || !result.blocks)
+		return libadt_rank_select_free(result);
+
+	// Gathered a byte at a time, as a whole word may not be allocated
+	const size_t whole = length / 64;
+	if (length % 64) {
+		for (size_t byte = 0; byte * CHAR_BIT < length % 64; byte++)
+			result.last |= (uint64_t)array.bits[whole * 8 + byte] << (56 - 8 * byte);
+		result.last &= ~(uint64_t)0 << (64 - length % 64);
+	}
+
+	const size_t blocks = blocks_for(length);
+	size_t ones = 0, superblock_ones = 0;
+	for (size_t block = 0; block < blocks; block++) {
+		if (!(block % BLOCKS_PER_SUPERBLOCK)) {
+			result.superblocks[block / BLOCKS_PER_SUPERBLOCK] = ones;
+			superblock_ones = ones;
+		}
+		result.blocks[block] = (uint16_t)(ones - superblock_ones);
+
+		const size_t end = (block + 1) * BLOCK < length ? (block + 1) * BLOCK : length;
+		for (size_t word = block * WORDS_PER_BLOCK; word * 64 < end; word++)
+			ones += libadt_rank_select_popcount(libadt_rank_select_word(&result, word));
+	}
+	result.ones = ones;
+
+	// The samples are sized by the number of ones and zeros, so
+	// they take one entry per SAMPLE bits in all
+	result.ones_samples = libadt_allocator_allocate(allocator, samples_for(ones) * sizeof(size_t));
+	result.zeros_samples = libadt_allocator_allocate(
+		allocator,
+		samples_for(length - ones) * sizeof(size_t)
+	);
+	if (!result.ones_samples || !result.zeros_samples)
+		return libadt_rank_select_free(result);
+
+	// Sample n is the block holding the (n * SAMPLE)th one or zero
+	size_t ones_sampled = 0, zeros_sampled = 0;
+	for (size_t block = 0; block < blocks; block++) {
+		const size_t
+			ones_to = block + 1 < blocks ? block_rank(&result, block + 1, true) : ones,
+			end = (block + 1) * BLOCK < length ? (block + 1) * BLOCK : length;
+		for (; ones_sampled * SAMPLE < ones_to; ones_sampled++)
+			result.ones_samples[ones_sampled] = block;
+		for (; zeros_sampled * SAMPLE < end - ones_to; zeros_sampled++)
+			result.zeros_samples[zeros_sampled] = block;
+	}
+	result.ones_samples[ones_sampled] = blocks - 1;
+	result.zeros_samples[zeros_sampled] = blocks - 1;
+	return result;
+}
+
+struct libadt_rank_select libadt_rank_select_init(struct libadt_bitwise_array array)
+{
+	return libadt_rank_select_init_with_allocator(array, NULL);
+}
+
+struct libadt_rank_select libadt_rank_select_free(struct libadt_rank_select index)
+{
+	const size_t length = (size_t)index.array.length;
+	const struct libadt_allocator *const allocator = index.allocator;
+	libadt_allocator_deallocate(
+		allocator,
+		index.superblocks,
+		superblocks_for(length) * sizeof(uint64_t)
+	);
+	libadt_allocator_deallocate(allocator, index.blocks, blocks_for(length) * sizeof(uint16_t));
+	libadt_allocator_deallocate(allocator, index.ones_samples, samples_for(index.ones) * sizeof(size_t));
+	libadt_allocator_deallocate(
+		allocator,
+		index.zeros_samples,
+		samples_for(length - index.ones) * sizeof(size_t)
+	);
+	return (struct libadt_rank_select) { 0 };
+}
+
+bool libadt_rank_select_valid(struct libadt_rank_select index)
+{
+	return index.superblocks != NULL;
+}
+
+// The position of the nth set bit of word, counting from the highest
+static unsigned int select_in_word(uint64_t word, unsigned int n)
+{
+	// Count from the lowest instead, where the arithmetic is simpler
+	n = libadt_rank_select_popcount(word) - 1 - n;
+
+	// Sum the ones in each byte, and in each byte and those below it
+	const uint64_t
+		ones = 0x0101010101010101u,
+		highs = 0x8080808080808080u;
+	uint64_t counts = word - ((word >> 1) & 0x5555555555555555u);
+	counts = (counts & 0x3333333333333333u) + ((counts >> 2) & 0x3333333333333333u);
+	counts = (counts + (counts >> 4)) & 0x0f0f0f0f0f0f0f0fu;
+	const uint64_t prefixes = counts * ones;
+
+	// The bytes whose prefix sum is at most n come before the one
+	// holding the bit
+	const unsigned int byte = libadt_rank_select_popcount(
+		(((n * ones) | highs) - prefixes) & highs
+	);
+	unsigned int bits = (unsigned int)(word >> (8 * byte)) & 0xff;
+	for (n -= byte ? (unsigned int)(prefixes >> (8 * byte - 8)) & 0xff : 0; n; n--)
+		bits &= bits - 1;
+
+#ifdef __GNUC__
+	return 63 - (8 * byte + (unsigned int)__builtin_ctz(bits));
+#else
+	unsigned int bit = 8 * byte;
+	for (; !(bits & 1); bits >>= 1)
+		bit++;
+	return 63 - bit;
+#endif
+}
+
+static ssize_t find(const struct libadt_rank_select *index, size_t n, bool one)
+{
+	const size_t total = one ? index->ones : (size_t)index->array.length - index->ones;
+	if (n >= total)
+		return -1;
+
+	// The last block with at most n before it, between the samples
+	// either side of n, written to compile to conditional moves as
+	// the comparisons are unpredictable
+	const size_t *const samples = one ? index->ones_samples : index->zeros_samples;
+	size_t low = samples[n / SAMPLE], high = samples[n / SAMPLE + 1];
+	while (low < high) {
+		const size_t middle = high - (high - low) / 2;
+		const bool before = block_rank(index, middle, one) <= n;
+		low = before ? middle : low;
+		high = before ? high : middle - 1;
+	}
+
+	n -= block_rank(index, low, one);
+	for (size_t word = low * WORDS_PER_BLOCK;; word++) {
+		uint64_t bits = libadt_rank_select_word(index, word);
+		if (!one)
+			bits = ~bits;
+		const unsigned int count = libadt_rank_select_popcount(bits);
+		if (n < count)
+			return (ssize_t)(word * 64 + select_in_word(bits, (unsigned int)n));
+		n -= count;
+	}
+}
+
+ssize_t libadt_rank_select_select(const struct libadt_rank_select *index, size_t n)
+{
+	return find(index, n, true);
+}
+
+ssize_t libadt_rank_select_select0(const struct libadt_rank_select *index, size_t n)
+{
+	return find(index, n, false);
+}
@@ -0,0 +1,212 @@
+#include "libadt/reader.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+
+struct libadt_const_lptr libadt_reader_next_record(
+	struct libadt_reader *reader,
+	char delimiter
+);
+struct libadt_const_lptr libadt_reader_next_line(struct libadt_reader *reader);
+
+static const struct libadt_const_lptr none = { NULL, 1, 0 };
+
+struct libadt_reader libadt_reader_init_with_allocator(
+	int fd,
+	size_t capacity,
+	const struct libadt_allocator *allocator
+)
+{
+	if (!capacity)
+		capacity = LIBADT_READER_DEFAULT_CAPACITY;
+	void *const buffer = capacity <= SSIZE_MAX
+		? libadt_allocator_allocate(allocator, capacity)
+		: NULL;
+	if (!buffer)
+		return (struct libadt_reader) { 0 };
+
+	return (struct libadt_reader) {
+		.fd = fd,
+		.buffer = { buffer, 1, (ssize_t)capacity },
+		.start = 0,
+		.end = 0,
+		.scanned = 0,
+		.window = 0,
+		.mask = 0,
+		.delimiter = 0,
+		.eof = false,
+		.error = 0,
+		.allocator = allocator,
+	};
+}
+
+struct libadt_reader libadt_reader_init(int fd, size_t capacity)
+{
+	return libadt_reader_init_with_allocator(fd, capacity, NULL);
+}
+
+struct libadt_reader libadt_reader_free(struct libadt_reader reader)
+{
+	libadt_allocator_deallocate(
+		reader.allocator,
+		reader.buffer.buffer,
+		(size_t)reader.buffer.length
+	);
+	return (struct libadt_reader) { 0 };
+}
+
+bool libadt_reader_valid(struct libadt_reader reader)
+{
+	return libadt_lptr_allocated(reader.buffer);
+}
+
+// Makes room at the end of the buffer: by moving the unreturned bytes
+// to the front if that leaves at least half of it free, or else by
+// doubling it once full
+static bool make_room(struct libadt_reader *reader)
+{
+	const size_t capacity = (size_t)reader->buffer.length;
+	if (reader->start == reader->end) {
+		reader->start = reader->end = reader->scanned = reader->window = 0;
+		reader->mask = 0;
+	} else if (capacity - reader->end < capacity / 2 && reader->end - reader->start <= capacity / 2) {
+		// Delimiters before start have been returned
+		if (reader->window < reader->start) {
+			const size_t shift = reader->start - reader->window;
+			reader->mask = shift < 64 ? reader->mask >> shift : 0;
+			reader->window = reader->start;
+		}
+		if (reader->scanned < reader->start)
+			reader->scanned = reader->start;
+		libadt_lptr_memmove(
+			reader->buffer,
+			(struct libadt_const_lptr) {
+				(char *)reader->buffer.buffer + reader->start,
+				1,
+				(ssize_t)(reader->end - reader->start),
+			}
+		);
+		reader->end -= reader->start;
+		reader->scanned -= reader->start;
+		reader->window -= reader->start;
+		reader->start = 0;
+	}
+	if (reader->end < capacity)
+		return true;
+
+	void *const buffer = capacity <= SSIZE_MAX / 2
+		? libadt_allocator_reallocate(reader->allocator, reader->buffer.buffer, capacity, capacity * 2)
+		: NULL;
+	if (!buffer) {
+		reader->error = ENOMEM;
+		return false;
+	}
+	reader->buffer = (struct libadt_lptr) { buffer, 1, (ssize_t)(capacity * 2) };
+	return true;
+}
+
+// Reads more input, returning false at the end of it or on an error
+static bool fill(struct libadt_reader *reader)
+{
+	if (reader->eof || reader->error || !make_room(reader))
+		return false;
+
+	for (;;) {
+		const ssize_t got = read(
+			reader->fd,
+			(char *)reader->buffer.buffer + reader->end,
+			(size_t)reader->buffer.length - reader->end
+		);
+		if (got > 0) {
+			reader->end += (size_t)got;
+			return true;
+		}
+		if (!got) {
+			reader->eof = true;
+			return false;
+		}
+		if (errno != EINTR) {
+			reader->error = errno;
+			return false;
+		}
+	}
+}
+
+// Returns the next length unreturned bytes, moving past them and the
+// skip bytes after them
+static struct libadt_const_lptr take(struct libadt_reader *reader, size_t length, size_t skip)
+{
+	const struct libadt_const_lptr result = {
+		(char *)reader->buffer.buffer + reader->start,
+		1,
+		(ssize_t)length,
+	};
+	reader->start += length + skip;
+	return result;
+}
+
+struct libadt_const_lptr libadt_reader_next_record_slow(
+	struct libadt_reader *reader,
+	char delimiter
+)
+{
+	if (!libadt_reader_valid(*reader))
+		return none;
+
+	// Rescan after a change of delimiter or libadt_reader_next_bytes()
+	if (delimiter != reader->delimiter || reader->scanned < reader->start) {
+		reader->delimiter = delimiter;
+		reader->scanned = reader->window = reader->start;
+		reader->mask = 0;
+	}
+
+	do {
+		const char *const buffer = reader->buffer.buffer;
+		for (;;) {
+			while (reader->mask) {
+				const size_t found = reader->window + libadt_str_lowest(reader->mask);
+				reader->mask &= reader->mask - 1;
+				if (found >= reader->start)
+					return take(reader, found - reader->start, 1);
+			}
+			if (reader->scanned == reader->end)
+				break;
+
+			const char *window = buffer + reader->scanned;
+			reader->mask = libadt_str_split_scan(
+				&window,
+				buffer + reader->end,
+				LIBADT_STR_SPLIT_BYTE,
+				delimiter,
+				NULL,
+				0
+			);
+			reader->window = (size_t)(window - buffer);
+			reader->scanned = reader->end - reader->window < 64
+				? reader->end
+				: reader->window + 64;
+		}
+	} while (fill(reader));
+
+	// The last record can end without a delimiter
+	if (reader->error || reader->start == reader->end)
+		return none;
+	return take(reader, reader->end - reader->start, 0);
+}
+
+struct libadt_const_lptr libadt_reader_next_bytes(
+	struct libadt_reader *reader,
+	size_t size
+)
+{
+	if (!libadt_reader_valid(*reader))
+		return none;
+
+	while (reader->end - reader->start < size && fill(reader));
+
+	const size_t available = reader->end - reader->start;
+	if (reader->error || !available)
+		return none;
+	return take(reader, available < size ? available : size, 0);
+}
@@ -0,0 +1,207 @@
+#include "libadt/segmented_vector.h"
+
+bool libadt_segmented_vector_valid(struct libadt_segmented_vector vector);
+bool libadt_segmented_vector_identity(
+	struct libadt_segmented_vector first,
+	struct libadt_segmented_vector second
+);
+unsigned int libadt_segmented_vector_msb(size_t value);
+void *libadt_segmented_vector_index(
+	struct libadt_segmented_vector vector,
+	size_t index
+);
+struct libadt_lptr libadt_segmented_vector_segment(
+	struct libadt_segmented_vector vector,
+	size_t index
+);
+struct libadt_segmented_vector libadt_segmented_vector_append(
+	struct libadt_segmented_vector vector,
+	const void *data
+);
+
+#define DEFAULT_FIRST_BLOCK 16
+
+// The most blocks a vector can have: enough to hold SIZE_MAX elements
+static size_t max_blocks(struct libadt_segmented_vector vector)
+{
+	return sizeof(size_t) * CHAR_BIT - vector.shift;
+}
+
+static size_t block_length(struct libadt_segmented_vector vector, size_t block)
+{
+	return (size_t)1 << (vector.shift + block);
+}
+
+// The number of blocks needed to hold length elements
+static size_t blocks_for(struct libadt_segmented_vector vector, size_t length)
+{
+	if (!length)
+		return 0;
+	return libadt_segmented_vector_msb((length - 1) + ((size_t)1 << vector.shift))
+		- vector.shift + 1;
+}
+
+static size_t block_count(struct libadt_segmented_vector vector)
+{
+	return blocks_for(vector, vector.capacity);
+}
+
+struct libadt_segmented_vector libadt_segmented_vector_init_with_allocator(
+	size_t size,
+	size_t first_block,
+	const struct libadt_allocator *allocator
+)
+{
+	if (!first_block)
+		first_block = DEFAULT_FIRST_BLOCK;
+	if (first_block > SIZE_MAX / 2)
+		return (struct libadt_segmented_vector) { 0 };
+
+	unsigned int shift = 0;
+	while (((size_t)1 << shift) < first_block)
+		shift++;
+
+	return (struct libadt_segmented_vector) {
+		.blocks = NULL,
+		.size = size,
+		.length = 0,
+		.capacity = 0,
+		.shift = shift,
+		.allocator = allocator,
+	};
+}
+
+struct libadt_segmented_vector libadt_segmented_vector_init(
+	size_t size,
+	size_t first_block
+)
+{
+	return libadt_segmented_vector_init_with_allocator(size, first_block, NULL);
+}
+
+// Frees the blocks from block onwards, and the table if none remain
+static struct libadt_segmented_vector free_blocks_from(
+	struct libadt_segmented_vector vector,
+	size_t block
+)
+{
+	for (size_t i = block_count(vector); i-- > block;) {
+		libadt_allocator_deallocate(
+			vector.allocator,
+			vector.blocks[i],
+			block_length(vector, i) * vector.size
+		);
+		vector.blocks[i] = NULL;
+		vector.capacity -= block_length(vector, i);
+	}
+
+	if (!block && vector.blocks) {
+		libadt_allocator_deallocate(
+			vector.allocator,
+			vector.blocks,
+			max_blocks(vector) * sizeof(*vector.blocks)
+		);
+		vector.blocks = NULL;
+	}
+
+	return vector;
+}
+
+struct libadt_segmented_vector libadt_segmented_vector_free(
+	struct libadt_segmented_vector vector
+)
+{
+	free_blocks_from(vector, 0);
+	return (struct libadt_segmented_vector) { 0 };
+}
+
+static struct libadt_segmented_vector reserve(
+	struct libadt_segmented_vector vector,
+	size_t capacity
+)
+{
+	const struct libadt_segmented_vector old = vector;
+
+	if (!vector.blocks) {
+		vector.blocks = libadt_allocator_allocate(
+			vector.allocator,
+			max_blocks(vector) * sizeof(*vector.blocks)
+		);
+		if (!vector.blocks)
+			return old;
+	}
+
+	for (size_t block = block_count(vector); vector.capacity < capacity; block++) {
+		const size_t length = block_length(vector, block);
+		void *buffer = NULL;
+
+		if (vector.size && length <= SIZE_MAX / vector.size)
+			buffer = libadt_allocator_allocate(vector.allocator, length * vector.size);
+		if (!buffer) {
+			// Also frees the table, if it was only just allocated
+			free_blocks_from(vector, block_count(old));
+			return old;
+		}
+
+		vector.blocks[block] = buffer;
+		vector.capacity += length;
+	}
+
+	return vector;
+}
+
+struct libadt_segmented_vector libadt_segmented_vector_append_n(
+	struct libadt_segmented_vector vector,
+	const void *data,
+	size_t number
+)
+{
+	if (number > SIZE_MAX - vector.length - ((size_t)1 << vector.shift))
+		return vector;
+
+	if (vector.length + number > vector.capacity) {
+		const struct libadt_segmented_vector
+			new = reserve(vector, vector.length + number);
+
+		if (libadt_segmented_vector_identity(new, vector))
+			return vector;
+		vector = new;
+	}
+
+	// Copy block by block
+	const char *source = data;
+	while (number) {
+		const size_t
+			position = vector.length + ((size_t)1 << vector.shift),
+			left_in_block = ((size_t)2 << libadt_segmented_vector_msb(position)) - position,
+			count = number < left_in_block ? number : left_in_block;
+
+		memcpy(
+			libadt_segmented_vector_index(vector, vector.length),
+			source,
+			count * vector.size
+		);
+		source += count * vector.size;
+		vector.length += count;
+		number -= count;
+	}
+
+	return vector;
+}
+
+struct libadt_segmented_vector libadt_segmented_vector_pop(
+	struct libadt_segmented_vector vector,
+	void *out
+)
+{
+	const void *value = libadt_segmented_vector_index(vector, --vector.length);
+	memmove(out, value, vector.size);
+	return vector;
+}
+
+struct libadt_segmented_vector libadt_segmented_vector_vacuum(
+	struct libadt_segmented_vector vector
+)
+{
+	return free_blocks_from(vector, blocks_for(vector, vector.length));
+}
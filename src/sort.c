@@ -0,0 +1,386 @@
+#include "libadt/sort.h"
+
+#include <limits.h>
+#include <stdint.h>
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+static bool scratch_fits(struct libadt_lptr lptr, struct libadt_lptr scratch)
+{
+	return libadt_const_lptr_size(libadt_const_lptr(scratch))
+		>= libadt_const_lptr_size(libadt_const_lptr(lptr));
+}
+
+static void swap(unsigned char *a, unsigned char *b, size_t size)
+{
+	unsigned char temp[64];
+	while (size) {
+		const size_t chunk = MIN(size, sizeof(temp));
+		memcpy(temp, a, chunk);
+		memcpy(a, b, chunk);
+		memcpy(b, temp, chunk);
+		a += chunk;
+		b += chunk;
+		size -= chunk;
+	}
+}
+
+static void insertion(
+	unsigned char *array,
+	size_t length,
+	size_t size,
+	libadt_sort_compare *compare
+)
+{
+	// Swapping rather than shifting avoids a temporary of unknown size
+	for (size_t i = 1; i < length; i++)
+		for (
+			unsigned char *j = array + i * size;
+			j > array && compare(j, j - size) < 0;
+			j -= size
+		)
+			swap(j, j - size, size);
+}
+
+static void sift(
+	unsigned char *array,
+	size_t root,
+	size_t length,
+	size_t size,
+	libadt_sort_compare *compare
+)
+{
+	for (size_t child; (child = 2 * root + 1) < length; root = child) {
+		if (
+			child + 1 < length
+			&& compare(array + child * size, array + (child + 1) * size) < 0
+		)
+			child++;
+		if (compare(array + root * size, array + child * size) >= 0)
+			break;
+		swap(array + root * size, array + child * size, size);
+	}
+}
+
+static void heapsort(
+	unsigned char *array,
+	size_t length,
+	size_t size,
+	libadt_sort_compare *compare
+)
+{
+	for (size_t i = length / 2; i-- > 0;)
+		sift(array, i, length, size, compare);
+	for (size_t end = length; end-- > 1;) {
+		swap(array, array + end * size, size);
+		sift(array, 0, end, size, compare);
+	}
+}
+
+// The same algorithm as LIBADT_SORT_DEFINE, except that the pivot is
+// tracked by pointer as it is swapped around rather than copied out
+static void introsort(
+	unsigned char *array,
+	size_t length,
+	size_t size,
+	libadt_sort_compare *compare,
+	unsigned int depth
+)
+{
+	while (length > LIBADT_SORT_INSERTION_THRESHOLD) {
+		if (!depth--) {
+			heapsort(array, length, size, compare);
+			return;
+		}
+
+		unsigned char
+			*const first = array,
+			*const middle = array + length / 2 * size,
+			*const last = array + (length - 1) * size;
+		if (compare(middle, first) < 0) swap(middle, first, size);
+		if (compare(last, middle) < 0) {
+			swap(last, middle, size);
+			if (compare(middle, first) < 0) swap(middle, first, size);
+		}
+		const unsigned char *pivot = middle;
+
+		unsigned char *i = first, *j = last;
+		for (;;) {
+			do i += size; while (compare(i, pivot) < 0);
+			do j -= size; while (compare(pivot, j) < 0);
+			if (i >= j)
+				break;
+			swap(i, j, size);
+			if (pivot == i)
+				pivot = j;
+			else if (pivot == j)
+				pivot = i;
+		}
+
+		const size_t left = (size_t)(i - array) / size;
+		if (left < length - left) {
+			introsort(array, left, size, compare, depth);
+			array = i;
+			length -= left;
+		} else {
+			introsort(i, length - left, size, compare, depth);
+			length = left;
+		}
+	}
+	insertion(array, length, size, compare);
+}
+
+void libadt_sort(struct libadt_lptr lptr, libadt_sort_compare *compare)
+{
+	if (lptr.length <= 1 || lptr.size <= 0)
+		return;
+
+	unsigned int depth = 0;
+	for (size_t length = (size_t)lptr.length; length >>= 1;)
+		depth += 2;
+	introsort(lptr.buffer, (size_t)lptr.length, (size_t)lptr.size, compare, depth);
+}
+
+static void merge(
+	const unsigned char *left,
+	const unsigned char *left_end,
+	const unsigned char *right,
+	const unsigned char *right_end,
+	unsigned char *out,
+	size_t size,
+	libadt_sort_compare *compare
+)
+{
+	while (left < left_end && right < right_end) {
+		// Take from the right only if strictly less, for stability
+		if (compare(right, left) < 0) {
+			memcpy(out, right, size);
+			right += size;
+		} else {
+			memcpy(out, left, size);
+			left += size;
+		}
+		out += size;
+	}
+	memcpy(out, left, (size_t)(left_end - left));
+	out += left_end - left;
+	memcpy(out, right, (size_t)(right_end - right));
+}
+
+bool libadt_sort_stable(
+	struct libadt_lptr lptr,
+	struct libadt_lptr scratch,
+	libadt_sort_compare *compare
+)
+{
+	if (lptr.length < 0 || lptr.size <= 0)
+		return false;
+	if (!scratch_fits(lptr, scratch))
+		return false;
+
+	const size_t
+		length = (size_t)lptr.length,
+		size = (size_t)lptr.size,
+		bytes = length * size;
+	unsigned char *from = lptr.buffer, *to = scratch.buffer;
+
+	for (size_t i = 0; i < length; i += LIBADT_SORT_INSERTION_THRESHOLD)
+		insertion(
+			from + i * size,
+			MIN(length - i, LIBADT_SORT_INSERTION_THRESHOLD),
+			size,
+			compare
+		);
+
+	for (size_t width = LIBADT_SORT_INSERTION_THRESHOLD; width < length; width *= 2) {
+		for (size_t i = 0; i < length; i += 2 * width) {
+			const size_t
+				middle = MIN(i + width, length),
+				end = MIN(middle + width, length);
+			merge(
+				from + i * size,
+				from + middle * size,
+				from + middle * size,
+				from + end * size,
+				to + i * size,
+				size,
+				compare
+			);
+		}
+		unsigned char *const temp = from;
+		from = to;
+		to = temp;
+	}
+
+	if (from != lptr.buffer)
+		memcpy(lptr.buffer, from, bytes);
+	return true;
+}
+
+/*
+ * The radix sorts count every digit of every key in one pass. Large
+ * inputs are first scattered by their most significant varying
+ * digit, which leaves buckets small enough to finish in cache with
+ * LSD passes over the remaining digits. Small inputs are LSD sorted
+ * directly, and the smallest are cheaper to sort by comparison.
+ *
+ * Passes where every key has the same digit would not move
+ * anything, and are skipped, so small keys in wide types cost less.
+ */
+
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_MASK (RADIX_BUCKETS - 1)
+
+// Inputs no longer than this are sorted by comparison
+#define RADIX_COMPARISON_LENGTH 1024
+
+// Inputs longer than this take an MSD pass first
+#define RADIX_MSD_LENGTH (1 << 16)
+
+#define RADIX_LESS(a, b) ((a) < (b))
+
+#define RADIX_DEFINE(NAME, TYPE) \
+LIBADT_SORT_DEFINE(NAME##_compare, TYPE, RADIX_LESS) \
+\
+enum { NAME##_digits = sizeof(TYPE) * CHAR_BIT / RADIX_BITS }; \
+\
+static void NAME##_count( \
+	const TYPE *data, \
+	size_t length, \
+	unsigned int digits, \
+	size_t counts[][RADIX_BUCKETS] \
+) \
+{ \
+	memset(counts, 0, digits * sizeof(*counts)); \
+	for (size_t i = 0; i < length; i++) \
+		for (unsigned int digit = 0; digit < digits; digit++) \
+			counts[digit][(data[i] >> (digit * RADIX_BITS)) & RADIX_MASK]++; \
+} \
+\
+/* Turns the counts for one digit into bucket offsets, returning */ \
+/* false if every key is in one bucket */ \
+static bool NAME##_offsets(size_t *count, size_t length, TYPE first, unsigned int digit) \
+{ \
+	if (count[(first >> (digit * RADIX_BITS)) & RADIX_MASK] == length) \
+		return false; \
+	size_t offset = 0; \
+	for (size_t bucket = 0; bucket < RADIX_BUCKETS; bucket++) { \
+		const size_t next = offset + count[bucket]; \
+		count[bucket] = offset; \
+		offset = next; \
+	} \
+	return true; \
+} \
+\
+static void NAME##_scatter( \
+	const TYPE *restrict from, \
+	TYPE *restrict to, \
+	size_t length, \
+	size_t *restrict offsets, \
+	unsigned int digit \
+) \
+{ \
+	const unsigned int shift = digit * RADIX_BITS; \
+	for (size_t i = 0; i < length; i++) { \
+		const TYPE value = from[i]; \
+		to[offsets[(value >> shift) & RADIX_MASK]++] = value; \
+	} \
+} \
+\
+/* Sorts data by its lowest digits, writing the result to data */ \
+static void NAME##_lsd( \
+	TYPE *data, \
+	TYPE *scratch, \
+	size_t length, \
+	unsigned int digits, \
+	size_t counts[][RADIX_BUCKETS] \
+) \
+{ \
+	if (length <= RADIX_COMPARISON_LENGTH) { \
+		NAME##_compare((struct libadt_lptr) { \
+			.buffer = data, \
+			.size = sizeof(TYPE), \
+			.length = (ssize_t)length, \
+		}); \
+		return; \
+	} \
+	\
+	NAME##_count(data, length, digits, counts); \
+	TYPE *from = data, *to = scratch; \
+	for (unsigned int digit = 0; digit < digits; digit++) { \
+		if (!NAME##_offsets(counts[digit], length, from[0], digit)) \
+			continue; \
+		NAME##_scatter(from, to, length, counts[digit], digit); \
+		TYPE *const temp = from; \
+		from = to; \
+		to = temp; \
+	} \
+	if (from != data) \
+		memcpy(data, from, length * sizeof(TYPE)); \
+} \
+\
+static void NAME(TYPE *data, TYPE *scratch, size_t length) \
+{ \
+	size_t counts[NAME##_digits][RADIX_BUCKETS]; \
+	if (length <= RADIX_MSD_LENGTH) { \
+		NAME##_lsd(data, scratch, length, NAME##_digits, counts); \
+		return; \
+	} \
+	\
+	NAME##_count(data, length, NAME##_digits, counts); \
+	unsigned int top = NAME##_digits; \
+	while (top-- > 0) \
+		if (NAME##_offsets(counts[top], length, data[0], top)) \
+			break; \
+	if (top >= NAME##_digits) \
+		return; \
+	\
+	size_t starts[RADIX_BUCKETS]; \
+	memcpy(starts, counts[top], sizeof(starts)); \
+	NAME##_scatter(data, scratch, length, counts[top], top); \
+	\
+	/* Each bucket is sorted in the scratch, using the matching */ \
+	/* part of data as its own scratch, then copied back */ \
+	for (size_t bucket = 0; bucket < RADIX_BUCKETS; bucket++) { \
+		const size_t \
+			start = starts[bucket], \
+			end = bucket + 1 < RADIX_BUCKETS ? starts[bucket + 1] : length; \
+		if (start == end) \
+			continue; \
+		NAME##_lsd(scratch + start, data + start, end - start, top, counts); \
+		memcpy(data + start, scratch + start, (end - start) * sizeof(TYPE)); \
+	} \
+}
+
+RADIX_DEFINE(radix_u32, uint32_t)
+RADIX_DEFINE(radix_u64, uint64_t)
+
+static bool radix_sizes_valid(
+	struct libadt_lptr lptr,
+	struct libadt_lptr scratch,
+	size_t size
+)
+{
+	return lptr.size == (ssize_t)size
+		&& lptr.length >= 0
+		&& scratch_fits(lptr, scratch);
+}
+
+bool libadt_sort_radix_u32(struct libadt_lptr lptr, struct libadt_lptr scratch)
+{
+	if (!radix_sizes_valid(lptr, scratch, sizeof(uint32_t)))
+		return false;
+	if (lptr.length > 1)
+		radix_u32(lptr.buffer, scratch.buffer, (size_t)lptr.length);
+	return true;
+}
+
+bool libadt_sort_radix_u64(struct libadt_lptr lptr, struct libadt_lptr scratch)
+{
+	if (!radix_sizes_valid(lptr, scratch, sizeof(uint64_t)))
+		return false;
+	if (lptr.length > 1)
+		radix_u64(lptr.buffer, scratch.buffer, (size_t)lptr.length);
+	return true;
+}
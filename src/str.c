@@ -1,4 +1,552 @@
 #include "libadt/str.h"
 
+#include "cpu.h"
+
 struct libadt_lptr libadt_str(char *const str);
 struct libadt_lptr libadt_wstr(wchar_t *const str);
+struct libadt_str_split libadt_str_split_init(
+	struct libadt_const_lptr str,
+	struct libadt_const_lptr delimiter,
+	enum libadt_str_split_mode mode
+);
+struct libadt_str_split libadt_str_split_byte(
+	struct libadt_const_lptr str,
+	char delimiter
+);
+struct libadt_str_split libadt_str_split_any(
+	struct libadt_const_lptr str,
+	struct libadt_const_lptr set
+);
+struct libadt_str_split libadt_str_split(
+	struct libadt_const_lptr str,
+	struct libadt_const_lptr substring
+);
+bool libadt_str_split_valid(struct libadt_str_split split);
+unsigned int libadt_str_lowest(uint64_t mask);
+bool libadt_str_split_match(struct libadt_str_split split, const char *candidate);
+struct libadt_str_split libadt_str_split_next(struct libadt_str_split split);
+
+// Sets at most this long are searched with SIMD comparisons
+#define SIMD_SET_LENGTH 16
+
+/*
+ * Searching.
+ *
+ * Each SIMD kernel checks as many whole blocks of positions as it
+ * can without reading past the end of the haystack. It returns the
+ * index of a match, or -1 with *done set to the positions it has
+ * ruled out, and the portable code searches whatever is left over.
+ */
+
+static struct libadt_const_lptr found(
+	struct libadt_const_lptr haystack,
+	ssize_t index,
+	ssize_t length
+)
+{
+	if (index < 0)
+		return (struct libadt_const_lptr) { NULL, haystack.size, 0 };
+	return libadt_const_lptr_truncate(
+		libadt_const_lptr_index(haystack, index),
+		(size_t)length
+	);
+}
+
+#if LIBADT_CPU_X86
+// Compares candidates without calling memcmp(), which would make the
+// kernels spill their vector registers around the call
+static inline bool equal(const char *a, const char *b, ssize_t length)
+{
+	for (ssize_t i = 0; i < length; i++)
+		if (a[i] != b[i])
+			return false;
+	return true;
+}
+
+LIBADT_TARGET_SSE2
+static ssize_t find_sse2(
+	const char *haystack,
+	ssize_t length,
+	const char *needle,
+	ssize_t needle_length,
+	ssize_t *done
+)
+{
+	const __m128i
+		first = _mm_set1_epi8(needle[0]),
+		last = _mm_set1_epi8(needle[needle_length - 1]);
+	ssize_t i = 0;
+	for (; i + needle_length - 1 + 16 <= length; i += 16) {
+		const __m128i
+			block_first = _mm_loadu_si128((const __m128i *)(haystack + i)),
+			block_last = _mm_loadu_si128((const __m128i *)(haystack + i + needle_length - 1));
+		unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_and_si128(
+			_mm_cmpeq_epi8(first, block_first),
+			_mm_cmpeq_epi8(last, block_last)
+		));
+		for (; mask; mask &= mask - 1) {
+			const ssize_t position = i + __builtin_ctz(mask);
+			if (equal(haystack + position + 1, needle + 1, needle_length - 2))
+				return position;
+		}
+	}
+	*done = i;
+	return -1;
+}
+
+LIBADT_TARGET_AVX2
+static ssize_t find_avx2(
+	const char *haystack,
+	ssize_t length,
+	const char *needle,
+	ssize_t needle_length,
+	ssize_t *done
+)
+{
+	const __m256i
+		first = _mm256_set1_epi8(needle[0]),
+		last = _mm256_set1_epi8(needle[needle_length - 1]);
+	ssize_t i = 0;
+	for (; i + needle_length - 1 + 32 <= length; i += 32) {
+		const __m256i
+			block_first = _mm256_loadu_si256((const __m256i *)(haystack + i)),
+			block_last = _mm256_loadu_si256((const __m256i *)(haystack + i + needle_length - 1));
+		unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_and_si256(
+			_mm256_cmpeq_epi8(first, block_first),
+			_mm256_cmpeq_epi8(last, block_last)
+		));
+		for (; mask; mask &= mask - 1) {
+			const ssize_t position = i + __builtin_ctz(mask);
+			if (equal(haystack + position + 1, needle + 1, needle_length - 2))
+				return position;
+		}
+	}
+	*done = i;
+	return -1;
+}
+
+// Checks start positions from the end, leaving *done as the number
+// of positions at the start still to check
+LIBADT_TARGET_SSE2
+static ssize_t rfind_sse2(
+	const char *haystack,
+	const char *needle,
+	ssize_t needle_length,
+	ssize_t *done
+)
+{
+	const __m128i
+		first = _mm_set1_epi8(needle[0]),
+		last = _mm_set1_epi8(needle[needle_length - 1]);
+	ssize_t end = *done;
+	for (; end >= 16; end -= 16) {
+		const ssize_t base = end - 16;
+		const __m128i
+			block_first = _mm_loadu_si128((const __m128i *)(haystack + base)),
+			block_last = _mm_loadu_si128((const __m128i *)(haystack + base + needle_length - 1));
+		unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_and_si128(
+			_mm_cmpeq_epi8(first, block_first),
+			_mm_cmpeq_epi8(last, block_last)
+		));
+		while (mask) {
+			const int bit = 31 - __builtin_clz(mask);
+			const ssize_t position = base + bit;
+			if (equal(haystack + position + 1, needle + 1, needle_length - 2))
+				return position;
+			mask &= ~(1u << bit);
+		}
+	}
+	*done = end;
+	return -1;
+}
+
+LIBADT_TARGET_AVX2
+static ssize_t rfind_avx2(
+	const char *haystack,
+	const char *needle,
+	ssize_t needle_length,
+	ssize_t *done
+)
+{
+	const __m256i
+		first = _mm256_set1_epi8(needle[0]),
+		last = _mm256_set1_epi8(needle[needle_length - 1]);
+	ssize_t end = *done;
+	for (; end >= 32; end -= 32) {
+		const ssize_t base = end - 32;
+		const __m256i
+			block_first = _mm256_loadu_si256((const __m256i *)(haystack + base)),
+			block_last = _mm256_loadu_si256((const __m256i *)(haystack + base + needle_length - 1));
+		unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_and_si256(
+			_mm256_cmpeq_epi8(first, block_first),
+			_mm256_cmpeq_epi8(last, block_last)
+		));
+		while (mask) {
+			const int bit = 31 - __builtin_clz(mask);
+			const ssize_t position = base + bit;
+			if (equal(haystack + position + 1, needle + 1, needle_length - 2))
+				return position;
+			mask &= ~(1u << bit);
+		}
+	}
+	*done = end;
+	return -1;
+}
+
+LIBADT_TARGET_SSE2
+static ssize_t find_any_sse2(
+	const char *haystack,
+	ssize_t length,
+	const char *set,
+	ssize_t set_length,
+	ssize_t *done
+)
+{
+	__m128i bytes[SIMD_SET_LENGTH];
+	for (ssize_t j = 0; j < set_length; j++)
+		bytes[j] = _mm_set1_epi8(set[j]);
+
+	ssize_t i = 0;
+	for (; i + 16 <= length; i += 16) {
+		const __m128i block = _mm_loadu_si128((const __m128i *)(haystack + i));
+		__m128i match = _mm_cmpeq_epi8(block, bytes[0]);
+		for (ssize_t j = 1; j < set_length; j++)
+			match = _mm_or_si128(match, _mm_cmpeq_epi8(block, bytes[j]));
+		const unsigned int mask = (unsigned int)_mm_movemask_epi8(match);
+		if (mask)
+			return i + __builtin_ctz(mask);
+	}
+	*done = i;
+	return -1;
+}
+
+LIBADT_TARGET_AVX2
+static ssize_t find_any_avx2(
+	const char *haystack,
+	ssize_t length,
+	const char *set,
+	ssize_t set_length,
+	ssize_t *done
+)
+{
+	__m256i bytes[SIMD_SET_LENGTH];
+	for (ssize_t j = 0; j < set_length; j++)
+		bytes[j] = _mm256_set1_epi8(set[j]);
+
+	ssize_t i = 0;
+	for (; i + 32 <= length; i += 32) {
+		const __m256i block = _mm256_loadu_si256((const __m256i *)(haystack + i));
+		__m256i match = _mm256_cmpeq_epi8(block, bytes[0]);
+		for (ssize_t j = 1; j < set_length; j++)
+			match = _mm256_or_si256(match, _mm256_cmpeq_epi8(block, bytes[j]));
+		const unsigned int mask = (unsigned int)_mm256_movemask_epi8(match);
+		if (mask)
+			return i + __builtin_ctz(mask);
+	}
+	*done = i;
+	return -1;
+}
+
+/*
+ * Splitting.
+ *
+ * Each SIMD kernel turns whole 64-byte windows into bitmasks of
+ * delimiters, stopping at the first window with any. It returns that
+ * mask with *window set to the window, or 0 with *window set to the
+ * first window it did not scan, and the portable code scans whatever
+ * is left over.
+ */
+
+LIBADT_TARGET_SSE2
+static uint64_t scan_byte_sse2(const char **window, const char *end, char byte)
+{
+	const __m128i delimiter = _mm_set1_epi8(byte);
+	const char *w = *window;
+	for (; end - w >= 64; w += 64) {
+		uint64_t mask = 0;
+		for (int i = 0; i < 64; i += 16) {
+			const __m128i block = _mm_loadu_si128((const __m128i *)(w + i));
+			mask |= (uint64_t)(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(block, delimiter)) << i;
+		}
+		if (mask) {
+			*window = w;
+			return mask;
+		}
+	}
+	*window = w;
+	return 0;
+}
+
+LIBADT_TARGET_AVX2
+static uint64_t scan_byte_avx2(const char **window, const char *end, char byte)
+{
+	const __m256i delimiter = _mm256_set1_epi8(byte);
+	const char *w = *window;
+	for (; end - w >= 64; w += 64) {
+		const __m256i
+			low = _mm256_loadu_si256((const __m256i *)w),
+			high = _mm256_loadu_si256((const __m256i *)(w + 32));
+		const uint64_t mask =
+			(uint64_t)(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, delimiter))
+			| (uint64_t)(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, delimiter)) << 32;
+		if (mask) {
+			*window = w;
+			return mask;
+		}
+	}
+	*window = w;
+	return 0;
+}
+
+LIBADT_TARGET_SSE2
+static uint64_t scan_any_sse2(
+	const char **window,
+	const char *end,
+	const char *set,
+	ssize_t set_length
+)
+{
+	__m128i bytes[SIMD_SET_LENGTH];
+	for (ssize_t j = 0; j < set_length; j++)
+		bytes[j] = _mm_set1_epi8(set[j]);
+
+	const char *w = *window;
+	for (; end - w >= 64; w += 64) {
+		uint64_t mask = 0;
+		for (int i = 0; i < 64; i += 16) {
+			const __m128i block = _mm_loadu_si128((const __m128i *)(w + i));
+			__m128i match = _mm_cmpeq_epi8(block, bytes[0]);
+			for (ssize_t j = 1; j < set_length; j++)
+				match = _mm_or_si128(match, _mm_cmpeq_epi8(block, bytes[j]));
+			mask |= (uint64_t)(unsigned int)_mm_movemask_epi8(match) << i;
+		}
+		if (mask) {
+			*window = w;
+			return mask;
+		}
+	}
+	*window = w;
+	return 0;
+}
+
+LIBADT_TARGET_AVX2
+static uint64_t scan_any_avx2(
+	const char **window,
+	const char *end,
+	const char *set,
+	ssize_t set_length
+)
+{
+	__m256i bytes[SIMD_SET_LENGTH];
+	for (ssize_t j = 0; j < set_length; j++)
+		bytes[j] = _mm256_set1_epi8(set[j]);
+
+	const char *w = *window;
+	for (; end - w >= 64; w += 64) {
+		const __m256i
+			low = _mm256_loadu_si256((const __m256i *)w),
+			high = _mm256_loadu_si256((const __m256i *)(w + 32));
+		__m256i
+			match_low = _mm256_cmpeq_epi8(low, bytes[0]),
+			match_high = _mm256_cmpeq_epi8(high, bytes[0]);
+		for (ssize_t j = 1; j < set_length; j++) {
+			match_low = _mm256_or_si256(match_low, _mm256_cmpeq_epi8(low, bytes[j]));
+			match_high = _mm256_or_si256(match_high, _mm256_cmpeq_epi8(high, bytes[j]));
+		}
+		const uint64_t mask = (uint64_t)(unsigned int)_mm256_movemask_epi8(match_low)
+			| (uint64_t)(unsigned int)_mm256_movemask_epi8(match_high) << 32;
+		if (mask) {
+			*window = w;
+			return mask;
+		}
+	}
+	*window = w;
+	return 0;
+}
+#endif
+
+static ssize_t find_scalar(
+	const char *haystack,
+	ssize_t length,
+	const char *needle,
+	ssize_t needle_length,
+	ssize_t start
+)
+{
+	for (ssize_t i = start; i + needle_length <= length; i++) {
+		const char *const candidate = memchr(
+			haystack + i,
+			needle[0],
+			(size_t)(length - needle_length + 1 - i)
+		);
+		if (!candidate)
+			return -1;
+		i = candidate - haystack;
+		if (!memcmp(candidate + 1, needle + 1, (size_t)needle_length - 1))
+			return i;
+	}
+	return -1;
+}
+
+struct libadt_const_lptr libadt_str_find(
+	struct libadt_const_lptr haystack,
+	struct libadt_const_lptr needle
+)
+{
+	const char *const h = haystack.buffer, *const n = needle.buffer;
+	const ssize_t length = haystack.length, needle_length = needle.length;
+
+	if (needle_length > length)
+		return found(haystack, -1, 0);
+	if (!needle_length)
+		return found(haystack, 0, 0);
+	if (needle_length == 1)
+		return libadt_str_find_byte(haystack, n[0]);
+
+	ssize_t done = 0, index = -1;
+#if LIBADT_CPU_X86
+	if (libadt_cpu_has_avx2())
+		index = find_avx2(h, length, n, needle_length, &done);
+	else if (libadt_cpu_has_sse2())
+		index = find_sse2(h, length, n, needle_length, &done);
+	if (index >= 0)
+		return found(haystack, index, needle_length);
+#endif
+
+	return found(haystack, find_scalar(h, length, n, needle_length, done), needle_length);
+}
+
+struct libadt_const_lptr libadt_str_rfind(
+	struct libadt_const_lptr haystack,
+	struct libadt_const_lptr needle
+)
+{
+	const char *const h = haystack.buffer, *const n = needle.buffer;
+	const ssize_t length = haystack.length, needle_length = needle.length;
+
+	if (needle_length > length)
+		return found(haystack, -1, 0);
+	if (!needle_length)
+		return found(haystack, length, 0);
+
+	// The number of start positions left to check, from 0
+	ssize_t remaining = length - needle_length + 1;
+#if LIBADT_CPU_X86
+	if (needle_length >= 2) {
+		ssize_t index = -1;
+		if (libadt_cpu_has_avx2())
+			index = rfind_avx2(h, n, needle_length, &remaining);
+		else if (libadt_cpu_has_sse2())
+			index = rfind_sse2(h, n, needle_length, &remaining);
+		if (index >= 0)
+			return found(haystack, index, needle_length);
+	}
+#endif
+
+	for (ssize_t i = remaining - 1; i >= 0; i--)
+		if (h[i] == n[0] && !memcmp(h + i + 1, n + 1, (size_t)needle_length - 1))
+			return found(haystack, i, needle_length);
+	return found(haystack, -1, 0);
+}
+
+struct libadt_const_lptr libadt_str_find_byte(
+	struct libadt_const_lptr haystack,
+	char byte
+)
+{
+	// The C library's memchr() is already vectorized
+	const char *const h = haystack.buffer;
+	const char *const result = haystack.length > 0
+		? memchr(h, byte, (size_t)haystack.length)
+		: NULL;
+	return found(haystack, result ? result - h : -1, 1);
+}
+
+struct libadt_const_lptr libadt_str_find_any(
+	struct libadt_const_lptr haystack,
+	struct libadt_const_lptr set
+)
+{
+	const char *const h = haystack.buffer, *const s = set.buffer;
+	const ssize_t length = haystack.length;
+
+	if (set.length <= 0)
+		return found(haystack, -1, 0);
+	if (set.length == 1)
+		return libadt_str_find_byte(haystack, s[0]);
+
+	ssize_t done = 0;
+#if LIBADT_CPU_X86
+	if (set.length <= SIMD_SET_LENGTH) {
+		ssize_t index = -1;
+		if (libadt_cpu_has_avx2())
+			index = find_any_avx2(h, length, s, set.length, &done);
+		else if (libadt_cpu_has_sse2())
+			index = find_any_sse2(h, length, s, set.length, &done);
+		if (index >= 0)
+			return found(haystack, index, 1);
+	}
+#endif
+
+	bool table[UCHAR_MAX + 1] = { false };
+	for (ssize_t j = 0; j < set.length; j++)
+		table[(unsigned char)s[j]] = true;
+	for (ssize_t i = done; i < length; i++)
+		if (table[(unsigned char)h[i]])
+			return found(haystack, i, 1);
+	return found(haystack, -1, 0);
+}
+
+uint64_t libadt_str_split_scan(
+	const char **window,
+	const char *end,
+	enum libadt_str_split_mode mode,
+	char byte,
+	const char *set,
+	ssize_t set_length
+)
+{
+	// An empty substring or set never matches
+	if (mode != LIBADT_STR_SPLIT_BYTE && set_length <= 0) {
+		*window = end;
+		return 0;
+	}
+
+	// Substrings are scanned for their first byte
+	const bool any = mode == LIBADT_STR_SPLIT_ANY;
+	uint64_t mask = 0;
+#if LIBADT_CPU_X86
+	if (!any || set_length <= SIMD_SET_LENGTH) {
+		if (libadt_cpu_has_avx2())
+			mask = any
+				? scan_any_avx2(window, end, set, set_length)
+				: scan_byte_avx2(window, end, byte);
+		else if (libadt_cpu_has_sse2())
+			mask = any
+				? scan_any_sse2(window, end, set, set_length)
+				: scan_byte_sse2(window, end, byte);
+		if (mask)
+			return mask;
+	}
+#endif
+
+	bool table[UCHAR_MAX + 1] = { false };
+	if (any)
+		for (ssize_t j = 0; j < set_length; j++)
+			table[(unsigned char)set[j]] = true;
+	else
+		table[(unsigned char)byte] = true;
+
+	const char *w = *window;
+	for (; w < end; w += 64) {
+		const ssize_t length = end - w < 64 ? end - w : 64;
+		for (ssize_t i = 0; i < length; i++)
+			mask |= (uint64_t)table[(unsigned char)w[i]] << i;
+		if (mask) {
+			*window = w;
+			return mask;
+		}
+	}
+	*window = end;
+	return 0;
+}
@@ -0,0 +1,423 @@
+#include "libadt/threadpool.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CACHE_LINE 64
+#define MASK (LIBADT_THREADPOOL_DEQUE_CAPACITY - 1)
+
+_Static_assert(
+	(LIBADT_THREADPOOL_DEQUE_CAPACITY & MASK) == 0,
+	"LIBADT_THREADPOOL_DEQUE_CAPACITY must be a power of two"
+);
+
+// Idle workers try this many times to find work before sleeping
+static const unsigned int idle_spins = 64;
+
+// Once done spinning, libadt_threadpool_wait() polls this often
+static const long wait_sleep_ns = 50000;
+
+/*
+ * A Chase-Lev deque, with the memory orderings from "Correct and
+ * Efficient Work-Stealing for Weak Memory Models" (Lê et al. 2013).
+ * The owner pushes and takes at the bottom, thieves steal from the
+ * top. The indices only ever increase, and are wrapped by the mask
+ * when indexing the fixed-size ring.
+ */
+struct deque {
+	_Alignas(CACHE_LINE) atomic_llong top;
+	_Alignas(CACHE_LINE) atomic_llong bottom;
+	_Alignas(CACHE_LINE) struct libadt_threadpool_task *_Atomic tasks[LIBADT_THREADPOOL_DEQUE_CAPACITY];
+};
+
+struct worker {
+	struct deque deque;
+	struct libadt_threadpool *pool;
+	pthread_t thread;
+	uint64_t random;
+};
+
+struct libadt_threadpool {
+	unsigned int threads;
+	struct worker *workers;
+
+	// The injection queue, and sleeping workers, are guarded by lock
+	pthread_mutex_t lock;
+	pthread_cond_t wake;
+	struct libadt_threadpool_task *head;
+	struct libadt_threadpool_task *tail;
+	bool stopping;
+
+	// Read without the lock, so that the fast paths can skip it
+	atomic_size_t injected;
+	atomic_uint sleeping;
+};
+
+// The worker running on this thread, if any
+static _Thread_local struct worker *current;
+
+static bool push(struct deque *deque, struct libadt_threadpool_task *task)
+{
+	const long long
+		bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed),
+		top = atomic_load_explicit(&deque->top, memory_order_acquire);
+	if (bottom - top >= LIBADT_THREADPOOL_DEQUE_CAPACITY)
+		return false;
+
+	atomic_store_explicit(&deque->tasks[bottom & MASK], task, memory_order_relaxed);
+	// A release store rather than the paper's release fence, which
+	// is the same on x86 and visible to ThreadSanitizer
+	atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_release);
+	return true;
+}
+
+static struct libadt_threadpool_task *take(struct deque *deque)
+{
+	const long long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+	atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+	atomic_thread_fence(memory_order_seq_cst);
+	long long top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+	if (top > bottom) {
+		atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+		return NULL;
+	}
+
+	struct libadt_threadpool_task *task = atomic_load_explicit(
+		&deque->tasks[bottom & MASK],
+		memory_order_relaxed
+	);
+	if (top == bottom) {
+		// The last task: race any thieves for it
+		if (!atomic_compare_exchange_strong_explicit(
+			&deque->top,
+			&top,
+			top + 1,
+			memory_order_seq_cst,
+			memory_order_relaxed
+		))
+			task = NULL;
+		atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+	}
+	return task;
+}
+
+static struct libadt_threadpool_task *steal(struct deque *deque)
+{
+	long long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+	atomic_thread_fence(memory_order_seq_cst);
+	const long long bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+	if (top >= bottom)
+		return NULL;
+
+	struct libadt_threadpool_task *const task = atomic_load_explicit(
+		&deque->tasks[top & MASK],
+		memory_order_relaxed
+	);
+	if (!atomic_compare_exchange_strong_explicit(
+		&deque->top,
+		&top,
+		top + 1,
+		memory_order_seq_cst,
+		memory_order_relaxed
+	))
+		return NULL;
+	return task;
+}
+
+static bool deque_empty(struct deque *deque)
+{
+	return atomic_load_explicit(&deque->top, memory_order_relaxed)
+		>= atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+}
+
+static struct worker *worker_of(struct libadt_threadpool *pool)
+{
+	return current && current->pool == pool ? current : NULL;
+}
+
+// Wakes a sleeping worker, if there is one, after work was queued
+static void notify(struct libadt_threadpool *pool)
+{
+	atomic_thread_fence(memory_order_seq_cst);
+	if (!atomic_load_explicit(&pool->sleeping, memory_order_relaxed))
+		return;
+	pthread_mutex_lock(&pool->lock);
+	pthread_cond_signal(&pool->wake);
+	pthread_mutex_unlock(&pool->lock);
+}
+
+static void inject(
+	struct libadt_threadpool *pool,
+	struct libadt_threadpool_task *first,
+	struct libadt_threadpool_task *last,
+	size_t number
+)
+{
+	last->next = NULL;
+	pthread_mutex_lock(&pool->lock);
+	if (pool->tail)
+		pool->tail->next = first;
+	else
+		pool->head = first;
+	pool->tail = last;
+	atomic_fetch_add_explicit(&pool->injected, number, memory_order_seq_cst);
+	if (atomic_load_explicit(&pool->sleeping, memory_order_relaxed)) {
+		if (number > 1)
+			pthread_cond_broadcast(&pool->wake);
+		else
+			pthread_cond_signal(&pool->wake);
+	}
+	pthread_mutex_unlock(&pool->lock);
+}
+
+static struct libadt_threadpool_task *dequeue(struct libadt_threadpool *pool)
+{
+	if (!atomic_load_explicit(&pool->injected, memory_order_relaxed))
+		return NULL;
+
+	pthread_mutex_lock(&pool->lock);
+	struct libadt_threadpool_task *const task = pool->head;
+	if (task) {
+		pool->head = task->next;
+		if (!pool->head)
+			pool->tail = NULL;
+		atomic_fetch_sub_explicit(&pool->injected, 1, memory_order_relaxed);
+	}
+	pthread_mutex_unlock(&pool->lock);
+	return task;
+}
+
+static uint64_t next_random(uint64_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+// Finds a task: from our own deque first, then the injection queue
+// if _inject_ is set, then by stealing from the other workers,
+// starting at a random one
+static struct libadt_threadpool_task *find(
+	struct libadt_threadpool *pool,
+	struct worker *self,
+	bool inject
+)
+{
+	struct libadt_threadpool_task *task = take(&self->deque);
+	if (task)
+		return task;
+	if (inject && (task = dequeue(pool)))
+		return task;
+
+	const unsigned int
+		threads = pool->threads,
+		start = (unsigned int)(next_random(&self->random) % threads);
+	for (unsigned int i = 0; i < threads; i++) {
+		struct worker *const victim = &pool->workers[(start + i) % threads];
+		if (victim != self && (task = steal(&victim->deque)))
+			return task;
+	}
+	return NULL;
+}
+
+static void execute(struct libadt_threadpool_task *task)
+{
+	// The task may be freed as soon as its group is released, so
+	// nothing in it is touched after running it
+	struct libadt_threadpool_group *const group = task->group;
+	task->function(task->context);
+	if (group)
+		atomic_fetch_sub_explicit(&group->pending, 1, memory_order_release);
+}
+
+static bool has_work(struct libadt_threadpool *pool)
+{
+	if (atomic_load_explicit(&pool->injected, memory_order_relaxed))
+		return true;
+	for (unsigned int i = 0; i < pool->threads; i++)
+		if (!deque_empty(&pool->workers[i].deque))
+			return true;
+	return false;
+}
+
+static void *work(void *argument)
+{
+	struct worker *const self = argument;
+	struct libadt_threadpool *const pool = self->pool;
+	current = self;
+
+	for (;;) {
+		struct libadt_threadpool_task *task = find(pool, self, true);
+		for (unsigned int i = 0; !task && i < idle_spins; i++) {
+			sched_yield();
+			task = find(pool, self, true);
+		}
+		if (task) {
+			execute(task);
+			continue;
+		}
+
+		pthread_mutex_lock(&pool->lock);
+		// Pairs with the fence in notify(): either the spawner sees
+		// us sleeping, or we see its task
+		atomic_fetch_add_explicit(&pool->sleeping, 1, memory_order_relaxed);
+		atomic_thread_fence(memory_order_seq_cst);
+		const bool idle = !has_work(pool);
+		if (idle && pool->stopping) {
+			atomic_fetch_sub_explicit(&pool->sleeping, 1, memory_order_relaxed);
+			pthread_mutex_unlock(&pool->lock);
+			break;
+		}
+		if (idle)
+			pthread_cond_wait(&pool->wake, &pool->lock);
+		atomic_fetch_sub_explicit(&pool->sleeping, 1, memory_order_relaxed);
+		pthread_mutex_unlock(&pool->lock);
+	}
+
+	current = NULL;
+	return NULL;
+}
+
+static void stop(struct libadt_threadpool *pool, unsigned int started)
+{
+	pthread_mutex_lock(&pool->lock);
+	pool->stopping = true;
+	pthread_cond_broadcast(&pool->wake);
+	pthread_mutex_unlock(&pool->lock);
+
+	for (unsigned int i = 0; i < started; i++)
+		pthread_join(pool->workers[i].thread, NULL);
+
+	pthread_cond_destroy(&pool->wake);
+	pthread_mutex_destroy(&pool->lock);
+	free(pool->workers);
+	free(pool);
+}
+
+struct libadt_threadpool *libadt_threadpool_init(unsigned int threads)
+{
+	if (!threads) {
+		const long online = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = online > 0 ? (unsigned int)online : 1;
+	}
+
+	struct libadt_threadpool *const pool = malloc(sizeof(*pool));
+	if (!pool)
+		return NULL;
+	*pool = (struct libadt_threadpool) {
+		.threads = threads,
+		.workers = aligned_alloc(CACHE_LINE, threads * sizeof(struct worker)),
+	};
+	if (!pool->workers) {
+		free(pool);
+		return NULL;
+	}
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->wake, NULL);
+	atomic_init(&pool->injected, 0);
+	atomic_init(&pool->sleeping, 0);
+
+	for (unsigned int i = 0; i < threads; i++) {
+		struct worker *const worker = &pool->workers[i];
+		atomic_init(&worker->deque.top, 0);
+		atomic_init(&worker->deque.bottom, 0);
+		worker->pool = pool;
+		worker->random = 0x9e3779b97f4a7c15u * (i + 1);
+	}
+
+	for (unsigned int i = 0; i < threads; i++) {
+		if (pthread_create(&pool->workers[i].thread, NULL, work, &pool->workers[i])) {
+			stop(pool, i);
+			return NULL;
+		}
+	}
+	return pool;
+}
+
+void libadt_threadpool_free(struct libadt_threadpool *pool)
+{
+	if (pool)
+		stop(pool, pool->threads);
+}
+
+unsigned int libadt_threadpool_threads(const struct libadt_threadpool *pool)
+{
+	return pool->threads;
+}
+
+void libadt_threadpool_spawn(
+	struct libadt_threadpool *pool,
+	struct libadt_threadpool_group *group,
+	struct libadt_threadpool_task *task
+)
+{
+	task->group = group;
+	if (group)
+		atomic_fetch_add_explicit(&group->pending, 1, memory_order_relaxed);
+
+	struct worker *const self = worker_of(pool);
+	if (!self) {
+		inject(pool, task, task, 1);
+	} else if (push(&self->deque, task)) {
+		notify(pool);
+	} else {
+		execute(task);
+	}
+}
+
+void libadt_threadpool_spawn_n(
+	struct libadt_threadpool *pool,
+	struct libadt_threadpool_group *group,
+	struct libadt_threadpool_task *tasks,
+	size_t number
+)
+{
+	if (!number)
+		return;
+
+	if (worker_of(pool)) {
+		for (size_t i = 0; i < number; i++)
+			libadt_threadpool_spawn(pool, group, &tasks[i]);
+		return;
+	}
+
+	if (group)
+		atomic_fetch_add_explicit(&group->pending, number, memory_order_relaxed);
+	for (size_t i = 0; i < number; i++) {
+		tasks[i].group = group;
+		tasks[i].next = &tasks[i + 1];
+	}
+	inject(pool, &tasks[0], &tasks[number - 1], number);
+}
+
+void libadt_threadpool_wait(
+	struct libadt_threadpool *pool,
+	struct libadt_threadpool_group *group
+)
+{
+	struct worker *const self = worker_of(pool);
+
+	// A worker helps with its own deque and by stealing, but doesn't
+	// start new work from the injection queue: that could nest
+	// unrelated jobs on its stack without bound. Other threads have
+	// no deque to help with, so they just wait.
+	for (unsigned int spins = 0; atomic_load_explicit(&group->pending, memory_order_acquire);) {
+		struct libadt_threadpool_task *const task = self ? find(pool, self, false) : NULL;
+		if (task) {
+			execute(task);
+			spins = 0;
+		} else if (spins < idle_spins) {
+			sched_yield();
+			spins++;
+		} else {
+			nanosleep(&(struct timespec) { .tv_nsec = wait_sleep_ns }, NULL);
+		}
+	}
+}
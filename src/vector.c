@@ -1,17 +1,118 @@
 #include "libadt/vector.h"
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
 
+const struct libadt_vector_growth
+	libadt_vector_growth_double = {
+		.grow = libadt_vector_grow_double,
+	},
+	libadt_vector_growth_half = {
+		.grow = libadt_vector_grow_half,
+	},
+	libadt_vector_growth_pages = {
+		.grow = libadt_vector_grow_pages,
+		.parameter = 4096,
+	};
+
+// Grow functions saturate rather than overflow: the result is
+// checked against the largest possible allocation afterwards
+static size_t add_saturated(size_t a, size_t b)
+{
+	return a + b < a ? SIZE_MAX : a + b;
+}
+
+size_t libadt_vector_grow_double(
+	const struct libadt_vector_growth *growth,
+	size_t size,
+	size_t capacity,
+	size_t required
+)
+{
+	(void)growth;
+	(void)size;
+	(void)required;
+	return add_saturated(capacity, capacity);
+}
+
+size_t libadt_vector_grow_half(
+	const struct libadt_vector_growth *growth,
+	size_t size,
+	size_t capacity,
+	size_t required
+)
+{
+	(void)growth;
+	(void)size;
+	(void)required;
+	return add_saturated(capacity, capacity / 2);
+}
+
+size_t libadt_vector_grow_chunk(
+	const struct libadt_vector_growth *growth,
+	size_t size,
+	size_t capacity,
+	size_t required
+)
+{
+	(void)size;
+	(void)required;
+	return add_saturated(capacity, growth->parameter);
+}
+
+size_t libadt_vector_grow_pages(
+	const struct libadt_vector_growth *growth,
+	size_t size,
+	size_t capacity,
+	size_t required
+)
+{
+	const size_t
+		page = growth->parameter ? growth->parameter : 1,
+		elements = MAX(add_saturated(capacity, capacity / 2), required);
+
+	if (!size || elements > SIZE_MAX / size)
+		return elements;
+
+	const size_t bytes = add_saturated(elements * size, page - 1) / page * page;
+	return bytes / size;
+}
+
+static size_t grow_capacity(struct libadt_vector vector, size_t required)
+{
+	const size_t capacity = vector.growth
+		? vector.growth->grow(vector.growth, vector.size, vector.capacity, required)
+		: add_saturated(vector.capacity, vector.capacity);
+	return MAX(capacity, required);
+}
+
 struct libadt_vector libadt_vector_trunc(
 	struct libadt_vector vector,
 	size_t new_capacity
 )
 {
-	void *attempt = realloc(vector.buffer, vector.size * new_capacity);
+	if (!new_capacity) {
+		libadt_allocator_deallocate(
+			vector.allocator,
+			vector.buffer,
+			vector.size * vector.capacity
+		);
+		vector.buffer = NULL;
+		vector.capacity = 0;
+		vector.length = 0;
+		return vector;
+	}
+
+	void *attempt = libadt_allocator_reallocate(
+		vector.allocator,
+		vector.buffer,
+		vector.size * vector.capacity,
+		vector.size * new_capacity
+	);
 
 	if (attempt) {
 		vector.buffer = attempt;
@@ -22,13 +123,18 @@ struct libadt_vector libadt_vector_trunc(
 	return vector;
 }
 
-struct libadt_vector libadt_vector_init(size_t size, size_t initial_capacity)
+struct libadt_vector libadt_vector_init_with_allocator(
+	size_t size,
+	size_t initial_capacity,
+	const struct libadt_allocator *allocator
+)
 {
 	struct libadt_vector result = {
 		.buffer = NULL,
 		.size = size,
 		.capacity = 0,
 		.length = 0,
+		.allocator = allocator,
 	};
 
 	if (initial_capacity) {
@@ -42,9 +148,23 @@ struct libadt_vector libadt_vector_init(size_t size, size_t initial_capacity)
 	return result;
 }
 
+struct libadt_vector libadt_vector_init(size_t size, size_t initial_capacity)
+{
+	return libadt_vector_init_with_allocator(size, initial_capacity, NULL);
+}
+
+struct libadt_vector libadt_vector_init_huge(size_t size, size_t initial_capacity)
+{
+	return libadt_vector_init_with_allocator(size, initial_capacity, &libadt_allocator_huge);
+}
+
 struct libadt_vector libadt_vector_free(struct libadt_vector vector)
 {
-	free(vector.buffer);
+	libadt_allocator_deallocate(
+		vector.allocator,
+		vector.buffer,
+		vector.size * vector.capacity
+	);
 	return (struct libadt_vector){ 0 };
 }
 
@@ -60,32 +180,98 @@ bool (libadt_vector_identity)(
 		&& first.capacity == second.capacity;
 }
 
+bool libadt_vector_has_room(struct libadt_vector vector, size_t number);
+void libadt_vector_copy(
+	void *destination,
+	const void *source,
+	size_t size,
+	size_t number
+);
+struct libadt_vector libadt_vector_append_lptr(
+	struct libadt_vector vector,
+	struct libadt_const_lptr source
+);
 struct libadt_vector libadt_vector_append_n(
 	struct libadt_vector vector,
 	void *data,
 	size_t number
+);
+struct libadt_vector libadt_vector_extend_uninit(
+	struct libadt_vector vector,
+	size_t number,
+	void **out
+);
+struct libadt_vector libadt_vector_commit(
+	struct libadt_vector vector,
+	size_t number
+);
+struct libadt_vector libadt_vector_rollback(
+	struct libadt_vector vector,
+	size_t number
+);
+
+struct libadt_lptr libadt_vector_lptr(struct libadt_vector vector);
+
+bool libadt_vector_make_room(struct libadt_vector *vector, size_t number)
+{
+	if (number > SIZE_MAX - vector->length)
+		return false;
+	if (vector->length + number <= vector->capacity)
+		return true;
+
+	size_t new_capacity = grow_capacity(*vector, vector->length + number);
+	if (vector->size && new_capacity > SIZE_MAX / vector->size)
+		new_capacity = vector->length + number;
+	if (vector->size && new_capacity > SIZE_MAX / vector->size)
+		return false;
+
+	struct libadt_vector
+		new = libadt_vector_trunc(*vector, new_capacity);
+
+	if (libadt_vector_identity(new, *vector))
+		return false;
+	*vector = new;
+	return true;
+}
+
+static struct libadt_vector append_lptr_grow(
+	struct libadt_vector vector,
+	struct libadt_const_lptr source
 )
 {
-	if (number + vector.length > vector.capacity) {
-		size_t new_capacity = MAX(
-			vector.capacity * 2,
-			vector.capacity + number
-		);
+	// The source may be a slice of the vector itself, which growing
+	// could move, so remember where it was relative to the buffer
+	const uintptr_t
+		begin = (uintptr_t)vector.buffer,
+		from = (uintptr_t)source.buffer;
+	const bool aliased = vector.buffer
+		&& from >= begin
+		&& from < begin + vector.size * vector.capacity;
 
-		struct libadt_vector
-			new = libadt_vector_trunc(vector, new_capacity);
+	if (!libadt_vector_make_room(&vector, (size_t)source.length))
+		return vector;
 
-		if (libadt_vector_identity(new, vector))
-			return vector;
-		vector = new;
-	}
+	if (aliased)
+		source.buffer = (const char *)vector.buffer + (from - begin);
 
-	// I _feel like_ this could be a memcpy but I'm scared of my users
-	memmove(libadt_vector_end(vector), data, vector.size * number);
-	vector.length += number;
+	libadt_vector_copy(
+		libadt_vector_end(vector),
+		source.buffer,
+		vector.size,
+		(size_t)source.length
+	);
+	vector.length += (size_t)source.length;
 	return vector;
 }
 
+void libadt_vector_append_lptr_grow(
+	struct libadt_vector *vector,
+	struct libadt_const_lptr source
+)
+{
+	*vector = append_lptr_grow(*vector, source);
+}
+
 struct libadt_vector (libadt_vector_append)(
 	struct libadt_vector vector,
 	void *data
@@ -94,6 +280,18 @@ struct libadt_vector (libadt_vector_append)(
 	return libadt_vector_append_n(vector, data, 1);
 }
 
+struct libadt_vector libadt_vector_reserve(
+	struct libadt_vector vector,
+	size_t capacity
+)
+{
+	if (capacity <= vector.capacity)
+		return vector;
+	if (vector.size && capacity > SIZE_MAX / vector.size)
+		return vector;
+	return libadt_vector_trunc(vector, capacity);
+}
+
 struct libadt_vector libadt_vector_vacuum(struct libadt_vector vector)
 {
 	return libadt_vector_trunc(vector, vector.length);
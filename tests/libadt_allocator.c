@@ -0,0 +1,189 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "libadt/allocator.h"
+#include "libadt/lptr.h"
+#include "libadt/vector.h"
+#include "libadt/bitwise_array.h"
+
+struct counts {
+	int allocations;
+	int reallocations;
+	int deallocations;
+	size_t live_bytes;
+};
+
+void *counting_allocate(void *context, size_t size)
+{
+	struct counts *counts = context;
+	counts->allocations++;
+	counts->live_bytes += size;
+	return malloc(size);
+}
+
+void *counting_reallocate(void *context, void *buffer, size_t old_size, size_t new_size)
+{
+	struct counts *counts = context;
+	void *result = realloc(buffer, new_size);
+	if (result) {
+		counts->reallocations++;
+		counts->live_bytes += new_size - old_size;
+	}
+	return result;
+}
+
+void counting_deallocate(void *context, void *buffer, size_t size)
+{
+	struct counts *counts = context;
+	counts->deallocations++;
+	counts->live_bytes -= size;
+	free(buffer);
+}
+
+#define COUNTING_ALLOCATOR(counts) \
+	((struct libadt_allocator) { \
+		counting_allocate, \
+		counting_reallocate, \
+		counting_deallocate, \
+		&(counts), \
+	})
+
+void test_lptr(void)
+{
+	struct counts counts = { 0 };
+	const struct libadt_allocator allocator = COUNTING_ALLOCATOR(counts);
+
+	struct libadt_lptr lptr = libadt_lptr_calloc_with_allocator(4, sizeof(int), &allocator);
+	assert(libadt_lptr_valid(lptr));
+	assert(lptr.length == 4);
+	assert(((int *)lptr.buffer)[3] == 0);
+	assert(counts.allocations == 1);
+	assert(counts.live_bytes == 4 * sizeof(int));
+
+	lptr = libadt_lptr_reallocarray_with_allocator(lptr, 8, &allocator);
+	assert(lptr.length == 8);
+	assert(counts.reallocations == 1);
+	assert(counts.live_bytes == 8 * sizeof(int));
+
+	lptr = libadt_lptr_free_with_allocator(lptr, &allocator);
+	assert(!libadt_lptr_allocated(lptr));
+	assert(counts.deallocations == 1);
+	assert(counts.live_bytes == 0);
+}
+
+void test_vector(void)
+{
+	struct counts counts = { 0 };
+	const struct libadt_allocator allocator = COUNTING_ALLOCATOR(counts);
+
+	struct libadt_vector vector = libadt_vector_init_with_allocator(sizeof(int), 0, &allocator);
+	assert(libadt_vector_valid(vector));
+	assert(vector.allocator == &allocator);
+	assert(counts.allocations == 0);
+
+	for (int i = 0; i < 100; i++)
+		vector = libadt_vector_append(vector, &i);
+
+	assert(vector.length == 100);
+	assert(counts.allocations == 1);
+	assert(counts.reallocations > 0);
+	assert(counts.live_bytes == vector.capacity * sizeof(int));
+
+	vector = libadt_vector_vacuum(vector);
+	assert(counts.live_bytes == 100 * sizeof(int));
+
+	vector = libadt_vector_free(vector);
+	assert(counts.deallocations == 1);
+	assert(counts.live_bytes == 0);
+}
+
+void test_bitwise_array(void)
+{
+	struct counts counts = { 0 };
+	const struct libadt_allocator allocator = COUNTING_ALLOCATOR(counts);
+
+	struct libadt_bitwise_array array = libadt_bitwise_array_alloc_with_allocator(10, 3, &allocator);
+	assert(libadt_bitwise_array_valid(array));
+	assert(counts.allocations == 1);
+
+	libadt_bitwise_array_set(array, 9, 5);
+	assert(libadt_bitwise_array_get(array, 9) == 5);
+
+	libadt_bitwise_array_free_with_allocator(array, &allocator);
+	assert(counts.deallocations == 1);
+	assert(counts.live_bytes == 0);
+}
+
+static void check_sequence(struct libadt_vector vector)
+{
+	for (size_t i = 0; i < vector.length; i++)
+		assert(((size_t *)vector.buffer)[i] == i);
+}
+
+void test_huge(void)
+{
+	struct libadt_vector vector = libadt_vector_init_huge(sizeof(size_t), 0);
+	assert(libadt_vector_valid(vector));
+	assert(vector.allocator == &libadt_allocator_huge);
+
+	// Grows well past the threshold
+	const size_t count = 3 * LIBADT_ALLOCATOR_HUGE_THRESHOLD / sizeof(size_t);
+	for (size_t i = 0; i < count; i++)
+		vector = libadt_vector_append(vector, &i);
+	assert(vector.length == count);
+	check_sequence(vector);
+
+	vector.length = count / 2;
+	vector = libadt_vector_vacuum(vector);
+	assert(vector.capacity == count / 2);
+	check_sequence(vector);
+
+	// Back below the threshold
+	vector.length = 100;
+	vector = libadt_vector_vacuum(vector);
+	assert(vector.capacity == 100);
+	check_sequence(vector);
+
+	libadt_vector_free(vector);
+
+	// A smaller threshold, crossing it in both directions
+	const size_t threshold = 4096;
+	struct libadt_allocator small = libadt_allocator_huge;
+	small.context = (void *)&threshold;
+
+	vector = libadt_vector_init_with_allocator(sizeof(size_t), 1, &small);
+	for (size_t i = 0; i < 10000; i++)
+		vector = libadt_vector_append(vector, &i);
+	check_sequence(vector);
+	vector.length = 10;
+	vector = libadt_vector_vacuum(vector);
+	check_sequence(vector);
+	for (size_t i = 10; i < 2000; i++)
+		vector = libadt_vector_append(vector, &i);
+	check_sequence(vector);
+	libadt_vector_free(vector);
+}
+
+int main()
+{
+	test_lptr();
+	test_vector();
+	test_bitwise_array();
+	test_huge();
+}
@@ -0,0 +1,142 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include <stdint.h>
+#include "libadt/arena.h"
+#include "libadt/vector.h"
+
+void test_alloc(void)
+{
+	struct libadt_arena arena = libadt_arena_init(1024);
+	assert(libadt_arena_valid(arena));
+
+	struct libadt_lptr
+		a = libadt_arena_calloc(&arena, 10, sizeof(int)),
+		b = libadt_arena_calloc(&arena, 10, sizeof(double));
+
+	assert(libadt_lptr_valid(a));
+	assert(libadt_lptr_valid(b));
+	assert(a.length == 10 && a.size == sizeof(int));
+	assert(b.length == 10 && b.size == sizeof(double));
+	assert((uintptr_t)b.buffer % _Alignof(max_align_t) == 0);
+	assert(((int *)a.buffer)[9] == 0);
+
+	// Allocations don't overlap
+	assert((char *)b.buffer >= (char *)a.buffer + 10 * sizeof(int));
+
+	arena = libadt_arena_free(arena);
+	assert(!libadt_arena_valid(arena));
+}
+
+void test_aligned_alloc(void)
+{
+	LIBADT_ARENA_WITH(arena, 1024) {
+		libadt_arena_alloc(&arena, 1, 1);
+		struct libadt_lptr aligned = libadt_arena_aligned_alloc(&arena, 4, 16, 64);
+		assert(libadt_lptr_allocated(aligned));
+		assert((uintptr_t)aligned.buffer % 64 == 0);
+
+		struct libadt_lptr bad = libadt_arena_aligned_alloc(&arena, 4, 16, 48);
+		assert(!libadt_lptr_allocated(bad));
+	}
+}
+
+void test_large_and_many(void)
+{
+	LIBADT_ARENA_WITH(arena, 64) {
+		// Larger than a chunk
+		struct libadt_lptr big = libadt_arena_calloc(&arena, 1000, 1);
+		assert(libadt_lptr_allocated(big));
+		memset(big.buffer, 0xff, 1000);
+
+		// Spills across many chunks
+		for (int i = 0; i < 100; i++) {
+			struct libadt_lptr small = libadt_arena_calloc(&arena, 5, sizeof(int));
+			assert(libadt_lptr_allocated(small));
+			((int *)small.buffer)[4] = i;
+		}
+	}
+}
+
+void test_mark_rewind_reset(void)
+{
+	LIBADT_ARENA_WITH(arena, 128) {
+		struct libadt_lptr keep = libadt_arena_alloc(&arena, 16, 1);
+		const struct libadt_arena_mark mark = libadt_arena_mark(&arena);
+
+		struct libadt_lptr first = libadt_arena_alloc(&arena, 500, 1);
+		libadt_arena_alloc(&arena, 500, 1);
+		assert(arena.current != mark.chunk);
+
+		libadt_arena_rewind(&arena, mark);
+		assert(arena.current == mark.chunk);
+		assert(arena.cursor == mark.cursor);
+
+		// Rewinding keeps chunks, so the same memory comes back
+		struct libadt_lptr again = libadt_arena_alloc(&arena, 500, 1);
+		assert(again.buffer == first.buffer);
+
+		libadt_arena_reset(&arena);
+		struct libadt_lptr reset = libadt_arena_alloc(&arena, 16, 1);
+		assert(reset.buffer == keep.buffer);
+	}
+}
+
+void test_scope(void)
+{
+	LIBADT_ARENA_WITH(arena, 128) {
+		unsigned char *const cursor = arena.cursor;
+		LIBADT_ARENA_SCOPE(&arena) {
+			libadt_arena_alloc(&arena, 16, 1);
+			assert(arena.cursor != cursor);
+		}
+		assert(arena.cursor == cursor);
+	}
+}
+
+void test_allocator(void)
+{
+	LIBADT_ARENA_WITH(arena, 256) {
+		const struct libadt_allocator allocator = libadt_arena_allocator(&arena);
+		struct libadt_vector vector = libadt_vector_init_with_allocator(sizeof(int), 1, &allocator);
+		assert(libadt_vector_valid(vector));
+
+		for (int i = 0; i < 1000; i++)
+			vector = libadt_vector_append(vector, &i);
+
+		assert(vector.length == 1000);
+		for (int i = 0; i < 1000; i++)
+			assert(*(int *)libadt_vector_index(vector, (size_t)i) == i);
+
+		// Freeing the last allocation gives it back
+		unsigned char *const cursor = arena.cursor;
+		libadt_vector_free(vector);
+		assert(arena.cursor < cursor);
+	}
+}
+
+int main()
+{
+	test_alloc();
+	test_aligned_alloc();
+	test_large_and_many();
+	test_mark_rewind_reset();
+	test_scope();
+	test_allocator();
+}
@@ -79,10 +79,212 @@ void test_get_large_overlap()
 	assert(libadt_bitwise_array_get(array, 3) == 1000);
 }
 
+void test_big_endian_layout()
+{
+	struct libadt_bitwise_array array = libadt_bitwise_array_alloc(16, 12);
+	assert(libadt_bitwise_array_valid(array));
+
+	libadt_bitwise_array_set(array, 0, 0xabc);
+	libadt_bitwise_array_set(array, 1, 0xdef);
+
+	assert(array.bits[0] == 0xab);
+	assert(array.bits[1] == 0xcd);
+	assert(array.bits[2] == 0xef);
+
+	array.bits[3] = 0x12;
+	array.bits[4] = 0x34;
+	array.bits[5] = 0x56;
+
+	assert(libadt_bitwise_array_get(array, 2) == 0x123);
+	assert(libadt_bitwise_array_get(array, 3) == 0x456);
+
+	libadt_bitwise_array_free(array);
+}
+
+void test_all_widths()
+{
+	for (int width = 1; width <= 32; width++) {
+		const ssize_t length = 100;
+		const unsigned mask = width == 32 ? ~0u : ~(~0u << width);
+		struct libadt_bitwise_array array = libadt_bitwise_array_alloc(length, width);
+		assert(libadt_bitwise_array_valid(array));
+
+		for (ssize_t i = 0; i < length; i++)
+			libadt_bitwise_array_set(array, i, ~0u & mask);
+		for (ssize_t i = 0; i < length; i += 2)
+			libadt_bitwise_array_set(array, i, (unsigned)(i * 2654435761u) & mask);
+
+		// Setting an element must not disturb its neighbours
+		for (ssize_t i = 0; i < length; i++) {
+			const unsigned expected = i % 2
+				? ~0u & mask
+				: (unsigned)(i * 2654435761u) & mask;
+			assert(libadt_bitwise_array_get(array, i) == expected);
+		}
+
+		libadt_bitwise_array_free(array);
+	}
+}
+
+void test_all_widths64()
+{
+	for (int width = 1; width <= 64; width++) {
+		const ssize_t length = 100;
+		const uint64_t mask = ~0ull >> (64 - width);
+		struct libadt_bitwise_array array = libadt_bitwise_array_alloc(length, width);
+		assert(libadt_bitwise_array_valid(array));
+
+		for (ssize_t i = 0; i < length; i++)
+			libadt_bitwise_array_set64(array, i, mask);
+		for (ssize_t i = 0; i < length; i += 2)
+			libadt_bitwise_array_set64(array, i, (uint64_t)i * 0x9e3779b97f4a7c15u & mask);
+
+		// Up to the last element, which is read a bit at a time
+		for (ssize_t i = 0; i < length; i++) {
+			const uint64_t expected = i % 2
+				? mask
+				: (uint64_t)i * 0x9e3779b97f4a7c15u & mask;
+			assert(libadt_bitwise_array_get64(array, i) == expected);
+			assert(libadt_bitwise_array_get(array, i) == (unsigned)expected);
+		}
+
+		libadt_bitwise_array_free(array);
+	}
+}
+
+void test_big_endian_layout64()
+{
+	struct libadt_bitwise_array array = libadt_bitwise_array_alloc(4, 40);
+	assert(libadt_bitwise_array_valid(array));
+
+	libadt_bitwise_array_set64(array, 0, 0x0123456789u);
+	libadt_bitwise_array_set64(array, 1, 0xabcdef0123u);
+	assert(array.bits[0] == 0x01);
+	assert(array.bits[4] == 0x89);
+	assert(array.bits[5] == 0xab);
+	assert(array.bits[9] == 0x23);
+	assert(libadt_bitwise_array_get64(array, 1) == 0xabcdef0123u);
+
+	libadt_bitwise_array_free(array);
+}
+
+void test_alloc_overflow()
+{
+	assert(!libadt_bitwise_array_valid(libadt_bitwise_array_alloc(SSIZE_MAX / 2, 3)));
+	assert(!libadt_bitwise_array_valid(libadt_bitwise_array_alloc(-1, 1)));
+}
+
+void test_unpack()
+{
+	const ssize_t length = 300;
+	unsigned out[300];
+
+	for (int width = 1; width <= 32; width++) {
+		const unsigned mask = width == 32 ? ~0u : ~(~0u << width);
+		struct libadt_bitwise_array array = libadt_bitwise_array_alloc(length, width);
+		assert(libadt_bitwise_array_valid(array));
+
+		for (ssize_t i = 0; i < length; i++)
+			libadt_bitwise_array_set(array, i, (unsigned)(i * 2654435761u) & mask);
+
+		for (ssize_t start = 0; start < 9; start++) {
+			const ssize_t count = length - start * 3;
+			libadt_bitwise_array_unpack(array, start, count, out);
+			for (ssize_t i = 0; i < count; i++)
+				assert(out[i] == libadt_bitwise_array_get(array, start + i));
+		}
+
+		libadt_bitwise_array_free(array);
+	}
+}
+
+void test_pack()
+{
+	const ssize_t length = 300;
+	unsigned in[300];
+
+	for (int width = 1; width <= 32; width++) {
+		const unsigned mask = width == 32 ? ~0u : ~(~0u << width);
+		for (ssize_t i = 0; i < length; i++)
+			in[i] = (unsigned)(i * 2654435761u) & mask;
+
+		for (ssize_t start = 0; start < 9; start++) {
+			const ssize_t count = length - start * 3;
+			struct libadt_bitwise_array array = libadt_bitwise_array_alloc(length, width);
+			assert(libadt_bitwise_array_valid(array));
+
+			for (ssize_t i = 0; i < length; i++)
+				libadt_bitwise_array_set(array, i, mask);
+
+			libadt_bitwise_array_pack(array, start, count, in);
+
+			// Elements outside of the packed range are untouched
+			for (ssize_t i = 0; i < length; i++) {
+				const unsigned expected = i >= start && i < start + count
+					? in[i - start]
+					: mask;
+				assert(libadt_bitwise_array_get(array, i) == expected);
+			}
+
+			libadt_bitwise_array_free(array);
+		}
+	}
+}
+
+void test_pack_unpack_wide()
+{
+	// Wider elements hold unsigned ints whole, and keep the bits
+	// above them when read back as unsigned ints
+	const ssize_t length = 300;
+	const int widths[] = { 33, 40, 61 };
+	unsigned in[300], out[300];
+
+	for (size_t w = 0; w < sizeof(widths) / sizeof(*widths); w++) {
+		const int width = widths[w];
+		const uint64_t mask = ~0ull >> (64 - width);
+		for (ssize_t i = 0; i < length; i++)
+			in[i] = (unsigned)(i * 2654435761u);
+
+		for (ssize_t start = 0; start < 9; start++) {
+			const ssize_t count = length - start * 3;
+			struct libadt_bitwise_array array = libadt_bitwise_array_alloc(length, width);
+			assert(libadt_bitwise_array_valid(array));
+
+			for (ssize_t i = 0; i < length; i++)
+				libadt_bitwise_array_set64(array, i, mask);
+
+			libadt_bitwise_array_pack(array, start, count, in);
+			for (ssize_t i = 0; i < length; i++) {
+				const uint64_t expected = i >= start && i < start + count
+					? in[i - start]
+					: mask;
+				assert(libadt_bitwise_array_get64(array, i) == expected);
+				assert(libadt_bitwise_array_get(array, i) == (unsigned)expected);
+			}
+
+			for (ssize_t i = 0; i < length; i++)
+				libadt_bitwise_array_set64(array, i, (uint64_t)i * 0x9e3779b97f4a7c15u & mask);
+			libadt_bitwise_array_unpack(array, start, count, out);
+			for (ssize_t i = 0; i < count; i++)
+				assert(out[i] == (unsigned)((uint64_t)(start + i) * 0x9e3779b97f4a7c15u & mask));
+
+			libadt_bitwise_array_free(array);
+		}
+	}
+}
+
 int main()
 {
 	test_alloc_success();
 	test_get_byte();
 	test_get_small_overlap();
 	test_get_large_overlap();
+	test_big_endian_layout();
+	test_all_widths();
+	test_all_widths64();
+	test_big_endian_layout64();
+	test_alloc_overflow();
+	test_unpack();
+	test_pack();
+	test_pack_unpack_wide();
 }
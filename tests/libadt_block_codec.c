@@ -0,0 +1,147 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "libadt/block_codec.h"
+
+#include <stdlib.h>
+
+enum { LENGTH = 3000 };
+
+static const enum libadt_block_codec_mode modes[] = {
+	LIBADT_BLOCK_CODEC_FOR,
+	LIBADT_BLOCK_CODEC_DELTA,
+	LIBADT_BLOCK_CODEC_ZIGZAG_DELTA,
+};
+
+static uint64_t random64(unsigned int *state)
+{
+	return (uint64_t)rand_r(state) << 42 ^ (uint64_t)rand_r(state) << 21 ^ (uint64_t)rand_r(state);
+}
+
+// Sorted with small steps, evenly spaced, wandering up and down,
+// decreasing, and random 64-bit values with no pattern at all
+static void fill(uint64_t *values, int pattern, unsigned int *state)
+{
+	uint64_t value = (uint64_t)1 << 40;
+	for (size_t i = 0; i < LENGTH; i++) {
+		switch (pattern) {
+		case 0: value += (uint64_t)rand_r(state) % 1000; break;
+		case 1: value += 60; break;
+		case 2: value += (uint64_t)(rand_r(state) % 201) - 100; break;
+		case 3: value -= (uint64_t)rand_r(state) % 50; break;
+		default: value = random64(state); break;
+		}
+		values[i] = value;
+	}
+}
+
+static void check(const uint64_t *values, size_t length, size_t block_length, enum libadt_block_codec_mode mode)
+{
+	struct libadt_block_codec codec = libadt_block_codec_encode(values, length, block_length, mode);
+	assert(libadt_block_codec_valid(codec));
+	assert(libadt_block_codec_blocks(codec) == (length + block_length - 1) / block_length);
+
+	uint64_t *const out = malloc(sizeof(*out) * (length + 1));
+	assert(out);
+	libadt_block_codec_decode(&codec, out);
+	assert(!memcmp(out, values, sizeof(*out) * length));
+
+	for (size_t b = 0; b < libadt_block_codec_blocks(codec); b++) {
+		const size_t decoded = libadt_block_codec_decode_block(&codec, b, out);
+		const size_t start = b * block_length;
+		assert(decoded == (length - start < block_length ? length - start : block_length));
+		assert(!memcmp(out, values + start, sizeof(*out) * decoded));
+	}
+
+	for (size_t i = 0; i < length; i++)
+		assert(libadt_block_codec_get(&codec, i) == values[i]);
+
+	free(out);
+	codec = libadt_block_codec_free(codec);
+	assert(!libadt_block_codec_valid(codec));
+}
+
+void test_round_trip(void)
+{
+	uint64_t *const values = malloc(sizeof(*values) * LENGTH);
+	assert(values);
+	const size_t
+		block_lengths[] = { 1, 7, 128, 256 },
+		lengths[] = { 0, 1, 2, 127, 128, 129, LENGTH };
+	unsigned int state = 11;
+	for (int pattern = 0; pattern < 5; pattern++) {
+		fill(values, pattern, &state);
+		for (size_t m = 0; m < sizeof(modes) / sizeof(*modes); m++)
+			for (size_t b = 0; b < sizeof(block_lengths) / sizeof(*block_lengths); b++)
+				for (size_t l = 0; l < sizeof(lengths) / sizeof(*lengths); l++)
+					check(values, lengths[l], block_lengths[b], modes[m]);
+	}
+	free(values);
+}
+
+void test_widths(void)
+{
+	uint64_t values[256];
+	for (size_t i = 0; i < 256; i++)
+		values[i] = 1000 + i * 5;
+
+	// Evenly spaced values take no bits as deltas
+	struct libadt_block_codec codec = libadt_block_codec_encode(values, 256, 128, LIBADT_BLOCK_CODEC_DELTA);
+	assert(codec.headers[0].width == 0);
+	assert(codec.headers[0].base == 1000);
+	assert(codec.headers[0].reference == 5);
+	assert(codec.headers[1].base == 1640);
+	assert(codec.size == 0);
+	libadt_block_codec_free(codec);
+
+	// Zigzag encodes a step of 5 as 10, and FOR spans 127 steps
+	codec = libadt_block_codec_encode(values, 256, 128, LIBADT_BLOCK_CODEC_ZIGZAG_DELTA);
+	assert(codec.headers[0].width == 4);
+	libadt_block_codec_free(codec);
+	codec = libadt_block_codec_encode(values, 256, 128, LIBADT_BLOCK_CODEC_FOR);
+	assert(codec.headers[0].width == 10);
+	assert(codec.headers[0].base == 1000);
+	libadt_block_codec_free(codec);
+
+	// An outlier only widens its own block
+	values[200] = UINT64_MAX;
+	codec = libadt_block_codec_encode(values, 256, 128, LIBADT_BLOCK_CODEC_FOR);
+	assert(codec.headers[0].width == 10);
+	assert(codec.headers[1].width == 64);
+	libadt_block_codec_free(codec);
+}
+
+void test_invalid(void)
+{
+	const uint64_t values[1] = { 0 };
+	assert(!libadt_block_codec_valid(libadt_block_codec_encode(values, 1, 0, LIBADT_BLOCK_CODEC_FOR)));
+	assert(!libadt_block_codec_valid(libadt_block_codec_encode(
+		values,
+		1,
+		LIBADT_BLOCK_CODEC_MAX_BLOCK + 1,
+		LIBADT_BLOCK_CODEC_FOR
+	)));
+}
+
+int main()
+{
+	test_round_trip();
+	test_widths();
+	test_invalid();
+}
@@ -0,0 +1,166 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "libadt/elias_fano.h"
+
+#include <stdlib.h>
+
+static uint64_t random64(unsigned int *state)
+{
+	return ((uint64_t)rand_r(state) << 42)
+		^ ((uint64_t)rand_r(state) << 21)
+		^ (uint64_t)rand_r(state);
+}
+
+// The index of the first value at least x, by binary search
+static size_t lower_bound(const uint64_t *values, size_t length, uint64_t x)
+{
+	size_t low = 0, high = length;
+	while (low < high) {
+		const size_t middle = low + (high - low) / 2;
+		if (values[middle] < x)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	return low;
+}
+
+static void check(const uint64_t *values, size_t length, unsigned int *state)
+{
+	struct libadt_elias_fano sequence = libadt_elias_fano_init(values, length);
+	assert(libadt_elias_fano_valid(sequence));
+	assert(sequence.length == length);
+
+	for (size_t i = 0; i < length; i++)
+		assert(libadt_elias_fano_get(&sequence, i) == values[i]);
+
+	struct libadt_elias_fano_iterator iterator = libadt_elias_fano_iterator_at(&sequence, 0);
+	uint64_t value;
+	for (size_t i = 0; i < length; i++) {
+		assert(libadt_elias_fano_iterator_next(&iterator, &value));
+		assert(value == values[i]);
+	}
+	assert(!libadt_elias_fano_iterator_next(&iterator, &value));
+
+	// From a few starting points, including the end
+	for (size_t start = length; start > 0; start /= 3) {
+		iterator = libadt_elias_fano_iterator_at(&sequence, start);
+		for (size_t i = start; i < length; i++) {
+			assert(libadt_elias_fano_iterator_next(&iterator, &value));
+			assert(value == values[i]);
+		}
+		assert(!libadt_elias_fano_iterator_next(&iterator, &value));
+	}
+
+	// Each value, either side of it, and random values
+	for (size_t i = 0; length && i < length + 100; i++) {
+		const uint64_t x = i < length ? values[i] : random64(state) % (values[length - 1] | 1);
+		const uint64_t targets[] = { x ? x - 1 : x, x, x < UINT64_MAX ? x + 1 : x };
+		for (size_t t = 0; t < sizeof(targets) / sizeof(*targets); t++) {
+			const size_t expected = lower_bound(values, length, targets[t]);
+			value = 0;
+			assert(libadt_elias_fano_next_geq(&sequence, targets[t], &value) == expected);
+			if (expected < length)
+				assert(value == values[expected]);
+		}
+	}
+	assert(libadt_elias_fano_next_geq(&sequence, UINT64_MAX, &value) == lower_bound(values, length, UINT64_MAX));
+
+	sequence = libadt_elias_fano_free(sequence);
+	assert(!libadt_elias_fano_valid(sequence));
+}
+
+void test_random(void)
+{
+	enum { LENGTH = 5000 };
+	uint64_t *const values = malloc(sizeof(uint64_t) * LENGTH);
+	assert(values);
+	unsigned int state = 7;
+
+	// Gaps averaging from 0, all duplicates, to very sparse
+	const uint64_t gaps[] = { 0, 1, 2, 3, 64, 1000, (uint64_t)1 << 40 };
+	const size_t lengths[] = { 1, 2, 63, 64, 65, 1000, LENGTH };
+	for (size_t g = 0; g < sizeof(gaps) / sizeof(*gaps); g++) {
+		for (size_t l = 0; l < sizeof(lengths) / sizeof(*lengths); l++) {
+			uint64_t value = random64(&state) % 100;
+			for (size_t i = 0; i < lengths[l]; i++) {
+				value += gaps[g] ? random64(&state) % (2 * gaps[g]) : 0;
+				values[i] = value;
+			}
+			check(values, lengths[l], &state);
+		}
+	}
+	free(values);
+}
+
+void test_edges(void)
+{
+	unsigned int state = 11;
+	const uint64_t zeros[] = { 0, 0, 0 };
+	check(zeros, 3, &state);
+
+	const uint64_t extremes[] = { 0, 1, UINT64_MAX / 2, UINT64_MAX - 1, UINT64_MAX, UINT64_MAX };
+	for (size_t i = 1; i <= sizeof(extremes) / sizeof(*extremes); i++)
+		check(extremes, i, &state);
+	const uint64_t largest[] = { UINT64_MAX };
+	check(largest, 1, &state);
+
+	// An empty sequence has nothing to get or find
+	struct libadt_elias_fano sequence = libadt_elias_fano_init(NULL, 0);
+	assert(libadt_elias_fano_valid(sequence));
+	uint64_t value;
+	assert(libadt_elias_fano_next_geq(&sequence, 0, &value) == 0);
+	struct libadt_elias_fano_iterator iterator = libadt_elias_fano_iterator_at(&sequence, 0);
+	assert(!libadt_elias_fano_iterator_next(&iterator, &value));
+	libadt_elias_fano_free(sequence);
+}
+
+void test_invalid(void)
+{
+	const uint64_t decreasing[] = { 1, 5, 4 };
+	assert(!libadt_elias_fano_valid(libadt_elias_fano_init(decreasing, 3)));
+}
+
+void test_size(void)
+{
+	// Gaps of about 1000 take about 2 + log2(1000) bits each
+	enum { LENGTH = 100000 };
+	uint64_t *const values = malloc(sizeof(uint64_t) * LENGTH);
+	assert(values);
+	unsigned int state = 13;
+	uint64_t value = 0;
+	for (size_t i = 0; i < LENGTH; i++)
+		values[i] = value += 1 + random64(&state) % 2000;
+
+	struct libadt_elias_fano sequence = libadt_elias_fano_init(values, LENGTH);
+	assert(libadt_elias_fano_valid(sequence));
+	assert(sequence.low.width == 9);
+	assert(libadt_elias_fano_size(sequence) * 8 < (size_t)LENGTH * 12);
+	libadt_elias_fano_free(sequence);
+	free(values);
+}
+
+int main()
+{
+	test_random();
+	test_edges();
+	test_invalid();
+	test_size();
+}
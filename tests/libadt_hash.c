@@ -0,0 +1,115 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "libadt/hash.h"
+
+#include <stdint.h>
+
+static unsigned char data[1000];
+
+static struct libadt_const_lptr bytes(const void *buffer, size_t length)
+{
+	return (struct libadt_const_lptr) { buffer, 1, (ssize_t)length };
+}
+
+void test_hash(void)
+{
+	// Every length, including every short path, is deterministic and
+	// distinguishes the last byte
+	for (size_t length = 0; length <= 200; length++) {
+		const uint64_t hash = libadt_lptr_hash(bytes(data, length));
+		assert(hash == libadt_lptr_hash(bytes(data, length)));
+		assert(hash == libadt_lptr_hash_seeded(bytes(data, length), 0));
+		assert(hash != libadt_lptr_hash_seeded(bytes(data, length), 1));
+		if (length) {
+			data[length - 1] ^= 1;
+			assert(hash != libadt_lptr_hash(bytes(data, length)));
+			data[length - 1] ^= 1;
+		}
+		assert(hash != libadt_lptr_hash(bytes(data, length + 1)));
+	}
+
+	// The element size counts
+	const uint32_t words[4] = { 1, 2, 3, 4 };
+	assert(
+		libadt_lptr_hash((struct libadt_const_lptr) { words, sizeof(uint32_t), 4 })
+		== libadt_lptr_hash(bytes(words, sizeof(words)))
+	);
+}
+
+void test_no_collisions(void)
+{
+	// Small integer keys, as in a hash table
+	static uint64_t hashes[1 << 16];
+	for (uint32_t i = 0; i < 1 << 16; i++)
+		hashes[i] = libadt_lptr_hash(bytes(&i, sizeof(i)));
+	for (uint32_t i = 0; i < 1 << 16; i++)
+		for (uint32_t j = i + 1; j < i + 64 && j < 1 << 16; j++)
+			assert(hashes[i] != hashes[j]);
+}
+
+void test_streaming(void)
+{
+	// Any split of any length gives the one-shot hash
+	for (size_t length = 0; length <= 300; length += length < 100 ? 1 : 7) {
+		const uint64_t expected = libadt_lptr_hash_seeded(bytes(data, length), 42);
+		for (size_t chunk = 1; chunk <= 70; chunk++) {
+			struct libadt_lptr_hasher hasher = libadt_lptr_hasher_init(42);
+			for (size_t offset = 0; offset < length; offset += chunk) {
+				const size_t size = length - offset < chunk ? length - offset : chunk;
+				libadt_lptr_hasher_update(&hasher, bytes(data + offset, size));
+			}
+			assert(libadt_lptr_hasher_final(&hasher) == expected);
+		}
+	}
+
+	// Uneven chunks, and finalizing part way through
+	struct libadt_lptr_hasher hasher = libadt_lptr_hasher_init(0);
+	size_t offset = 0;
+	for (size_t chunk = 0; offset + chunk <= sizeof(data); offset += chunk, chunk = (chunk * 7 + 3) % 101) {
+		libadt_lptr_hasher_update(&hasher, bytes(data + offset, chunk));
+		assert(
+			libadt_lptr_hasher_final(&hasher)
+			== libadt_lptr_hash(bytes(data, offset + chunk))
+		);
+	}
+}
+
+void test_batch(void)
+{
+	struct libadt_const_lptr lptrs[100];
+	uint64_t hashes[100];
+	for (size_t i = 0; i < 100; i++)
+		lptrs[i] = bytes(data + i, i * 3);
+	libadt_lptr_hash_batch(lptrs, hashes, 100, 7);
+	for (size_t i = 0; i < 100; i++)
+		assert(hashes[i] == libadt_lptr_hash_seeded(lptrs[i], 7));
+	libadt_lptr_hash_batch(lptrs, hashes, 0, 7);
+}
+
+int main()
+{
+	for (size_t i = 0; i < sizeof(data); i++)
+		data[i] = (unsigned char)(i * 131 + 17);
+
+	test_hash();
+	test_no_collisions();
+	test_streaming();
+	test_batch();
+}
@@ -0,0 +1,304 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "libadt/hash_map.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static uint64_t mix64(uint64_t x)
+{
+	x ^= x >> 33;
+	x *= 0xff51afd7ed558ccdu;
+	x ^= x >> 33;
+	x *= 0xc4ceb9fe1a85ec53u;
+	x ^= x >> 33;
+	return x;
+}
+
+#define u64_equal(a, b) ((a) == (b))
+LIBADT_HASH_MAP_DEFINE(u64_map, uint64_t, uint64_t, mix64, u64_equal)
+
+// Sends every key down the same probe sequence
+static uint64_t constant(uint64_t x)
+{
+	(void)x;
+	return 0x1234;
+}
+LIBADT_HASH_MAP_DEFINE(colliding_map, uint64_t, uint32_t, constant, u64_equal)
+
+void test_init(void)
+{
+	struct libadt_hash_map map = libadt_hash_map_init(sizeof(int), sizeof(int), NULL, NULL);
+	assert(libadt_hash_map_valid(map));
+	assert(map.length == 0);
+	assert(map.capacity == 0);
+	int key = 1;
+	assert(!libadt_hash_map_find(&map, &key));
+	assert(!libadt_hash_map_erase(&map, &key));
+	assert(libadt_hash_map_next(&map, 0) == map.capacity);
+	libadt_hash_map_clear(&map);
+	map = libadt_hash_map_free(map);
+	assert(!libadt_hash_map_valid(map));
+}
+
+void test_generic(void)
+{
+	struct libadt_hash_map map = libadt_hash_map_init(sizeof(int), sizeof(long), NULL, NULL);
+	for (int i = 0; i < 10000; i++) {
+		const long value = (long)i * 3;
+		long *const stored = libadt_hash_map_insert(&map, &i, &value);
+		assert(stored);
+		assert(*stored == value);
+	}
+	assert(map.length == 10000);
+	assert(map.length <= map.capacity - map.capacity / 8);
+
+	for (int i = 0; i < 10000; i++) {
+		const long *const value = libadt_hash_map_find(&map, &i);
+		assert(value);
+		assert(*value == (long)i * 3);
+	}
+	for (int i = 10000; i < 20000; i++)
+		assert(!libadt_hash_map_find(&map, &i));
+
+	// Replacing keeps the length
+	const int key = 42;
+	const long replacement = -1;
+	libadt_hash_map_insert(&map, &key, &replacement);
+	assert(map.length == 10000);
+	assert(*(long *)libadt_hash_map_find(&map, &key) == -1);
+
+	for (int i = 0; i < 10000; i += 2)
+		assert(libadt_hash_map_erase(&map, &i));
+	assert(!libadt_hash_map_erase(&map, &key));
+	assert(map.length == 5000);
+	for (int i = 0; i < 10000; i++)
+		assert(!libadt_hash_map_find(&map, &i) == !(i % 2));
+
+	libadt_hash_map_free(map);
+}
+
+struct wide_key {
+	char name[20];
+	int number;
+};
+
+void test_wide_keys(void)
+{
+	struct libadt_hash_map map = libadt_hash_map_init(sizeof(struct wide_key), sizeof(int), NULL, NULL);
+	for (int i = 0; i < 500; i++) {
+		struct wide_key key = { { 0 }, i };
+		snprintf(key.name, sizeof(key.name), "key %d", i % 7);
+		assert(libadt_hash_map_insert(&map, &key, &i));
+	}
+	for (int i = 0; i < 500; i++) {
+		struct wide_key key = { { 0 }, i };
+		snprintf(key.name, sizeof(key.name), "key %d", i % 7);
+		const int *const value = libadt_hash_map_find(&map, &key);
+		assert(value && *value == i);
+		snprintf(key.name, sizeof(key.name), "key %d", i % 7 + 1);
+		assert(!libadt_hash_map_find(&map, &key));
+	}
+	libadt_hash_map_free(map);
+}
+
+void test_set(void)
+{
+	struct libadt_hash_map set = libadt_hash_map_init(sizeof(uint64_t), 0, NULL, NULL);
+	for (uint64_t i = 0; i < 1000; i++) {
+		const uint64_t key = i * i;
+		const uint64_t *const stored = libadt_hash_map_insert(&set, &key, NULL);
+		assert(stored && *stored == key);
+	}
+	for (uint64_t i = 0; i < 1000; i++) {
+		const uint64_t key = i * i, other = i * i + 2;
+		assert(libadt_hash_map_find(&set, &key));
+		assert(i < 2 || !libadt_hash_map_find(&set, &other));
+	}
+	libadt_hash_map_free(set);
+}
+
+void test_iterate(void)
+{
+	struct libadt_hash_map map = u64_map_init();
+	uint64_t expected = 0;
+	for (uint64_t i = 1; i <= 300; i++) {
+		u64_map_insert(&map, i, i * 10);
+		expected += i;
+	}
+	for (uint64_t i = 1; i <= 300; i += 3) {
+		assert(u64_map_erase(&map, i));
+		expected -= i;
+	}
+
+	uint64_t sum = 0;
+	size_t count = 0;
+	for (
+		size_t slot = libadt_hash_map_next(&map, 0);
+		slot < map.capacity;
+		slot = libadt_hash_map_next(&map, slot + 1)
+	) {
+		const uint64_t key = *(uint64_t *)libadt_hash_map_key(&map, slot);
+		assert(*(uint64_t *)libadt_hash_map_value(&map, slot) == key * 10);
+		sum += key;
+		count++;
+	}
+	assert(count == map.length);
+	assert(sum == expected);
+	libadt_hash_map_free(map);
+}
+
+void test_typed(void)
+{
+	struct libadt_hash_map map = u64_map_init();
+	for (uint64_t i = 0; i < 100000; i++)
+		assert(u64_map_insert(&map, i * 0x9e3779b97f4a7c15u, i));
+	assert(map.length == 100000);
+	for (uint64_t i = 0; i < 100000; i++) {
+		const uint64_t *const value = u64_map_find(&map, i * 0x9e3779b97f4a7c15u);
+		assert(value && *value == i);
+	}
+	assert(!u64_map_find(&map, 1));
+
+	// Typed and generic functions work on the same map
+	const uint64_t key = 5 * 0x9e3779b97f4a7c15u, value = 55;
+	assert(*(uint64_t *)libadt_hash_map_find(&map, &key) == 5);
+	libadt_hash_map_insert(&map, &key, &value);
+	assert(*u64_map_find(&map, key) == 55);
+	assert(libadt_hash_map_erase(&map, &key));
+	assert(!u64_map_find(&map, key));
+	assert(!u64_map_erase(&map, key));
+	libadt_hash_map_free(map);
+}
+
+void test_collisions(void)
+{
+	struct libadt_hash_map map = colliding_map_init();
+	for (uint64_t i = 0; i < 200; i++)
+		assert(colliding_map_insert(&map, i, (uint32_t)i + 1));
+	for (uint64_t i = 0; i < 200; i++)
+		assert(*colliding_map_find(&map, i) == i + 1);
+	assert(!colliding_map_find(&map, 200));
+	for (uint64_t i = 0; i < 200; i += 2)
+		assert(colliding_map_erase(&map, i));
+	for (uint64_t i = 0; i < 200; i++)
+		assert(!colliding_map_find(&map, i) == !(i % 2));
+	libadt_hash_map_free(map);
+}
+
+void test_churn(void)
+{
+	// Deleted slots are reclaimed without the table growing forever
+	struct libadt_hash_map map = u64_map_init();
+	for (uint64_t i = 0; i < 100; i++)
+		u64_map_insert(&map, i, i);
+	const size_t capacity = map.capacity;
+	for (uint64_t i = 100; i < 100000; i++) {
+		assert(u64_map_insert(&map, i, i));
+		assert(u64_map_erase(&map, i - 100));
+	}
+	assert(map.length == 100);
+	assert(map.capacity <= 2 * capacity);
+	for (uint64_t i = 100000 - 100; i < 100000; i++)
+		assert(*u64_map_find(&map, i) == i);
+	libadt_hash_map_free(map);
+}
+
+void test_reserve_clear(void)
+{
+	struct libadt_hash_map map = u64_map_init();
+	assert(libadt_hash_map_reserve(&map, 1000));
+	const size_t capacity = map.capacity;
+	assert(capacity - capacity / 8 >= 1000);
+	for (uint64_t i = 0; i < 1000; i++)
+		u64_map_insert(&map, i, i);
+	assert(map.capacity == capacity);
+	assert(libadt_hash_map_reserve(&map, 10));
+	assert(map.capacity == capacity);
+
+	libadt_hash_map_clear(&map);
+	assert(map.length == 0);
+	assert(map.capacity == capacity);
+	assert(!u64_map_find(&map, 5));
+	assert(libadt_hash_map_next(&map, 0) == map.capacity);
+	u64_map_insert(&map, 5, 6);
+	assert(*u64_map_find(&map, 5) == 6);
+	libadt_hash_map_free(map);
+}
+
+static int allocations;
+
+static void *allocate(void *context, size_t size)
+{
+	(void)context;
+	allocations++;
+	return malloc(size);
+}
+
+static void *reallocate(void *context, void *buffer, size_t old_size, size_t new_size)
+{
+	(void)context;
+	(void)old_size;
+	return realloc(buffer, new_size);
+}
+
+static void deallocate(void *context, void *buffer, size_t size)
+{
+	(void)context;
+	(void)size;
+	allocations--;
+	free(buffer);
+}
+
+void test_allocator(void)
+{
+	const struct libadt_allocator allocator = {
+		.allocate = allocate,
+		.reallocate = reallocate,
+		.deallocate = deallocate,
+	};
+	struct libadt_hash_map map = libadt_hash_map_init_with_allocator(
+		sizeof(int),
+		sizeof(int),
+		NULL,
+		NULL,
+		&allocator
+	);
+	for (int i = 0; i < 1000; i++)
+		libadt_hash_map_insert(&map, &i, &i);
+	assert(allocations == 3);
+	libadt_hash_map_free(map);
+	assert(allocations == 0);
+}
+
+int main()
+{
+	test_init();
+	test_generic();
+	test_wide_keys();
+	test_set();
+	test_iterate();
+	test_typed();
+	test_collisions();
+	test_churn();
+	test_reserve_clear();
+	test_allocator();
+}
@@ -0,0 +1,161 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "libadt/mmap.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static char path[] = "/tmp/libadt_mmap_XXXXXX";
+
+// Replaces the contents of the file at path
+static void write_file(const void *data, size_t size)
+{
+	FILE *const file = fopen(path, "wb");
+	assert(file);
+	assert(fwrite(data, 1, size, file) == size);
+	assert(!fclose(file));
+}
+
+void test_mmap_file(void)
+{
+	static const char text[] = "hello\nworld\n";
+	write_file(text, sizeof(text) - 1);
+
+	const int flags[] = {
+		0,
+		LIBADT_MMAP_SEQUENTIAL,
+		LIBADT_MMAP_WILLNEED,
+		LIBADT_MMAP_HUGEPAGE,
+		LIBADT_MMAP_POPULATE | LIBADT_MMAP_SEQUENTIAL,
+	};
+	for (size_t i = 0; i < sizeof(flags) / sizeof(*flags); i++) {
+		struct libadt_const_lptr file = libadt_lptr_mmap_file(path, flags[i]);
+		assert(libadt_const_lptr_allocated(file));
+		assert(file.size == 1);
+		assert(file.length == sizeof(text) - 1);
+		assert(!memcmp(file.buffer, text, sizeof(text) - 1));
+		file = libadt_const_lptr_munmap(file);
+		assert(!libadt_const_lptr_allocated(file));
+	}
+}
+
+void test_mmap_large(void)
+{
+	// Past a huge page, so the mapping is aligned for one
+	const size_t size = (3 << 20) + 123;
+	unsigned char *const data = malloc(size);
+	assert(data);
+	for (size_t i = 0; i < size; i++)
+		data[i] = (unsigned char)(i * 7 + i / 4096);
+	write_file(data, size);
+
+	const int flags[] = {
+		0,
+		LIBADT_MMAP_HUGEPAGE,
+		LIBADT_MMAP_HUGEPAGE | LIBADT_MMAP_POPULATE,
+	};
+	for (size_t i = 0; i < sizeof(flags) / sizeof(*flags); i++) {
+		const struct libadt_const_lptr file = libadt_lptr_mmap_file(path, flags[i]);
+		assert(libadt_const_lptr_allocated(file));
+		assert(file.length == (ssize_t)size);
+		assert(!memcmp(file.buffer, data, size));
+		libadt_const_lptr_munmap(file);
+	}
+	free(data);
+}
+
+void test_mmap_empty(void)
+{
+	// Allocated, so that an empty file is not mistaken for an error
+	write_file("", 0);
+	struct libadt_const_lptr file = libadt_lptr_mmap_file(path, LIBADT_MMAP_POPULATE);
+	assert(libadt_const_lptr_allocated(file));
+	assert(file.length == 0);
+	libadt_const_lptr_munmap(file);
+
+	struct libadt_lptr shared = libadt_lptr_mmap_file_shared(path, 0);
+	assert(libadt_lptr_allocated(shared));
+	assert(shared.length == 0);
+	libadt_lptr_munmap(shared);
+}
+
+void test_mmap_errors(void)
+{
+	errno = 0;
+	struct libadt_const_lptr file = libadt_lptr_mmap_file("/nonexistent/libadt", 0);
+	assert(!libadt_const_lptr_allocated(file));
+	assert(errno == ENOENT);
+
+	// Directories have no contents to map
+	errno = 0;
+	file = libadt_lptr_mmap_file("/tmp", 0);
+	assert(!libadt_const_lptr_allocated(file));
+	assert(errno == ENODEV);
+
+	errno = 0;
+	struct libadt_lptr shared = libadt_lptr_mmap_file_shared("/nonexistent/libadt", 0);
+	assert(!libadt_lptr_allocated(shared));
+	assert(errno == ENOENT);
+
+	// Unmapping a failed mapping does nothing
+	libadt_const_lptr_munmap(file);
+	libadt_lptr_munmap(shared);
+}
+
+void test_mmap_file_shared(void)
+{
+	write_file("abcdef", 6);
+	struct libadt_lptr shared = libadt_lptr_mmap_file_shared(path, LIBADT_MMAP_WILLNEED);
+	assert(libadt_lptr_allocated(shared));
+	assert(shared.length == 6);
+	memcpy((char *)shared.buffer + 2, "XY", 2);
+
+	// Other mappings see the write at once, and the file after
+	// unmapping
+	const struct libadt_const_lptr file = libadt_lptr_mmap_file(path, 0);
+	assert(!memcmp(file.buffer, "abXYef", 6));
+	libadt_const_lptr_munmap(file);
+	shared = libadt_lptr_munmap(shared);
+	assert(!libadt_lptr_allocated(shared));
+
+	char contents[7] = { 0 };
+	FILE *const stream = fopen(path, "rb");
+	assert(stream);
+	assert(fread(contents, 1, sizeof(contents), stream) == 6);
+	fclose(stream);
+	assert(!strcmp(contents, "abXYef"));
+}
+
+int main()
+{
+	const int fd = mkstemp(path);
+	assert(fd >= 0);
+	close(fd);
+
+	test_mmap_file();
+	test_mmap_large();
+	test_mmap_empty();
+	test_mmap_errors();
+	test_mmap_file_shared();
+
+	unlink(path);
+}
@@ -0,0 +1,135 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "libadt/packed_vector.h"
+
+#include <stdlib.h>
+
+void test_init(void)
+{
+	assert(!libadt_packed_vector_valid(libadt_packed_vector_init(0, 0)));
+	assert(!libadt_packed_vector_valid(libadt_packed_vector_init(33, 0)));
+
+	struct libadt_packed_vector vector = libadt_packed_vector_init(5, 100);
+	assert(libadt_packed_vector_valid(vector));
+	assert(vector.width == 5);
+	assert(vector.capacity == 100);
+	assert(vector.length == 0);
+	vector = libadt_packed_vector_free(vector);
+	assert(!libadt_packed_vector_valid(vector));
+}
+
+void test_width_for(void)
+{
+	assert(libadt_packed_vector_width_for(0) == 1);
+	assert(libadt_packed_vector_width_for(1) == 1);
+	assert(libadt_packed_vector_width_for(2) == 2);
+	assert(libadt_packed_vector_width_for(255) == 8);
+	assert(libadt_packed_vector_width_for(256) == 9);
+	assert(libadt_packed_vector_width_for(UINT_MAX) == 32);
+}
+
+void test_append_pop(void)
+{
+	// Growing values widen the vector at every power of two, with
+	// every element re-packed each time
+	enum { LENGTH = 5000 };
+	unsigned int *const expected = malloc(sizeof(*expected) * LENGTH);
+	assert(expected);
+	unsigned int state = 7;
+	struct libadt_packed_vector vector = libadt_packed_vector_init(1, 0);
+	for (size_t i = 0; i < LENGTH; i++) {
+		const int bits = (int)(i * 32 / LENGTH) + 1;
+		expected[i] = (unsigned int)rand_r(&state) * 2654435761u >> (32 - bits);
+		vector = libadt_packed_vector_append(vector, expected[i]);
+		assert(vector.length == i + 1);
+		assert(libadt_packed_vector_fits(vector, expected[i]));
+		assert(libadt_packed_vector_get(vector, i) == expected[i]);
+	}
+	assert(vector.width == 32 || vector.width == 31);
+	for (size_t i = 0; i < LENGTH; i++)
+		assert(libadt_packed_vector_get(vector, i) == expected[i]);
+
+	for (size_t i = LENGTH; i > 0; i--) {
+		unsigned int value;
+		vector = libadt_packed_vector_pop(vector, &value);
+		assert(value == expected[i - 1]);
+		assert(vector.length == i - 1);
+	}
+	libadt_packed_vector_free(vector);
+	free(expected);
+}
+
+void test_append_n(void)
+{
+	enum { LENGTH = 3000 };
+	unsigned int values[LENGTH];
+	for (size_t i = 0; i < LENGTH; i++)
+		values[i] = (unsigned int)(i * 7 % 1000);
+
+	// Appended in runs that start and end part way through bytes,
+	// widened by the second run
+	struct libadt_packed_vector vector = libadt_packed_vector_init(3, 0);
+	vector = libadt_packed_vector_append(vector, 5);
+	vector = libadt_packed_vector_append_n(vector, values, 7);
+	assert(vector.width == 6);
+	vector = libadt_packed_vector_append_n(vector, values + 7, LENGTH - 7);
+	assert(vector.width == 10);
+	vector = libadt_packed_vector_append_n(vector, values, 0);
+	assert(vector.length == LENGTH + 1);
+	assert(libadt_packed_vector_get(vector, 0) == 5);
+	for (size_t i = 0; i < LENGTH; i++)
+		assert(libadt_packed_vector_get(vector, i + 1) == values[i]);
+
+	const struct libadt_bitwise_array array = libadt_packed_vector_array(vector);
+	assert(array.length == LENGTH + 1);
+	assert(array.width == 10);
+	assert(libadt_bitwise_array_get(array, LENGTH) == values[LENGTH - 1]);
+	libadt_packed_vector_free(vector);
+}
+
+void test_reserve_vacuum(void)
+{
+	struct libadt_packed_vector vector = libadt_packed_vector_init(4, 0);
+	vector = libadt_packed_vector_reserve(vector, 1000);
+	assert(vector.capacity == 1000);
+	for (unsigned int i = 0; i < 1000; i++)
+		vector = libadt_packed_vector_append(vector, i % 16);
+	assert(vector.capacity == 1000);
+	vector = libadt_packed_vector_reserve(vector, 10);
+	assert(vector.capacity == 1000);
+
+	for (int i = 0; i < 500; i++)
+		vector = libadt_packed_vector_pop(vector, NULL);
+	vector = libadt_packed_vector_vacuum(vector);
+	assert(vector.capacity == 500);
+	assert(vector.length == 500);
+	for (unsigned int i = 0; i < 500; i++)
+		assert(libadt_packed_vector_get(vector, i) == i % 16);
+	libadt_packed_vector_free(vector);
+}
+
+int main()
+{
+	test_init();
+	test_width_for();
+	test_append_pop();
+	test_append_n();
+	test_reserve_vacuum();
+}
@@ -0,0 +1,197 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "libadt/parallel.h"
+#include "libadt/util.h"
+
+#include <stdint.h>
+
+// serial_bytes of 1 forces even tiny inputs through the threads
+static const struct libadt_parallel settings[] = {
+	{ .threads = 1, .serial_bytes = 1 },
+	{ .threads = 3, .serial_bytes = 1 },
+	{ .threads = 8, .serial_bytes = 1 },
+	{ .threads = 8, .serial_bytes = 0 },
+};
+
+static struct libadt_lptr lptr_of(void *buffer, size_t size, size_t length)
+{
+	return (struct libadt_lptr) {
+		.buffer = buffer,
+		.size = (ssize_t)size,
+		.length = (ssize_t)length,
+	};
+}
+
+static void mark(struct libadt_lptr chunk, size_t offset, void *context)
+{
+	(void)context;
+	// Chunks cover whole cache lines of an aligned buffer
+	assert((uintptr_t)chunk.buffer % LIBADT_PARALLEL_CACHE_LINE == 0);
+	int *const data = chunk.buffer;
+	for (ssize_t i = 0; i < chunk.length; i++)
+		data[i] += (int)offset + (int)i + 1;
+}
+
+void test_for(void)
+{
+	static _Alignas(LIBADT_PARALLEL_CACHE_LINE) int data[100000];
+	static const size_t lengths[] = { 0, 1, 15, 16, 17, 1000, 100000 };
+
+	for (size_t s = 0; s < libadt_util_arrlength(settings); s++) {
+		for (size_t l = 0; l < libadt_util_arrlength(lengths); l++) {
+			const size_t length = lengths[l];
+			memset(data, 0, sizeof(data));
+			libadt_parallel_for(lptr_of(data, sizeof(int), length), mark, NULL, &settings[s]);
+			// Every element visited exactly once, with the right offset
+			for (size_t i = 0; i < length; i++)
+				assert(data[i] == (int)i + 1);
+			for (size_t i = length; i < libadt_util_arrlength(data); i++)
+				assert(data[i] == 0);
+		}
+	}
+
+	// NULL selects the defaults
+	memset(data, 0, sizeof(data));
+	libadt_parallel_for(lptr_of(data, sizeof(int), 100000), mark, NULL, NULL);
+	for (size_t i = 0; i < 100000; i++)
+		assert(data[i] == (int)i + 1);
+}
+
+// The accumulator tracks a range and whether it is in order, which
+// only combines correctly if accumulators are combined in order
+struct range {
+	long long sum;
+	int first;
+	int last;
+	bool ordered;
+};
+
+static void fold(void *accumulator, struct libadt_lptr chunk, void *context)
+{
+	(void)context;
+	struct range *const range = accumulator;
+	const int *const data = chunk.buffer;
+	for (ssize_t i = 0; i < chunk.length; i++) {
+		range->sum += data[i];
+		if (range->first < 0)
+			range->first = data[i];
+		else if (data[i] != range->last + 1)
+			range->ordered = false;
+		range->last = data[i];
+	}
+}
+
+static void combine(void *accumulator, const void *other, void *context)
+{
+	(void)context;
+	struct range *const range = accumulator;
+	const struct range *const next = other;
+	if (next->first < 0)
+		return;
+	if (range->first < 0) {
+		*range = *next;
+		return;
+	}
+	range->sum += next->sum;
+	range->ordered = range->ordered && next->ordered && next->first == range->last + 1;
+	range->last = next->last;
+}
+
+void test_reduce(void)
+{
+	static int data[50000];
+	for (int i = 0; i < 50000; i++)
+		data[i] = i;
+
+	for (size_t s = 0; s < libadt_util_arrlength(settings); s++) {
+		struct range result = { .first = -1, .ordered = true };
+		libadt_parallel_reduce(
+			lptr_of(data, sizeof(int), 50000),
+			lptr_of(&result, sizeof(result), 1),
+			fold,
+			combine,
+			NULL,
+			&settings[s]
+		);
+		assert(result.sum == 50000LL * 49999 / 2);
+		assert(result.first == 0 && result.last == 49999);
+		assert(result.ordered);
+	}
+}
+
+struct pair {
+	int key;
+	int order;
+};
+
+static int compare_pair(const void *first, const void *second)
+{
+	const int
+		a = ((const struct pair *)first)->key,
+		b = ((const struct pair *)second)->key;
+	return (a > b) - (a < b);
+}
+
+void test_sort(void)
+{
+	static struct pair data[100000], scratch[100000];
+	static const size_t lengths[] = { 0, 1, 2, 100, 1001, 100000 };
+	uint64_t state = 1;
+
+	for (size_t s = 0; s < libadt_util_arrlength(settings); s++) {
+		for (size_t l = 0; l < libadt_util_arrlength(lengths); l++) {
+			const size_t length = lengths[l];
+			for (size_t i = 0; i < length; i++) {
+				state ^= state << 13;
+				state ^= state >> 7;
+				state ^= state << 17;
+				// Few distinct keys, to check stability
+				data[i] = (struct pair) { (int)(state % 100), (int)i };
+			}
+
+			assert(libadt_parallel_sort(
+				lptr_of(data, sizeof(*data), length),
+				lptr_of(scratch, sizeof(*scratch), length),
+				compare_pair,
+				&settings[s]
+			));
+			for (size_t i = 1; i < length; i++) {
+				assert(data[i - 1].key <= data[i].key);
+				if (data[i - 1].key == data[i].key)
+					assert(data[i - 1].order < data[i].order);
+			}
+		}
+	}
+
+	// Scratch too small
+	assert(!libadt_parallel_sort(
+		lptr_of(data, sizeof(*data), 10),
+		lptr_of(scratch, sizeof(*scratch), 9),
+		compare_pair,
+		NULL
+	));
+}
+
+int main()
+{
+	test_for();
+	test_reduce();
+	test_sort();
+}
@@ -0,0 +1,210 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include <stdint.h>
+#include "libadt/pool.h"
+
+struct record {
+	long key;
+	double value;
+	char name[20];
+};
+
+void test_init(void)
+{
+	struct libadt_pool pool = libadt_pool_init(sizeof(struct record));
+	assert(libadt_pool_valid(pool));
+	assert(pool.slot_size >= sizeof(struct record));
+	assert(pool.slots >= 16);
+
+	assert(!libadt_pool_valid(libadt_pool_init(0)));
+	assert(!libadt_pool_valid(libadt_pool_init(SIZE_MAX)));
+
+	// Small objects still have room for the free list pointer, and
+	// slots are aligned for any type, as with malloc()
+	struct libadt_pool tiny = libadt_pool_init(1);
+	assert(tiny.slot_size == _Alignof(max_align_t));
+	assert(tiny.slot_size >= sizeof(void *));
+
+	pool = libadt_pool_destroy(pool);
+	assert(!libadt_pool_valid(pool));
+}
+
+void test_alloc_free(void)
+{
+	struct libadt_pool pool = libadt_pool_init(sizeof(struct record));
+
+	struct libadt_lptr
+		a = libadt_pool_calloc(&pool),
+		b = libadt_pool_alloc(&pool);
+
+	assert(libadt_lptr_allocated(a));
+	assert(libadt_lptr_allocated(b));
+	assert(a.size == sizeof(struct record) && a.length == 1);
+	assert(a.buffer != b.buffer);
+	assert((uintptr_t)a.buffer % _Alignof(struct record) == 0);
+	assert(((struct record *)a.buffer)->key == 0);
+	assert(((struct record *)a.buffer)->name[19] == 0);
+
+	// Freed slots are reused first, and calloc zeroes them again
+	memset(a.buffer, 0xff, sizeof(struct record));
+	void *const freed = a.buffer;
+	a = libadt_pool_free(&pool, a);
+	assert(!libadt_lptr_valid(a));
+	a = libadt_pool_calloc(&pool);
+	assert(a.buffer == freed);
+	assert(((struct record *)a.buffer)->key == 0);
+
+	// Freeing an unallocated lptr does nothing
+	libadt_pool_free(&pool, (struct libadt_lptr) { 0 });
+
+	libadt_pool_free(&pool, a);
+	libadt_pool_free(&pool, b);
+	libadt_pool_destroy(pool);
+}
+
+void test_alignment(void)
+{
+	// A 24-byte record of a wider-aligned type needs every slot,
+	// not just the first, on a max_align_t boundary
+	const size_t sizes[] = { 1, 8, 24, sizeof(max_align_t) + 8, 100 };
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(*sizes); s++) {
+		struct libadt_pool pool = libadt_pool_init(sizes[s]);
+		assert(pool.slot_size % _Alignof(max_align_t) == 0);
+		struct libadt_lptr slots[40];
+		for (size_t i = 0; i < 40; i++) {
+			slots[i] = libadt_pool_alloc(&pool);
+			assert(libadt_lptr_allocated(slots[i]));
+			assert((uintptr_t)slots[i].buffer % _Alignof(max_align_t) == 0);
+		}
+		for (size_t i = 0; i < 40; i++)
+			libadt_pool_free(&pool, slots[i]);
+		libadt_pool_destroy(pool);
+	}
+}
+
+void test_many_slabs(void)
+{
+	struct libadt_pool pool = libadt_pool_init(sizeof(struct record));
+	const size_t count = pool.slots * 5 + 3;
+	struct libadt_lptr *objects = calloc(count, sizeof(*objects));
+
+	for (size_t i = 0; i < count; i++) {
+		objects[i] = libadt_pool_alloc(&pool);
+		assert(libadt_lptr_allocated(objects[i]));
+		((struct record *)objects[i].buffer)->key = (long)i;
+	}
+	for (size_t i = 0; i < count; i++)
+		assert(((struct record *)objects[i].buffer)->key == (long)i);
+
+	// Free every other object, then fill the holes again without
+	// needing new slabs
+	for (size_t i = 0; i < count; i += 2)
+		objects[i] = libadt_pool_free(&pool, objects[i]);
+
+	size_t slabs = 0;
+	for (struct libadt_pool_slab *slab = pool.head; slab; slab = slab->next)
+		slabs++;
+
+	for (size_t i = 0; i < count; i += 2) {
+		objects[i] = libadt_pool_alloc(&pool);
+		assert(libadt_lptr_allocated(objects[i]));
+		((struct record *)objects[i].buffer)->key = (long)i;
+	}
+	for (size_t i = 0; i < count; i++)
+		assert(((struct record *)objects[i].buffer)->key == (long)i);
+
+	size_t after = 0;
+	for (struct libadt_pool_slab *slab = pool.head; slab; slab = slab->next)
+		after++;
+	assert(after == slabs);
+
+	// Freeing everything releases all but a few empty slabs, and
+	// trimming releases all but the first
+	for (size_t i = 0; i < count; i++)
+		libadt_pool_free(&pool, objects[i]);
+
+	size_t kept = 0;
+	for (struct libadt_pool_slab *slab = pool.head; slab; slab = slab->next) {
+		assert(slab->used == 0);
+		kept++;
+	}
+	assert(kept == pool.max_empty + 1);
+	assert(pool.empty == pool.max_empty);
+
+	libadt_pool_trim(&pool);
+	assert(pool.head && pool.head == pool.tail);
+	assert(pool.empty == 0);
+
+	// Kept slabs are reused
+	pool.max_empty = 1;
+	for (size_t i = 0; i < pool.slots * 2; i++)
+		objects[i] = libadt_pool_alloc(&pool);
+	for (size_t i = 0; i < pool.slots * 2; i++)
+		libadt_pool_free(&pool, objects[i]);
+	struct libadt_pool_slab *const spare = pool.head->next;
+	assert(spare && pool.empty == 1);
+	for (size_t i = 0; i < pool.slots * 2; i++)
+		objects[i] = libadt_pool_alloc(&pool);
+	assert(pool.empty == 0);
+	assert(pool.head == spare || pool.tail == spare);
+	for (size_t i = 0; i < pool.slots * 2; i++)
+		libadt_pool_free(&pool, objects[i]);
+
+	free(objects);
+	libadt_pool_destroy(pool);
+}
+
+void test_alternating(void)
+{
+	struct libadt_pool pool = libadt_pool_init(sizeof(long));
+	struct libadt_lptr *objects = calloc(pool.slots, sizeof(*objects));
+
+	for (size_t i = 0; i < pool.slots; i++)
+		objects[i] = libadt_pool_alloc(&pool);
+
+	// The first slab is full, so this needs a second one, which is
+	// kept around while empty rather than released and reallocated
+	struct libadt_lptr extra = libadt_pool_alloc(&pool);
+	struct libadt_pool_slab *const second = pool.head;
+	for (int i = 0; i < 10; i++) {
+		libadt_pool_free(&pool, extra);
+		assert(pool.head == second);
+		extra = libadt_pool_alloc(&pool);
+	}
+
+	for (size_t i = 0; i < pool.slots; i++)
+		libadt_pool_free(&pool, objects[i]);
+	libadt_pool_free(&pool, extra);
+	assert(pool.empty == 1);
+	libadt_pool_trim(&pool);
+	assert(pool.head == pool.tail);
+
+	free(objects);
+	libadt_pool_destroy(pool);
+}
+
+int main()
+{
+	test_init();
+	test_alloc_free();
+	test_alignment();
+	test_many_slabs();
+	test_alternating();
+}
@@ -0,0 +1,138 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "libadt/rank_select.h"
+
+#include <stdlib.h>
+
+// Fills length bits with ones at the given density, out of 256, and
+// the bits past the length with garbage, which must not be counted
+static struct libadt_bitwise_array random_bits(ssize_t length, unsigned int density, unsigned int *state)
+{
+	struct libadt_bitwise_array array = libadt_bitwise_array_alloc(length, 1);
+	assert(libadt_bitwise_array_valid(array));
+	for (size_t i = 0; i < libadt_bitwise_array_size(array); i++)
+		array.bits[i] = (libadt_bitwise_array_bit)rand_r(state);
+	for (ssize_t i = 0; i < length; i++)
+		libadt_bitwise_array_set(array, i, (unsigned int)rand_r(state) % 256 < density);
+	return array;
+}
+
+static void check(struct libadt_bitwise_array array)
+{
+	struct libadt_rank_select index = libadt_rank_select_init(array);
+	assert(libadt_rank_select_valid(index));
+
+	size_t ones = 0, zeros = 0;
+	for (ssize_t i = 0; i < array.length; i++) {
+		assert(libadt_rank_select_rank(&index, i) == ones);
+		assert(libadt_rank_select_rank0(&index, i) == zeros);
+		if (libadt_bitwise_array_get(array, i))
+			assert(libadt_rank_select_select(&index, ones++) == i);
+		else
+			assert(libadt_rank_select_select0(&index, zeros++) == i);
+	}
+	assert(libadt_rank_select_rank(&index, array.length) == ones);
+	assert(libadt_rank_select_rank0(&index, array.length) == zeros);
+	assert(index.ones == ones);
+	assert(libadt_rank_select_select(&index, ones) == -1);
+	assert(libadt_rank_select_select0(&index, zeros) == -1);
+
+	index = libadt_rank_select_free(index);
+	assert(!libadt_rank_select_valid(index));
+}
+
+void test_rank_select(void)
+{
+	// Across words, blocks, superblocks and select samples, with
+	// partial last words
+	const ssize_t lengths[] = {
+		0, 1, 63, 64, 65, 511, 512, 513, 1025, 8193,
+		65535, 65536, 65537, 200003,
+	};
+	const unsigned int densities[] = { 0, 3, 128, 253, 256 };
+	unsigned int state = 5;
+	for (size_t l = 0; l < sizeof(lengths) / sizeof(*lengths); l++) {
+		for (size_t d = 0; d < sizeof(densities) / sizeof(*densities); d++) {
+			struct libadt_bitwise_array array = random_bits(lengths[l], densities[d], &state);
+			check(array);
+			libadt_bitwise_array_free(array);
+		}
+	}
+}
+
+void test_invalid(void)
+{
+	struct libadt_bitwise_array array = libadt_bitwise_array_alloc(10, 2);
+	assert(!libadt_rank_select_valid(libadt_rank_select_init(array)));
+	libadt_bitwise_array_free(array);
+}
+
+static size_t allocated;
+
+static void *allocate(void *context, size_t size)
+{
+	(void)context;
+	allocated += size;
+	return malloc(size);
+}
+
+static void *reallocate(void *context, void *buffer, size_t old_size, size_t new_size)
+{
+	(void)context;
+	allocated += new_size - old_size;
+	return realloc(buffer, new_size);
+}
+
+static void deallocate(void *context, void *buffer, size_t size)
+{
+	(void)context;
+	allocated -= size;
+	free(buffer);
+}
+
+void test_size(void)
+{
+	// The index takes under 10% of the bits, however many are ones,
+	// and frees exactly what it allocated
+	const struct libadt_allocator allocator = {
+		.allocate = allocate,
+		.reallocate = reallocate,
+		.deallocate = deallocate,
+	};
+	const ssize_t length = 1 << 20;
+	const unsigned int densities[] = { 0, 3, 128, 256 };
+	unsigned int state = 7;
+	for (size_t d = 0; d < sizeof(densities) / sizeof(*densities); d++) {
+		struct libadt_bitwise_array array = random_bits(length, densities[d], &state);
+		struct libadt_rank_select index = libadt_rank_select_init_with_allocator(array, &allocator);
+		assert(libadt_rank_select_valid(index));
+		assert(allocated * 8 < (size_t)length / 10);
+		libadt_rank_select_free(index);
+		assert(allocated == 0);
+		libadt_bitwise_array_free(array);
+	}
+}
+
+int main()
+{
+	test_rank_select();
+	test_invalid();
+	test_size();
+}
@@ -0,0 +1,194 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "libadt/reader.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static pid_t writer;
+
+// Returns a pipe that a child process writes data into, chunk bytes
+// at a time, so that reads return partial records
+static int pipe_from(const char *data, size_t size, size_t chunk)
+{
+	int fds[2];
+	assert(!pipe(fds));
+	writer = fork();
+	assert(writer >= 0);
+	if (!writer) {
+		close(fds[0]);
+		for (size_t done = 0; done < size;) {
+			const size_t length = size - done < chunk ? size - done : chunk;
+			const ssize_t written = write(fds[1], data + done, length);
+			if (written <= 0)
+				_exit(1);
+			done += (size_t)written;
+		}
+		_exit(0);
+	}
+	close(fds[1]);
+	return fds[0];
+}
+
+static void close_pipe(int fd)
+{
+	int status;
+	close(fd);
+	assert(waitpid(writer, &status, 0) == writer);
+	assert(WIFEXITED(status) && !WEXITSTATUS(status));
+}
+
+static bool is(struct libadt_const_lptr record, const char *expected)
+{
+	return libadt_const_lptr_allocated(record)
+		&& record.length == (ssize_t)strlen(expected)
+		&& !memcmp(record.buffer, expected, strlen(expected));
+}
+
+void test_next_line(void)
+{
+	static const char text[] = "a\nbc\n\nlast";
+	const int fd = pipe_from(text, sizeof(text) - 1, 3);
+	struct libadt_reader reader = libadt_reader_init(fd, 4);
+	assert(libadt_reader_valid(reader));
+
+	assert(is(libadt_reader_next_line(&reader), "a"));
+	assert(is(libadt_reader_next_line(&reader), "bc"));
+	assert(is(libadt_reader_next_line(&reader), ""));
+	assert(is(libadt_reader_next_line(&reader), "last"));
+	assert(!libadt_const_lptr_allocated(libadt_reader_next_line(&reader)));
+	assert(!libadt_const_lptr_allocated(libadt_reader_next_line(&reader)));
+	assert(reader.eof);
+	assert(!reader.error);
+
+	reader = libadt_reader_free(reader);
+	assert(!libadt_reader_valid(reader));
+	close_pipe(fd);
+
+	// No empty record after a final delimiter, and none in no input
+	const int trailing = pipe_from("x;", 2, 2);
+	reader = libadt_reader_init(trailing, 0);
+	assert(is(libadt_reader_next_record(&reader, ';'), "x"));
+	assert(!libadt_const_lptr_allocated(libadt_reader_next_record(&reader, ';')));
+	libadt_reader_free(reader);
+	close_pipe(trailing);
+
+	const int empty = pipe_from("", 0, 1);
+	reader = libadt_reader_init(empty, 0);
+	assert(!libadt_const_lptr_allocated(libadt_reader_next_line(&reader)));
+	libadt_reader_free(reader);
+	close_pipe(empty);
+}
+
+void test_next_record_random(void)
+{
+	// Records from empty to many times the buffer, so that they are
+	// cut off by its end, moved to the front and grown into
+	enum { SIZE = 1 << 18 };
+	char *const text = malloc(SIZE);
+	assert(text);
+	unsigned int state = 3;
+	size_t records = 0;
+	for (size_t i = 0; i < SIZE;) {
+		const size_t length = rand_r(&state) % 8 ? rand_r(&state) % 40 : rand_r(&state) % 3000;
+		for (size_t j = 0; j < length && i < SIZE; j++)
+			text[i++] = (char)('a' + rand_r(&state) % 26);
+		if (i < SIZE)
+			text[i++] = ';';
+		records++;
+	}
+
+	const size_t chunks[] = { 1, 7, 100, 4096, SIZE };
+	for (size_t c = 0; c < sizeof(chunks) / sizeof(*chunks); c++) {
+		const int fd = pipe_from(text, SIZE, chunks[c]);
+		struct libadt_reader reader = libadt_reader_init(fd, 64);
+		size_t at = 0, found = 0;
+		for (
+			struct libadt_const_lptr record = libadt_reader_next_record(&reader, ';');
+			libadt_const_lptr_allocated(record);
+			record = libadt_reader_next_record(&reader, ';')
+		) {
+			assert(record.length <= SIZE - (ssize_t)at);
+			assert(!memcmp(record.buffer, text + at, (size_t)record.length));
+			assert(!memchr(record.buffer, ';', (size_t)record.length));
+			at += (size_t)record.length;
+			if (at < SIZE) {
+				assert(text[at] == ';');
+				at++;
+			}
+			found++;
+		}
+		assert(at == SIZE);
+		assert(found == records - (text[SIZE - 1] == ';'));
+		assert(!reader.error);
+		libadt_reader_free(reader);
+		close_pipe(fd);
+	}
+	free(text);
+}
+
+void test_next_bytes(void)
+{
+	char text[95];
+	for (size_t i = 0; i < sizeof(text); i++)
+		text[i] = (char)i;
+
+	const int fd = pipe_from(text, sizeof(text), 13);
+	struct libadt_reader reader = libadt_reader_init(fd, 16);
+	for (size_t i = 0; i < 9; i++) {
+		const struct libadt_const_lptr record = libadt_reader_next_bytes(&reader, 10);
+		assert(record.length == 10);
+		assert(!memcmp(record.buffer, text + i * 10, 10));
+	}
+
+	// Records larger than the buffer, and a short last record
+	struct libadt_const_lptr record = libadt_reader_next_bytes(&reader, 100);
+	assert(record.length == 5);
+	assert(!memcmp(record.buffer, text + 90, 5));
+	record = libadt_reader_next_bytes(&reader, 10);
+	assert(!libadt_const_lptr_allocated(record));
+	libadt_reader_free(reader);
+	close_pipe(fd);
+}
+
+void test_error(void)
+{
+	// Reading from the write end of a pipe fails
+	int fds[2];
+	assert(!pipe(fds));
+	struct libadt_reader reader = libadt_reader_init(fds[1], 0);
+	assert(!libadt_const_lptr_allocated(libadt_reader_next_line(&reader)));
+	assert(reader.error == EBADF);
+	assert(!reader.eof);
+	assert(!libadt_const_lptr_allocated(libadt_reader_next_bytes(&reader, 1)));
+	libadt_reader_free(reader);
+	close(fds[0]);
+	close(fds[1]);
+}
+
+int main()
+{
+	test_next_line();
+	test_next_record_random();
+	test_next_bytes();
+	test_error();
+}
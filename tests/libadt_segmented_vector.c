@@ -0,0 +1,161 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "libadt/segmented_vector.h"
+
+typedef struct libadt_segmented_vector vector;
+
+void test_init(void)
+{
+	vector a = libadt_segmented_vector_init(sizeof(int), 0);
+	assert(libadt_segmented_vector_valid(a));
+	assert(a.shift == 4);
+	assert(!a.blocks && !a.capacity);
+
+	// Rounded up to a power of two
+	a = libadt_segmented_vector_init(sizeof(int), 5);
+	assert(a.shift == 3);
+
+	a = libadt_segmented_vector_free(a);
+	assert(!libadt_segmented_vector_valid(a));
+}
+
+void test_append_index(void)
+{
+	vector a = libadt_segmented_vector_init(sizeof(size_t), 4);
+
+	for (size_t i = 0; i < 1000; i++) {
+		vector b = libadt_segmented_vector_append(a, &i);
+		assert(!libadt_segmented_vector_identity(a, b));
+		a = b;
+	}
+
+	assert(a.length == 1000);
+	assert(a.capacity >= 1000);
+	for (size_t i = 0; i < 1000; i++)
+		assert(*(size_t *)libadt_segmented_vector_index(a, i) == i);
+
+	// Block boundaries: 4, 8, 16, ... elements
+	assert(libadt_segmented_vector_index(a, 0) == a.blocks[0]);
+	assert(libadt_segmented_vector_index(a, 4) == a.blocks[1]);
+	assert(libadt_segmented_vector_index(a, 12) == a.blocks[2]);
+	assert(libadt_segmented_vector_index(a, 28) == a.blocks[3]);
+
+	libadt_segmented_vector_free(a);
+}
+
+void test_stable_pointers(void)
+{
+	LIBADT_SEGMENTED_VECTOR_WITH(a, sizeof(int), 1) {
+		int value = 42;
+		a = libadt_segmented_vector_append(a, &value);
+		int *const first = libadt_segmented_vector_index(a, 0);
+
+		for (int i = 0; i < 10000; i++)
+			a = libadt_segmented_vector_append(a, &i);
+
+		assert(libadt_segmented_vector_index(a, 0) == first);
+		assert(*first == 42);
+	}
+}
+
+void test_append_n(void)
+{
+	int data[100];
+	for (int i = 0; i < 100; i++)
+		data[i] = i;
+
+	vector a = libadt_segmented_vector_init(sizeof(int), 16);
+	for (int round = 0; round < 10; round++)
+		a = libadt_segmented_vector_append_n(a, data, 100);
+
+	assert(a.length == 1000);
+	for (size_t i = 0; i < 1000; i++)
+		assert(*(int *)libadt_segmented_vector_index(a, i) == (int)(i % 100));
+
+	libadt_segmented_vector_free(a);
+}
+
+void test_pop_vacuum(void)
+{
+	vector a = libadt_segmented_vector_init(sizeof(int), 4);
+	for (int i = 0; i < 100; i++)
+		a = libadt_segmented_vector_append(a, &i);
+
+	int out = 0;
+	a = libadt_segmented_vector_pop(a, &out);
+	assert(out == 99);
+	assert(a.length == 99);
+
+	int *const kept = libadt_segmented_vector_index(a, 5);
+	a.length = 10;
+	a = libadt_segmented_vector_vacuum(a);
+	// Blocks of 4 and 8 elements remain
+	assert(a.capacity == 12);
+	assert(libadt_segmented_vector_index(a, 5) == kept);
+	assert(*kept == 5);
+
+	a.length = 0;
+	a = libadt_segmented_vector_vacuum(a);
+	assert(!a.blocks && !a.capacity);
+
+	// Still usable afterwards
+	a = libadt_segmented_vector_append(a, &out);
+	assert(*(int *)libadt_segmented_vector_index(a, 0) == 99);
+
+	libadt_segmented_vector_free(a);
+}
+
+void test_segment(void)
+{
+	vector a = libadt_segmented_vector_init(sizeof(int), 4);
+	for (int i = 0; i < 50; i++)
+		a = libadt_segmented_vector_append(a, &i);
+
+	struct libadt_lptr run = libadt_segmented_vector_segment(a, 0);
+	assert(run.length == 4 && run.size == sizeof(int));
+	run = libadt_segmented_vector_segment(a, 6);
+	assert(run.length == 6);
+	assert(*(int *)run.buffer == 6);
+
+	// The last run stops at the length
+	run = libadt_segmented_vector_segment(a, 45);
+	assert(run.length == 5);
+
+	int expected = 0;
+	for (size_t i = 0; i < a.length;) {
+		run = libadt_segmented_vector_segment(a, i);
+		for (ssize_t j = 0; j < run.length; j++)
+			assert(((int *)run.buffer)[j] == expected++);
+		i += (size_t)run.length;
+	}
+	assert(expected == 50);
+
+	libadt_segmented_vector_free(a);
+}
+
+int main()
+{
+	test_init();
+	test_append_index();
+	test_stable_pointers();
+	test_append_n();
+	test_pop_vacuum();
+	test_segment();
+}
@@ -0,0 +1,279 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "libadt/sort.h"
+#include "libadt/vector.h"
+#include "libadt/util.h"
+
+#include <stdint.h>
+
+struct pair {
+	int key;
+	int order;
+};
+
+#define int_less(a, b) ((a) < (b))
+#define pair_less(a, b) ((a).key < (b).key)
+
+LIBADT_SORT_DEFINE(sort_int, int, int_less)
+LIBADT_SORT_DEFINE(sort_pair, struct pair, pair_less)
+
+static int compare_int(const void *first, const void *second)
+{
+	const int a = *(const int *)first, b = *(const int *)second;
+	return (a > b) - (a < b);
+}
+
+static int compare_pair(const void *first, const void *second)
+{
+	return compare_int(
+		&((const struct pair *)first)->key,
+		&((const struct pair *)second)->key
+	);
+}
+
+static uint64_t next(uint64_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+static struct libadt_lptr lptr_of(void *buffer, size_t size, size_t length)
+{
+	return (struct libadt_lptr) {
+		.buffer = buffer,
+		.size = (ssize_t)size,
+		.length = (ssize_t)length,
+	};
+}
+
+// Random data, sorted, reversed, all equal and few distinct values,
+// which between them reach every branch of the partitioning
+static void fill(int *data, size_t length, int pattern, uint64_t *state)
+{
+	for (size_t i = 0; i < length; i++) {
+		switch (pattern) {
+		case 0: data[i] = (int)(next(state) % 1000000); break;
+		case 1: data[i] = (int)i; break;
+		case 2: data[i] = (int)(length - i); break;
+		case 3: data[i] = 7; break;
+		default: data[i] = (int)(next(state) % 4); break;
+		}
+	}
+}
+
+static bool sorted(const int *data, size_t length)
+{
+	for (size_t i = 1; i < length; i++)
+		if (data[i - 1] > data[i])
+			return false;
+	return true;
+}
+
+static long long sum(const int *data, size_t length)
+{
+	long long result = 0;
+	for (size_t i = 0; i < length; i++)
+		result += data[i];
+	return result;
+}
+
+void test_sort(void)
+{
+	static const size_t lengths[] = { 0, 1, 2, 3, 16, 17, 100, 1000, 20000 };
+	static int data[20000], scratch[20000];
+	uint64_t state = 1;
+
+	for (size_t l = 0; l < libadt_util_arrlength(lengths); l++) {
+		const size_t length = lengths[l];
+		for (int pattern = 0; pattern < 5; pattern++) {
+			fill(data, length, pattern, &state);
+			long long expected = sum(data, length);
+			libadt_sort(lptr_of(data, sizeof(int), length), compare_int);
+			assert(sorted(data, length));
+			assert(sum(data, length) == expected);
+
+			fill(data, length, pattern, &state);
+			expected = sum(data, length);
+			sort_int(lptr_of(data, sizeof(int), length));
+			assert(sorted(data, length));
+			assert(sum(data, length) == expected);
+
+			fill(data, length, pattern, &state);
+			expected = sum(data, length);
+			assert(libadt_sort_stable(
+				lptr_of(data, sizeof(int), length),
+				lptr_of(scratch, sizeof(int), length),
+				compare_int
+			));
+			assert(sorted(data, length));
+			assert(sum(data, length) == expected);
+
+			fill(data, length, pattern, &state);
+			expected = sum(data, length);
+			assert(sort_int_stable(
+				lptr_of(data, sizeof(int), length),
+				lptr_of(scratch, sizeof(int), length)
+			));
+			assert(sorted(data, length));
+			assert(sum(data, length) == expected);
+		}
+	}
+}
+
+void test_heapsort_fallback(void)
+{
+	// A depth limit of 0 sends everything straight to heapsort
+	int data[1000];
+	uint64_t state = 3;
+	fill(data, 1000, 0, &state);
+	const long long expected = sum(data, 1000);
+	sort_int_introsort(data, 1000, 0);
+	assert(sorted(data, 1000));
+	assert(sum(data, 1000) == expected);
+}
+
+void test_stable(void)
+{
+	static struct pair data[5000];
+	static struct pair scratch[5000];
+	uint64_t state = 5;
+
+	for (int variant = 0; variant < 2; variant++) {
+		for (int i = 0; i < 5000; i++)
+			data[i] = (struct pair) { (int)(next(&state) % 10), i };
+
+		const struct libadt_lptr lptr = lptr_of(data, sizeof(*data), 5000);
+		const struct libadt_lptr scratch_lptr = lptr_of(scratch, sizeof(*scratch), 5000);
+		if (variant)
+			assert(sort_pair_stable(lptr, scratch_lptr));
+		else
+			assert(libadt_sort_stable(lptr, scratch_lptr, compare_pair));
+
+		for (int i = 1; i < 5000; i++) {
+			assert(data[i - 1].key <= data[i].key);
+			if (data[i - 1].key == data[i].key)
+				assert(data[i - 1].order < data[i].order);
+		}
+	}
+
+	// Scratch too small: nothing happens
+	data[0].key = 1;
+	data[1].key = 0;
+	assert(!libadt_sort_stable(
+		lptr_of(data, sizeof(*data), 2),
+		lptr_of(scratch, sizeof(*scratch), 1),
+		compare_pair
+	));
+	assert(!sort_pair_stable(
+		lptr_of(data, sizeof(*data), 2),
+		lptr_of(scratch, sizeof(*scratch), 1)
+	));
+	assert(data[0].key == 1 && data[1].key == 0);
+}
+
+void test_large_elements(void)
+{
+	// Larger than the generic swap's temporary buffer
+	struct big { int key; char padding[100]; } data[300];
+	uint64_t state = 7;
+	for (int i = 0; i < 300; i++) {
+		data[i].key = (int)(next(&state) % 50);
+		data[i].padding[99] = (char)data[i].key;
+	}
+
+	libadt_sort(lptr_of(data, sizeof(*data), 300), compare_int);
+	for (int i = 0; i < 300; i++) {
+		assert(data[i].padding[99] == (char)data[i].key);
+		if (i)
+			assert(data[i - 1].key <= data[i].key);
+	}
+}
+
+void test_radix(void)
+{
+	static uint64_t data64[100000], scratch64[100000];
+	static uint32_t data32[100000], scratch32[100000];
+	uint64_t state = 11;
+
+	// Long enough to take the MSD pass, whose buckets then reach
+	// both the LSD and the comparison paths
+	for (int pattern = 0; pattern < 3; pattern++) {
+		for (size_t i = 0; i < 100000; i++) {
+			const uint64_t value = next(&state);
+			// Full width, small keys that skip passes, and equal keys
+			data64[i] = pattern == 0 ? value : pattern == 1 ? value % 300 : 42;
+			data32[i] = (uint32_t)data64[i];
+		}
+
+		assert(libadt_sort_radix_u64(
+			lptr_of(data64, sizeof(uint64_t), 100000),
+			lptr_of(scratch64, sizeof(uint64_t), 100000)
+		));
+		assert(libadt_sort_radix_u32(
+			lptr_of(data32, sizeof(uint32_t), 100000),
+			lptr_of(scratch32, sizeof(uint32_t), 100000)
+		));
+		for (size_t i = 1; i < 100000; i++) {
+			assert(data64[i - 1] <= data64[i]);
+			assert(data32[i - 1] <= data32[i]);
+		}
+	}
+
+	// Wrong element size, or too little scratch
+	assert(!libadt_sort_radix_u64(
+		lptr_of(data32, sizeof(uint32_t), 10),
+		lptr_of(scratch64, sizeof(uint64_t), 10)
+	));
+	assert(!libadt_sort_radix_u32(
+		lptr_of(data32, sizeof(uint32_t), 10),
+		lptr_of(scratch32, sizeof(uint32_t), 9)
+	));
+	assert(libadt_sort_radix_u32(
+		lptr_of(data32, sizeof(uint32_t), 0),
+		lptr_of(NULL, sizeof(uint32_t), 0)
+	));
+}
+
+void test_vector(void)
+{
+	struct libadt_vector vector = libadt_vector_init(sizeof(int), 0);
+	for (int i = 0; i < 100; i++) {
+		int value = (i * 37) % 100;
+		vector = libadt_vector_append(vector, &value);
+	}
+
+	sort_int(libadt_vector_lptr(vector));
+	for (int i = 0; i < 100; i++)
+		assert(*(int *)libadt_vector_index(vector, (size_t)i) == i);
+
+	libadt_vector_free(vector);
+}
+
+int main()
+{
+	test_sort();
+	test_heapsort_fallback();
+	test_stable();
+	test_large_elements();
+	test_radix();
+	test_vector();
+}
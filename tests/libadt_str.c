@@ -18,6 +18,7 @@
 
 #include <assert.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 #include <wchar.h>
 
@@ -50,9 +51,239 @@ void test_wstr(void)
 	assert(result.length == (ssize_t)wcslen(TEST_WSTR));
 }
 
+static struct libadt_const_lptr bytes(const char *buffer, ssize_t length)
+{
+	return (struct libadt_const_lptr) { buffer, 1, length };
+}
+
+// Brute-force searches to check against
+static ssize_t naive_find(const char *h, ssize_t length, const char *n, ssize_t needle_length)
+{
+	for (ssize_t i = 0; i + needle_length <= length; i++)
+		if (!memcmp(h + i, n, (size_t)needle_length))
+			return i;
+	return -1;
+}
+
+static ssize_t naive_rfind(const char *h, ssize_t length, const char *n, ssize_t needle_length)
+{
+	for (ssize_t i = length - needle_length; i >= 0; i--)
+		if (!memcmp(h + i, n, (size_t)needle_length))
+			return i;
+	return -1;
+}
+
+static ssize_t naive_find_any(const char *h, ssize_t length, const char *set, ssize_t set_length)
+{
+	for (ssize_t i = 0; i < length; i++)
+		if (memchr(set, h[i], (size_t)set_length))
+			return i;
+	return -1;
+}
+
+static ssize_t position(struct libadt_const_lptr haystack, struct libadt_const_lptr result)
+{
+	if (!libadt_const_lptr_allocated(result))
+		return -1;
+	return (const char *)result.buffer - (const char *)haystack.buffer;
+}
+
+void test_find(void)
+{
+	const struct libadt_const_lptr
+		haystack = libadt_str_literal("the cat sat on the mat"),
+		missing = libadt_str_find(haystack, libadt_str_literal("dog"));
+
+	struct libadt_const_lptr result = libadt_str_find(haystack, libadt_str_literal("at"));
+	assert(position(haystack, result) == 5);
+	assert(result.length == 2);
+	assert(position(haystack, libadt_str_rfind(haystack, libadt_str_literal("at"))) == 20);
+	assert(!libadt_const_lptr_allocated(missing));
+	assert(missing.length == 0);
+	assert(position(haystack, libadt_str_find(haystack, libadt_str_literal(""))) == 0);
+	assert(position(haystack, libadt_str_rfind(haystack, libadt_str_literal(""))) == 22);
+	assert(position(haystack, libadt_str_find_byte(haystack, 's')) == 8);
+	assert(position(haystack, libadt_str_find_byte(haystack, 'z')) == -1);
+	assert(position(haystack, libadt_str_find_any(haystack, libadt_str_literal("mso"))) == 8);
+	assert(position(haystack, libadt_str_find_any(haystack, libadt_str_literal("xyz"))) == -1);
+	assert(position(haystack, libadt_str_find_any(haystack, libadt_str_literal(""))) == -1);
+	assert(!libadt_const_lptr_allocated(libadt_str_find(
+		libadt_str_literal("at"),
+		libadt_str_literal("cat")
+	)));
+}
+
+void test_find_random(void)
+{
+	// A small alphabet makes partial matches common, and lengths
+	// around the block sizes exercise the tails
+	static char haystack[300];
+	static char needle[40];
+	unsigned int state = 1;
+	for (int round = 0; round < 3000; round++) {
+		const ssize_t
+			length = rand_r(&state) % (ssize_t)sizeof(haystack),
+			needle_length = 1 + rand_r(&state) % 39,
+			set_length = 1 + rand_r(&state) % 24;
+		const int alphabet = 2 + rand_r(&state) % 4;
+		for (ssize_t i = 0; i < length; i++)
+			haystack[i] = (char)('a' + rand_r(&state) % alphabet);
+		for (ssize_t i = 0; i < needle_length; i++)
+			needle[i] = (char)('a' + rand_r(&state) % alphabet);
+		// Most of the time, plant the needle
+		if (needle_length <= length && rand_r(&state) % 4) {
+			const ssize_t at = rand_r(&state) % (length - needle_length + 1);
+			memcpy(haystack + at, needle, (size_t)needle_length);
+		}
+
+		const struct libadt_const_lptr h = bytes(haystack, length), n = bytes(needle, needle_length);
+		assert(position(h, libadt_str_find(h, n)) == naive_find(haystack, length, needle, needle_length));
+		assert(position(h, libadt_str_rfind(h, n)) == naive_rfind(haystack, length, needle, needle_length));
+		assert(position(h, libadt_str_find_byte(h, needle[0])) == naive_find(haystack, length, needle, 1));
+
+		// Sets beyond the alphabet, some larger than the SIMD limit
+		char set[24];
+		for (ssize_t i = 0; i < set_length; i++)
+			set[i] = (char)('a' + alphabet - 1 + (rand_r(&state) % 40));
+		assert(
+			position(h, libadt_str_find_any(h, bytes(set, set_length)))
+			== naive_find_any(haystack, length, set, set_length)
+		);
+	}
+}
+
+static bool token_is(struct libadt_str_split split, const char *expected)
+{
+	return libadt_str_split_valid(split)
+		&& split.token.length == (ssize_t)strlen(expected)
+		&& !memcmp(split.token.buffer, expected, strlen(expected));
+}
+
+void test_split(void)
+{
+	const struct libadt_const_lptr csv = libadt_str_literal("a,bc,,d,");
+	struct libadt_str_split split = libadt_str_split_next(libadt_str_split_byte(csv, ','));
+	assert(token_is(split, "a"));
+	assert(split.token.buffer == csv.buffer);
+	split = libadt_str_split_next(split);
+	assert(token_is(split, "bc"));
+	split = libadt_str_split_next(split);
+	assert(token_is(split, ""));
+	split = libadt_str_split_next(split);
+	assert(token_is(split, "d"));
+	split = libadt_str_split_next(split);
+	assert(token_is(split, ""));
+	split = libadt_str_split_next(split);
+	assert(!libadt_str_split_valid(split));
+	split = libadt_str_split_next(split);
+	assert(!libadt_str_split_valid(split));
+
+	split = libadt_str_split_next(libadt_str_split_any(
+		libadt_str_literal("key=value; other = 2"),
+		libadt_str_literal("=; ")
+	));
+	const char *const fields[] = { "key", "value", "", "other", "", "", "2" };
+	for (size_t i = 0; i < libadt_util_arrlength(fields); i++, split = libadt_str_split_next(split))
+		assert(token_is(split, fields[i]));
+	assert(!libadt_str_split_valid(split));
+
+	split = libadt_str_split_next(libadt_str_split(
+		libadt_str_literal("one\r\ntwo\r\n\r\nthree"),
+		libadt_str_literal("\r\n")
+	));
+	const char *const lines[] = { "one", "two", "", "three" };
+	for (size_t i = 0; i < libadt_util_arrlength(lines); i++, split = libadt_str_split_next(split))
+		assert(token_is(split, lines[i]));
+	assert(!libadt_str_split_valid(split));
+
+	// An empty string has one empty field, an empty substring or set
+	// never matches, and a NULL string has none
+	split = libadt_str_split_next(libadt_str_split_byte(libadt_str_literal(""), ','));
+	assert(token_is(split, ""));
+	assert(!libadt_str_split_valid(libadt_str_split_next(split)));
+	split = libadt_str_split_next(libadt_str_split(libadt_str_literal("abc"), libadt_str_literal("")));
+	assert(token_is(split, "abc"));
+	assert(!libadt_str_split_valid(libadt_str_split_next(split)));
+	char bytes[200];
+	for (size_t i = 0; i < sizeof(bytes); i++)
+		bytes[i] = (char)i;
+	const struct libadt_const_lptr all = { bytes, 1, sizeof(bytes) };
+	split = libadt_str_split_next(libadt_str_split_any(all, (struct libadt_const_lptr) { "", 1, 0 }));
+	assert(libadt_str_split_valid(split));
+	assert(split.token.buffer == bytes && split.token.length == (ssize_t)sizeof(bytes));
+	assert(!libadt_str_split_valid(libadt_str_split_next(split)));
+	split = libadt_str_split_next(libadt_str_split_byte((struct libadt_const_lptr) { NULL, 1, 0 }, ','));
+	assert(!libadt_str_split_valid(split));
+}
+
+void test_split_random(void)
+{
+	// Rebuild each string from its fields, across many windows
+	static char str[500], rebuilt[600];
+	unsigned int state = 2;
+	for (int round = 0; round < 2000; round++) {
+		const ssize_t length = rand_r(&state) % (ssize_t)sizeof(str);
+		const int alphabet = 2 + rand_r(&state) % 30;
+		for (ssize_t i = 0; i < length; i++)
+			str[i] = (char)('a' + rand_r(&state) % alphabet);
+
+		char set[24];
+		const ssize_t set_length = 1 + rand_r(&state) % 24;
+		for (ssize_t i = 0; i < set_length; i++)
+			set[i] = (char)('a' + rand_r(&state) % 40);
+
+		const struct libadt_const_lptr
+			whole = bytes(str, length),
+			delimiters = bytes(set, set_length),
+			substring = bytes(set, 1 + set_length % 3);
+		const int mode = round % 3;
+		struct libadt_str_split split = mode == 0
+			? libadt_str_split_byte(whole, set[0])
+			: mode == 1
+				? libadt_str_split_any(whole, delimiters)
+				: libadt_str_split(whole, substring);
+
+		ssize_t at = 0, fields = 0;
+		for (
+			split = libadt_str_split_next(split);
+			libadt_str_split_valid(split);
+			split = libadt_str_split_next(split)
+		) {
+			// Each field is in place, followed by a delimiter unless last
+			const char *const token = split.token.buffer;
+			assert(token == str + at);
+			if (mode == 0)
+				assert(!memchr(token, set[0], (size_t)split.token.length));
+			else if (mode == 1)
+				assert(naive_find_any(token, split.token.length, set, set_length) < 0);
+			else if (mode == 2)
+				// The leftmost match, even one starting inside the field
+				assert(
+					naive_find(token, length - at, set, substring.length)
+					== (libadt_const_lptr_allocated(split.rest) ? split.token.length : -1)
+				);
+			memcpy(rebuilt + at, token, (size_t)split.token.length);
+			at += split.token.length;
+			fields++;
+			if (libadt_const_lptr_allocated(split.rest)) {
+				const ssize_t delimiter_length = mode == 2 ? substring.length : 1;
+				assert(split.rest.buffer == str + at + delimiter_length);
+				assert(split.rest.length == length - at - delimiter_length);
+				at += delimiter_length;
+			}
+		}
+		assert(at == length);
+		assert(fields >= 1);
+	}
+}
+
 int main()
 {
 	test_lit();
 	test_str();
 	test_wstr();
+	test_find();
+	test_find_random();
+	test_split();
+	test_split_random();
 }
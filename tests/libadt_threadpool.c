@@ -0,0 +1,240 @@
+/*
+ * libadt - A library containing abstract data types
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "libadt/threadpool.h"
+#include "libadt/parallel.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+static atomic_size_t counter;
+
+static void count(void *context)
+{
+	atomic_fetch_add(&counter, (size_t)(uintptr_t)context);
+}
+
+static struct libadt_threadpool_task counting(size_t amount)
+{
+	return (struct libadt_threadpool_task) {
+		.function = count,
+		.context = (void *)(uintptr_t)amount,
+	};
+}
+
+void test_init(void)
+{
+	struct libadt_threadpool *pool = libadt_threadpool_init(3);
+	assert(pool);
+	assert(libadt_threadpool_threads(pool) == 3);
+	libadt_threadpool_free(pool);
+
+	pool = libadt_threadpool_init(0);
+	assert(pool);
+	assert(libadt_threadpool_threads(pool) >= 1);
+	libadt_threadpool_free(pool);
+
+	libadt_threadpool_free(NULL);
+}
+
+void test_spawn_wait(void)
+{
+	struct libadt_threadpool *pool = libadt_threadpool_init(4);
+	static struct libadt_threadpool_task tasks[1000];
+
+	for (int round = 0; round < 3; round++) {
+		atomic_store(&counter, 0);
+		struct libadt_threadpool_group group = LIBADT_THREADPOOL_GROUP_INIT;
+		for (size_t i = 0; i < 1000; i++) {
+			tasks[i] = counting(1);
+			libadt_threadpool_spawn(pool, &group, &tasks[i]);
+		}
+		libadt_threadpool_wait(pool, &group);
+		assert(atomic_load(&counter) == 1000);
+		assert(atomic_load(&group.pending) == 0);
+	}
+
+	// Batches
+	atomic_store(&counter, 0);
+	struct libadt_threadpool_group group = LIBADT_THREADPOOL_GROUP_INIT;
+	for (size_t i = 0; i < 1000; i++)
+		tasks[i] = counting(2);
+	libadt_threadpool_spawn_n(pool, &group, tasks, 1000);
+	libadt_threadpool_spawn_n(pool, &group, tasks, 0);
+	libadt_threadpool_wait(pool, &group);
+	assert(atomic_load(&counter) == 2000);
+
+	libadt_threadpool_free(pool);
+}
+
+struct fib {
+	struct libadt_threadpool *pool;
+	unsigned int n;
+	unsigned long result;
+};
+
+static void fib(void *context)
+{
+	struct fib *const f = context;
+	if (f->n < 2) {
+		f->result = f->n;
+		return;
+	}
+
+	struct fib
+		left = { f->pool, f->n - 1, 0 },
+		right = { f->pool, f->n - 2, 0 };
+	struct libadt_threadpool_task task = { .function = fib, .context = &left };
+	struct libadt_threadpool_group group = LIBADT_THREADPOOL_GROUP_INIT;
+	libadt_threadpool_spawn(f->pool, &group, &task);
+	fib(&right);
+	libadt_threadpool_wait(f->pool, &group);
+	f->result = left.result + right.result;
+}
+
+void test_fork_join(void)
+{
+	for (unsigned int threads = 1; threads <= 4; threads++) {
+		struct libadt_threadpool *pool = libadt_threadpool_init(threads);
+		struct fib f = { pool, 20, 0 };
+		struct libadt_threadpool_task task = { .function = fib, .context = &f };
+		struct libadt_threadpool_group group = LIBADT_THREADPOOL_GROUP_INIT;
+		libadt_threadpool_spawn(pool, &group, &task);
+		libadt_threadpool_wait(pool, &group);
+		assert(f.result == 6765);
+		libadt_threadpool_free(pool);
+	}
+}
+
+struct fan_out {
+	struct libadt_threadpool *pool;
+	size_t number;
+	bool batch;
+};
+
+static void fan_out(void *context)
+{
+	const struct fan_out *const fan = context;
+	struct libadt_threadpool_task *const tasks = calloc(fan->number, sizeof(*tasks));
+	struct libadt_threadpool_group group = LIBADT_THREADPOOL_GROUP_INIT;
+	for (size_t i = 0; i < fan->number; i++)
+		tasks[i] = counting(1);
+
+	if (fan->batch) {
+		libadt_threadpool_spawn_n(fan->pool, &group, tasks, fan->number);
+	} else {
+		for (size_t i = 0; i < fan->number; i++)
+			libadt_threadpool_spawn(fan->pool, &group, &tasks[i]);
+	}
+	libadt_threadpool_wait(fan->pool, &group);
+	free(tasks);
+}
+
+void test_full_deque(void)
+{
+	// More tasks than a deque holds: the rest run inline
+	struct libadt_threadpool *pool = libadt_threadpool_init(2);
+	for (int batch = 0; batch < 2; batch++) {
+		atomic_store(&counter, 0);
+		struct fan_out fan = { pool, 5 * LIBADT_THREADPOOL_DEQUE_CAPACITY, batch };
+		struct libadt_threadpool_task task = { .function = fan_out, .context = &fan };
+		struct libadt_threadpool_group group = LIBADT_THREADPOOL_GROUP_INIT;
+		libadt_threadpool_spawn(pool, &group, &task);
+		libadt_threadpool_wait(pool, &group);
+		assert(atomic_load(&counter) == fan.number);
+	}
+	libadt_threadpool_free(pool);
+}
+
+void test_free_drains(void)
+{
+	static struct libadt_threadpool_task tasks[100];
+	atomic_store(&counter, 0);
+	struct libadt_threadpool *pool = libadt_threadpool_init(2);
+	for (size_t i = 0; i < 100; i++) {
+		tasks[i] = counting(1);
+		libadt_threadpool_spawn(pool, NULL, &tasks[i]);
+	}
+	libadt_threadpool_free(pool);
+	assert(atomic_load(&counter) == 100);
+}
+
+static int compare_int(const void *first, const void *second)
+{
+	const int a = *(const int *)first, b = *(const int *)second;
+	return (a > b) - (a < b);
+}
+
+struct sort_job {
+	struct libadt_parallel parallel;
+	int *data;
+	int *scratch;
+	size_t length;
+};
+
+static void sort_job(void *context)
+{
+	struct sort_job *const job = context;
+	assert(libadt_parallel_sort(
+		(struct libadt_lptr) { job->data, sizeof(int), (ssize_t)job->length },
+		(struct libadt_lptr) { job->scratch, sizeof(int), (ssize_t)job->length },
+		compare_int,
+		&job->parallel
+	));
+}
+
+void test_parallel(void)
+{
+	// The parallel algorithms can run on a pool, even from its tasks
+	struct libadt_threadpool *pool = libadt_threadpool_init(3);
+	static int data[20000], scratch[20000];
+	for (int i = 0; i < 20000; i++)
+		data[i] = (i * 7919) % 20000;
+
+	struct sort_job job = {
+		.parallel = { .pool = pool, .serial_bytes = 1 },
+		.data = data,
+		.scratch = scratch,
+		.length = 20000,
+	};
+	struct libadt_threadpool_task task = { .function = sort_job, .context = &job };
+	struct libadt_threadpool_group group = LIBADT_THREADPOOL_GROUP_INIT;
+	libadt_threadpool_spawn(pool, &group, &task);
+	libadt_threadpool_wait(pool, &group);
+	for (int i = 0; i < 20000; i++)
+		assert(data[i] == i);
+
+	for (int i = 0; i < 20000; i++)
+		data[i] = 20000 - i;
+	sort_job(&job);
+	for (int i = 0; i < 20000; i++)
+		assert(data[i] == i + 1);
+
+	libadt_threadpool_free(pool);
+}
+
+int main()
+{
+	test_init();
+	test_spawn_wait();
+	test_fork_join();
+	test_full_deque();
+	test_free_drains();
+	test_parallel();
+}
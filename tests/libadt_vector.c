@@ -29,6 +29,7 @@
 #define vector_end libadt_vector_end
 #define truncate libadt_vector_trunc
 #define pop libadt_vector_pop
+#define reserve libadt_vector_reserve
 typedef struct libadt_vector vector;
 
 void test_identity(void)
@@ -222,6 +223,191 @@ void test_pop(void)
 	assert(output == 4);
 }
 
+void test_reserve(void)
+{
+	vector a = init_vector(sizeof(int), 0);
+
+	int data = 4;
+	a = append(a, &data);
+
+	a = reserve(a, 100);
+	assert(a.capacity == 100);
+	assert(a.length == 1);
+	assert(*(int*)index(a, 0) == 4);
+
+	// Reserving less than the capacity does nothing
+	vector same = reserve(a, 10);
+	assert(identity(same, a));
+
+	// Appending within the reserved capacity doesn't reallocate
+	void *const buffer = a.buffer;
+	for (int i = 0; i < 99; i++)
+		a = append(a, &i);
+	assert(a.buffer == buffer);
+	assert(a.capacity == 100);
+
+	free_vector(a);
+}
+
+static size_t grow_to_seven(
+	const struct libadt_vector_growth *growth,
+	size_t size,
+	size_t capacity,
+	size_t required
+)
+{
+	(void)size;
+	(void)capacity;
+	(void)required;
+	++*(int *)growth->context;
+	return 7;
+}
+
+void test_growth(void)
+{
+	int data[128] = { 0 };
+
+	vector a = init_vector(sizeof(int), 100);
+	a.growth = &libadt_vector_growth_half;
+	a = append_n(a, data, 101);
+	assert(a.capacity == 150);
+	free_vector(a);
+
+	const struct libadt_vector_growth chunk = {
+		.grow = libadt_vector_grow_chunk,
+		.parameter = 32,
+	};
+	a = init_vector(sizeof(int), 0);
+	a.growth = &chunk;
+	a = append(a, data);
+	assert(a.capacity == 32);
+	a = append_n(a, data, 32);
+	assert(a.capacity == 64);
+	a.length = 60;
+	a = append_n(a, data, 10);
+	assert(a.length == 70 && a.capacity == 96);
+	free_vector(a);
+
+	a = init_vector(3, 1000);
+	a.growth = &libadt_vector_growth_pages;
+	a = append_n(a, data, 1);
+	a.length = 1000;
+	a = append_n(a, data, 1);
+	// 1500 elements rounded up to two pages' worth
+	assert(a.capacity == 8192 / 3);
+	free_vector(a);
+
+	int calls = 0;
+	const struct libadt_vector_growth custom = {
+		.grow = grow_to_seven,
+		.context = &calls,
+	};
+	a = init_vector(sizeof(int), 0);
+	a.growth = &custom;
+	a = append(a, data);
+	assert(calls == 1 && a.capacity == 7);
+	// Policies that don't grow enough get the required capacity
+	a = append_n(a, data, 10);
+	assert(calls == 2 && a.capacity == 11);
+	free_vector(a);
+}
+
+void test_extend_uninit(void)
+{
+	vector a = init_vector(sizeof(int), 0);
+
+	int *slots = NULL;
+	a = libadt_vector_extend_uninit(a, 10, (void **)&slots);
+	assert(slots);
+	assert(slots == a.buffer);
+	assert(a.length == 0);
+	assert(a.capacity >= 10);
+
+	// A partial fill
+	for (int i = 0; i < 6; i++)
+		slots[i] = i;
+	a = libadt_vector_commit(a, 6);
+	assert(a.length == 6);
+
+	a = libadt_vector_extend_uninit(a, 100, (void **)&slots);
+	assert(slots == (int *)a.buffer + 6);
+	for (int i = 0; i < 100; i++)
+		slots[i] = 6 + i;
+	a = libadt_vector_commit(a, 100);
+	assert(a.length == 106);
+	for (int i = 0; i < 106; i++)
+		assert(*(int*)index(a, i) == i);
+
+	a = libadt_vector_rollback(a, 6);
+	assert(a.length == 100);
+	a = libadt_vector_rollback(a, 1000);
+	assert(a.length == 0);
+
+	// Commits never pass the capacity
+	a = libadt_vector_commit(a, a.capacity + 10);
+	assert(a.length == a.capacity);
+
+	free_vector(a);
+}
+
+void test_append_lptr(void)
+{
+	int data[] = { 1, 2, 3, 4 };
+	vector a = init_vector(sizeof(int), 0);
+
+	a = libadt_vector_append_lptr(a, libadt_const_lptr_init_array(data));
+	assert(a.length == 4);
+	assert(*(int*)index(a, 3) == 4);
+
+	// Mismatched sizes are refused
+	const long longs[] = { 1, 2 };
+	vector same = libadt_vector_append_lptr(a, libadt_const_lptr_init_array(longs));
+	assert(identity(same, a));
+
+	// Appending the vector to itself, forcing reallocations
+	for (int round = 0; round < 5; round++) {
+		a = libadt_vector_trunc(a, a.length);
+		const size_t length = a.length;
+		a = libadt_vector_append_lptr(a, (struct libadt_const_lptr) {
+			.buffer = a.buffer,
+			.size = sizeof(int),
+			.length = (ssize_t)length,
+		});
+		assert(a.length == length * 2);
+	}
+	assert(a.length == 128);
+	for (size_t i = 0; i < a.length; i++)
+		assert(*(int*)index(a, i) == data[i % 4]);
+
+	// A slice from the middle of the vector, with and without room
+	a = libadt_vector_trunc(a, a.length);
+	a = append_n(a, index(a, 1), 2);
+	assert(a.length == 130);
+	assert(*(int*)index(a, 128) == 2 && *(int*)index(a, 129) == 3);
+	a = append_n(a, index(a, 2), 1);
+	assert(*(int*)index(a, 130) == 3);
+
+	free_vector(a);
+}
+
+void test_append_sizes(void)
+{
+	const size_t sizes[] = { 1, 2, 3, 4, 8, 16, 24 };
+	unsigned char element[24];
+
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+		vector a = init_vector(sizes[s], 0);
+		for (int i = 0; i < 100; i++) {
+			memset(element, i, sizeof(element));
+			a = append(a, element);
+		}
+		for (size_t i = 0; i < 100; i++)
+			for (size_t j = 0; j < sizes[s]; j++)
+				assert(((unsigned char *)index(a, i))[j] == i);
+		free_vector(a);
+	}
+}
+
 int main()
 {
 	test_identity();
@@ -230,4 +416,9 @@ int main()
 	test_append();
 	test_vacuum();
 	test_pop();
+	test_reserve();
+	test_growth();
+	test_extend_uninit();
+	test_append_lptr();
+	test_append_sizes();
 }